@@ -0,0 +1,1746 @@
+//==============================================================================
+// Copyright (c) 2015 Advanced Micro Devices, Inc. All rights reserved.
+//
+/// \author AMD Developer Tools
+/// \file
+/// \brief  A stand-in for the HSAIL debug agent, for exercising gdb without a GPU.
+///
+/// The fake agent is run as gdb's inferior. It speaks the CommunicationControl.h
+/// protocol over the fifos and shared memory like the agent does, dispatches
+/// synthetic kernels and stops on the HSAIL breakpoints gdb creates with
+/// synthetic waves. A session can be recorded and replayed, and the time gdb
+/// takes to handle each notification and to flush its breakpoints is reported.
+//==============================================================================
+/// System:
+#include <errno.h>
+#include <getopt.h>
+#include <poll.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+/// STL:
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <type_traits>
+#include <unordered_set>
+#include <vector>
+
+/// Local:
+#include <CommunicationControl.h>
+#include <CommunicationParams.h>
+#include "FakeAgentRecording.h"
+
+using namespace HsailFakeAgent;
+
+/// How long the agent waits for gdb to read a notification before giving up on the sample
+static const uint64_t gs_NOTIFICATION_TIMEOUT_NS = 10ull * 1000 * 1000 * 1000;
+
+/// How long the agent waits for gdb during the fifo handshake
+static const int gs_HANDSHAKE_TIMEOUT_MS = 30 * 1000;
+
+/// The lanes of a wave
+static const unsigned int gs_WAVE_SIZE = 64;
+
+namespace HsailFakeAgent
+{
+struct Options
+{
+    std::string m_kernelName = "&__OpenCL_fake_kernel";
+    std::string m_binaryPath;
+    std::string m_recordPath;
+    std::string m_replayPath;
+    std::string m_reportPath;
+    unsigned int m_numDispatches = 1;
+    unsigned int m_numWaves = 10;
+    unsigned int m_wavesPerGroup = 1;
+    unsigned int m_numStops = 1;
+    int m_flushTimeoutMs = 50;
+    bool m_isRealTime = false;
+};
+
+/// A command received from gdb, in either protocol
+struct Command
+{
+    HsailCommand m_command = HSAIL_COMMAND_UNKNOWN;
+    int m_gdbBreakpointID = -1;
+    uint64_t m_pc = HSAIL_ISA_PC_UNKOWN;
+    int m_numMomentaryBP = 0;
+    int m_numVariables = 0;
+    HsailConditionPacket m_conditionPacket;
+    std::string m_kernelName;
+};
+
+struct Breakpoint
+{
+    uint64_t m_pc;
+    std::string m_kernelName;
+    HsailConditionPacket m_conditionPacket;
+    bool m_isEnabled;
+};
+
+/// The samples of one latency measurement
+class LatencySeries
+{
+public:
+    void Add(uint64_t ns) { m_samples.push_back(ns); };
+
+    void Print(FILE* pFile, const char* name, const char* prefix) const
+    {
+        if (m_samples.empty())
+        {
+            return;
+        }
+
+        std::vector<uint64_t> sorted(m_samples);
+        std::sort(sorted.begin(), sorted.end());
+
+        uint64_t total = 0;
+
+        for (uint64_t ns : sorted)
+        {
+            total += ns;
+        }
+
+        size_t count = sorted.size();
+        fprintf(pFile, "%s%-32s %8zu %12.1f %12.1f %12.1f %12.1f\n", prefix, name, count,
+                (double)total / count / 1000.0,
+                sorted[count / 2] / 1000.0,
+                sorted[std::min(count - 1, count * 99 / 100)] / 1000.0,
+                sorted[count - 1] / 1000.0);
+    };
+
+private:
+    std::vector<uint64_t> m_samples;
+};
+
+/// A range of a shared memory write
+struct ShmemRange
+{
+    size_t m_offset;
+    const void* m_pData;
+    size_t m_size;
+};
+
+class Session
+{
+public:
+    explicit Session(const Options& options);
+    ~Session();
+
+    bool Initialize();
+    void Terminate();
+
+    /// Generate the dispatches and stops described by the options
+    bool RunGenerated();
+
+    /// Replay a recorded session
+    bool RunReplay();
+
+    void PrintReport() const;
+
+    /// The inferior calls gdb makes into the agent
+    void ServiceVariableReads(int numVariables);
+    void ServiceVariableGather();
+    void SetFocus(const HsailWaveDim3& workGroup, const HsailWaveDim3& workItem);
+    void Kill(bool isQuitCommandIssued);
+
+private:
+    uint64_t Now() const;
+    void SignalGdb() const;
+
+    bool WriteShmem(key_t shmKey, size_t maxSize, size_t offset, const void* pData, size_t dataSize,
+                    const void* pExtraData = nullptr, size_t extraDataSize = 0);
+    bool WriteShmemRanges(key_t shmKey, size_t maxSize, const ShmemRange* pRanges, size_t numRanges);
+    bool Notify(const HsailNotificationPayload& payload, bool isReply = false);
+    bool WaitForDrain(uint64_t& drainNs) const;
+    void Stop();
+
+    /// Read and apply the commands gdb sent, waiting up to timeoutMs for the first one
+    /// Returns true if a command was applied
+    bool ProcessCommands(int timeoutMs);
+    size_t ParseCommands(const unsigned char* pBytes, size_t size);
+    void ApplyCommand(const Command& command);
+
+    bool WriteBinary();
+    bool ReserveWaveBuffer(size_t size);
+    /// Moves the waves of work-group movedWorkGroup to pc, or all the waves if movedWorkGroup is -1
+    bool WriteWaves(unsigned int numWaves, uint64_t pc, int movedWorkGroup, HsailWaveDim3& workGroupSize, HsailWaveDim3& gridSize);
+    void CountBreakpointHit(int gdbBreakpointID, unsigned int numWaves);
+    const Breakpoint* FindStopBreakpoint(int& gdbBreakpointID);
+
+    Options m_options;
+    Recorder m_recorder;
+    uint64_t m_startNs;
+    uint32_t m_protocolVersion;
+    bool m_isBeginDebuggingReceived;
+    bool m_isContinueReceived;
+    bool m_isKillRequested;
+    bool m_isGdbGone;
+    bool m_isTerminated;
+    std::vector<unsigned char> m_binary;
+    std::vector<unsigned char> m_commandBytes;
+    std::map<int, Breakpoint> m_breakpoints;
+    std::map<int, Breakpoint>::const_iterator m_lastStopBreakpoint;
+    std::vector<HsailMomentaryBP> m_momentaryBreakpoints;
+    size_t m_waveBufferSize;
+    std::vector<unsigned char> m_waveSnapshot;  ///< The last snapshot written to the wave buffer
+    uint64_t m_waveSequence;
+    HsailWaveDim3 m_focusWorkGroup;
+    uint64_t m_lastBatchNs;
+    unsigned int m_numBatches;
+
+    LatencySeries m_notificationLatency[HSAIL_NOTIFY_COMMAND_BATCH_COMPLETE + 1];
+    LatencySeries m_flushLatency;
+    LatencySeries m_stopLatency;
+};
+}
+
+static Session* gs_pSession = nullptr;
+
+static const char* NotificationName(HsailNotification notification)
+{
+    switch (notification)
+    {
+        case HSAIL_NOTIFY_BREAKPOINT_HIT: return "BREAKPOINT_HIT";
+        case HSAIL_NOTIFY_NEW_BINARY: return "NEW_BINARY";
+        case HSAIL_NOTIFY_AGENT_UNLOAD: return "AGENT_UNLOAD";
+        case HSAIL_NOTIFY_BEGIN_DEBUGGING: return "BEGIN_DEBUGGING";
+        case HSAIL_NOTIFY_END_DEBUGGING: return "END_DEBUGGING";
+        case HSAIL_NOTIFY_FOCUS_CHANGE: return "FOCUS_CHANGE";
+        case HSAIL_NOTIFY_START_DEBUG_THREAD: return "START_DEBUG_THREAD";
+        case HSAIL_NOTIFY_PREDISPATCH_STATE: return "PREDISPATCH_STATE";
+        case HSAIL_NOTIFY_AGENT_ERROR: return "AGENT_ERROR";
+        case HSAIL_NOTIFY_KILL_COMPLETE: return "KILL_COMPLETE";
+        case HSAIL_NOTIFY_PROTOCOL_VERSION: return "PROTOCOL_VERSION";
+        case HSAIL_NOTIFY_COMMAND_BATCH_COMPLETE: return "COMMAND_BATCH_COMPLETE";
+        default: return "UNKNOWN";
+    }
+}
+
+static size_t AlignRecord(size_t size)
+{
+    return (size + HSAIL_COMMAND_RECORD_ALIGNMENT - 1) & ~((size_t)HSAIL_COMMAND_RECORD_ALIGNMENT - 1);
+}
+
+/// The pid of the debugger tracing us, 0 if there is none
+static pid_t GetTracerPid()
+{
+    pid_t retVal = 0;
+    std::ifstream status("/proc/self/status");
+    std::string line;
+
+    while (std::getline(status, line))
+    {
+        if (0 == line.compare(0, 10, "TracerPid:"))
+        {
+            retVal = (pid_t)atoi(line.c_str() + 10);
+            break;
+        }
+    }
+
+    return retVal;
+}
+
+static void AgentSignalHandler(int signo)
+{
+    HSAIL_UNREFERENCED_PARAMETER(signo);
+}
+
+Session::Session(const Options& options) :
+    m_options(options),
+    m_startNs(0),
+    m_protocolVersion(HSAIL_PROTOCOL_VERSION_LEGACY),
+    m_isBeginDebuggingReceived(false),
+    m_isContinueReceived(false),
+    m_isKillRequested(false),
+    m_isGdbGone(false),
+    m_isTerminated(false),
+    m_lastStopBreakpoint(m_breakpoints.end()),
+    m_waveBufferSize(g_WAVE_BUFFER_INITIAL_SIZE),
+    m_waveSequence(0),
+    m_lastBatchNs(0),
+    m_numBatches(0)
+{
+    m_startNs = Now();
+    memset(&m_focusWorkGroup, 0, sizeof(m_focusWorkGroup));
+}
+
+Session::~Session()
+{
+    Terminate();
+}
+
+uint64_t Session::Now() const
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+/// Let gdb know the next fifo is ready: gdb counts the SIGALRMs it receives,
+/// and the signal raised in the inferior wakes up its wait for inferior events
+void Session::SignalGdb() const
+{
+    kill(GetTracerPid(), SIGALRM);
+    raise(AGENT_GDB_SIGNAL);
+}
+
+bool Session::Initialize()
+{
+    bool retVal = true;
+    struct sigaction action;
+
+    if (0 == GetTracerPid())
+    {
+        fprintf(stderr, "[fake-agent] Must be run under gdb\n");
+        return false;
+    }
+
+    // gdb passes the breakpoint signal back to the inferior when it resumes it
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = AgentSignalHandler;
+    sigaction(SIGUSR2, &action, nullptr);
+
+    if (!m_options.m_recordPath.empty() && !m_recorder.Open(m_options.m_recordPath))
+    {
+        fprintf(stderr, "[fake-agent] Could not create the recording %s\n", m_options.m_recordPath.c_str());
+        return false;
+    }
+
+    retVal = (HSAIL_AGENT_STATUS_SUCCESS == CreateCommunicationFifos());
+    retVal = retVal && (HSAIL_AGENT_STATUS_SUCCESS == AgentAllocSharedMemBuffer(g_DBEBINARY_SHMKEY, g_BINARY_BUFFER_MAXSIZE));
+    retVal = retVal && (HSAIL_AGENT_STATUS_SUCCESS == AgentAllocSharedMemBuffer(g_WAVE_BUFFER_SHMKEY, m_waveBufferSize));
+    retVal = retVal && (HSAIL_AGENT_STATUS_SUCCESS == AgentAllocSharedMemBuffer(g_MOMENTARY_BP_BUFFER_SHMKEY, g_MOMENTARY_BP_BUFFER_MAXSIZE));
+    retVal = retVal && (HSAIL_AGENT_STATUS_SUCCESS == AgentAllocSharedMemBuffer(g_VARIABLE_READ_BUFFER_SHMKEY, g_VARIABLE_READ_BUFFER_MAXSIZE));
+    retVal = retVal && (HSAIL_AGENT_STATUS_SUCCESS == AgentAllocSharedMemBuffer(g_BREAKPOINT_STATISTICS_SHMKEY, g_BREAKPOINT_STATISTICS_MAXSIZE));
+    retVal = retVal && (HSAIL_AGENT_STATUS_SUCCESS == AgentAllocSharedMemBuffer(g_VARIABLE_GATHER_BUFFER_SHMKEY, g_VARIABLE_GATHER_BUFFER_MAXSIZE));
+
+    if (retVal)
+    {
+        HsailBreakpointStatisticsHeader* pHeader =
+            (HsailBreakpointStatisticsHeader*)AgentMapSharedMemBuffer(g_BREAKPOINT_STATISTICS_SHMKEY, g_BREAKPOINT_STATISTICS_MAXSIZE);
+        retVal = (nullptr != pHeader);
+
+        if (retVal)
+        {
+            pHeader->m_version = HSAIL_BREAKPOINT_STATISTICS_VERSION;
+            pHeader->m_numEntries = (g_BREAKPOINT_STATISTICS_MAXSIZE - sizeof(HsailBreakpointStatisticsHeader)) /
+                                    sizeof(HsailBreakpointStatistics);
+            AgentUnMapSharedMemBuffer(pHeader);
+        }
+    }
+
+    // Stage 1: gdb opens its read end, which unblocks our write end
+    retVal = retVal && (HSAIL_AGENT_STATUS_SUCCESS == InitFifoReadEnd());
+
+    if (retVal)
+    {
+        SignalGdb();
+        retVal = (HSAIL_AGENT_STATUS_SUCCESS == InitFifoWriteEnd());
+    }
+
+    // Stage 2: gdb opens its write end and offers its protocol version
+    if (retVal)
+    {
+        uint64_t deadline = Now() + gs_HANDSHAKE_TIMEOUT_MS * 1000000ull;
+        SignalGdb();
+
+        while (!m_isBeginDebuggingReceived && !m_isGdbGone && Now() < deadline)
+        {
+            ProcessCommands(100);
+        }
+
+        retVal = m_isBeginDebuggingReceived;
+
+        if (!retVal)
+        {
+            fprintf(stderr, "[fake-agent] gdb did not begin debugging\n");
+        }
+    }
+
+    if (retVal)
+    {
+        HsailNotificationPayload payload;
+        memset(&payload, 0, sizeof(payload));
+        payload.m_Notification = HSAIL_NOTIFY_START_DEBUG_THREAD;
+        payload.payload.StartDebugThreadNotification.m_tid = (int)syscall(SYS_gettid);
+        retVal = Notify(payload);
+    }
+
+    return retVal;
+}
+
+void Session::Terminate()
+{
+    if (m_isTerminated)
+    {
+        return;
+    }
+
+    m_isTerminated = true;
+    m_recorder.Close();
+
+    if (0 <= GetFifoWriteEnd())
+    {
+        close(GetFifoWriteEnd());
+    }
+
+    if (0 <= GetFifoReadEnd())
+    {
+        close(GetFifoReadEnd());
+    }
+
+    AgentFreeSharedMemBuffer(g_DBEBINARY_SHMKEY, g_BINARY_BUFFER_MAXSIZE);
+    AgentFreeSharedMemBuffer(g_WAVE_BUFFER_SHMKEY, m_waveBufferSize);
+    AgentFreeSharedMemBuffer(g_MOMENTARY_BP_BUFFER_SHMKEY, g_MOMENTARY_BP_BUFFER_MAXSIZE);
+    AgentFreeSharedMemBuffer(g_VARIABLE_READ_BUFFER_SHMKEY, g_VARIABLE_READ_BUFFER_MAXSIZE);
+    AgentFreeSharedMemBuffer(g_BREAKPOINT_STATISTICS_SHMKEY, g_BREAKPOINT_STATISTICS_MAXSIZE);
+    AgentFreeSharedMemBuffer(g_VARIABLE_GATHER_BUFFER_SHMKEY, g_VARIABLE_GATHER_BUFFER_MAXSIZE);
+}
+
+bool Session::WriteShmem(key_t shmKey, size_t maxSize, size_t offset, const void* pData, size_t dataSize,
+                         const void* pExtraData, size_t extraDataSize)
+{
+    ShmemRange ranges[2] = { { offset, pData, dataSize }, { offset + dataSize, pExtraData, extraDataSize } };
+
+    return WriteShmemRanges(shmKey, maxSize, ranges, (0 < extraDataSize) ? 2 : 1);
+}
+
+/// Ranges that follow each other are recorded as one write, so that a replayed
+/// write is never split at a point where the wave buffer would have to grow
+bool Session::WriteShmemRanges(key_t shmKey, size_t maxSize, const ShmemRange* pRanges, size_t numRanges)
+{
+    bool retVal = true;
+    size_t totalSize = 0;
+    unsigned char* pShm = nullptr;
+
+    for (size_t i = 0; i < numRanges; i++)
+    {
+        retVal = retVal && (pRanges[i].m_offset + pRanges[i].m_size <= maxSize);
+        totalSize += pRanges[i].m_size;
+    }
+
+    if (retVal)
+    {
+        pShm = (unsigned char*)AgentMapSharedMemBuffer(shmKey, (int)maxSize);
+        retVal = (nullptr != pShm);
+    }
+
+    if (retVal)
+    {
+        for (size_t i = 0; i < numRanges; i++)
+        {
+            memcpy(pShm + pRanges[i].m_offset, pRanges[i].m_pData, pRanges[i].m_size);
+        }
+
+        AgentUnMapSharedMemBuffer(pShm);
+
+        if (m_recorder.IsOpen())
+        {
+            std::vector<unsigned char> bytes;
+            size_t offset = 0;
+
+            for (size_t i = 0; i <= numRanges; i++)
+            {
+                bool isContiguous = (i < numRanges) && (pRanges[i].m_offset == offset + bytes.size());
+
+                if (!bytes.empty() && !isContiguous)
+                {
+                    HsailRecordShmemWrite shmemWrite;
+                    memset(&shmemWrite, 0, sizeof(shmemWrite));
+                    shmemWrite.m_shmKey = (uint32_t)shmKey;
+                    shmemWrite.m_offset = (uint32_t)offset;
+                    shmemWrite.m_size = bytes.size();
+                    m_recorder.Write(HSAIL_RECORD_SHMEM_WRITE, Now() - m_startNs,
+                                     &shmemWrite, sizeof(shmemWrite), bytes.data(), bytes.size());
+                    bytes.clear();
+                }
+
+                if (i < numRanges)
+                {
+                    if (bytes.empty())
+                    {
+                        offset = pRanges[i].m_offset;
+                    }
+
+                    bytes.insert(bytes.end(), (const unsigned char*)pRanges[i].m_pData,
+                                 (const unsigned char*)pRanges[i].m_pData + pRanges[i].m_size);
+                }
+            }
+        }
+    }
+    else
+    {
+        fprintf(stderr, "[fake-agent] Could not write %zu bytes to shared memory %d\n",
+                totalSize, (int)shmKey);
+    }
+
+    return retVal;
+}
+
+/// Wait until gdb has read everything we wrote to the fifo
+bool Session::WaitForDrain(uint64_t& drainNs) const
+{
+    uint64_t start = Now();
+    uint64_t now = start;
+    int pending = 0;
+
+    do
+    {
+        if (0 != ioctl(GetFifoWriteEnd(), FIONREAD, &pending) || 0 == pending)
+        {
+            break;
+        }
+
+        sched_yield();
+        now = Now();
+    }
+    while (now - start < gs_NOTIFICATION_TIMEOUT_NS);
+
+    drainNs = Now() - start;
+
+    return 0 == pending;
+}
+
+/// Notifications of the session are recorded, and the time gdb takes to read them is measured.
+/// Replies to commands are neither, since gdb may be busy in an inferior call when we send them.
+bool Session::Notify(const HsailNotificationPayload& payload, bool isReply)
+{
+    const unsigned char* pBytes = (const unsigned char*)&payload;
+    size_t remaining = sizeof(payload);
+
+    while (0 < remaining)
+    {
+        ssize_t written = write(GetFifoWriteEnd(), pBytes, remaining);
+
+        if (0 > written)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+
+            fprintf(stderr, "[fake-agent] Could not write to %s: %s\n", gs_AgentToGdbFifoName, strerror(errno));
+            return false;
+        }
+
+        pBytes += written;
+        remaining -= written;
+    }
+
+    if (!isReply)
+    {
+        uint64_t drainNs = 0;
+
+        if (m_recorder.IsOpen())
+        {
+            m_recorder.Write(HSAIL_RECORD_NOTIFICATION, Now() - m_startNs, &payload, sizeof(payload));
+        }
+
+        if (WaitForDrain(drainNs))
+        {
+            m_notificationLatency[payload.m_Notification].Add(drainNs);
+        }
+        else
+        {
+            fprintf(stderr, "[fake-agent] gdb did not read the %s notification\n",
+                    NotificationName(payload.m_Notification));
+        }
+    }
+
+    return true;
+}
+
+/// Stop the inferior on a breakpoint and wait for gdb to continue the dispatch
+void Session::Stop()
+{
+    uint64_t start = Now();
+
+    if (m_recorder.IsOpen())
+    {
+        m_recorder.Write(HSAIL_RECORD_STOP, start - m_startNs, nullptr, 0);
+    }
+
+    raise(SIGUSR2);
+
+    while (!m_isContinueReceived && !m_isKillRequested && !m_isGdbGone)
+    {
+        ProcessCommands(-1);
+    }
+
+    m_isContinueReceived = false;
+    m_stopLatency.Add(Now() - start);
+}
+
+bool Session::ProcessCommands(int timeoutMs)
+{
+    bool retVal = false;
+    struct pollfd pfd;
+    unsigned char buffer[4096];
+
+    pfd.fd = GetFifoReadEnd();
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+
+    if (0 >= poll(&pfd, 1, timeoutMs))
+    {
+        return false;
+    }
+
+    while (true)
+    {
+        ssize_t bytesRead = read(GetFifoReadEnd(), buffer, sizeof(buffer));
+
+        if (0 < bytesRead)
+        {
+            m_commandBytes.insert(m_commandBytes.end(), buffer, buffer + bytesRead);
+
+            if (m_recorder.IsOpen())
+            {
+                m_recorder.Write(HSAIL_RECORD_COMMANDS, Now() - m_startNs, buffer, bytesRead);
+            }
+        }
+        else if (0 > bytesRead && EINTR == errno)
+        {
+            continue;
+        }
+        else
+        {
+            // 0 is returned once gdb closed its end
+            m_isGdbGone = m_isGdbGone || (0 == bytesRead && 0 != (pfd.revents & POLLHUP));
+            break;
+        }
+    }
+
+    size_t parsed = ParseCommands(m_commandBytes.data(), m_commandBytes.size());
+    m_commandBytes.erase(m_commandBytes.begin(), m_commandBytes.begin() + parsed);
+    retVal = (0 < parsed);
+
+    return retVal;
+}
+
+/// Apply the complete commands, legacy packets and framed batches, and return the bytes used
+size_t Session::ParseCommands(const unsigned char* pBytes, size_t size)
+{
+    size_t offset = 0;
+
+    while (sizeof(uint32_t) <= size - offset)
+    {
+        uint32_t magic = 0;
+        memcpy(&magic, pBytes + offset, sizeof(magic));
+
+        if (HSAIL_COMMAND_BATCH_MAGIC == magic)
+        {
+            HsailCommandBatchHeader header;
+
+            if (sizeof(header) > size - offset)
+            {
+                break;
+            }
+
+            memcpy(&header, pBytes + offset, sizeof(header));
+
+            if (sizeof(header) + header.m_payloadSize > size - offset)
+            {
+                break;
+            }
+
+            const unsigned char* pRecord = pBytes + offset + sizeof(header);
+            const unsigned char* pEnd = pRecord + header.m_payloadSize;
+            uint32_t numApplied = 0;
+
+            while (numApplied < header.m_numRecords && sizeof(HsailCommandRecord) <= (size_t)(pEnd - pRecord))
+            {
+                HsailCommandRecord record;
+                Command command;
+                memcpy(&record, pRecord, sizeof(record));
+
+                if (sizeof(record) > record.m_recordSize || record.m_recordSize > (size_t)(pEnd - pRecord))
+                {
+                    break;
+                }
+
+                command.m_command = record.m_command;
+                command.m_gdbBreakpointID = record.m_gdbBreakpointID;
+                command.m_pc = record.m_pc;
+                command.m_numMomentaryBP = record.m_numMomentaryBP;
+                command.m_numVariables = record.m_numVariables;
+                command.m_conditionPacket = record.m_conditionPacket;
+
+                if (0 < record.m_kernelNameLen)
+                {
+                    const char* pKernelName = (const char*)pRecord + sizeof(record) + AlignRecord(record.m_sourceLineLen);
+                    command.m_kernelName.assign(pKernelName, strnlen(pKernelName, record.m_kernelNameLen));
+                }
+
+                ApplyCommand(command);
+                numApplied++;
+                pRecord += record.m_recordSize;
+            }
+
+            m_lastBatchNs = Now();
+            m_numBatches++;
+
+            HsailNotificationPayload payload;
+            memset(&payload, 0, sizeof(payload));
+            payload.m_Notification = HSAIL_NOTIFY_COMMAND_BATCH_COMPLETE;
+            payload.payload.CommandBatchCompleteNotification.m_batchId = header.m_batchId;
+            payload.payload.CommandBatchCompleteNotification.m_numCommandsApplied = numApplied;
+            payload.payload.CommandBatchCompleteNotification.m_status =
+                (numApplied == header.m_numRecords) ? HSAIL_AGENT_STATUS_SUCCESS : HSAIL_AGENT_STATUS_FAILURE;
+            Notify(payload, true);
+
+            offset += sizeof(header) + header.m_payloadSize;
+        }
+        else
+        {
+            HsailCommandPacket packet;
+            Command command;
+
+            if (sizeof(packet) > size - offset)
+            {
+                break;
+            }
+
+            memcpy(&packet, pBytes + offset, sizeof(packet));
+            command.m_command = packet.m_command;
+            command.m_gdbBreakpointID = packet.m_gdbBreakpointID;
+            command.m_pc = packet.m_pc;
+            command.m_numMomentaryBP = packet.m_numMomentaryBP;
+            command.m_numVariables = packet.m_numVariables;
+            command.m_conditionPacket = packet.m_conditionPacket;
+            command.m_kernelName.assign(packet.m_kernelName, strnlen(packet.m_kernelName, AGENT_MAX_FUNC_NAME_LEN));
+
+            ApplyCommand(command);
+            m_lastBatchNs = Now();
+            m_numBatches++;
+
+            offset += sizeof(packet);
+        }
+    }
+
+    return offset;
+}
+
+void Session::ApplyCommand(const Command& command)
+{
+    switch (command.m_command)
+    {
+        case HSAIL_COMMAND_BEGIN_DEBUGGING:
+        {
+            // A gdb older than the framed protocol leaves m_pc unset and does not expect a reply
+            m_isBeginDebuggingReceived = true;
+
+            if (HSAIL_ISA_PC_UNKOWN != command.m_pc && HSAIL_PROTOCOL_VERSION_LEGACY < command.m_pc)
+            {
+                HsailNotificationPayload payload;
+                // The fake agent does not evaluate condition bytecode, so it does not go past the framed protocol:
+                m_protocolVersion = (uint32_t)std::min<uint64_t>(command.m_pc, HSAIL_PROTOCOL_VERSION_FRAMED);
+
+                memset(&payload, 0, sizeof(payload));
+                payload.m_Notification = HSAIL_NOTIFY_PROTOCOL_VERSION;
+                payload.payload.ProtocolVersionNotification.m_protocolVersion = m_protocolVersion;
+                Notify(payload, true);
+            }
+
+            break;
+        }
+
+        case HSAIL_COMMAND_CREATE_BREAKPOINT:
+        {
+            Breakpoint& bp = m_breakpoints[command.m_gdbBreakpointID];
+            bp.m_pc = command.m_pc;
+            bp.m_kernelName = command.m_kernelName;
+            bp.m_conditionPacket = command.m_conditionPacket;
+            bp.m_isEnabled = true;
+            m_lastStopBreakpoint = m_breakpoints.end();
+            break;
+        }
+
+        case HSAIL_COMMAND_DELETE_BREAKPOINT:
+            m_breakpoints.erase(command.m_gdbBreakpointID);
+            m_lastStopBreakpoint = m_breakpoints.end();
+            break;
+
+        case HSAIL_COMMAND_ENABLE_BREAKPOINT:
+        case HSAIL_COMMAND_DISABLE_BREAKPOINT:
+        {
+            auto bp = m_breakpoints.find(command.m_gdbBreakpointID);
+
+            if (m_breakpoints.end() != bp)
+            {
+                bp->second.m_isEnabled = (HSAIL_COMMAND_ENABLE_BREAKPOINT == command.m_command);
+            }
+
+            break;
+        }
+
+        case HSAIL_COMMAND_MOMENTARY_BREAKPOINT:
+        {
+            const HsailMomentaryBP* pMomentary =
+                (const HsailMomentaryBP*)AgentMapSharedMemBuffer(g_MOMENTARY_BP_BUFFER_SHMKEY, g_MOMENTARY_BP_BUFFER_MAXSIZE);
+            m_momentaryBreakpoints.clear();
+
+            if (nullptr != pMomentary)
+            {
+                m_momentaryBreakpoints.assign(pMomentary, pMomentary + command.m_numMomentaryBP);
+                AgentUnMapSharedMemBuffer((void*)pMomentary);
+            }
+
+            break;
+        }
+
+        case HSAIL_COMMAND_CONTINUE:
+            m_isContinueReceived = true;
+            break;
+
+        case HSAIL_COMMAND_KILL_ALL_WAVES:
+            Kill(false);
+            break;
+
+        case HSAIL_COMMAND_READ_VARIABLES:
+            ServiceVariableReads(command.m_numVariables);
+            break;
+
+        case HSAIL_COMMAND_GATHER_VARIABLE:
+            ServiceVariableGather();
+            break;
+
+        case HSAIL_COMMAND_SET_LOGGING:
+        default:
+            break;
+    }
+}
+
+/// The values are made up from the locations, so that a variable always reads the same
+void Session::ServiceVariableReads(int numVariables)
+{
+    HsailVariableReadHeader* pHeader =
+        (HsailVariableReadHeader*)AgentMapSharedMemBuffer(g_VARIABLE_READ_BUFFER_SHMKEY, g_VARIABLE_READ_BUFFER_MAXSIZE);
+
+    if (nullptr == pHeader)
+    {
+        return;
+    }
+
+    HsailVariableLocation* pLocations = (HsailVariableLocation*)(pHeader + 1);
+    unsigned char* pValues = (unsigned char*)pHeader + pHeader->m_valueAreaOffset;
+    uint32_t count = std::min<uint32_t>((uint32_t)numVariables, pHeader->m_numVariables);
+    uint32_t numRead = 0;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        HsailVariableLocation& location = pLocations[i];
+        uint64_t value = ((uint64_t)location.m_regNum << 16) + location.m_offset + location.m_constAdd;
+        size_t valueSize = std::min<size_t>(location.m_varSize, sizeof(value));
+
+        if (location.m_valueOffset + valueSize <= pHeader->m_valueAreaSize &&
+            pHeader->m_valueAreaOffset + pHeader->m_valueAreaSize <= g_VARIABLE_READ_BUFFER_MAXSIZE)
+        {
+            memcpy(pValues + location.m_valueOffset, &value, valueSize);
+            location.m_readStatus = HSAIL_AGENT_STATUS_SUCCESS;
+            numRead++;
+        }
+        else
+        {
+            location.m_readStatus = HSAIL_AGENT_STATUS_FAILURE;
+        }
+    }
+
+    pHeader->m_numValuesRead = numRead;
+    AgentUnMapSharedMemBuffer(pHeader);
+}
+
+/// The gathered values of the lanes of one variable
+template<typename T>
+struct GatheredValues
+{
+    void Add(T value, const std::pair<uint32_t, uint32_t>& lane, bool isKept)
+    {
+        if (isKept)
+        {
+            m_values.push_back(value);
+            m_lanes.push_back(lane);
+        }
+    };
+
+    std::vector<T> m_values;
+    std::vector<std::pair<uint32_t, uint32_t>> m_lanes; ///< The wave and the lane of each value
+};
+
+/// Integer sums wrap around
+static int64_t AddValues(int64_t sum, int64_t value) { return (int64_t)((uint64_t)sum + (uint64_t)value); }
+static uint64_t AddValues(uint64_t sum, uint64_t value) { return sum + value; }
+static double AddValues(double sum, double value) { return sum + value; }
+
+/// Computes the reductions of HSAIL_GATHER_MODE_REDUCE on the values as T
+template<typename T>
+static void ReduceGatheredValues(const GatheredValues<T>& gathered, HsailVariableGatherHeader& header)
+{
+    std::unordered_set<uint64_t> uniqueValues;
+    size_t minIndex = gathered.m_values.size();
+    size_t maxIndex = gathered.m_values.size();
+    T sum = 0;
+
+    for (size_t i = 0; i < gathered.m_values.size(); i++)
+    {
+        T value = gathered.m_values[i];
+        uint64_t bits = 0;
+        memcpy(&bits, &value, sizeof(value));
+        uniqueValues.insert(bits);
+        sum = AddValues(sum, value);
+
+        // NaN values never compare, so they are left out
+        if (value == value)
+        {
+            if (gathered.m_values.size() == minIndex || value < gathered.m_values[minIndex])
+            {
+                minIndex = i;
+            }
+
+            if (gathered.m_values.size() == maxIndex || value > gathered.m_values[maxIndex])
+            {
+                maxIndex = i;
+            }
+        }
+    }
+
+    T minValue = (gathered.m_values.size() == minIndex) ? 0 : gathered.m_values[minIndex];
+    T maxValue = (gathered.m_values.size() == maxIndex) ? 0 : gathered.m_values[maxIndex];
+    T bucketWidth = 0;
+
+    if (std::is_integral<T>::value)
+    {
+        // Each bucket is at least one value wide, so the last one reaches the max
+        bucketWidth = (T)((uint64_t)(maxValue - minValue) / HSAIL_GATHER_HISTOGRAM_BUCKETS + 1);
+    }
+    else
+    {
+        bucketWidth = (maxValue - minValue) / HSAIL_GATHER_HISTOGRAM_BUCKETS;
+    }
+
+    for (size_t i = 0; i < gathered.m_values.size() && gathered.m_values.size() != minIndex; i++)
+    {
+        T value = gathered.m_values[i];
+        uint64_t bucket = 0;
+
+        if (value != value)
+        {
+            continue;
+        }
+
+        if (std::is_integral<T>::value)
+        {
+            bucket = (uint64_t)(value - minValue) / (uint64_t)bucketWidth;
+        }
+        else if (0 < bucketWidth)
+        {
+            bucket = (uint64_t)((value - minValue) / bucketWidth);
+        }
+
+        header.m_histogram[std::min<uint64_t>(bucket, HSAIL_GATHER_HISTOGRAM_BUCKETS - 1)]++;
+    }
+
+    memcpy(&header.m_min, &minValue, sizeof(minValue));
+    memcpy(&header.m_max, &maxValue, sizeof(maxValue));
+    memcpy(&header.m_sum, &sum, sizeof(sum));
+    memcpy(&header.m_bucketWidth, &bucketWidth, sizeof(bucketWidth));
+    header.m_numUnique = uniqueValues.size();
+
+    if (gathered.m_values.size() != minIndex)
+    {
+        header.m_minWaveIndex = gathered.m_lanes[minIndex].first;
+        header.m_minLane = gathered.m_lanes[minIndex].second;
+        header.m_maxWaveIndex = gathered.m_lanes[maxIndex].first;
+        header.m_maxLane = gathered.m_lanes[maxIndex].second;
+    }
+}
+
+/// Reads the variable of the gather buffer from the active lanes of the last wave snapshot.
+/// The value of a lane is the value ServiceVariableReads makes up plus the lane's absolute
+/// work-item ID modulo 1000, so that the values differ between the work-items
+void Session::ServiceVariableGather()
+{
+    HsailVariableGatherHeader* pHeader =
+        (HsailVariableGatherHeader*)AgentMapSharedMemBuffer(g_VARIABLE_GATHER_BUFFER_SHMKEY, g_VARIABLE_GATHER_BUFFER_MAXSIZE);
+
+    if (nullptr == pHeader)
+    {
+        return;
+    }
+
+    HsailVariableGatherHeader& header = *pHeader;
+    const HsailVariableLocation& location = header.m_location;
+    const unsigned char* pWaves = (const unsigned char*)AgentMapSharedMemBuffer(g_WAVE_BUFFER_SHMKEY, m_waveBufferSize);
+    HsailWaveSnapshotHeader snapshot;
+    bool isValid = (nullptr != pWaves && HSAIL_VARIABLE_GATHER_VERSION == header.m_version &&
+                    0 < location.m_varSize && sizeof(uint64_t) >= location.m_varSize &&
+                    header.m_valueAreaOffset <= g_VARIABLE_GATHER_BUFFER_MAXSIZE &&
+                    header.m_valueAreaSize <= g_VARIABLE_GATHER_BUFFER_MAXSIZE - header.m_valueAreaOffset);
+
+    header.m_status = HSAIL_AGENT_STATUS_FAILURE;
+    header.m_numLanes = 0;
+    header.m_numValuesWritten = 0;
+    memset(header.m_histogram, 0, sizeof(header.m_histogram));
+
+    if (isValid)
+    {
+        memcpy(&snapshot, pWaves, sizeof(snapshot));
+        isValid = (HSAIL_WAVE_SNAPSHOT_MAGIC == snapshot.m_magic);
+    }
+
+    if (isValid)
+    {
+        const uint64_t* pExecMasks = (const uint64_t*)(pWaves + snapshot.m_execMaskOffset);
+        const HsailWaveDim3* pWorkGroupIds = (const HsailWaveDim3*)(pWaves + snapshot.m_workGroupIdOffset);
+        const HsailWaveDim3* pBaseWorkItemIds = (const HsailWaveDim3*)(pWaves + snapshot.m_baseWorkItemIdOffset);
+        unsigned char* pValues = (unsigned char*)pHeader + header.m_valueAreaOffset;
+        uint64_t baseValue = ((uint64_t)location.m_regNum << 16) + location.m_offset + location.m_constAdd;
+        size_t valueSize = location.m_varSize;
+        int extendShift = (int)(64 - 8 * valueSize);
+        bool isReduce = (HSAIL_GATHER_MODE_REDUCE == header.m_mode);
+        GatheredValues<int64_t> signedValues;
+        GatheredValues<uint64_t> unsignedValues;
+        GatheredValues<double> floatValues;
+
+        for (uint32_t wave = 0; wave < snapshot.m_numWaves; wave++)
+        {
+            const HsailWaveDim3& workGroupId = pWorkGroupIds[wave];
+
+            if ((HSAIL_GATHER_SCOPE_WAVE == header.m_scope && wave != header.m_waveIndex) ||
+                (HSAIL_GATHER_SCOPE_WORK_GROUP == header.m_scope &&
+                 0 != memcmp(&workGroupId, &header.m_workGroupId, sizeof(workGroupId))))
+            {
+                continue;
+            }
+
+            for (uint32_t lane = 0; lane < gs_WAVE_SIZE; lane++)
+            {
+                if (0 == (pExecMasks[wave] & (1ull << lane)))
+                {
+                    continue;
+                }
+
+                // The dispatches are one dimensional
+                uint64_t absoluteId = (uint64_t)workGroupId.x * snapshot.m_workGroupSize.x + pBaseWorkItemIds[wave].x + lane;
+                uint64_t bits = baseValue + absoluteId % 1000;
+                std::pair<uint32_t, uint32_t> position(wave, lane);
+
+                if (HSAIL_GATHER_ENCODING_FLOAT == header.m_encoding)
+                {
+                    double value = (double)bits;
+                    float floatValue = (float)value;
+                    bits = 0;
+
+                    if (sizeof(float) == valueSize)
+                    {
+                        memcpy(&bits, &floatValue, sizeof(floatValue));
+                        value = floatValue;
+                    }
+                    else
+                    {
+                        memcpy(&bits, &value, sizeof(value));
+                    }
+
+                    floatValues.Add(value, position, isReduce);
+                }
+                else if (HSAIL_GATHER_ENCODING_SIGNED == header.m_encoding)
+                {
+                    signedValues.Add((int64_t)(bits << extendShift) >> extendShift, position, isReduce);
+                }
+                else
+                {
+                    unsignedValues.Add((bits << extendShift) >> extendShift, position, isReduce);
+                }
+
+                if (!isReduce && (header.m_numValuesWritten + 1) * valueSize <= header.m_valueAreaSize)
+                {
+                    memcpy(pValues + header.m_numValuesWritten * valueSize, &bits, valueSize);
+                    header.m_numValuesWritten++;
+                }
+
+                header.m_numLanes++;
+            }
+        }
+
+        if (isReduce)
+        {
+            switch (header.m_encoding)
+            {
+                case HSAIL_GATHER_ENCODING_SIGNED: ReduceGatheredValues(signedValues, header); break;
+                case HSAIL_GATHER_ENCODING_UNSIGNED: ReduceGatheredValues(unsignedValues, header); break;
+                case HSAIL_GATHER_ENCODING_FLOAT: ReduceGatheredValues(floatValues, header); break;
+                default: break;
+            }
+        }
+
+        header.m_status = HSAIL_AGENT_STATUS_SUCCESS;
+    }
+
+    if (nullptr != pWaves)
+    {
+        AgentUnMapSharedMemBuffer((void*)pWaves);
+    }
+
+    AgentUnMapSharedMemBuffer(pHeader);
+}
+
+void Session::SetFocus(const HsailWaveDim3& workGroup, const HsailWaveDim3& workItem)
+{
+    HsailNotificationPayload payload;
+    memset(&payload, 0, sizeof(payload));
+    payload.m_Notification = HSAIL_NOTIFY_FOCUS_CHANGE;
+    payload.payload.FocusChange.m_focusWorkGroup = workGroup;
+    payload.payload.FocusChange.m_focusWorkItem = workItem;
+    m_focusWorkGroup = workGroup;
+    Notify(payload, true);
+}
+
+void Session::Kill(bool isQuitCommandIssued)
+{
+    HsailNotificationPayload payload;
+
+    m_isKillRequested = true;
+
+    memset(&payload, 0, sizeof(payload));
+    payload.m_Notification = HSAIL_NOTIFY_KILL_COMPLETE;
+    payload.payload.KillCompleteNotification.killSuccessful = true;
+    payload.payload.KillCompleteNotification.isQuitCommandIssued = isQuitCommandIssued;
+    Notify(payload, true);
+}
+
+/// The binary buffer holds the size of the binary followed by the binary
+bool Session::WriteBinary()
+{
+    size_t binarySize = m_binary.size();
+
+    return WriteShmem(g_DBEBINARY_SHMKEY, g_BINARY_BUFFER_MAXSIZE, 0,
+                      &binarySize, sizeof(binarySize), m_binary.data(), m_binary.size());
+}
+
+/// A shared memory segment cannot be resized, the wave buffer is replaced with
+/// a larger one, which gdb attaches to when it sees the key refers to another segment
+bool Session::ReserveWaveBuffer(size_t size)
+{
+    bool retVal = true;
+
+    if (size > m_waveBufferSize)
+    {
+        size_t newSize = m_waveBufferSize;
+
+        while (newSize < size)
+        {
+            newSize *= 2;
+        }
+
+        AgentFreeSharedMemBuffer(g_WAVE_BUFFER_SHMKEY, m_waveBufferSize);
+        retVal = (HSAIL_AGENT_STATUS_SUCCESS == AgentAllocSharedMemBuffer(g_WAVE_BUFFER_SHMKEY, newSize));
+        m_waveBufferSize = retVal ? newSize : 0;
+    }
+
+    return retVal;
+}
+
+/// One dimensional dispatch of numWaves full waves, m_wavesPerGroup waves in each work-group
+/// The work-item IDs of full waves follow from the base IDs, so no lane is overridden
+///
+/// After the first snapshot of a dispatch only the entries of the waves that changed are
+/// written, with the changed-waves bitmap, the delta records and the header
+bool Session::WriteWaves(unsigned int numWaves, uint64_t pc, int movedWorkGroup, HsailWaveDim3& workGroupSize, HsailWaveDim3& gridSize)
+{
+    unsigned int wavesPerGroup = std::max(1u, m_options.m_wavesPerGroup);
+    size_t bitmapSize = AlignRecord((numWaves + 7) / 8);
+    HsailWaveSnapshotHeader header;
+
+    workGroupSize.x = wavesPerGroup * gs_WAVE_SIZE;
+    workGroupSize.y = 1;
+    workGroupSize.z = 1;
+    gridSize.x = numWaves * gs_WAVE_SIZE;
+    gridSize.y = 1;
+    gridSize.z = 1;
+
+    memset(&header, 0, sizeof(header));
+    header.m_magic = HSAIL_WAVE_SNAPSHOT_MAGIC;
+    header.m_version = HSAIL_WAVE_SNAPSHOT_VERSION;
+    header.m_headerSize = sizeof(header);
+    header.m_numWaves = numWaves;
+    header.m_workGroupSize = workGroupSize;
+    header.m_numLaneOverrides = 0;
+
+    // The 8 byte arrays first, so that every array stays aligned
+    header.m_execMaskOffset = sizeof(header);
+    header.m_pcOffset = header.m_execMaskOffset + numWaves * sizeof(uint64_t);
+    header.m_workGroupIdOffset = header.m_pcOffset + numWaves * sizeof(HsailProgramCounter);
+    header.m_baseWorkItemIdOffset = AlignRecord(header.m_workGroupIdOffset + numWaves * sizeof(HsailWaveDim3));
+    header.m_waveAddressOffset = AlignRecord(header.m_baseWorkItemIdOffset + numWaves * sizeof(HsailWaveDim3));
+    header.m_changedWaveBitmapOffset = AlignRecord(header.m_waveAddressOffset + numWaves * sizeof(HsailWaveAddress));
+    header.m_deltaRecordOffset = header.m_changedWaveBitmapOffset + bitmapSize;
+    header.m_laneOverrideOffset = AlignRecord(header.m_deltaRecordOffset + numWaves * sizeof(HsailWaveDeltaRecord));
+    header.m_snapshotSize = header.m_laneOverrideOffset;
+
+    // The same number of waves gives the same layout, a new dispatch clears the snapshot
+    size_t waveBufferSize = m_waveBufferSize;
+    bool isFull = (m_waveSnapshot.size() != header.m_snapshotSize);
+    bool retVal = ReserveWaveBuffer(header.m_snapshotSize);
+    isFull = isFull || (waveBufferSize != m_waveBufferSize);
+
+    header.m_sequence = ++m_waveSequence;
+    header.m_baseSequence = isFull ? 0 : header.m_sequence - 1;
+
+    if (isFull)
+    {
+        m_waveSnapshot.assign(header.m_snapshotSize, 0);
+    }
+
+    unsigned char* pBase = m_waveSnapshot.data();
+    uint64_t* pExecMasks = (uint64_t*)(pBase + header.m_execMaskOffset);
+    HsailProgramCounter* pPcs = (HsailProgramCounter*)(pBase + header.m_pcOffset);
+    HsailWaveDim3* pWorkGroupIds = (HsailWaveDim3*)(pBase + header.m_workGroupIdOffset);
+    HsailWaveDim3* pBaseWorkItemIds = (HsailWaveDim3*)(pBase + header.m_baseWorkItemIdOffset);
+    HsailWaveAddress* pWaveAddresses = (HsailWaveAddress*)(pBase + header.m_waveAddressOffset);
+    unsigned char* pBitmap = pBase + header.m_changedWaveBitmapOffset;
+    HsailWaveDeltaRecord* pDeltaRecords = (HsailWaveDeltaRecord*)(pBase + header.m_deltaRecordOffset);
+    std::vector<ShmemRange> ranges;
+
+    memset(pBitmap, 0, bitmapSize);
+
+    for (unsigned int i = 0; i < numWaves; i++)
+    {
+        if (isFull)
+        {
+            pExecMasks[i] = ~0ull;
+            pPcs[i] = pc;
+            pWorkGroupIds[i].x = i / wavesPerGroup;
+            pBaseWorkItemIds[i].x = (i % wavesPerGroup) * gs_WAVE_SIZE;
+            pWaveAddresses[i] = i;
+            pBitmap[i / 8] |= (unsigned char)(1 << (i % 8));
+        }
+        else if ((movedWorkGroup < 0 || (unsigned int)movedWorkGroup == pWorkGroupIds[i].x) && pc != pPcs[i])
+        {
+            HsailWaveDeltaRecord& record = pDeltaRecords[header.m_numDeltaRecords++];
+            record.m_waveIndex = i;
+            record.m_changedFields = HSAIL_WAVE_FIELD_PC;
+
+            pPcs[i] = pc;
+            pBitmap[i / 8] |= (unsigned char)(1 << (i % 8));
+            ranges.push_back({ header.m_pcOffset + i * sizeof(HsailProgramCounter), &pPcs[i], sizeof(HsailProgramCounter) });
+        }
+    }
+
+    memcpy(pBase, &header, sizeof(header));
+
+    if (isFull)
+    {
+        ranges.push_back({ 0, pBase, header.m_snapshotSize });
+    }
+    else
+    {
+        ranges.push_back({ header.m_changedWaveBitmapOffset, pBitmap, bitmapSize });
+        ranges.push_back({ header.m_deltaRecordOffset, pDeltaRecords, header.m_numDeltaRecords * sizeof(HsailWaveDeltaRecord) });
+        ranges.push_back({ 0, pBase, sizeof(header) });
+    }
+
+    return retVal && WriteShmemRanges(g_WAVE_BUFFER_SHMKEY, m_waveBufferSize, ranges.data(), ranges.size());
+}
+
+void Session::CountBreakpointHit(int gdbBreakpointID, unsigned int numWaves)
+{
+    HsailBreakpointStatisticsHeader* pHeader =
+        (HsailBreakpointStatisticsHeader*)AgentMapSharedMemBuffer(g_BREAKPOINT_STATISTICS_SHMKEY, g_BREAKPOINT_STATISTICS_MAXSIZE);
+
+    if (nullptr == pHeader)
+    {
+        return;
+    }
+
+    if (0 <= gdbBreakpointID && (uint32_t)gdbBreakpointID < pHeader->m_numEntries)
+    {
+        HsailBreakpointStatistics* pStatistics = (HsailBreakpointStatistics*)(pHeader + 1) + gdbBreakpointID;
+        unsigned int bucket = std::min<unsigned int>(6, HSAIL_BREAKPOINT_HISTOGRAM_BUCKETS - 1); // 64 active work-items
+
+        __atomic_add_fetch(&pStatistics->m_hitCount, numWaves, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&pStatistics->m_workItemHitCount, (uint64_t)numWaves * gs_WAVE_SIZE, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&pStatistics->m_waveHistogram[bucket], numWaves, __ATOMIC_RELAXED);
+
+        // The counters are replayed by writing the whole entry back
+        if (m_recorder.IsOpen())
+        {
+            HsailRecordShmemWrite shmemWrite;
+            memset(&shmemWrite, 0, sizeof(shmemWrite));
+            shmemWrite.m_shmKey = (uint32_t)g_BREAKPOINT_STATISTICS_SHMKEY;
+            shmemWrite.m_offset = (uint32_t)((unsigned char*)pStatistics - (unsigned char*)pHeader);
+            shmemWrite.m_size = sizeof(*pStatistics);
+            m_recorder.Write(HSAIL_RECORD_SHMEM_WRITE, Now() - m_startNs,
+                             &shmemWrite, sizeof(shmemWrite), pStatistics, sizeof(*pStatistics));
+        }
+    }
+
+    AgentUnMapSharedMemBuffer(pHeader);
+}
+
+/// The enabled breakpoints which can stop the current kernel are taken in turn,
+/// kernel name breakpoints of other kernels never stop it
+const Breakpoint* Session::FindStopBreakpoint(int& gdbBreakpointID)
+{
+    auto it = m_lastStopBreakpoint;
+
+    for (size_t i = 0; i < m_breakpoints.size(); i++)
+    {
+        it = (m_breakpoints.end() == it) ? m_breakpoints.begin() : std::next(it);
+
+        if (m_breakpoints.end() == it)
+        {
+            it = m_breakpoints.begin();
+        }
+
+        const Breakpoint& bp = it->second;
+
+        if (bp.m_isEnabled && (bp.m_kernelName.empty() || bp.m_kernelName == m_options.m_kernelName))
+        {
+            m_lastStopBreakpoint = it;
+            gdbBreakpointID = it->first;
+            return &bp;
+        }
+    }
+
+    return nullptr;
+}
+
+bool Session::RunGenerated()
+{
+    bool retVal = true;
+    unsigned int numWaves = m_options.m_numWaves;
+
+    if (!m_options.m_binaryPath.empty())
+    {
+        std::ifstream binaryFile(m_options.m_binaryPath, std::ios::binary);
+        m_binary.assign(std::istreambuf_iterator<char>(binaryFile), std::istreambuf_iterator<char>());
+
+        if (m_binary.empty())
+        {
+            fprintf(stderr, "[fake-agent] Could not read %s\n", m_options.m_binaryPath.c_str());
+            return false;
+        }
+    }
+    else
+    {
+        // Not a code object, gdb reports it cannot debug the kernel source
+        static const char syntheticBinary[] = "HSAIL fake agent synthetic binary";
+        m_binary.assign(syntheticBinary, syntheticBinary + sizeof(syntheticBinary));
+    }
+
+    for (unsigned int dispatch = 0; retVal && dispatch < m_options.m_numDispatches && !m_isKillRequested; dispatch++)
+    {
+        HsailNotificationPayload payload;
+        HsailWaveDim3 workGroupSize;
+        HsailWaveDim3 gridSize;
+        bool isDebugging = false;
+
+        // The waves of the stops give the dispatch its shape
+        m_waveSnapshot.clear();
+        retVal = WriteBinary() && WriteWaves(numWaves, 0, -1, workGroupSize, gridSize);
+
+        memset(&payload, 0, sizeof(payload));
+        payload.m_Notification = HSAIL_NOTIFY_PREDISPATCH_STATE;
+        payload.payload.PredispatchNotification.m_predispatchState = HSAIL_PREDISPATCH_ENTERED_PREDISPATCH;
+        retVal = retVal && Notify(payload);
+
+        memset(&payload, 0, sizeof(payload));
+        payload.m_Notification = HSAIL_NOTIFY_NEW_BINARY;
+        strncpy(payload.payload.BinaryNotification.m_KernelName, m_options.m_kernelName.c_str(), AGENT_MAX_FUNC_NAME_LEN - 1);
+        strncpy(payload.payload.BinaryNotification.m_hlSymbolName, m_options.m_kernelName.c_str(), MAX_SHADER_BINARY_ELF_SYMBOL_LEN - 1);
+        strncpy(payload.payload.BinaryNotification.m_llSymbolName, m_options.m_kernelName.c_str(), MAX_SHADER_BINARY_ELF_SYMBOL_LEN - 1);
+        payload.payload.BinaryNotification.m_binarySize = m_binary.size();
+        payload.payload.BinaryNotification.m_workGroupSize = workGroupSize;
+        payload.payload.BinaryNotification.m_gridSize = gridSize;
+
+        // gdb sends the breakpoints waiting for a binary once it handled the notification
+        uint64_t binaryNs = Now();
+        unsigned int numBatches = m_numBatches;
+        retVal = retVal && Notify(payload);
+
+        while (retVal && ProcessCommands(m_options.m_flushTimeoutMs))
+        {
+        }
+
+        if (numBatches != m_numBatches)
+        {
+            m_flushLatency.Add(m_lastBatchNs - binaryNs);
+        }
+
+        memset(&payload, 0, sizeof(payload));
+        payload.m_Notification = HSAIL_NOTIFY_PREDISPATCH_STATE;
+        payload.payload.PredispatchNotification.m_predispatchState = HSAIL_PREDISPATCH_LEFT_PREDISPATCH;
+        retVal = retVal && Notify(payload);
+
+        for (unsigned int stop = 0; retVal && stop < m_options.m_numStops && !m_isKillRequested && !m_isGdbGone; stop++)
+        {
+            HsailWaveDim3 focusWorkGroup = { 0, 0, 0 };
+            HsailWaveDim3 focusWorkItem = { 0, 0, 0 };
+            int gdbBreakpointID = -1;
+            int movedWorkGroup = -1;
+            uint64_t pc = 0;
+
+            // A step stops on the momentary breakpoints, anything else on a gdb breakpoint
+            ProcessCommands(0);
+
+            // A step only moves the waves of the focus work-group
+            if (!m_momentaryBreakpoints.empty())
+            {
+                pc = m_momentaryBreakpoints[0].m_pc;
+                m_momentaryBreakpoints.clear();
+                focusWorkGroup = m_focusWorkGroup;
+                movedWorkGroup = (int)focusWorkGroup.x;
+            }
+            else
+            {
+                const Breakpoint* pBreakpoint = FindStopBreakpoint(gdbBreakpointID);
+
+                if (nullptr == pBreakpoint)
+                {
+                    break;
+                }
+
+                pc = (HSAIL_ISA_PC_UNKOWN == pBreakpoint->m_pc) ? 0 : pBreakpoint->m_pc;
+
+                if (HSAIL_BREAKPOINT_CONDITION_EQUAL == pBreakpoint->m_conditionPacket.m_conditionCode)
+                {
+                    focusWorkGroup = pBreakpoint->m_conditionPacket.m_workgroupID;
+                    focusWorkItem = pBreakpoint->m_conditionPacket.m_workitemID;
+                }
+            }
+
+            retVal = WriteWaves(numWaves, pc, movedWorkGroup, workGroupSize, gridSize);
+            CountBreakpointHit(gdbBreakpointID, numWaves);
+
+            if (!isDebugging)
+            {
+                memset(&payload, 0, sizeof(payload));
+                payload.m_Notification = HSAIL_NOTIFY_BEGIN_DEBUGGING;
+                payload.payload.BeginDebugNotification.setDeviceFocus = true;
+                retVal = retVal && Notify(payload);
+                isDebugging = true;
+            }
+
+            memset(&payload, 0, sizeof(payload));
+            payload.m_Notification = HSAIL_NOTIFY_FOCUS_CHANGE;
+            payload.payload.FocusChange.m_focusWorkGroup = focusWorkGroup;
+            payload.payload.FocusChange.m_focusWorkItem = focusWorkItem;
+            m_focusWorkGroup = focusWorkGroup;
+            retVal = retVal && Notify(payload);
+
+            memset(&payload, 0, sizeof(payload));
+            payload.m_Notification = HSAIL_NOTIFY_BREAKPOINT_HIT;
+
+            for (int i = 0; i < HSAIL_MAX_REPORTABLE_BREAKPOINTS; i++)
+            {
+                payload.payload.BreakpointHit.m_breakpointId[i] = -1;
+                payload.payload.BreakpointHit.m_hitCount[i] = -1;
+            }
+
+            if (0 <= gdbBreakpointID)
+            {
+                payload.payload.BreakpointHit.m_breakpointId[0] = gdbBreakpointID;
+                payload.payload.BreakpointHit.m_hitCount[0] = (int)(stop + 1);
+            }
+
+            payload.payload.BreakpointHit.m_numActiveWaves = (int)numWaves;
+            retVal = retVal && Notify(payload);
+
+            if (retVal)
+            {
+                Stop();
+            }
+        }
+
+        if (retVal && isDebugging && !m_isGdbGone)
+        {
+            memset(&payload, 0, sizeof(payload));
+            payload.m_Notification = HSAIL_NOTIFY_END_DEBUGGING;
+            payload.payload.EndDebugNotification.hasDispatchCompleted = true;
+            retVal = Notify(payload);
+        }
+    }
+
+    return retVal;
+}
+
+bool Session::RunReplay()
+{
+    Player player;
+    HsailRecordHeader header;
+    std::vector<unsigned char> payload;
+    uint64_t replayStartNs = Now();
+    bool retVal = player.Open(m_options.m_replayPath);
+
+    if (!retVal)
+    {
+        fprintf(stderr, "[fake-agent] %s is not a recording\n", m_options.m_replayPath.c_str());
+        return false;
+    }
+
+    while (retVal && !m_isKillRequested && !m_isGdbGone && player.Next(header, payload))
+    {
+        if (m_options.m_isRealTime)
+        {
+            uint64_t now = Now();
+
+            if (replayStartNs + header.m_timestampNs > now)
+            {
+                uint64_t waitNs = replayStartNs + header.m_timestampNs - now;
+                struct timespec ts;
+                ts.tv_sec = waitNs / 1000000000ull;
+                ts.tv_nsec = waitNs % 1000000000ull;
+                nanosleep(&ts, nullptr);
+            }
+        }
+
+        // Keep up with gdb's commands between the records
+        ProcessCommands(0);
+
+        switch (header.m_type)
+        {
+            case HSAIL_RECORD_NOTIFICATION:
+            {
+                HsailNotificationPayload notification;
+                retVal = (sizeof(notification) == payload.size());
+
+                if (retVal)
+                {
+                    memcpy(&notification, payload.data(), sizeof(notification));
+
+                    // The debug thread was already announced by Initialize, with this process's tid
+                    if (HSAIL_NOTIFY_START_DEBUG_THREAD != notification.m_Notification)
+                    {
+                        retVal = Notify(notification);
+                    }
+                }
+
+                break;
+            }
+
+            case HSAIL_RECORD_SHMEM_WRITE:
+            {
+                HsailRecordShmemWrite shmemWrite;
+                retVal = (sizeof(shmemWrite) <= payload.size());
+
+                if (retVal)
+                {
+                    memcpy(&shmemWrite, payload.data(), sizeof(shmemWrite));
+                    retVal = (sizeof(shmemWrite) + shmemWrite.m_size == payload.size());
+                }
+
+                if (retVal)
+                {
+                    size_t maxSize = 0;
+
+                    switch (shmemWrite.m_shmKey)
+                    {
+                        case g_DBEBINARY_SHMKEY: maxSize = g_BINARY_BUFFER_MAXSIZE; break;
+
+                        case g_WAVE_BUFFER_SHMKEY:
+                            retVal = ReserveWaveBuffer(shmemWrite.m_offset + shmemWrite.m_size);
+                            maxSize = m_waveBufferSize;
+                            break;
+
+                        case g_MOMENTARY_BP_BUFFER_SHMKEY: maxSize = g_MOMENTARY_BP_BUFFER_MAXSIZE; break;
+                        case g_VARIABLE_READ_BUFFER_SHMKEY: maxSize = g_VARIABLE_READ_BUFFER_MAXSIZE; break;
+                        case g_BREAKPOINT_STATISTICS_SHMKEY: maxSize = g_BREAKPOINT_STATISTICS_MAXSIZE; break;
+                        default: break;
+                    }
+
+                    retVal = retVal && WriteShmem(shmemWrite.m_shmKey, maxSize, shmemWrite.m_offset,
+                                                  payload.data() + sizeof(shmemWrite), shmemWrite.m_size);
+                }
+
+                break;
+            }
+
+            case HSAIL_RECORD_STOP:
+                Stop();
+                break;
+
+            case HSAIL_RECORD_COMMANDS:
+            default:
+                break;
+        }
+    }
+
+    if (!retVal)
+    {
+        fprintf(stderr, "[fake-agent] Malformed record in %s\n", m_options.m_replayPath.c_str());
+    }
+
+    return retVal;
+}
+
+void Session::PrintReport() const
+{
+    static const char header[] = "%s%-32s %8s %12s %12s %12s %12s\n";
+    FILE* pReport = nullptr;
+    char prefix[64] = "";
+
+    fprintf(stderr, header, "[fake-agent] ", "latency (us)", "count", "mean", "p50", "p99", "max");
+
+    for (int i = 0; i <= HSAIL_NOTIFY_COMMAND_BATCH_COMPLETE; i++)
+    {
+        std::string name = std::string("notify ") + NotificationName((HsailNotification)i);
+        m_notificationLatency[i].Print(stderr, name.c_str(), "[fake-agent] ");
+    }
+
+    m_flushLatency.Print(stderr, "breakpoint flush", "[fake-agent] ");
+    m_stopLatency.Print(stderr, "stop to continue", "[fake-agent] ");
+
+    // The report file has one line per measurement, prefixed with the wave count
+    if (!m_options.m_reportPath.empty())
+    {
+        pReport = fopen(m_options.m_reportPath.c_str(), "a");
+    }
+
+    if (nullptr != pReport)
+    {
+        snprintf(prefix, sizeof(prefix), "waves=%u ", m_options.m_numWaves);
+
+        for (int i = 0; i <= HSAIL_NOTIFY_COMMAND_BATCH_COMPLETE; i++)
+        {
+            std::string name = std::string("notify_") + NotificationName((HsailNotification)i);
+            m_notificationLatency[i].Print(pReport, name.c_str(), prefix);
+        }
+
+        m_flushLatency.Print(pReport, "breakpoint_flush", prefix);
+        m_stopLatency.Print(pReport, "stop_to_continue", prefix);
+        fclose(pReport);
+    }
+}
+
+/// The inferior calls gdb makes into the agent
+extern "C"
+{
+void GetVarValues(int numVariables)
+{
+    if (nullptr != gs_pSession)
+    {
+        gs_pSession->ServiceVariableReads(numVariables);
+    }
+}
+
+void GatherVarValues(void)
+{
+    if (nullptr != gs_pSession)
+    {
+        gs_pSession->ServiceVariableGather();
+    }
+}
+
+void FreeVarValue(void)
+{
+}
+
+void SetHsailThreadCmdInfo(unsigned int wgX, unsigned int wgY, unsigned int wgZ,
+                           unsigned int wiX, unsigned int wiY, unsigned int wiZ)
+{
+    if (nullptr != gs_pSession)
+    {
+        HsailWaveDim3 workGroup = { wgX, wgY, wgZ };
+        HsailWaveDim3 workItem = { wiX, wiY, wiZ };
+        gs_pSession->SetFocus(workGroup, workItem);
+    }
+}
+
+void KillHsailDebug(bool isQuitCommandIssued)
+{
+    if (nullptr != gs_pSession)
+    {
+        gs_pSession->Kill(isQuitCommandIssued);
+    }
+}
+}
+
+static void PrintUsage(const char* program)
+{
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "Stand-in for the HSAIL debug agent, run it as the inferior of gdb.\n"
+            "  --kernel NAME           The kernel name of the dispatches\n"
+            "  --binary FILE           The code object to dispatch (default: a binary gdb cannot debug)\n"
+            "  --dispatches N          The number of dispatches (default 1)\n"
+            "  --waves N               The number of waves reported at each stop (default 10)\n"
+            "  --waves-per-group N     The number of waves in each work-group (default 1)\n"
+            "  --stops N               The number of stops in each dispatch (default 1)\n"
+            "  --flush-timeout MS      How long to wait for gdb's breakpoints after a new binary (default 50)\n"
+            "  --record FILE           Record the session\n"
+            "  --replay FILE           Replay a recorded session instead of generating one\n"
+            "  --realtime              Replay with the recorded timing\n"
+            "  --report FILE           Append the latency measurements to FILE\n",
+            program);
+}
+
+int main(int argc, char* argv[])
+{
+    static const struct option longOptions[] =
+    {
+        { "kernel", required_argument, nullptr, 'k' },
+        { "binary", required_argument, nullptr, 'b' },
+        { "dispatches", required_argument, nullptr, 'd' },
+        { "waves", required_argument, nullptr, 'w' },
+        { "waves-per-group", required_argument, nullptr, 'g' },
+        { "stops", required_argument, nullptr, 's' },
+        { "flush-timeout", required_argument, nullptr, 't' },
+        { "record", required_argument, nullptr, 'r' },
+        { "replay", required_argument, nullptr, 'p' },
+        { "realtime", no_argument, nullptr, 'R' },
+        { "report", required_argument, nullptr, 'o' },
+        { "help", no_argument, nullptr, 'h' },
+        { nullptr, 0, nullptr, 0 }
+    };
+
+    Options options;
+    int opt = 0;
+
+    while (-1 != (opt = getopt_long(argc, argv, "", longOptions, nullptr)))
+    {
+        switch (opt)
+        {
+            case 'k': options.m_kernelName = optarg; break;
+            case 'b': options.m_binaryPath = optarg; break;
+            case 'd': options.m_numDispatches = (unsigned int)strtoul(optarg, nullptr, 0); break;
+            case 'w': options.m_numWaves = (unsigned int)strtoul(optarg, nullptr, 0); break;
+            case 'g': options.m_wavesPerGroup = (unsigned int)strtoul(optarg, nullptr, 0); break;
+            case 's': options.m_numStops = (unsigned int)strtoul(optarg, nullptr, 0); break;
+            case 't': options.m_flushTimeoutMs = atoi(optarg); break;
+            case 'r': options.m_recordPath = optarg; break;
+            case 'p': options.m_replayPath = optarg; break;
+            case 'R': options.m_isRealTime = true; break;
+            case 'o': options.m_reportPath = optarg; break;
+            default:
+                PrintUsage(argv[0]);
+                return 'h' == opt ? 0 : 1;
+        }
+    }
+
+    Session session(options);
+    gs_pSession = &session;
+
+    bool retVal = session.Initialize();
+
+    if (retVal)
+    {
+        retVal = options.m_replayPath.empty() ? session.RunGenerated() : session.RunReplay();
+        session.PrintReport();
+    }
+
+    gs_pSession = nullptr;
+    session.Terminate();
+
+    return retVal ? 0 : 1;
+}
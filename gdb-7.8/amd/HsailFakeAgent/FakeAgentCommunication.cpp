@@ -0,0 +1,174 @@
+//==============================================================================
+// Copyright (c) 2015 Advanced Micro Devices, Inc. All rights reserved.
+//
+/// \author AMD Developer Tools
+/// \file
+/// \brief  The agent side of the fifos and shared memory, as declared in CommunicationControl.h
+//==============================================================================
+/// System:
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+/// Local:
+#include <CommunicationControl.h>
+#include <CommunicationParams.h>
+
+static int gs_fifoReadEnd = -1;
+static int gs_fifoWriteEnd = -1;
+
+HsailAgentStatus CreateCommunicationFifos()
+{
+    HsailAgentStatus retVal = HSAIL_AGENT_STATUS_SUCCESS;
+
+    // A fifo left over by an earlier session is reused
+    if (0 != mkfifo(gs_AgentToGdbFifoName, g_FIFO_PERMISSIONS) && EEXIST != errno)
+    {
+        fprintf(stderr, "[fake-agent] Could not create %s: %s\n", gs_AgentToGdbFifoName, strerror(errno));
+        retVal = HSAIL_AGENT_STATUS_FAILURE;
+    }
+
+    if (0 != mkfifo(gs_GdbToAgentFifoName, g_FIFO_PERMISSIONS) && EEXIST != errno)
+    {
+        fprintf(stderr, "[fake-agent] Could not create %s: %s\n", gs_GdbToAgentFifoName, strerror(errno));
+        retVal = HSAIL_AGENT_STATUS_FAILURE;
+    }
+
+    return retVal;
+}
+
+/// The read end is opened without blocking, so that gdb can open its write end
+/// while the agent is waiting for it
+HsailAgentStatus InitFifoReadEnd()
+{
+    gs_fifoReadEnd = open(gs_GdbToAgentFifoName, O_RDONLY | O_NONBLOCK);
+
+    if (0 > gs_fifoReadEnd)
+    {
+        fprintf(stderr, "[fake-agent] Could not open %s: %s\n", gs_GdbToAgentFifoName, strerror(errno));
+        return HSAIL_AGENT_STATUS_FAILURE;
+    }
+
+    return HSAIL_AGENT_STATUS_SUCCESS;
+}
+
+/// Blocks until gdb has opened its read end
+HsailAgentStatus InitFifoWriteEnd()
+{
+    do
+    {
+        gs_fifoWriteEnd = open(gs_AgentToGdbFifoName, O_WRONLY);
+    }
+    while (0 > gs_fifoWriteEnd && EINTR == errno);
+
+    if (0 > gs_fifoWriteEnd)
+    {
+        fprintf(stderr, "[fake-agent] Could not open %s: %s\n", gs_AgentToGdbFifoName, strerror(errno));
+        return HSAIL_AGENT_STATUS_FAILURE;
+    }
+
+    return HSAIL_AGENT_STATUS_SUCCESS;
+}
+
+int GetFifoReadEnd()
+{
+    return gs_fifoReadEnd;
+}
+
+int GetFifoWriteEnd()
+{
+    return gs_fifoWriteEnd;
+}
+
+void CheckSharedMem(const key_t shmkey, const int maxShmSize)
+{
+    int shmid = shmget(shmkey, maxShmSize, 0666);
+
+    if (0 > shmid)
+    {
+        fprintf(stderr, "[fake-agent] Shared memory %d does not exist\n", (int)shmkey);
+    }
+}
+
+HsailAgentStatus AgentAllocSharedMemBuffer(const key_t shmkey, const int maxShmSize)
+{
+    void* pShm = nullptr;
+    int shmid = shmget(shmkey, maxShmSize, IPC_CREAT | 0666);
+
+    if (0 > shmid)
+    {
+        fprintf(stderr, "[fake-agent] Could not create shared memory %d: %s\n", (int)shmkey, strerror(errno));
+        return HSAIL_AGENT_STATUS_FAILURE;
+    }
+
+    // A segment left over by an earlier session may hold stale data
+    pShm = shmat(shmid, nullptr, 0);
+
+    if ((void*)-1 == pShm)
+    {
+        return HSAIL_AGENT_STATUS_FAILURE;
+    }
+
+    memset(pShm, 0, maxShmSize);
+    shmdt(pShm);
+
+    return HSAIL_AGENT_STATUS_SUCCESS;
+}
+
+HsailAgentStatus AgentFreeSharedMemBuffer(const key_t shmkey, const int maxShmSize)
+{
+    int shmid = shmget(shmkey, maxShmSize, 0666);
+
+    if (0 > shmid || 0 != shmctl(shmid, IPC_RMID, nullptr))
+    {
+        return HSAIL_AGENT_STATUS_FAILURE;
+    }
+
+    return HSAIL_AGENT_STATUS_SUCCESS;
+}
+
+void* AgentMapSharedMemBuffer(const key_t shmkey, const int maxShmSize)
+{
+    void* pShm = nullptr;
+    int shmid = shmget(shmkey, maxShmSize, 0666);
+
+    if (0 <= shmid)
+    {
+        pShm = shmat(shmid, nullptr, 0);
+
+        if ((void*)-1 == pShm)
+        {
+            pShm = nullptr;
+        }
+    }
+
+    return pShm;
+}
+
+HsailAgentStatus AgentUnMapSharedMemBuffer(void* pShm)
+{
+    if (nullptr == pShm || 0 != shmdt(pShm))
+    {
+        return HSAIL_AGENT_STATUS_FAILURE;
+    }
+
+    return HSAIL_AGENT_STATUS_SUCCESS;
+}
+
+/// gdb only writes shared memory while the inferior is stopped,
+/// so the update is visible once the agent runs again
+HsailAgentStatus WaitForSharedMemoryUpdate(const key_t shmkey, const int maxShmSize)
+{
+    HSAIL_UNREFERENCED_PARAMETER(shmkey);
+    HSAIL_UNREFERENCED_PARAMETER(maxShmSize);
+
+    __sync_synchronize();
+
+    return HSAIL_AGENT_STATUS_SUCCESS;
+}
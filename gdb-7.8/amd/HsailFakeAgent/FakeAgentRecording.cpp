@@ -0,0 +1,156 @@
+//==============================================================================
+// Copyright (c) 2015 Advanced Micro Devices, Inc. All rights reserved.
+//
+/// \author AMD Developer Tools
+/// \file
+/// \brief  Recording of the agent side of an HSAIL debugging session
+//==============================================================================
+/// Local:
+#include "FakeAgentRecording.h"
+
+/// STL:
+#include <string.h>
+
+using namespace HsailFakeAgent;
+
+static size_t RecordPadding(size_t size)
+{
+    return (HSAIL_RECORD_ALIGNMENT - (size % HSAIL_RECORD_ALIGNMENT)) % HSAIL_RECORD_ALIGNMENT;
+}
+
+Recorder::Recorder() : m_pFile(nullptr)
+{
+}
+
+Recorder::~Recorder()
+{
+    Close();
+}
+
+bool Recorder::Open(const std::string& path)
+{
+    bool retVal = false;
+
+    Close();
+    m_pFile = fopen(path.c_str(), "wb");
+
+    if (nullptr != m_pFile)
+    {
+        HsailRecordingHeader header;
+        memset(&header, 0, sizeof(header));
+        header.m_magic = HSAIL_RECORDING_MAGIC;
+        header.m_version = HSAIL_RECORDING_VERSION;
+        header.m_protocolVersion = HSAIL_PROTOCOL_VERSION;
+        header.m_notificationSize = sizeof(HsailNotificationPayload);
+
+        retVal = (1 == fwrite(&header, sizeof(header), 1, m_pFile));
+    }
+
+    if (!retVal)
+    {
+        Close();
+    }
+
+    return retVal;
+}
+
+void Recorder::Close()
+{
+    if (nullptr != m_pFile)
+    {
+        fclose(m_pFile);
+        m_pFile = nullptr;
+    }
+}
+
+bool Recorder::Write(HsailRecordType type, uint64_t timestampNs,
+                     const void* pData, size_t dataSize,
+                     const void* pExtraData, size_t extraDataSize)
+{
+    static const unsigned char padding[HSAIL_RECORD_ALIGNMENT] = { 0 };
+    bool retVal = IsOpen();
+
+    if (retVal)
+    {
+        HsailRecordHeader header;
+        size_t payloadSize = dataSize + extraDataSize;
+        size_t paddingSize = RecordPadding(payloadSize);
+
+        header.m_type = (uint32_t)type;
+        header.m_size = (uint32_t)payloadSize;
+        header.m_timestampNs = timestampNs;
+
+        retVal = (1 == fwrite(&header, sizeof(header), 1, m_pFile));
+        retVal = retVal && (0 == dataSize || 1 == fwrite(pData, dataSize, 1, m_pFile));
+        retVal = retVal && (0 == extraDataSize || 1 == fwrite(pExtraData, extraDataSize, 1, m_pFile));
+        retVal = retVal && (0 == paddingSize || 1 == fwrite(padding, paddingSize, 1, m_pFile));
+    }
+
+    return retVal;
+}
+
+Player::Player() : m_pFile(nullptr)
+{
+}
+
+Player::~Player()
+{
+    Close();
+}
+
+bool Player::Open(const std::string& path)
+{
+    bool retVal = false;
+
+    Close();
+    m_pFile = fopen(path.c_str(), "rb");
+
+    if (nullptr != m_pFile)
+    {
+        HsailRecordingHeader header;
+
+        if (1 == fread(&header, sizeof(header), 1, m_pFile))
+        {
+            retVal = (HSAIL_RECORDING_MAGIC == header.m_magic) &&
+                     (HSAIL_RECORDING_VERSION == header.m_version) &&
+                     (sizeof(HsailNotificationPayload) == header.m_notificationSize);
+
+            if (retVal && HSAIL_PROTOCOL_VERSION != header.m_protocolVersion)
+            {
+                fprintf(stderr, "[fake-agent] Recording made with protocol %u, replaying with %u\n",
+                        header.m_protocolVersion, (uint32_t)HSAIL_PROTOCOL_VERSION);
+            }
+        }
+    }
+
+    if (!retVal)
+    {
+        Close();
+    }
+
+    return retVal;
+}
+
+void Player::Close()
+{
+    if (nullptr != m_pFile)
+    {
+        fclose(m_pFile);
+        m_pFile = nullptr;
+    }
+}
+
+bool Player::Next(HsailRecordHeader& header, std::vector<unsigned char>& payload)
+{
+    bool retVal = (nullptr != m_pFile) && (1 == fread(&header, sizeof(header), 1, m_pFile));
+
+    if (retVal)
+    {
+        size_t paddedSize = header.m_size + RecordPadding(header.m_size);
+        payload.resize(paddedSize);
+        retVal = (0 == paddedSize) || (1 == fread(payload.data(), paddedSize, 1, m_pFile));
+        payload.resize(header.m_size);
+    }
+
+    return retVal;
+}
@@ -0,0 +1,97 @@
+//==============================================================================
+// Copyright (c) 2015 Advanced Micro Devices, Inc. All rights reserved.
+//
+/// \author AMD Developer Tools
+/// \file
+/// \brief  Recording of the agent side of an HSAIL debugging session
+//==============================================================================
+#ifndef FAKEAGENTRECORDING_H_
+#define FAKEAGENTRECORDING_H_
+
+/// STL:
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/// Local:
+#include <CommunicationControl.h>
+
+// A recording is a HsailRecordingHeader followed by records, each a HsailRecordHeader
+// followed by m_size bytes of payload padded to HSAIL_RECORD_ALIGNMENT.
+// Recordings are in the host byte order and are only replayed on the host that made them.
+#define HSAIL_RECORDING_MAGIC 0x48534152 // "HSAR"
+#define HSAIL_RECORDING_VERSION 1
+#define HSAIL_RECORD_ALIGNMENT 8
+
+typedef enum
+{
+    HSAIL_RECORD_UNKNOWN,
+    HSAIL_RECORD_NOTIFICATION,  // A HsailNotificationPayload written to the agent -> gdb fifo
+    HSAIL_RECORD_SHMEM_WRITE,   // A HsailRecordShmemWrite followed by the bytes written to the segment
+    HSAIL_RECORD_STOP,          // The inferior was stopped on a breakpoint, and resumed by HSAIL_COMMAND_CONTINUE
+    HSAIL_RECORD_COMMANDS       // The bytes read from the gdb -> agent fifo, kept for reference and not replayed
+} HsailRecordType;
+
+typedef struct _HsailRecordingHeader
+{
+    uint32_t m_magic;               // HSAIL_RECORDING_MAGIC
+    uint32_t m_version;             // HSAIL_RECORDING_VERSION
+    uint32_t m_protocolVersion;     // HSAIL_PROTOCOL_VERSION of the recording agent
+    uint32_t m_notificationSize;    // sizeof(HsailNotificationPayload) of the recording agent
+} HsailRecordingHeader;
+
+typedef struct _HsailRecordHeader
+{
+    uint32_t m_type;                // HsailRecordType
+    uint32_t m_size;                // The size of the payload, without the padding
+    uint64_t m_timestampNs;         // Time since the start of the recording
+} HsailRecordHeader;
+
+typedef struct _HsailRecordShmemWrite
+{
+    uint32_t m_shmKey;              // The shared memory key
+    uint32_t m_offset;              // Where the bytes were written, from the start of the segment
+    uint64_t m_size;                // The number of bytes written
+} HsailRecordShmemWrite;
+
+namespace HsailFakeAgent
+{
+/// Writes the records of a session to a file
+class Recorder
+{
+public:
+    Recorder();
+    ~Recorder();
+
+    bool Open(const std::string& path);
+    void Close();
+    bool IsOpen() const { return nullptr != m_pFile; };
+
+    /// Append a record, the payload is made of the two buffers one after the other
+    bool Write(HsailRecordType type, uint64_t timestampNs,
+               const void* pData, size_t dataSize,
+               const void* pExtraData = nullptr, size_t extraDataSize = 0);
+
+private:
+    FILE* m_pFile;
+};
+
+/// Reads back the records written by a Recorder
+class Player
+{
+public:
+    Player();
+    ~Player();
+
+    bool Open(const std::string& path);
+    void Close();
+
+    /// Read the next record, returns false at the end of the recording or on a malformed record
+    bool Next(HsailRecordHeader& header, std::vector<unsigned char>& payload);
+
+private:
+    FILE* m_pFile;
+};
+}
+
+#endif // FAKEAGENTRECORDING_H_
@@ -0,0 +1,86 @@
+#!/bin/bash
+#==============================================================================
+# Copyright (c) 2015 Advanced Micro Devices, Inc. All rights reserved.
+#
+# Times gdb's HSAIL commands against hsail-fake-agent for a range of wave counts
+#
+# Usage: run-benchmarks.sh GDB KERNEL_NAME [CODE_OBJECT] [WAVE_COUNTS...]
+#==============================================================================
+
+if [ $# -lt 2 ]; then
+    echo "Usage: $0 GDB KERNEL_NAME [CODE_OBJECT] [WAVE_COUNTS...]"
+    exit 1
+fi
+
+GDB=$(readlink -f "$1")
+KERNEL=$2
+BINARY=
+shift 2
+
+if [ $# -gt 0 ] && [ -f "$1" ]; then
+    BINARY=$(readlink -f "$1")
+    shift
+fi
+
+WAVE_COUNTS=${*:-"10 1000 10000"}
+AGENT=$(dirname "$(readlink -f "$0")")/hsail-fake-agent
+STOPS=4
+
+if [ ! -x "$AGENT" ]; then
+    echo "$AGENT was not found, run make first"
+    exit 1
+fi
+
+# gdb creates the fifos in its working directory
+WORKDIR=$(mktemp -d)
+trap 'rm -rf "$WORKDIR"' EXIT
+cd "$WORKDIR" || exit 1
+
+for WAVES in $WAVE_COUNTS; do
+    AGENT_ARGS="--kernel $KERNEL --waves $WAVES --stops $STOPS --report report.txt"
+
+    if [ -n "$BINARY" ]; then
+        AGENT_ARGS="$AGENT_ARGS --binary $BINARY"
+    fi
+
+    {
+        echo "set pagination off"
+        echo "set confirm off"
+        echo "break hsail:$KERNEL"
+        echo "run $AGENT_ARGS"
+        echo "maint set per-command time on"
+        for COMMAND in "info hsail kernels" "info hsail wavefronts" "info hsail wgs" \
+                       "info hsail wis" "info hsail dispatches"; do
+            echo "echo @@@ $COMMAND\\n"
+            echo "$COMMAND"
+        done
+        for i in $(seq 2 $STOPS); do
+            echo "echo @@@ continue\\n"
+            echo "continue"
+        done
+        echo "maint set per-command time off"
+        echo "continue"
+        echo "kill"
+        echo "quit"
+    } > commands.gdb
+
+    rm -f report.txt
+    "$GDB" -nx -batch -x commands.gdb "$AGENT" > gdb.log 2>&1
+
+    echo "== $WAVES waves"
+
+    # The time of each command follows its marker
+    awk '/^@@@ / { command = substr($0, 5) }
+         /^Command execution time:/ && command != "" {
+             wall = $6
+             printf "gdb   %-24s %s s (wall)\n", command, wall
+             command = ""
+         }' gdb.log
+
+    if [ -f report.txt ]; then
+        sed 's/^/agent /' report.txt
+    else
+        echo "agent did not write a report, see the gdb output:"
+        tail -20 gdb.log
+    fi
+done
@@ -0,0 +1,621 @@
+//==============================================================================
+// Copyright (c) 2015 Advanced Micro Devices, Inc. All rights reserved.
+//
+/// \author AMD Developer Tools
+/// \file
+/// \brief  Generates HSA 1.0 code objects with debug information of a chosen size
+//==============================================================================
+/// Local:
+#include "CodeObjectGenerator.h"
+
+/// STL:
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+
+/// Libdwarf:
+#include <dwarf.h>
+
+/// Brig:
+#include <BrigSectionHeader.h>
+
+// The HSA attributes, as read by DbgInfoDwarfParser.cpp:
+#define HWDBGINFO_BENCH_DW_AT_HSA_is_kernel 0x3000
+#define HWDBGINFO_BENCH_DW_AT_HSA_brig_offset 0x3004
+#define HWDBGINFO_BENCH_DW_LANG_HSA_Assembly 0x9000
+
+// Not in every elf.h:
+#define HWDBGINFO_BENCH_EM_HSAIL 0xAF5A
+#define HWDBGINFO_BENCH_EM_AMDGPU 224
+
+using namespace HwDbgInfoBenchmark;
+
+namespace
+{
+/// The first HSAIL instruction line, after the module and kernel declarations
+const size_t gs_FIRST_HSAIL_INSTRUCTION_LINE = 6;
+
+/// GCN instructions are (at least) four bytes
+const unsigned long long gs_ISA_INSTRUCTION_SIZE = 4;
+const unsigned long long gs_ISA_LOW_ADDRESS = 0x1000;
+
+/// The file paths of the line tables are made from it, as they are for a compiler's output
+const char gs_COMPILATION_DIRECTORY[] = "/hwdbginfo-bench";
+
+/// SHT_PROGBITS, the type of every generated section
+const uint32_t gs_SECTION_TYPE_PROGBITS = 1;
+
+/// The DWARF 2 compilation unit header is unit_length, version, debug_abbrev_offset, address_size
+const size_t gs_CU_HEADER_SIZE = 11;
+
+/// A little-endian byte buffer
+class ByteBuffer
+{
+public:
+    void U8(uint8_t value) { m_bytes.push_back(value); }
+    void U16(uint16_t value) { Raw(&value, sizeof(value)); }
+    void U32(uint32_t value) { Raw(&value, sizeof(value)); }
+    void U64(uint64_t value) { Raw(&value, sizeof(value)); }
+    void Raw(const void* pData, size_t size) { m_bytes.insert(m_bytes.end(), (const uint8_t*)pData, (const uint8_t*)pData + size); }
+    void String(const std::string& value) { Raw(value.c_str(), value.length() + 1); }
+
+    void ULEB128(uint64_t value)
+    {
+        do
+        {
+            uint8_t byte = value & 0x7f;
+            value >>= 7;
+            U8((0 != value) ? (byte | 0x80) : byte);
+        }
+        while (0 != value);
+    }
+
+    void SLEB128(int64_t value)
+    {
+        bool more = true;
+
+        while (more)
+        {
+            uint8_t byte = value & 0x7f;
+            value >>= 7;
+            more = !((0 == value && 0 == (byte & 0x40)) || (-1 == value && 0 != (byte & 0x40)));
+            U8(more ? (byte | 0x80) : byte);
+        }
+    }
+
+    void Align(size_t alignment)
+    {
+        while (0 != (m_bytes.size() % alignment))
+        {
+            U8(0);
+        }
+    }
+
+    void PatchU32(size_t offset, uint32_t value) { memcpy(&m_bytes[offset], &value, sizeof(value)); }
+
+    size_t Size() const { return m_bytes.size(); }
+
+    std::vector<uint8_t> m_bytes;
+};
+
+/// DWARF 2 abbreviations, each is a tag, a children flag and (attribute, form) pairs
+class AbbreviationTable
+{
+public:
+    AbbreviationTable() : m_lastCode(0) {};
+
+    unsigned int Add(uint16_t tag, bool hasChildren, const std::vector<std::pair<uint16_t, uint16_t> >& attributes)
+    {
+        m_table.ULEB128(++m_lastCode);
+        m_table.ULEB128(tag);
+        m_table.U8(hasChildren ? DW_CHILDREN_yes : DW_CHILDREN_no);
+
+        for (const auto& attribute : attributes)
+        {
+            m_table.ULEB128(attribute.first);
+            m_table.ULEB128(attribute.second);
+        }
+
+        m_table.U8(0);
+        m_table.U8(0);
+
+        return m_lastCode;
+    }
+
+    const std::vector<uint8_t>& Finish()
+    {
+        m_table.U8(0);
+        return m_table.m_bytes;
+    }
+
+private:
+    unsigned int m_lastCode;
+    ByteBuffer m_table;
+};
+
+/// The DIEs of a compilation unit, with their offsets from the start of the unit
+class DebugInfo
+{
+public:
+    size_t Offset() const { return gs_CU_HEADER_SIZE + m_dies.Size(); }
+
+    size_t Begin(unsigned int abbreviation)
+    {
+        size_t retVal = Offset();
+        m_dies.ULEB128(abbreviation);
+        return retVal;
+    }
+
+    void EndChildren() { m_dies.U8(0); }
+
+    std::vector<uint8_t> Finish()
+    {
+        ByteBuffer unit;
+        unit.U32((uint32_t)(gs_CU_HEADER_SIZE - 4 + m_dies.Size()));
+        unit.U16(2);
+        unit.U32(0);
+        unit.U8(8);
+        unit.Raw(m_dies.m_bytes.data(), m_dies.Size());
+        return unit.m_bytes;
+    }
+
+    ByteBuffer m_dies;
+};
+
+/// A DWARF 2 line program for a single file, from (address, line) rows sorted by address
+std::vector<uint8_t> BuildLineProgram(const std::string& fileName, const std::vector<std::pair<uint64_t, uint64_t> >& rows)
+{
+    static const int8_t lineBase = -5;
+    static const uint8_t lineRange = 14;
+    static const uint8_t opcodeBase = 13;
+    static const uint8_t standardOpcodeLengths[opcodeBase - 1] = { 0, 1, 1, 1, 1, 0, 0, 0, 1, 0, 0, 1 };
+
+    ByteBuffer program;
+    program.U32(0);                             // unit_length, patched below
+    program.U16(2);
+    size_t headerLengthOffset = program.Size();
+    program.U32(0);                             // header_length, patched below
+    size_t headerStart = program.Size();
+    program.U8(1);                              // minimum_instruction_length
+    program.U8(1);                              // default_is_stmt
+    program.U8((uint8_t)lineBase);
+    program.U8(lineRange);
+    program.U8(opcodeBase);
+    program.Raw(standardOpcodeLengths, sizeof(standardOpcodeLengths));
+    program.String(gs_COMPILATION_DIRECTORY);   // The only include directory
+    program.U8(0);
+    program.String(fileName);
+    program.ULEB128(1);
+    program.ULEB128(0);
+    program.ULEB128(0);
+    program.U8(0);                              // End of the file names
+    program.PatchU32(headerLengthOffset, (uint32_t)(program.Size() - headerStart));
+
+    uint64_t address = rows.empty() ? 0 : rows.front().first;
+    int64_t line = 1;
+
+    program.U8(0);
+    program.ULEB128(9);
+    program.U8(DW_LNE_set_address);
+    program.U64(address);
+
+    for (const auto& row : rows)
+    {
+        uint64_t addressDelta = row.first - address;
+        int64_t lineDelta = (int64_t)row.second - line;
+        uint64_t specialOpcode = (uint64_t)(lineDelta - lineBase) + (lineRange * addressDelta) + opcodeBase;
+
+        if (lineBase <= lineDelta && lineDelta < lineBase + lineRange && 255 >= specialOpcode)
+        {
+            program.U8((uint8_t)specialOpcode);
+        }
+        else
+        {
+            if (0 != addressDelta)
+            {
+                program.U8(DW_LNS_advance_pc);
+                program.ULEB128(addressDelta);
+            }
+
+            if (0 != lineDelta)
+            {
+                program.U8(DW_LNS_advance_line);
+                program.SLEB128(lineDelta);
+            }
+
+            program.U8(DW_LNS_copy);
+        }
+
+        address = row.first;
+        line = (int64_t)row.second;
+    }
+
+    program.U8(DW_LNS_advance_pc);
+    program.ULEB128(1);
+    program.U8(0);
+    program.ULEB128(1);
+    program.U8(DW_LNE_end_sequence);
+
+    program.PatchU32(0, (uint32_t)(program.Size() - 4));
+
+    return program.m_bytes;
+}
+
+/// A section of a generated ELF
+struct ElfSection
+{
+    ElfSection(const std::string& name, uint32_t type, const std::vector<uint8_t>& data) :
+        m_name(name), m_type(type), m_data(data) {};
+
+    std::string m_name;
+    uint32_t m_type;
+    std::vector<uint8_t> m_data;
+};
+
+/// A relocatable ELF64 with the sections and a section name string table
+std::vector<uint8_t> BuildElf(uint16_t machine, const std::vector<ElfSection>& sections)
+{
+    static const size_t elfHeaderSize = 64;
+    static const size_t sectionHeaderSize = 64;
+    static const uint32_t sectionTypeStrtab = 3;
+
+    ByteBuffer nameTable;
+    std::vector<uint32_t> nameOffsets;
+    nameTable.U8(0);
+
+    for (const auto& section : sections)
+    {
+        nameOffsets.push_back((uint32_t)nameTable.Size());
+        nameTable.String(section.m_name);
+    }
+
+    uint32_t nameTableNameOffset = (uint32_t)nameTable.Size();
+    nameTable.String(".shstrtab");
+
+    // The section data follows the ELF header, the section headers come last:
+    ByteBuffer elf;
+    elf.m_bytes.resize(elfHeaderSize, 0);
+    std::vector<uint64_t> dataOffsets;
+
+    for (const auto& section : sections)
+    {
+        elf.Align(8);
+        dataOffsets.push_back(elf.Size());
+        elf.Raw(section.m_data.data(), section.m_data.size());
+    }
+
+    elf.Align(8);
+    uint64_t nameTableOffset = elf.Size();
+    elf.Raw(nameTable.m_bytes.data(), nameTable.Size());
+    elf.Align(8);
+    uint64_t sectionHeadersOffset = elf.Size();
+    uint16_t sectionCount = (uint16_t)(sections.size() + 2);
+
+    // SHN_UNDEF:
+    elf.m_bytes.resize(elf.Size() + sectionHeaderSize, 0);
+
+    for (size_t i = 0; i <= sections.size(); i++)
+    {
+        bool isNameTable = (sections.size() == i);
+        elf.U32(isNameTable ? nameTableNameOffset : nameOffsets[i]);
+        elf.U32(isNameTable ? sectionTypeStrtab : sections[i].m_type);
+        elf.U64(0);                             // sh_flags
+        elf.U64(0);                             // sh_addr
+        elf.U64(isNameTable ? nameTableOffset : dataOffsets[i]);
+        elf.U64(isNameTable ? nameTable.Size() : sections[i].m_data.size());
+        elf.U32(0);                             // sh_link
+        elf.U32(0);                             // sh_info
+        elf.U64(1);                             // sh_addralign
+        elf.U64(0);                             // sh_entsize
+    }
+
+    // The ELF header:
+    ByteBuffer header;
+    static const uint8_t ident[16] = { 0x7f, 'E', 'L', 'F', 2 /* ELFCLASS64 */, 1 /* ELFDATA2LSB */, 1 /* EV_CURRENT */ };
+    header.Raw(ident, sizeof(ident));
+    header.U16(1);                              // ET_REL
+    header.U16(machine);
+    header.U32(1);                              // EV_CURRENT
+    header.U64(0);                              // e_entry
+    header.U64(0);                              // e_phoff
+    header.U64(sectionHeadersOffset);
+    header.U32(0);                              // e_flags
+    header.U16((uint16_t)elfHeaderSize);
+    header.U16(0);                              // e_phentsize
+    header.U16(0);                              // e_phnum
+    header.U16((uint16_t)sectionHeaderSize);
+    header.U16(sectionCount);
+    header.U16((uint16_t)(sectionCount - 1));   // e_shstrndx
+    memcpy(elf.m_bytes.data(), header.m_bytes.data(), elfHeaderSize);
+
+    return elf.m_bytes;
+}
+
+/// The HSAIL text, one instruction per HL address
+std::string BuildHsailText(const CodeObjectShape& shape, size_t hsailInstructions)
+{
+    std::string retVal;
+    char line[128];
+
+    retVal.reserve(hsailInstructions * 32);
+    retVal += "module &hwdbginfo_bench:1:0:$full:$large:$default;\n";
+    retVal += "\n";
+    retVal += "prog kernel &" + shape.m_kernelName + "(\n";
+    retVal += "\tkernarg_u64 %__arg_p0)\n";
+    retVal += "{\n";
+
+    for (size_t i = 0; i < hsailInstructions; i++)
+    {
+        snprintf(line, sizeof(line), "\tadd_u32\t$s%u, $s%u, %u;\n", (unsigned int)(i % 128), (unsigned int)((i + 1) % 128), (unsigned int)i);
+        retVal += line;
+    }
+
+    retVal += "};\n";
+
+    return retVal;
+}
+
+/// The .source BRIG section, the HSAIL text after a section header
+std::vector<uint8_t> BuildBrigSourceSection(const std::string& hsailText)
+{
+    static const char sectionName[] = "hsa_source";
+    ByteBuffer section;
+    section.U64(0);                             // byteCount, patched below
+    section.U32(0);                             // headerByteCount, patched below
+    section.U32(sizeof(sectionName) - 1);
+    section.Raw(sectionName, sizeof(sectionName) - 1);
+    section.Align(4);
+    uint32_t headerByteCount = (uint32_t)section.Size();
+    section.Raw(hsailText.c_str(), hsailText.length());
+
+    uint64_t byteCount = section.Size();
+    memcpy(&section.m_bytes[offsetof(BrigSectionHeader, byteCount)], &byteCount, sizeof(byteCount));
+    section.PatchU32(offsetof(BrigSectionHeader, headerByteCount), headerByteCount);
+
+    return section.m_bytes;
+}
+}
+
+CodeObjectShape::CodeObjectShape() :
+    m_kernelName("hwdbginfo_bench_kernel"),
+    m_sourceLines(100000),
+    m_hsailLinesPerSourceLine(2),
+    m_isaInstructionsPerHsailLine(2),
+    m_inlineDepth(8),
+    m_inlineSites(64),
+    m_variablesPerScope(4)
+{
+}
+
+bool HwDbgInfoBenchmark::GenerateCodeObject(const CodeObjectShape& shape, std::vector<unsigned char>& o_codeObject, CodeObjectLayout& o_layout)
+{
+    typedef std::pair<uint16_t, uint16_t> Attr;
+
+    if (0 == shape.m_sourceLines || 0 == shape.m_hsailLinesPerSourceLine || 0 == shape.m_isaInstructionsPerHsailLine || shape.m_kernelName.empty())
+    {
+        return false;
+    }
+
+    size_t hsailInstructions = shape.m_sourceLines * shape.m_hsailLinesPerSourceLine;
+    uint64_t hlLow = gs_FIRST_HSAIL_INSTRUCTION_LINE;
+    uint64_t hlHigh = hlLow + hsailInstructions;
+    uint64_t isaHigh = gs_ISA_LOW_ADDRESS + hsailInstructions * shape.m_isaInstructionsPerHsailLine * gs_ISA_INSTRUCTION_SIZE;
+
+    // Each HL variable is matched to its ISA register by its BRIG offset:
+    std::vector<uint32_t> brigOffsets;
+
+    ////////////////////////////////////////////////////////////////////////
+    // High-level (BRIG) DWARF: OpenCL source lines at HSAIL line addresses
+    ////////////////////////////////////////////////////////////////////////
+    AbbreviationTable hlAbbrevs;
+    unsigned int hlCompileUnit = hlAbbrevs.Add(DW_TAG_compile_unit, true, { Attr(DW_AT_name, DW_FORM_string), Attr(DW_AT_comp_dir, DW_FORM_string), Attr(DW_AT_producer, DW_FORM_string), Attr(DW_AT_language, DW_FORM_data2),
+                                                                          Attr(DW_AT_low_pc, DW_FORM_addr), Attr(DW_AT_high_pc, DW_FORM_addr), Attr(DW_AT_stmt_list, DW_FORM_data4)
+                                                                        });
+    unsigned int hlBaseType = hlAbbrevs.Add(DW_TAG_base_type, false, { Attr(DW_AT_name, DW_FORM_string), Attr(DW_AT_byte_size, DW_FORM_data1), Attr(DW_AT_encoding, DW_FORM_data1) });
+    unsigned int hlKernel = hlAbbrevs.Add(DW_TAG_subprogram, true, { Attr(DW_AT_name, DW_FORM_string), Attr(DW_AT_low_pc, DW_FORM_addr), Attr(DW_AT_high_pc, DW_FORM_addr),
+                                                                   Attr(HWDBGINFO_BENCH_DW_AT_HSA_is_kernel, DW_FORM_flag)
+                                                                 });
+    unsigned int hlVariable = hlAbbrevs.Add(DW_TAG_variable, false, { Attr(DW_AT_name, DW_FORM_string), Attr(DW_AT_type, DW_FORM_ref4), Attr(DW_AT_location, DW_FORM_block1) });
+    unsigned int hlAbstractFunction = hlAbbrevs.Add(DW_TAG_subprogram, true, { Attr(DW_AT_name, DW_FORM_string), Attr(DW_AT_inline, DW_FORM_flag) });
+    unsigned int hlAbstractVariable = hlAbbrevs.Add(DW_TAG_variable, false, { Attr(DW_AT_name, DW_FORM_string), Attr(DW_AT_type, DW_FORM_ref4) });
+    unsigned int hlInlined = hlAbbrevs.Add(DW_TAG_inlined_subroutine, true, { Attr(DW_AT_abstract_origin, DW_FORM_ref4), Attr(DW_AT_low_pc, DW_FORM_addr), Attr(DW_AT_high_pc, DW_FORM_addr),
+                                                                            Attr(DW_AT_call_file, DW_FORM_udata), Attr(DW_AT_call_line, DW_FORM_udata)
+                                                                          });
+    unsigned int hlConcreteVariable = hlAbbrevs.Add(DW_TAG_variable, false, { Attr(DW_AT_abstract_origin, DW_FORM_ref4), Attr(DW_AT_location, DW_FORM_block1) });
+
+    auto addBrigLocation = [&brigOffsets](ByteBuffer & dies)
+    {
+        uint32_t brigOffset = (uint32_t)(0x100 + 0x30 * brigOffsets.size());
+        brigOffsets.push_back(brigOffset);
+        dies.U8(9);
+        dies.U8(DW_OP_addr);
+        dies.U64(brigOffset);
+    };
+
+    DebugInfo hlInfo;
+    hlInfo.Begin(hlCompileUnit);
+    hlInfo.m_dies.String("hwdbginfo_bench.cl");
+    hlInfo.m_dies.String(gs_COMPILATION_DIRECTORY);
+    hlInfo.m_dies.String("HwDbgFacilities benchmark generator");
+    hlInfo.m_dies.U16(DW_LANG_C99);
+    hlInfo.m_dies.U64(hlLow);
+    hlInfo.m_dies.U64(hlHigh);
+    hlInfo.m_dies.U32(0);
+
+    size_t hlIntType = hlInfo.Begin(hlBaseType);
+    hlInfo.m_dies.String("int");
+    hlInfo.m_dies.U8(4);
+    hlInfo.m_dies.U8(DW_ATE_signed);
+
+    // One inlined function for each nesting level, the first variable of every scope is "i":
+    std::vector<size_t> abstractFunctions;
+    std::vector<std::vector<size_t> > abstractVariables(shape.m_inlineDepth);
+
+    for (size_t d = 0; d < shape.m_inlineDepth; d++)
+    {
+        abstractFunctions.push_back(hlInfo.Begin(hlAbstractFunction));
+        hlInfo.m_dies.String("inlined_level_" + std::to_string(d));
+        hlInfo.m_dies.U8(1);
+
+        for (size_t v = 0; v < shape.m_variablesPerScope; v++)
+        {
+            abstractVariables[d].push_back(hlInfo.Begin(hlAbstractVariable));
+            hlInfo.m_dies.String((0 == v) ? std::string("i") : "level" + std::to_string(d) + "_var" + std::to_string(v));
+            hlInfo.m_dies.U32((uint32_t)hlIntType);
+        }
+
+        hlInfo.EndChildren();
+    }
+
+    hlInfo.Begin(hlKernel);
+    hlInfo.m_dies.String(shape.m_kernelName);
+    hlInfo.m_dies.U64(hlLow);
+    hlInfo.m_dies.U64(hlHigh);
+    hlInfo.m_dies.U8(1);
+
+    for (size_t v = 0; v < shape.m_variablesPerScope; v++)
+    {
+        hlInfo.Begin(hlVariable);
+        hlInfo.m_dies.String((0 == v) ? std::string("i") : "kernel_var" + std::to_string(v));
+        hlInfo.m_dies.U32((uint32_t)hlIntType);
+        addBrigLocation(hlInfo.m_dies);
+    }
+
+    // The inline sites split the kernel, each chain narrows towards the middle of its site:
+    size_t siteCount = (0 < shape.m_inlineDepth) ? shape.m_inlineSites : 0;
+    uint64_t siteLength = (0 < siteCount) ? (hsailInstructions / siteCount) : 0;
+
+    for (size_t s = 0; s < siteCount && 0 < siteLength; s++)
+    {
+        uint64_t siteLow = hlLow + s * siteLength;
+        uint64_t siteHigh = siteLow + siteLength;
+        uint64_t narrowing = siteLength / (2 * (shape.m_inlineDepth + 1));
+
+        for (size_t d = 0; d < shape.m_inlineDepth; d++)
+        {
+            uint64_t low = siteLow + (d + 1) * narrowing;
+            uint64_t high = siteHigh - (d + 1) * narrowing;
+            uint64_t callerLow = (0 == d) ? siteLow : (low - narrowing);
+
+            hlInfo.Begin(hlInlined);
+            hlInfo.m_dies.U32((uint32_t)abstractFunctions[d]);
+            hlInfo.m_dies.U64(low);
+            hlInfo.m_dies.U64(high);
+            hlInfo.m_dies.ULEB128(1);
+            hlInfo.m_dies.ULEB128((callerLow - hlLow) / shape.m_hsailLinesPerSourceLine + 1);
+
+            for (size_t v = 0; v < shape.m_variablesPerScope; v++)
+            {
+                hlInfo.Begin(hlConcreteVariable);
+                hlInfo.m_dies.U32((uint32_t)abstractVariables[d][v]);
+                addBrigLocation(hlInfo.m_dies);
+            }
+        }
+
+        for (size_t d = 0; d < shape.m_inlineDepth; d++)
+        {
+            hlInfo.EndChildren();
+        }
+    }
+
+    hlInfo.EndChildren();                       // The kernel
+    hlInfo.EndChildren();                       // The compilation unit
+
+    std::vector<std::pair<uint64_t, uint64_t> > hlRows;
+    hlRows.reserve(hsailInstructions);
+
+    for (uint64_t addr = hlLow; addr < hlHigh; addr++)
+    {
+        hlRows.push_back(std::make_pair(addr, (addr - hlLow) / shape.m_hsailLinesPerSourceLine + 1));
+    }
+
+    std::string hsailText = BuildHsailText(shape, hsailInstructions);
+    std::vector<ElfSection> brigSections;
+    brigSections.push_back(ElfSection(".source", gs_SECTION_TYPE_PROGBITS, BuildBrigSourceSection(hsailText)));
+    brigSections.push_back(ElfSection(".debug_abbrev", gs_SECTION_TYPE_PROGBITS, hlAbbrevs.Finish()));
+    brigSections.push_back(ElfSection(".debug_info", gs_SECTION_TYPE_PROGBITS, hlInfo.Finish()));
+    brigSections.push_back(ElfSection(".debug_line", gs_SECTION_TYPE_PROGBITS, BuildLineProgram("hwdbginfo_bench.cl", hlRows)));
+    hlRows.clear();
+    hlRows.shrink_to_fit();
+
+    ////////////////////////////////////////////////////////////////////////
+    // Low-level (ISA) DWARF: HSAIL lines at ISA addresses
+    ////////////////////////////////////////////////////////////////////////
+    AbbreviationTable llAbbrevs;
+    unsigned int llCompileUnit = llAbbrevs.Add(DW_TAG_compile_unit, true, { Attr(DW_AT_name, DW_FORM_string), Attr(DW_AT_comp_dir, DW_FORM_string), Attr(DW_AT_language, DW_FORM_data2),
+                                                                          Attr(DW_AT_low_pc, DW_FORM_addr), Attr(DW_AT_high_pc, DW_FORM_addr), Attr(DW_AT_stmt_list, DW_FORM_data4)
+                                                                        });
+    unsigned int llBaseType = llAbbrevs.Add(DW_TAG_base_type, false, { Attr(DW_AT_name, DW_FORM_string), Attr(DW_AT_byte_size, DW_FORM_data1), Attr(DW_AT_encoding, DW_FORM_data1) });
+    unsigned int llKernel = llAbbrevs.Add(DW_TAG_subprogram, true, { Attr(DW_AT_name, DW_FORM_string), Attr(DW_AT_low_pc, DW_FORM_addr), Attr(DW_AT_high_pc, DW_FORM_addr),
+                                                                   Attr(HWDBGINFO_BENCH_DW_AT_HSA_is_kernel, DW_FORM_flag)
+                                                                 });
+    unsigned int llVariable = llAbbrevs.Add(DW_TAG_variable, false, { Attr(DW_AT_name, DW_FORM_string), Attr(DW_AT_type, DW_FORM_ref4), Attr(DW_AT_location, DW_FORM_block1),
+                                                                    Attr(HWDBGINFO_BENCH_DW_AT_HSA_brig_offset, DW_FORM_udata)
+                                                                  });
+
+    DebugInfo llInfo;
+    llInfo.Begin(llCompileUnit);
+    llInfo.m_dies.String("hwdbginfo_bench.hsail");
+    llInfo.m_dies.String(gs_COMPILATION_DIRECTORY);
+    llInfo.m_dies.U16(HWDBGINFO_BENCH_DW_LANG_HSA_Assembly);
+    llInfo.m_dies.U64(gs_ISA_LOW_ADDRESS);
+    llInfo.m_dies.U64(isaHigh);
+    llInfo.m_dies.U32(0);
+
+    size_t llIntType = llInfo.Begin(llBaseType);
+    llInfo.m_dies.String("u32");
+    llInfo.m_dies.U8(4);
+    llInfo.m_dies.U8(DW_ATE_unsigned);
+
+    llInfo.Begin(llKernel);
+    llInfo.m_dies.String("&" + shape.m_kernelName);
+    llInfo.m_dies.U64(gs_ISA_LOW_ADDRESS);
+    llInfo.m_dies.U64(isaHigh);
+    llInfo.m_dies.U8(1);
+
+    for (size_t v = 0; v < brigOffsets.size(); v++)
+    {
+        ByteBuffer location;
+        location.U8(DW_OP_regx);
+        location.ULEB128(v);
+
+        llInfo.Begin(llVariable);
+        llInfo.m_dies.String("$s" + std::to_string(v));
+        llInfo.m_dies.U32((uint32_t)llIntType);
+        llInfo.m_dies.U8((uint8_t)location.Size());
+        llInfo.m_dies.Raw(location.m_bytes.data(), location.Size());
+        llInfo.m_dies.ULEB128(brigOffsets[v]);
+    }
+
+    llInfo.EndChildren();                       // The kernel
+    llInfo.EndChildren();                       // The compilation unit
+
+    std::vector<std::pair<uint64_t, uint64_t> > llRows;
+    llRows.reserve(hsailInstructions * shape.m_isaInstructionsPerHsailLine);
+    uint64_t isaAddr = gs_ISA_LOW_ADDRESS;
+
+    for (uint64_t hsailLine = hlLow; hsailLine < hlHigh; hsailLine++)
+    {
+        for (size_t i = 0; i < shape.m_isaInstructionsPerHsailLine; i++, isaAddr += gs_ISA_INSTRUCTION_SIZE)
+        {
+            llRows.push_back(std::make_pair(isaAddr, hsailLine));
+        }
+    }
+
+    std::vector<ElfSection> codeObjectSections;
+    codeObjectSections.push_back(ElfSection(".hsahldebug_" + shape.m_kernelName, gs_SECTION_TYPE_PROGBITS, BuildElf(HWDBGINFO_BENCH_EM_HSAIL, brigSections)));
+    brigSections.clear();
+    codeObjectSections.push_back(ElfSection(".debug_abbrev", gs_SECTION_TYPE_PROGBITS, llAbbrevs.Finish()));
+    codeObjectSections.push_back(ElfSection(".debug_info", gs_SECTION_TYPE_PROGBITS, llInfo.Finish()));
+    codeObjectSections.push_back(ElfSection(".debug_line", gs_SECTION_TYPE_PROGBITS, BuildLineProgram("hwdbginfo_bench.hsail", llRows)));
+
+    o_codeObject = BuildElf(HWDBGINFO_BENCH_EM_AMDGPU, codeObjectSections);
+
+    o_layout.m_hsailLines = (size_t)hlHigh;
+    o_layout.m_isaLowAddress = gs_ISA_LOW_ADDRESS;
+    o_layout.m_isaHighAddress = isaHigh;
+    o_layout.m_variables = brigOffsets.size();
+
+    return true;
+}
@@ -0,0 +1,46 @@
+//==============================================================================
+// Copyright (c) 2015 Advanced Micro Devices, Inc. All rights reserved.
+//
+/// \author AMD Developer Tools
+/// \file
+/// \brief  Generates HSA 1.0 code objects with debug information of a chosen size
+//==============================================================================
+#ifndef CODEOBJECTGENERATOR_H_
+#define CODEOBJECTGENERATOR_H_
+
+/// STL:
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace HwDbgInfoBenchmark
+{
+/// The shape of a generated code object
+struct CodeObjectShape
+{
+    CodeObjectShape();
+
+    std::string m_kernelName;           ///< Without the '&' prefix
+    size_t m_sourceLines;               ///< Lines of the (virtual) OpenCL source
+    size_t m_hsailLinesPerSourceLine;   ///< HSAIL instructions emitted for each source line
+    size_t m_isaInstructionsPerHsailLine; ///< ISA instructions emitted for each HSAIL instruction
+    size_t m_inlineDepth;               ///< Nesting of the inlined function chains
+    size_t m_inlineSites;               ///< How many chains are inlined into the kernel
+    size_t m_variablesPerScope;         ///< Variables in the kernel and in each inlined function
+};
+
+/// The numbers a benchmark needs to pick its queries
+struct CodeObjectLayout
+{
+    size_t m_hsailLines;                ///< The HL addresses are 1..m_hsailLines
+    unsigned long long m_isaLowAddress; ///< The first mapped ISA address
+    unsigned long long m_isaHighAddress; ///< One past the last mapped ISA address
+    size_t m_variables;                 ///< Variables, counting each inlined instance
+};
+
+/// Builds an ELF with one .hsahldebug_ code object holding the BRIG DWARF and the HSAIL
+/// text, and the ISA DWARF in the outer ELF, which is what hwdbginfo_init_with_hsa_1_0_binary reads
+bool GenerateCodeObject(const CodeObjectShape& shape, std::vector<unsigned char>& o_codeObject, CodeObjectLayout& o_layout);
+}
+
+#endif // CODEOBJECTGENERATOR_H_
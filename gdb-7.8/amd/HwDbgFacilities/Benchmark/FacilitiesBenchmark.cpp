@@ -0,0 +1,531 @@
+//==============================================================================
+// Copyright (c) 2015 Advanced Micro Devices, Inc. All rights reserved.
+//
+/// \author AMD Developer Tools
+/// \file
+/// \brief  Times the HwDbgFacilities query APIs on real or generated code objects
+//==============================================================================
+/// System:
+#include <getopt.h>
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+
+/// STL:
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+/// Local:
+#include "CodeObjectGenerator.h"
+#include <FacilitiesInterface.h>
+
+using namespace HwDbgInfoBenchmark;
+
+namespace
+{
+/// The command line
+struct BenchmarkOptions
+{
+    BenchmarkOptions() : m_queries(10000), m_seed(1), m_parseOptions(HWDBGINFO_PARSE_DEFAULT) {};
+
+    std::vector<std::string> m_codeObjectPaths;
+    CodeObjectShape m_shape;
+    std::string m_outputPath;
+    std::string m_reportPath;
+    size_t m_queries;
+    unsigned int m_seed;
+    unsigned int m_parseOptions;
+};
+
+uint64_t Now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/// The resident set size now, in KiB
+long CurrentRssKiB()
+{
+    long retVal = 0;
+    FILE* pStatm = fopen("/proc/self/statm", "r");
+
+    if (nullptr != pStatm)
+    {
+        long sizePages = 0;
+        long residentPages = 0;
+
+        if (2 == fscanf(pStatm, "%ld %ld", &sizePages, &residentPages))
+        {
+            retVal = residentPages * (sysconf(_SC_PAGESIZE) / 1024);
+        }
+
+        fclose(pStatm);
+    }
+
+    return retVal;
+}
+
+/// The largest resident set size so far, in KiB
+long PeakRssKiB()
+{
+    struct rusage usage;
+    memset(&usage, 0, sizeof(usage));
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+/// The latencies of one API, with how many calls found nothing and how many results the rest returned
+class LatencySeries
+{
+public:
+    explicit LatencySeries(const char* name) : m_name(name), m_misses(0), m_results(0) {};
+
+    void Add(uint64_t ns, bool found, size_t results = 1)
+    {
+        m_samples.push_back(ns);
+
+        if (found)
+        {
+            m_results += results;
+        }
+        else
+        {
+            m_misses++;
+        }
+    }
+
+    void Print(FILE* pOut, const std::string& prefix)
+    {
+        if (m_samples.empty())
+        {
+            return;
+        }
+
+        std::sort(m_samples.begin(), m_samples.end());
+
+        double sum = 0;
+
+        for (uint64_t sample : m_samples)
+        {
+            sum += (double)sample;
+        }
+
+        size_t count = m_samples.size();
+        size_t found = count - m_misses;
+
+        fprintf(pOut, "%s%-28s %8zu %8zu %9.1f %10.2f %10.2f %10.2f %10.2f\n", prefix.c_str(), m_name, count, m_misses,
+                (0 < found) ? (double)m_results / found : 0.0,
+                sum / count / 1000.0, m_samples[count / 2] / 1000.0, m_samples[std::min(count - 1, count * 99 / 100)] / 1000.0, m_samples.back() / 1000.0);
+    }
+
+private:
+    const char* m_name;
+    std::vector<uint64_t> m_samples;
+    size_t m_misses;
+    size_t m_results;
+};
+
+void PrintHeader(FILE* pOut)
+{
+    fprintf(pOut, "%-28s %8s %8s %9s %10s %10s %10s %10s\n", "api", "calls", "misses", "results", "mean(us)", "p50(us)", "p99(us)", "max(us)");
+}
+
+/// Runs every query API on one code object
+bool RunBenchmark(const std::string& name, std::vector<unsigned char>& codeObject, const BenchmarkOptions& options)
+{
+    std::mt19937_64 random(options.m_seed);
+    HwDbgInfo_err err = HWDBGINFO_E_SUCCESS;
+    long rssBeforeInit = CurrentRssKiB();
+
+    printf("== %s: %zu bytes\n", name.c_str(), codeObject.size());
+
+    uint64_t start = Now();
+    HwDbgInfo_debug dbg = hwdbginfo_init_with_hsa_1_0_binary(codeObject.data(), codeObject.size(), &err);
+    uint64_t initNs = Now() - start;
+
+    if (nullptr == dbg)
+    {
+        fprintf(stderr, "hwdbginfo_init_with_hsa_1_0_binary failed on %s: %u\n", name.c_str(), err);
+        return false;
+    }
+
+    long rssAfterInit = CurrentRssKiB();
+
+    // The DWARF is parsed by the first query:
+    size_t mappedAddrCount = 0;
+    start = Now();
+    err = hwdbginfo_all_mapped_addrs(dbg, 0, nullptr, &mappedAddrCount);
+    uint64_t parseNs = Now() - start;
+
+    if (HWDBGINFO_E_SUCCESS != err || 0 == mappedAddrCount)
+    {
+        fprintf(stderr, "%s has no mapped addresses: %u\n", name.c_str(), err);
+        hwdbginfo_release_debug_info(&dbg);
+        return false;
+    }
+
+    long rssAfterParse = CurrentRssKiB();
+
+    std::vector<HwDbgInfo_addr> mappedAddrs(mappedAddrCount);
+    hwdbginfo_all_mapped_addrs(dbg, mappedAddrCount, mappedAddrs.data(), nullptr);
+    std::sort(mappedAddrs.begin(), mappedAddrs.end());
+
+    HwDbgInfo_addr lowAddr = mappedAddrs.front();
+    HwDbgInfo_addr highAddr = mappedAddrs.back();
+    auto mappedAddr = [&]() { return mappedAddrs[random() % mappedAddrCount]; };
+    auto anyAddr = [&]() { return lowAddr + random() % (highAddr - lowAddr + 0x100); };
+
+    printf("init %.2f ms, parse %.2f ms, %zu mapped addresses in [%#llx, %#llx]\n",
+           initNs / 1000000.0, parseNs / 1000000.0, mappedAddrCount, lowAddr, highAddr);
+    printf("rss %ld KiB before init, %ld KiB after init, %ld KiB after parse\n", rssBeforeInit, rssAfterInit, rssAfterParse);
+
+    size_t parseReportLen = 0;
+
+    if (HWDBGINFO_E_SUCCESS == hwdbginfo_parse_timings_report(dbg, 0, nullptr, &parseReportLen))
+    {
+        std::vector<char> parseReport(parseReportLen);
+        hwdbginfo_parse_timings_report(dbg, parseReportLen, parseReport.data(), nullptr);
+        printf("%s", parseReport.data());
+    }
+
+    LatencySeries addrToLine("addr_to_line");
+    LatencySeries lineToAddrs("line_to_addrs");
+    LatencySeries nearestMappedAddr("nearest_mapped_addr");
+    LatencySeries stepAddresses("step_addresses");
+    LatencySeries stepOutAddresses("step_addresses(out)");
+    LatencySeries frameVariables("frame_variables");
+    LatencySeries variable("variable");
+
+    // One in four addresses is unmapped, as a wave may stop anywhere:
+    std::vector<HwDbgInfo_code_location> lines;
+    lines.reserve(options.m_queries);
+
+    for (size_t i = 0; i < options.m_queries; i++)
+    {
+        HwDbgInfo_code_location loc = nullptr;
+        HwDbgInfo_addr addr = (3 == i % 4) ? anyAddr() : mappedAddr();
+
+        start = Now();
+        err = hwdbginfo_addr_to_line(dbg, addr, &loc);
+        addrToLine.Add(Now() - start, HWDBGINFO_E_SUCCESS == err);
+
+        if (HWDBGINFO_E_SUCCESS == err && nullptr != loc)
+        {
+            lines.push_back(loc);
+        }
+    }
+
+    // Lines past the end of the file find nothing, as breakpoints on stale sources do:
+    std::string fileName;
+    HwDbgInfo_linenum maxLine = 1;
+
+    for (HwDbgInfo_code_location loc : lines)
+    {
+        char fileNameBuffer[1024] = { 0 };
+        HwDbgInfo_linenum line = 0;
+
+        if (HWDBGINFO_E_SUCCESS == hwdbginfo_code_location_details(loc, &line, sizeof(fileNameBuffer), fileNameBuffer, nullptr))
+        {
+            maxLine = std::max(maxLine, line);
+
+            if (fileName.empty())
+            {
+                fileName = fileNameBuffer;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < options.m_queries && !lines.empty(); i++)
+    {
+        HwDbgInfo_code_location loc = lines[i % lines.size()];
+        HwDbgInfo_code_location fuzzLoc = nullptr;
+
+        if (3 == i % 4)
+        {
+            fuzzLoc = hwdbginfo_make_code_location(fileName.c_str(), 1 + random() % (maxLine + maxLine / 8 + 1));
+            loc = fuzzLoc;
+        }
+
+        // As hsail-breakpoint.c does, one query whose addresses are read in place:
+        size_t addrCount = 0;
+
+        start = Now();
+        HwDbgInfo_result res = hwdbginfo_query_line_to_addrs(dbg, loc, &err);
+        hwdbginfo_result_addrs(res, &addrCount);
+        hwdbginfo_release_result(&res);
+        lineToAddrs.Add(Now() - start, HWDBGINFO_E_SUCCESS == err && 0 < addrCount, addrCount);
+
+        if (nullptr != fuzzLoc)
+        {
+            hwdbginfo_release_code_locations(&fuzzLoc, 1);
+        }
+    }
+
+    hwdbginfo_release_code_locations(lines.data(), lines.size());
+    lines.clear();
+
+    for (size_t i = 0; i < options.m_queries; i++)
+    {
+        HwDbgInfo_addr addr = anyAddr();
+        HwDbgInfo_addr nearest = 0;
+
+        start = Now();
+        err = hwdbginfo_nearest_mapped_addr(dbg, addr, &nearest);
+        nearestMappedAddr.Add(Now() - start, HWDBGINFO_E_SUCCESS == err);
+    }
+
+    // As hsail-step-plan.c does, one query whose addresses are read in place:
+    for (size_t i = 0; i < 2 * options.m_queries; i++)
+    {
+        bool stepOut = (1 == i % 2);
+        HwDbgInfo_addr addr = mappedAddr();
+        size_t addrCount = 0;
+
+        start = Now();
+        HwDbgInfo_result res = hwdbginfo_query_step_addresses(dbg, addr, stepOut, &err);
+        hwdbginfo_result_addrs(res, &addrCount);
+        hwdbginfo_release_result(&res);
+        (stepOut ? stepOutAddresses : stepAddresses).Add(Now() - start, HWDBGINFO_E_SUCCESS == err, addrCount);
+    }
+
+    // As hsail-print.c does, one query whose variables and names are read in place. The
+    // names found are used to look the variables up one at a time below:
+    std::vector<std::string> variableNames;
+
+    for (size_t i = 0; i < options.m_queries; i++)
+    {
+        HwDbgInfo_addr addr = mappedAddr();
+        size_t varCount = 0;
+
+        start = Now();
+        HwDbgInfo_result res = hwdbginfo_query_frame_variables(dbg, addr, -1, false, &err);
+        const HwDbgInfo_variable* vars = hwdbginfo_result_variables(res, &varCount);
+        frameVariables.Add(Now() - start, HWDBGINFO_E_SUCCESS == err && 0 < varCount, varCount);
+
+        for (size_t j = 0; j < varCount; j++)
+        {
+            const char* varName = nullptr;
+
+            if (variableNames.size() < 4096 &&
+                HWDBGINFO_E_SUCCESS == hwdbginfo_variable_names(vars[j], &varName, nullptr, nullptr, nullptr) &&
+                variableNames.end() == std::find(variableNames.begin(), variableNames.end(), varName))
+            {
+                variableNames.push_back(varName);
+            }
+        }
+
+        hwdbginfo_release_result(&res);
+    }
+
+    // A name is often not in scope at a random address, and one in eight does not exist at all:
+    variableNames.push_back("hwdbginfo_bench_no_such_variable");
+
+    for (size_t i = 0; i < options.m_queries; i++)
+    {
+        HwDbgInfo_addr addr = mappedAddr();
+        const std::string& varName = (7 == i % 8) ? variableNames.back() : variableNames[random() % variableNames.size()];
+
+        start = Now();
+        HwDbgInfo_variable var = hwdbginfo_variable(dbg, addr, true, varName.c_str(), &err);
+        variable.Add(Now() - start, nullptr != var);
+
+        if (nullptr != var)
+        {
+            hwdbginfo_release_variables(dbg, &var, 1);
+        }
+    }
+
+    PrintHeader(stdout);
+    LatencySeries* allSeries[] = { &addrToLine, &lineToAddrs, &nearestMappedAddr, &stepAddresses, &stepOutAddresses, &frameVariables, &variable };
+
+    for (LatencySeries* pSeries : allSeries)
+    {
+        pSeries->Print(stdout, "");
+    }
+
+    if (!options.m_reportPath.empty())
+    {
+        FILE* pReport = fopen(options.m_reportPath.c_str(), "a");
+
+        if (nullptr != pReport)
+        {
+            std::string prefix = name + " ";
+            fprintf(pReport, "%s%-28s %.2f ms\n", prefix.c_str(), "init", initNs / 1000000.0);
+            fprintf(pReport, "%s%-28s %.2f ms\n", prefix.c_str(), "parse", parseNs / 1000000.0);
+
+            for (LatencySeries* pSeries : allSeries)
+            {
+                pSeries->Print(pReport, prefix);
+            }
+
+            fprintf(pReport, "%s%-28s %ld KiB\n", prefix.c_str(), "peak_rss", PeakRssKiB());
+            fclose(pReport);
+        }
+    }
+
+    hwdbginfo_release_debug_info(&dbg);
+
+    return true;
+}
+
+void PrintUsage(const char* program)
+{
+    CodeObjectShape defaults;
+    fprintf(stderr,
+            "Usage: %s [options] [CODE_OBJECT...]\n"
+            "Times the HwDbgFacilities query APIs on each code object, or on a generated one.\n"
+            "  --lines N               Source lines of the generated kernel (default %zu)\n"
+            "  --hsail-per-line N      HSAIL instructions for each source line (default %zu)\n"
+            "  --isa-per-hsail N       ISA instructions for each HSAIL instruction (default %zu)\n"
+            "  --inline-depth N        Nesting of the inlined function chains (default %zu)\n"
+            "  --inline-sites N        Inlined function chains in the kernel (default %zu)\n"
+            "  --vars N                Variables in each scope (default %zu)\n"
+            "  --kernel NAME           The generated kernel's name (default %s)\n"
+            "  --output FILE           Also write the generated code object to FILE\n"
+            "  --queries N             Calls of each API (default 10000)\n"
+            "  --seed N                Seed of the query addresses (default 1)\n"
+            "  --report FILE           Append the measurements to FILE\n"
+            "  --parse MODE            serial, levels (parse the HL and LL DWARF concurrently, the default)\n"
+            "                          or subprograms (also parse the subprograms of each CU concurrently)\n",
+            program, defaults.m_sourceLines, defaults.m_hsailLinesPerSourceLine, defaults.m_isaInstructionsPerHsailLine,
+            defaults.m_inlineDepth, defaults.m_inlineSites, defaults.m_variablesPerScope, defaults.m_kernelName.c_str());
+}
+}
+
+int main(int argc, char** argv)
+{
+    static const struct option longOptions[] =
+    {
+        { "lines", required_argument, nullptr, 'l' },
+        { "hsail-per-line", required_argument, nullptr, 'H' },
+        { "isa-per-hsail", required_argument, nullptr, 'I' },
+        { "inline-depth", required_argument, nullptr, 'd' },
+        { "inline-sites", required_argument, nullptr, 's' },
+        { "vars", required_argument, nullptr, 'v' },
+        { "kernel", required_argument, nullptr, 'k' },
+        { "output", required_argument, nullptr, 'o' },
+        { "queries", required_argument, nullptr, 'q' },
+        { "seed", required_argument, nullptr, 'S' },
+        { "report", required_argument, nullptr, 'r' },
+        { "parse", required_argument, nullptr, 'p' },
+        { "help", no_argument, nullptr, 'h' },
+        { nullptr, 0, nullptr, 0 }
+    };
+
+    BenchmarkOptions options;
+    int opt = 0;
+
+    while (-1 != (opt = getopt_long(argc, argv, "", longOptions, nullptr)))
+    {
+        switch (opt)
+        {
+            case 'l': options.m_shape.m_sourceLines = strtoul(optarg, nullptr, 0); break;
+            case 'H': options.m_shape.m_hsailLinesPerSourceLine = strtoul(optarg, nullptr, 0); break;
+            case 'I': options.m_shape.m_isaInstructionsPerHsailLine = strtoul(optarg, nullptr, 0); break;
+            case 'd': options.m_shape.m_inlineDepth = strtoul(optarg, nullptr, 0); break;
+            case 's': options.m_shape.m_inlineSites = strtoul(optarg, nullptr, 0); break;
+            case 'v': options.m_shape.m_variablesPerScope = strtoul(optarg, nullptr, 0); break;
+            case 'k': options.m_shape.m_kernelName = optarg; break;
+            case 'o': options.m_outputPath = optarg; break;
+            case 'q': options.m_queries = strtoul(optarg, nullptr, 0); break;
+            case 'S': options.m_seed = (unsigned int)strtoul(optarg, nullptr, 0); break;
+            case 'r': options.m_reportPath = optarg; break;
+
+            case 'p':
+                if (0 == strcmp(optarg, "serial"))
+                {
+                    options.m_parseOptions = 0;
+                }
+                else if (0 == strcmp(optarg, "levels"))
+                {
+                    options.m_parseOptions = HWDBGINFO_PARSE_PARALLEL_LEVELS;
+                }
+                else if (0 == strcmp(optarg, "subprograms"))
+                {
+                    options.m_parseOptions = HWDBGINFO_PARSE_PARALLEL_LEVELS | HWDBGINFO_PARSE_PARALLEL_SUBPROGRAMS;
+                }
+                else
+                {
+                    PrintUsage(argv[0]);
+                    return 1;
+                }
+
+                break;
+
+            default:
+                PrintUsage(argv[0]);
+                return ('h' == opt) ? 0 : 1;
+        }
+    }
+
+    for (int i = optind; i < argc; i++)
+    {
+        options.m_codeObjectPaths.push_back(argv[i]);
+    }
+
+    hwdbginfo_set_parse_options(options.m_parseOptions);
+
+    bool retVal = true;
+
+    if (options.m_codeObjectPaths.empty())
+    {
+        std::vector<unsigned char> codeObject;
+        CodeObjectLayout layout;
+        const CodeObjectShape& shape = options.m_shape;
+
+        uint64_t start = Now();
+        retVal = GenerateCodeObject(shape, codeObject, layout);
+
+        if (!retVal)
+        {
+            fprintf(stderr, "Could not generate a code object of this shape\n");
+            return 1;
+        }
+
+        printf("generated %zu source lines, %zu HSAIL lines, ISA [%#llx, %#llx), %zu variables in %.2f ms\n",
+               shape.m_sourceLines, layout.m_hsailLines, layout.m_isaLowAddress, layout.m_isaHighAddress, layout.m_variables, (Now() - start) / 1000000.0);
+
+        if (!options.m_outputPath.empty())
+        {
+            std::ofstream outputFile(options.m_outputPath, std::ios::binary);
+            outputFile.write((const char*)codeObject.data(), codeObject.size());
+
+            if (!outputFile)
+            {
+                fprintf(stderr, "Could not write %s\n", options.m_outputPath.c_str());
+                retVal = false;
+            }
+        }
+
+        std::string name = "generated:lines=" + std::to_string(shape.m_sourceLines) + ",depth=" + std::to_string(shape.m_inlineDepth) +
+                           ",sites=" + std::to_string(shape.m_inlineSites) + ",vars=" + std::to_string(shape.m_variablesPerScope);
+        retVal = RunBenchmark(name, codeObject, options) && retVal;
+    }
+
+    for (const std::string& path : options.m_codeObjectPaths)
+    {
+        std::ifstream codeObjectFile(path, std::ios::binary);
+        std::vector<unsigned char> codeObject((std::istreambuf_iterator<char>(codeObjectFile)), std::istreambuf_iterator<char>());
+
+        if (codeObject.empty())
+        {
+            fprintf(stderr, "Could not read %s\n", path.c_str());
+            retVal = false;
+            continue;
+        }
+
+        retVal = RunBenchmark(path, codeObject, options) && retVal;
+    }
+
+    printf("peak rss %ld KiB\n", PeakRssKiB());
+
+    return retVal ? 0 : 1;
+}
@@ -111,6 +111,10 @@ public:
     virtual bool GetCachedAddresses(const LAddrType& startLAddr, bool includeCurrentScope, std::vector<LAddrType>& o_cachedLAddresses) const;
     /// Returns the low level variable given a high level var name and an low level address.
     virtual bool GetMatchingVariableInfoInCurrentScope(const LAddrType& startLAddr, typename TwoLvlIConsumer::VarMatchFunc pfnMatch, const void* pMatchData, LowLvlVariableInfo& o_variable) const;
+    /// Returns the low level variable given a high level var name and an low level address, using the high level consumer's name lookup.
+    virtual bool GetVariableInfoInCurrentScope(const LAddrType& startLAddr, const std::string& variableName, LowLvlVariableInfo& o_variable) const;
+    /// Returns the low level variable given a BRIG offset and an low level address, using the high level consumer's BRIG offset lookup.
+    virtual bool GetVariableInfoByBrigOffsetInCurrentScope(const LAddrType& startLAddr, unsigned int brigOffset, LowLvlVariableInfo& o_variable) const;
     /// Gets the frame base which is a low level variable location
     virtual bool GetFrameBase(LAddrType startLAddr, const std::string& varName, LVarLocationType& o_lFrameBase) const;
     /// Translates scope and gets a list of all high level variables defined in address's scope and all containing scopes
@@ -601,6 +605,74 @@ bool DbgInfoCompoundConsumer<HAddrType, HLineType, HVarLocationType, LAddrType,
     return retVal;
 }
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+/// GetVariableInfoInCurrentScope
+/// \brief Description: Returns the low level variable given a high level var name and an low level address.
+///                     Same as GetMatchingVariableInfoInCurrentScope, but the high level consumer looks the name up in its index
+/// \param[in]          startLAddr - Low level address
+/// \param[in]          variableName - High level variable name or member path
+/// \param[out]         o_variable - low level variable to return
+/// \return             Success / failure.
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename HAddrType, typename HLineType, typename HVarLocationType, typename LAddrType, typename LVarLocationType, typename LLineType>
+bool DbgInfoCompoundConsumer<HAddrType, HLineType, HVarLocationType, LAddrType, LVarLocationType, LLineType>::GetVariableInfoInCurrentScope(const LAddrType& startLAddr, const std::string& variableName, LowLvlVariableInfo& o_variable) const
+{
+    bool retVal = false;
+    LLineType lLine;
+
+    // Get Low level line:
+    if (m_pLConsumer->GetLineFromAddress(startLAddr, lLine))
+    {
+        // Translate to High level address:
+        HAddrType hAddr = (HAddrType)lLine;
+        HighLvlVariableInfo hVar;
+
+        // Get high level variable:
+        if (m_pHConsumer->GetVariableInfoInCurrentScope(hAddr, variableName, hVar))
+        {
+            // Copy high level variable to low level variable, resolving necessary fields:
+            CopyHighToLowVariable(startLAddr, hVar, o_variable);
+            retVal = true;
+        }
+    }
+
+    return retVal;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+/// GetVariableInfoByBrigOffsetInCurrentScope
+/// \brief Description: Returns the low level variable given a BRIG offset and an low level address.
+///                     Same as GetMatchingVariableInfoInCurrentScope, but the high level consumer looks the offset up in its index
+/// \param[in]          startLAddr - Low level address
+/// \param[in]          brigOffset - High level variable BRIG offset
+/// \param[out]         o_variable - low level variable to return
+/// \return             Success / failure.
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename HAddrType, typename HLineType, typename HVarLocationType, typename LAddrType, typename LVarLocationType, typename LLineType>
+bool DbgInfoCompoundConsumer<HAddrType, HLineType, HVarLocationType, LAddrType, LVarLocationType, LLineType>::GetVariableInfoByBrigOffsetInCurrentScope(const LAddrType& startLAddr, unsigned int brigOffset, LowLvlVariableInfo& o_variable) const
+{
+    bool retVal = false;
+    LLineType lLine;
+
+    // Get Low level line:
+    if (m_pLConsumer->GetLineFromAddress(startLAddr, lLine))
+    {
+        // Translate to High level address:
+        HAddrType hAddr = (HAddrType)lLine;
+        HighLvlVariableInfo hVar;
+
+        // Get high level variable:
+        if (m_pHConsumer->GetVariableInfoByBrigOffsetInCurrentScope(hAddr, brigOffset, hVar))
+        {
+            // Copy high level variable to low level variable, resolving necessary fields:
+            CopyHighToLowVariable(startLAddr, hVar, o_variable);
+            retVal = true;
+        }
+    }
+
+    return retVal;
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 /// GetFrameBase
 /// \brief Description: Gets the frame base which is a low level variable location, this is done by
@@ -72,6 +72,10 @@ public:
     virtual bool GetCachedAddresses(const AddrType& startAddr, bool includeCurrentScope, std::vector<AddrType>& o_cachedAddresses) const;
     /// Gets the variable info given an address and a variable name
     virtual bool GetMatchingVariableInfoInCurrentScope(const AddrType& startAddr, VarMatchFunc pfnMatch, const void* pMatchData, ConsumedVariableInfo& o_variable) const;
+    /// Gets the variable info given an address and a variable name, from the variable name index
+    virtual bool GetVariableInfoInCurrentScope(const AddrType& startAddr, const std::string& variableName, ConsumedVariableInfo& o_variable) const;
+    /// Gets the variable info given an address and a BRIG offset, from the BRIG offset index
+    virtual bool GetVariableInfoByBrigOffsetInCurrentScope(const AddrType& startAddr, unsigned int brigOffset, ConsumedVariableInfo& o_variable) const;
     /// Gets the frame base
     virtual bool GetFrameBase(AddrType startAddr, const std::string& varName, VarLocationType& o_frameBase) const;
     /// Gets all the variables in a given scope at a given stack frame depth
@@ -313,7 +317,7 @@ bool DbgInfoConsumerImpl<AddrType, LineType, VarLocationType>::GetFrameBase(Addr
     {
         // Get the variable's scope:
         ConsumedVariableInfo tmpVar;
-        const ConsumedCodeScope* pCurrentScope = m_pTopCodeScope->FindClosestScopeContainingVariable(startAddr, DbgInfoIConsumer<AddrType, LineType, VarLocationType>::MatchVariableByName, (const void*)(&varName), tmpVar);
+        const ConsumedCodeScope* pCurrentScope = m_pTopCodeScope->FindClosestScopeContainingVariableByName(startAddr, varName, tmpVar);
 
         while (pCurrentScope != nullptr)
         {
@@ -532,6 +536,50 @@ bool DbgInfoConsumerImpl<AddrType, LineType, VarLocationType>::GetMatchingVariab
     return retVal;
 }
 
+/// ---------------------------------------------------------------------------
+/// GetVariableInfoInCurrentScope
+/// \brief Description: Returns the variable or member named variableName in the lowest
+///                scope containing it, looking the name up in the top scope's name index
+/// \param[in] startAddr - The address to start looking in
+/// \param[in] variableName - The variable name or member path ("a.b.c") to find
+/// \param[out] o_variable - out param containing the var info
+/// \return Success / failure.
+/// ---------------------------------------------------------------------------
+template<typename AddrType, typename LineType, typename VarLocationType>
+bool DbgInfoConsumerImpl<AddrType, LineType, VarLocationType>::GetVariableInfoInCurrentScope(const AddrType& startAddr, const std::string& variableName, ConsumedVariableInfo& o_variable) const
+{
+    bool retVal = false;
+
+    if (nullptr != m_pTopCodeScope)
+    {
+        retVal = (nullptr != m_pTopCodeScope->FindClosestScopeContainingVariableByName(startAddr, variableName, o_variable));
+    }
+
+    return retVal;
+}
+
+/// ---------------------------------------------------------------------------
+/// GetVariableInfoByBrigOffsetInCurrentScope
+/// \brief Description: Returns the variable with the given BRIG offset in the lowest
+///                scope containing it, looking the offset up in the top scope's index
+/// \param[in] startAddr - The address to start looking in
+/// \param[in] brigOffset - The BRIG offset to find
+/// \param[out] o_variable - out param containing the var info
+/// \return Success / failure.
+/// ---------------------------------------------------------------------------
+template<typename AddrType, typename LineType, typename VarLocationType>
+bool DbgInfoConsumerImpl<AddrType, LineType, VarLocationType>::GetVariableInfoByBrigOffsetInCurrentScope(const AddrType& startAddr, unsigned int brigOffset, ConsumedVariableInfo& o_variable) const
+{
+    bool retVal = false;
+
+    if (nullptr != m_pTopCodeScope)
+    {
+        retVal = (nullptr != m_pTopCodeScope->FindClosestScopeContainingVariableByBrigOffset(startAddr, brigOffset, o_variable));
+    }
+
+    return retVal;
+}
+
 /// ---------------------------------------------------------------------------
 /// ListVariablesFromAddress
 /// \brief Description: Gets a list of all variables defined in address's scope and all
@@ -30,7 +30,10 @@
 /// ----------------------------------------------------------------------
 
 // STL:
+#include <algorithm>
+#include <functional>
 #include <set>
+#include <unordered_map>
 #include <vector>
 #include <string>
 #include <string.h> // ::memcpy()
@@ -176,6 +179,10 @@ public:
     const FullCodeScope* FindSmallestScopeContainingAddress(const AddrType& addr) const;
     /// Find the innermost scope containing an address and variable name, and return that variable
     const FullCodeScope* FindClosestScopeContainingVariable(AddrType startAddr, VarMatchFunc pfnMatch, const void* pMatchData, FullVariableInfo& o_variableInfo) const;
+    /// Find the innermost scope containing an address and a variable or member named varFullName (e.g. "a.b.c"), and return that variable
+    const FullCodeScope* FindClosestScopeContainingVariableByName(AddrType startAddr, const std::string& varFullName, FullVariableInfo& o_variableInfo) const;
+    /// Find the innermost scope containing an address and a variable with the given BRIG offset, and return that variable
+    const FullCodeScope* FindClosestScopeContainingVariableByBrigOffset(AddrType startAddr, unsigned int brigOffset, FullVariableInfo& o_variableInfo) const;
     /// Get the stack depth of an address
     int GetStackDepth(const AddrType& addr) const;
     /// Return the lowest address in all the ranges in the scope
@@ -184,6 +191,10 @@ public:
     bool GetHighestAddressInScope(AddrType& o_address) const;
     /// Put each address in the innermost CodeScope containing it - needs to receive the topmost scope
     bool MapAddressesToCodeScopes(const std::vector<AddrType>& addresses);
+    /// Build the address to innermost scope index - needs to receive the topmost scope, once the scope tree is complete
+    void BuildAddressIndex();
+    /// Build the variable name and BRIG offset indices - needs to receive the topmost scope, once the scope tree is complete
+    void BuildVariableIndex();
     /// Makes sure that variable ranges do not overlap
     void IntersectVariablesInScope();
 
@@ -203,11 +214,43 @@ public:
 
 private:
     /// Internal function which puts each address in the innermost CodeScope containing it - Recursive
-    bool InternalMapAddressesToCodeScopes(const std::vector<AddrType>& addresses, std::map<AddrType, FullCodeScope*>& addrScopeMap);
-    /// Get the subset of addresses which are in range of the current scope and return them as an out parameter
-    bool GetAddressesInRange(const std::vector<AddrType>& addresses, std::vector<AddrType>& o_AddressesInRange) const;
+    bool InternalMapAddressesToCodeScopes(const std::vector<AddrType>& sortedAddresses, std::vector<FullCodeScope*>& io_addressScopes);
     /// Check whether the specified address is in the code scope
     bool IsAddressInCodeScope(const AddrType& addr) const;
+    /// Find the address index range containing addr, return false if addr is before the first range
+    bool FindAddressIndexEntry(const AddrType& addr, size_t& o_entry) const;
+
+    /// Address index, only built for the top level scope. The address space is cut into ranges in which the innermost
+    /// scope does not change. Range i starts at m_addrIndexStarts[i] and ends where range i + 1 starts:
+    std::vector<AddrType> m_addrIndexStarts;
+    std::vector<const FullCodeScope*> m_addrIndexScopes;    ///< The innermost scope of each range, nullptr if there is none
+    std::vector<int> m_addrIndexStackDepths;                ///< The stack depth of each range's scope
+    bool m_isAddrIndexBuilt;                                ///< Is the address index built
+
+    /// -----------------------------------------------------------------------------------------------
+    /// \struct VariableIndexEntry
+    /// \brief Description:  A variable in the variable indices, and the scope defining it
+    /// -----------------------------------------------------------------------------------------------
+    struct VariableIndexEntry
+    {
+        const FullCodeScope* m_pScope;          ///< The scope defining the variable
+        const FullVariableInfo* m_pVariable;    ///< The variable
+    };
+    typedef std::vector<VariableIndexEntry> VariableIndexEntries;
+
+    /// Find the innermost scope containing an address and one of the indexed variables
+    const FullCodeScope* FindClosestScopeInVariableIndex(AddrType startAddr, const VariableIndexEntries& entries, const std::string* pMemberFullName, FullVariableInfo& o_variableInfo) const;
+    /// Order the variable index entries by their scopes
+    static bool CompareVariableIndexEntries(const VariableIndexEntry& entryA, const VariableIndexEntry& entryB) { return std::less<const FullCodeScope*>()(entryA.m_pScope, entryB.m_pScope); };
+    /// Variable matching functions for the name and BRIG offset, used when there is no variable index
+    static bool MatchVariableByName(const FullVariableInfo& var, const void* matchData, const FullVariableInfo*& pFoundMember) { return var.CanMatchMemberName(*(const std::string*)matchData, pFoundMember); };
+    static bool MatchVariableByBrigOffset(const FullVariableInfo& var, const void* matchData, const FullVariableInfo*& pFoundMember) { pFoundMember = &var; return (var.m_brigOffset == *(const unsigned int*)matchData); };
+
+    /// Variable indices, only built for the top level scope. Each distinct variable name is kept once, and the entries
+    /// of each name or offset are sorted by scope, keeping the order of the variables in each scope:
+    std::unordered_map<std::string, VariableIndexEntries> m_varNameIndex;
+    std::unordered_map<unsigned int, VariableIndexEntries> m_varBrigOffsetIndex;
+    bool m_isVarIndexBuilt;                                 ///< Are the variable indices built
     /// Private Copy constructor - Disallow copying
     CodeScope(const FullCodeScope& other);
     /// Private assignment operator- Disallow copying
@@ -420,7 +463,7 @@ bool VariableInfo<AddrType, VarLocationType>::CanMatchMemberName(const std::stri
 /// -----------------------------------------------------------------------------------------------
 template<typename AddrType, typename LineType, typename VarLocationType>
 CodeScope<AddrType, LineType, VarLocationType>::CodeScope()
-    : m_scopeType(DID_SCT_COMPILATION_UNIT), m_pFrameBase(nullptr), m_pParentScope(nullptr), m_scopeHasNonTrivialAddressRanges(false), m_isKernel(false), m_pWorkitemOffset(nullptr)
+    : m_scopeType(DID_SCT_COMPILATION_UNIT), m_pFrameBase(nullptr), m_pParentScope(nullptr), m_scopeHasNonTrivialAddressRanges(false), m_isKernel(false), m_pWorkitemOffset(nullptr), m_isAddrIndexBuilt(false), m_isVarIndexBuilt(false)
 {
 };
 
@@ -471,8 +514,17 @@ const CodeScope<AddrType, LineType, VarLocationType>* CodeScope<AddrType, LineTy
 {
     const FullCodeScope* pRetVal = nullptr;
     const FullCodeScope* pTmpVal = nullptr;
+    size_t addrIndexEntry = 0;
 
-    if (IsAddressInCodeScope(addr))
+    if (m_isAddrIndexBuilt)
+    {
+        // The top level scope answers from its index:
+        if (FindAddressIndexEntry(addr, addrIndexEntry))
+        {
+            pRetVal = m_addrIndexScopes[addrIndexEntry];
+        }
+    }
+    else if (IsAddressInCodeScope(addr))
     {
         // At the very least, the address is contained in this scope:
         pRetVal = this;
@@ -539,18 +591,31 @@ template<typename AddrType, typename LineType, typename VarLocationType>
 int CodeScope<AddrType, LineType, VarLocationType>::GetStackDepth(const AddrType& addr) const
 {
     int retVal = 0;
-    const FullCodeScope* pBottomScope = FindSmallestScopeContainingAddress(addr);
-    const FullCodeScope* pTempScope = pBottomScope;
+    size_t addrIndexEntry = 0;
 
-    if (pTempScope != nullptr)
+    if (m_isAddrIndexBuilt)
+    {
+        // The top level scope has the depth in its index:
+        if (FindAddressIndexEntry(addr, addrIndexEntry))
+        {
+            retVal = m_addrIndexStackDepths[addrIndexEntry];
+        }
+    }
+    else
     {
-        // End condition:
-        while (pTempScope != this)
+        const FullCodeScope* pBottomScope = FindSmallestScopeContainingAddress(addr);
+        const FullCodeScope* pTempScope = pBottomScope;
+
+        if (pTempScope != nullptr)
         {
-            // Increment stack depth:
-            ++retVal;
-            // Go up one level:
-            pTempScope = pTempScope->m_pParentScope;
+            // End condition:
+            while (pTempScope != this)
+            {
+                // Increment stack depth:
+                ++retVal;
+                // Go up one level:
+                pTempScope = pTempScope->m_pParentScope;
+            }
         }
     }
 
@@ -642,38 +707,6 @@ bool CodeScope<AddrType, LineType, VarLocationType>::IsAddressInCodeScope(const
     return retVal;
 }
 
-/// -----------------------------------------------------------------------------------------------
-/// GetAddressesInRange
-/// \brief Description: fills the output vector with the subset of all addresses which are in the scope's range
-/// \param[in]          addresses - the addresses to check
-/// \param[out]         o_AddressesInRange - the subset of in-range addresses to return
-/// \return True : addresses are found
-/// \return False: no addresses found
-/// -----------------------------------------------------------------------------------------------
-template<typename AddrType, typename LineType, typename VarLocationType>
-bool CodeScope<AddrType, LineType, VarLocationType>::GetAddressesInRange(const std::vector<AddrType>& addresses, std::vector<AddrType>& o_AddressesInRange) const
-{
-    bool retVal = false;
-    o_AddressesInRange.clear();
-
-    // Iterate over the scope's address ranges:
-    int numberOfAddrs = (int)addresses.size();
-
-    for (int i = 0; i < numberOfAddrs; i++)
-    {
-        const AddrType& currentAddr = addresses[i];
-
-        if (IsAddressInCodeScope(currentAddr))
-        {
-            o_AddressesInRange.push_back(currentAddr);
-        }
-    }
-
-    retVal = !o_AddressesInRange.empty();
-
-    return retVal;
-}
-
 /// -----------------------------------------------------------------------------------------------
 /// MapAddressesToCodeScopes
 /// \brief Description: Fills the relevant scopes' address caches with the corresponding addresses
@@ -690,21 +723,30 @@ bool CodeScope<AddrType, LineType, VarLocationType>::MapAddressesToCodeScopes(co
 
     if ((m_scopeType == FullCodeScope::DID_SCT_COMPILATION_UNIT || m_scopeType == FullCodeScope::DID_SCT_GLOBAL_SCOPE) && m_pParentScope == nullptr)
     {
-        // Initialize map:
-        std::map<AddrType, FullCodeScope*> addrScopeMap;
-        // Fills the map:
-        retVal = InternalMapAddressesToCodeScopes(addresses, addrScopeMap);
+        // Sort the addresses, so each scope range can find its addresses with a binary search:
+        std::vector<AddrType> sortedAddresses(addresses);
+        std::sort(sortedAddresses.begin(), sortedAddresses.end());
+        sortedAddresses.erase(std::unique(sortedAddresses.begin(), sortedAddresses.end()), sortedAddresses.end());
+
+        // Fills the scope of each address:
+        std::vector<FullCodeScope*> addressScopes(sortedAddresses.size(), nullptr);
+        retVal = InternalMapAddressesToCodeScopes(sortedAddresses, addressScopes);
 
-        // Fill the caches with the map:
+        // Fill the caches with the scopes:
         if (retVal)
         {
-            // For each pair of address and code scope in the map, add the address to the code scope's cache:
-            for (typename std::map<AddrType, FullCodeScope*>::iterator it = addrScopeMap.begin(); it != addrScopeMap.end(); ++ it)
+            // For each pair of address and code scope, add the address to the code scope's cache:
+            size_t numberOfAddrs = sortedAddresses.size();
+
+            for (size_t i = 0; i < numberOfAddrs; i++)
             {
-                AddrType addrType = it->first;
-                FullCodeScope* pCodeScope = it->second;
-                HWDBG_ASSERT(pCodeScope->m_pParentScope == nullptr || pCodeScope->m_scopeType == FullCodeScope::DID_SCT_INLINED_FUNCTION || pCodeScope->m_scopeType == FullCodeScope::DID_SCT_FUNCTION);
-                pCodeScope->m_addressCache.insert(addrType);
+                FullCodeScope* pCodeScope = addressScopes[i];
+
+                if (nullptr != pCodeScope)
+                {
+                    HWDBG_ASSERT(pCodeScope->m_pParentScope == nullptr || pCodeScope->m_scopeType == FullCodeScope::DID_SCT_INLINED_FUNCTION || pCodeScope->m_scopeType == FullCodeScope::DID_SCT_FUNCTION);
+                    pCodeScope->m_addressCache.insert(pCodeScope->m_addressCache.end(), sortedAddresses[i]);
+                }
             }
         }
     }
@@ -714,48 +756,41 @@ bool CodeScope<AddrType, LineType, VarLocationType>::MapAddressesToCodeScopes(co
 
 /// -----------------------------------------------------------------------------------------------
 /// InternalMapAddressesToCodeScopes
-/// \brief Description: Internal version of the above function which fills the map
-/// \param[in]          addresses - addresses to map
-/// \param[out]         o_addrScopeMap - output map of address -> scope
+/// \brief Description: Internal version of the above function which fills the address scopes
+/// \param[in]          sortedAddresses - addresses to map, sorted and unique
+/// \param[in,out]      io_addressScopes - the scope of each address, nullptr if it is not yet mapped
 /// \return True : at least one pair mapped
 /// \return False: Otherwise
 /// -----------------------------------------------------------------------------------------------
 template<typename AddrType, typename LineType, typename VarLocationType>
-bool CodeScope<AddrType, LineType, VarLocationType>::InternalMapAddressesToCodeScopes(const std::vector<AddrType>& addresses, std::map<AddrType, FullCodeScope*>& o_addrScopeMap)
+bool CodeScope<AddrType, LineType, VarLocationType>::InternalMapAddressesToCodeScopes(const std::vector<AddrType>& sortedAddresses, std::vector<FullCodeScope*>& io_addressScopes)
 {
     bool retVal = false;
 
     // If this scope is the top level, or it is a function, get its memory addresses:
     if (m_pParentScope == nullptr || m_scopeType == FullCodeScope::DID_SCT_INLINED_FUNCTION || m_scopeType == FullCodeScope::DID_SCT_FUNCTION)
     {
-        std::vector<AddrType> addressesInRange;
-        GetAddressesInRange(addresses, addressesInRange);
+        int numberOfRanges = (int)m_scopeAddressRanges.size();
 
-        // Fill the map with the Addr->pScope mapping:
-        int numberOfAddrs = (int)addressesInRange.size();
-
-        for (int i = 0; i < numberOfAddrs; i++)
+        for (int i = 0; i < numberOfRanges; i++)
         {
-            const AddrType& currentAddr = addressesInRange[i];
+            // The ranges are inclusive, see IsAddressInCodeScope:
+            const AddressRange& currentRange = m_scopeAddressRanges[i];
+            size_t firstAddr = std::lower_bound(sortedAddresses.begin(), sortedAddresses.end(), currentRange.m_minAddr) - sortedAddresses.begin();
+            size_t endAddr = std::upper_bound(sortedAddresses.begin(), sortedAddresses.end(), currentRange.m_maxAddr) - sortedAddresses.begin();
 
-            if (m_scopeHasNonTrivialAddressRanges)
-            {
-                o_addrScopeMap[currentAddr] = this;
-            }
-            else
+            // Fill the Addr->pScope mapping:
+            for (size_t j = firstAddr; j < endAddr; j++)
             {
                 // For trivially-ranged scopes, only save addresses that are not already mapped (if a non-trivial sibling appears later, it will overtake
                 // these addresses).
-                typename std::map<AddrType, FullCodeScope*>::const_iterator findIter = o_addrScopeMap.find(currentAddr);
-                typename std::map<AddrType, FullCodeScope*>::const_iterator endIter = o_addrScopeMap.end();
-
-                if (endIter == findIter)
+                if (m_scopeHasNonTrivialAddressRanges || (nullptr == io_addressScopes[j]))
                 {
-                    o_addrScopeMap[currentAddr] = this;
+                    io_addressScopes[j] = this;
                 }
-            }
 
-            retVal = true;
+                retVal = true;
+            }
         }
     }
 
@@ -769,13 +804,185 @@ bool CodeScope<AddrType, LineType, VarLocationType>::InternalMapAddressesToCodeS
         if (nullptr != pCurrentChild)
         {
             // Recursive function call to fill map. It is enough that one child succeeds even if we failed:
-            retVal = pCurrentChild->InternalMapAddressesToCodeScopes(addresses, o_addrScopeMap) || retVal;
+            retVal = pCurrentChild->InternalMapAddressesToCodeScopes(sortedAddresses, io_addressScopes) || retVal;
         }
     }
 
     return retVal;
 }
 
+/// -----------------------------------------------------------------------------------------------
+/// BuildAddressIndex
+/// \brief Description: Sweeps over the scopes' address ranges once and records, for each range of
+/// addresses in which it does not change, the scope FindSmallestScopeContainingAddress would return.
+/// At each point of the sweep the active children of each scope are kept ordered the way
+/// FindSmallestScopeContainingAddress visits them (non-trivial ranges first), so the innermost scope
+/// is found by descending through the first active child of each level.
+/// -----------------------------------------------------------------------------------------------
+template<typename AddrType, typename LineType, typename VarLocationType>
+void CodeScope<AddrType, LineType, VarLocationType>::BuildAddressIndex()
+{
+    // Only allow this function to be run on the top level scope:
+    HWDBG_ASSERT(m_pParentScope == nullptr);
+
+    m_addrIndexStarts.clear();
+    m_addrIndexScopes.clear();
+    m_addrIndexStackDepths.clear();
+    m_isAddrIndexBuilt = false;
+
+    // Flatten the tree, the top level scope is scope 0:
+    std::vector<const FullCodeScope*> scopes(1, this);
+    std::vector<int> parents(1, -1);
+    std::vector<int> stackDepths(1, 0);
+    std::vector<int> childRanks(1, 0);
+
+    for (size_t i = 0; i < scopes.size(); i++)
+    {
+        const std::vector<FullCodeScope*>& children = scopes[i]->m_children;
+        int numberOfChildren = (int)children.size();
+        int childRank = 0;
+
+        // Prefer Scopes that have specific ranges over scopes that have just the default (0, infinity) range:
+        for (int pass = 0; pass < 2; pass++)
+        {
+            for (int j = 0; j < numberOfChildren; j++)
+            {
+                const FullCodeScope* pCurrentChild = children[j];
+
+                if ((nullptr != pCurrentChild) && (pCurrentChild->m_scopeHasNonTrivialAddressRanges == (0 == pass)))
+                {
+                    scopes.push_back(pCurrentChild);
+                    parents.push_back((int)i);
+                    stackDepths.push_back(stackDepths[i] + 1);
+                    childRanks.push_back(childRank++);
+                }
+            }
+        }
+    }
+
+    // Each inclusive range [min, max] enters the sweep at min and leaves it at max + 1:
+    struct ScopeRangeEvent
+    {
+        AddrType m_addr;
+        int m_scope;
+        int m_delta;
+    };
+    std::vector<ScopeRangeEvent> events;
+    int numberOfScopes = (int)scopes.size();
+
+    for (int i = 0; i < numberOfScopes; i++)
+    {
+        const std::vector<AddressRange>& ranges = scopes[i]->m_scopeAddressRanges;
+        int numberOfRanges = (int)ranges.size();
+
+        for (int j = 0; j < numberOfRanges; j++)
+        {
+            if (!(ranges[j].m_maxAddr < ranges[j].m_minAddr))
+            {
+                ScopeRangeEvent rangeStart = {ranges[j].m_minAddr, i, 1};
+                events.push_back(rangeStart);
+
+                // A range ending at the top of the address space never leaves:
+                AddrType afterRange = ranges[j].m_maxAddr;
+                ++afterRange;
+
+                if (ranges[j].m_maxAddr < afterRange)
+                {
+                    ScopeRangeEvent rangeEnd = {afterRange, i, -1};
+                    events.push_back(rangeEnd);
+                }
+            }
+        }
+    }
+
+    std::sort(events.begin(), events.end(), [](const ScopeRangeEvent& a, const ScopeRangeEvent& b) { return a.m_addr < b.m_addr; });
+
+    // The number of ranges of each scope containing the current address, and the (rank, scope) of each scope's children containing it:
+    std::vector<int> activeRanges(numberOfScopes, 0);
+    std::vector<std::set<std::pair<int, int> > > activeChildren(numberOfScopes);
+    size_t numberOfEvents = events.size();
+    size_t currentEvent = 0;
+
+    while (currentEvent < numberOfEvents)
+    {
+        AddrType currentAddr = events[currentEvent].m_addr;
+
+        // Apply all the events at this address:
+        for (; (currentEvent < numberOfEvents) && !(currentAddr < events[currentEvent].m_addr); currentEvent++)
+        {
+            int scope = events[currentEvent].m_scope;
+            bool wasActive = (0 < activeRanges[scope]);
+            activeRanges[scope] += events[currentEvent].m_delta;
+            bool isActive = (0 < activeRanges[scope]);
+
+            if ((wasActive != isActive) && (0 <= parents[scope]))
+            {
+                std::pair<int, int> rankedScope(childRanks[scope], scope);
+
+                if (isActive)
+                {
+                    activeChildren[parents[scope]].insert(rankedScope);
+                }
+                else
+                {
+                    activeChildren[parents[scope]].erase(rankedScope);
+                }
+            }
+        }
+
+        // Descend to the innermost scope - a child only counts if its parent contains the address too:
+        const FullCodeScope* pInnermostScope = nullptr;
+        int stackDepth = 0;
+
+        if (0 < activeRanges[0])
+        {
+            int scope = 0;
+
+            while (!activeChildren[scope].empty())
+            {
+                scope = activeChildren[scope].begin()->second;
+            }
+
+            pInnermostScope = scopes[scope];
+            stackDepth = stackDepths[scope];
+        }
+
+        // Only start a new range where the scope changes:
+        if (m_addrIndexScopes.empty() || (m_addrIndexScopes.back() != pInnermostScope))
+        {
+            m_addrIndexStarts.push_back(currentAddr);
+            m_addrIndexScopes.push_back(pInnermostScope);
+            m_addrIndexStackDepths.push_back(stackDepth);
+        }
+    }
+
+    m_isAddrIndexBuilt = true;
+}
+
+/// -----------------------------------------------------------------------------------------------
+/// FindAddressIndexEntry
+/// \brief Description: Binary search for the address index range containing an address
+/// \param[in]          addr - the address
+/// \param[out]         o_entry - the index of the range
+/// \return True : The address is in a range
+/// \return False: The address is before the first range
+/// -----------------------------------------------------------------------------------------------
+template<typename AddrType, typename LineType, typename VarLocationType>
+bool CodeScope<AddrType, LineType, VarLocationType>::FindAddressIndexEntry(const AddrType& addr, size_t& o_entry) const
+{
+    bool retVal = false;
+
+    typename std::vector<AddrType>::const_iterator nextIter = std::upper_bound(m_addrIndexStarts.begin(), m_addrIndexStarts.end(), addr);
+
+    if (m_addrIndexStarts.begin() != nextIter)
+    {
+        retVal = true;
+        o_entry = (nextIter - m_addrIndexStarts.begin()) - 1;
+    }
+
+    return retVal;
+}
+
 /// -----------------------------------------------------------------------------------------------
 /// FindClosestScopeContainingVariable
 /// \brief Description: Finds the smallest scope that contains startAddr and defines a variable named varName
@@ -878,6 +1085,197 @@ const CodeScope<AddrType, LineType, VarLocationType>* CodeScope<AddrType, LineTy
     return retVal;
 }
 
+/// -----------------------------------------------------------------------------------------------
+/// FindClosestScopeContainingVariableByName
+/// \brief Description: Finds the smallest scope that contains startAddr and defines a variable or member named
+/// varFullName. The top level scope answers from its name index, other scopes match the names of their variables.
+/// \param[in]          startAddr - The address to look in
+/// \param[in]          varFullName - the variable name, or a member path such as "a.b.c"
+/// \param[out]         o_variableInfo - The variable or member
+/// \return pointer to the closest scope containing the variable
+/// -----------------------------------------------------------------------------------------------
+template<typename AddrType, typename LineType, typename VarLocationType>
+const CodeScope<AddrType, LineType, VarLocationType>* CodeScope<AddrType, LineType, VarLocationType>::FindClosestScopeContainingVariableByName(AddrType startAddr, const std::string& varFullName, FullVariableInfo& o_variableInfo) const
+{
+    const FullCodeScope* retVal = nullptr;
+
+    if (m_isVarIndexBuilt)
+    {
+        // The variable name is the first token of the member path, the way CanMatchMemberName tokenizes it:
+        size_t nameStart = varFullName.find_first_not_of('.');
+
+        if (std::string::npos != nameStart)
+        {
+            size_t nameEnd = varFullName.find('.', nameStart);
+            typename std::unordered_map<std::string, VariableIndexEntries>::const_iterator findIter = m_varNameIndex.find(varFullName.substr(nameStart, nameEnd - nameStart));
+
+            if (m_varNameIndex.end() != findIter)
+            {
+                // Only match members if the name is not just the variable name:
+                bool isVariableName = (0 == nameStart) && (std::string::npos == nameEnd);
+                retVal = FindClosestScopeInVariableIndex(startAddr, findIter->second, isVariableName ? nullptr : &varFullName, o_variableInfo);
+            }
+        }
+    }
+    else
+    {
+        retVal = FindClosestScopeContainingVariable(startAddr, MatchVariableByName, (const void*)(&varFullName), o_variableInfo);
+    }
+
+    return retVal;
+}
+
+/// -----------------------------------------------------------------------------------------------
+/// FindClosestScopeContainingVariableByBrigOffset
+/// \brief Description: Finds the smallest scope that contains startAddr and defines a variable with the given BRIG
+/// offset. The top level scope answers from its BRIG offset index, other scopes match their variables' offsets.
+/// \param[in]          startAddr - The address to look in
+/// \param[in]          brigOffset - the BRIG offset of the variable
+/// \param[out]         o_variableInfo - The variable
+/// \return pointer to the closest scope containing the variable
+/// -----------------------------------------------------------------------------------------------
+template<typename AddrType, typename LineType, typename VarLocationType>
+const CodeScope<AddrType, LineType, VarLocationType>* CodeScope<AddrType, LineType, VarLocationType>::FindClosestScopeContainingVariableByBrigOffset(AddrType startAddr, unsigned int brigOffset, FullVariableInfo& o_variableInfo) const
+{
+    const FullCodeScope* retVal = nullptr;
+
+    if (m_isVarIndexBuilt)
+    {
+        typename std::unordered_map<unsigned int, VariableIndexEntries>::const_iterator findIter = m_varBrigOffsetIndex.find(brigOffset);
+
+        if (m_varBrigOffsetIndex.end() != findIter)
+        {
+            retVal = FindClosestScopeInVariableIndex(startAddr, findIter->second, nullptr, o_variableInfo);
+        }
+    }
+    else
+    {
+        retVal = FindClosestScopeContainingVariable(startAddr, MatchVariableByBrigOffset, (const void*)(&brigOffset), o_variableInfo);
+    }
+
+    return retVal;
+}
+
+/// -----------------------------------------------------------------------------------------------
+/// BuildVariableIndex
+/// \brief Description: Indexes the variables of all the scopes by name and by BRIG offset, so the variable
+/// lookups only need to look at the variables with the right name or offset in each scope they visit.
+/// -----------------------------------------------------------------------------------------------
+template<typename AddrType, typename LineType, typename VarLocationType>
+void CodeScope<AddrType, LineType, VarLocationType>::BuildVariableIndex()
+{
+    // Only allow this function to be run on the top level scope:
+    HWDBG_ASSERT(m_pParentScope == nullptr);
+
+    m_varNameIndex.clear();
+    m_varBrigOffsetIndex.clear();
+    m_isVarIndexBuilt = false;
+
+    std::vector<const FullCodeScope*> scopes(1, this);
+
+    for (size_t i = 0; i < scopes.size(); i++)
+    {
+        const FullCodeScope* pCurrentScope = scopes[i];
+        int numberOfVars = (int)pCurrentScope->m_scopeVars.size();
+
+        for (int j = 0; j < numberOfVars; j++)
+        {
+            const FullVariableInfo* pCurrentVar = pCurrentScope->m_scopeVars[j];
+
+            if (nullptr != pCurrentVar)
+            {
+                VariableIndexEntry entry = {pCurrentScope, pCurrentVar};
+                m_varNameIndex[pCurrentVar->m_varName].push_back(entry);
+                m_varBrigOffsetIndex[pCurrentVar->m_brigOffset].push_back(entry);
+            }
+        }
+
+        int numberOfChildren = (int)pCurrentScope->m_children.size();
+
+        for (int j = 0; j < numberOfChildren; j++)
+        {
+            if (nullptr != pCurrentScope->m_children[j])
+            {
+                scopes.push_back(pCurrentScope->m_children[j]);
+            }
+        }
+    }
+
+    // Sort the entries by scope, so each scope's entries can be found with a binary search:
+    for (typename std::unordered_map<std::string, VariableIndexEntries>::iterator iter = m_varNameIndex.begin(); m_varNameIndex.end() != iter; ++iter)
+    {
+        std::stable_sort(iter->second.begin(), iter->second.end(), CompareVariableIndexEntries);
+    }
+
+    for (typename std::unordered_map<unsigned int, VariableIndexEntries>::iterator iter = m_varBrigOffsetIndex.begin(); m_varBrigOffsetIndex.end() != iter; ++iter)
+    {
+        std::stable_sort(iter->second.begin(), iter->second.end(), CompareVariableIndexEntries);
+    }
+
+    m_isVarIndexBuilt = true;
+}
+
+/// -----------------------------------------------------------------------------------------------
+/// FindClosestScopeInVariableIndex
+/// \brief Description: Does what FindClosestScopeContainingVariable does, only visiting the variables of each scope
+/// that are in the index entries for the requested name or offset.
+/// \param[in]          startAddr - The address to look in
+/// \param[in]          entries - the index entries of the variable name or offset, sorted by scope
+/// \param[in]          pMemberFullName - the member path to match in the variables, nullptr to return the variables themselves
+/// \param[out]         o_variableInfo - The variable
+/// \return pointer to the closest scope containing the variable
+/// -----------------------------------------------------------------------------------------------
+template<typename AddrType, typename LineType, typename VarLocationType>
+const CodeScope<AddrType, LineType, VarLocationType>* CodeScope<AddrType, LineType, VarLocationType>::FindClosestScopeInVariableIndex(AddrType startAddr, const VariableIndexEntries& entries, const std::string* pMemberFullName, FullVariableInfo& o_variableInfo) const
+{
+    const FullCodeScope* retVal = nullptr;
+
+    // Find the smallest scope that contains startAddr:
+    const FullCodeScope* pCurrentScope = FindSmallestScopeContainingAddress(startAddr);
+
+    while (pCurrentScope != nullptr)
+    {
+        // Get this scope's entries:
+        VariableIndexEntry scopeKey = {pCurrentScope, nullptr};
+        std::pair<typename VariableIndexEntries::const_iterator, typename VariableIndexEntries::const_iterator> scopeEntries = std::equal_range(entries.begin(), entries.end(), scopeKey, CompareVariableIndexEntries);
+        bool foundVar = false;
+
+        for (typename VariableIndexEntries::const_iterator iter = scopeEntries.first; scopeEntries.second != iter; ++iter)
+        {
+            const FullVariableInfo* pCurrentVar = iter->m_pVariable;
+            const FullVariableInfo* pFoundMember = pCurrentVar;
+
+            if ((nullptr == pMemberFullName) || pCurrentVar->CanMatchMemberName(*pMemberFullName, pFoundMember))
+            {
+                // If const:
+                if (FullVariableInfo::DID_VAR_CONSTANT_VALUE == pCurrentVar->VarValueType())
+                {
+                    foundVar = true;
+                    o_variableInfo = *pFoundMember;
+                    break;
+                }
+                // If the address is in the variable's scope:
+                else if ((pCurrentVar->m_highVariablePC >= startAddr) && (pCurrentVar->m_lowVariablePC <= startAddr))
+                {
+                    foundVar = true;
+                    o_variableInfo = *pFoundMember;
+                }
+            }
+        }
+
+        if (foundVar)
+        {
+            retVal = pCurrentScope;
+            break;
+        }
+
+        // Do not traverse function boundaries, see FindClosestScopeContainingVariable:
+        pCurrentScope = (DID_SCT_CODE_SCOPE == pCurrentScope->m_scopeType) ? pCurrentScope->m_pParentScope : nullptr;
+    }
+
+    return retVal;
+}
+
 /// -----------------------------------------------------------------------------------------------
 /// IntersectVariablesInScope
 /// \brief Description: Goes over the variables list in the scope, intersecting the ranges of
@@ -24,7 +24,10 @@
 #endif
 
 /// STL:
+#include <chrono>
+#include <mutex>
 #include <queue>
+#include <thread>
 #include <assert.h>
 #include <string.h>
 
@@ -35,6 +38,13 @@
 #include <DbgInfoDwarfParser.h>
 #include <DbgInfoUtils.h>
 
+/// \def HWDBGINFO_LIBDWARF_ELFTOOLCHAIN: 1 if we are built against elftoolchain's libdwarf, set by the Makefile.
+/// Its dwarf_srcfiles keeps the list with the CU's line information and returns it to every caller, so it must
+/// not be released. The SGI libdwarf allocates a new list on each call, which the caller releases.
+#ifndef HWDBGINFO_LIBDWARF_ELFTOOLCHAIN
+    #define HWDBGINFO_LIBDWARF_ELFTOOLCHAIN 0
+#endif
+
 //@{
 /// \def Uri, 18/11/10: our implementation of DWARF is missing some values in the header file, added them here:
 #define DW_DLA_STRING 0x01
@@ -98,6 +108,26 @@ enum Amd_HSA_address_class
 
 using namespace HwDbg;
 
+/// The threads that parse the subprograms of a CU, counting the calling thread:
+#define HWDBG_DW_MAX_PARSE_THREADS 8
+
+/// The CU needs at least this many subprograms to be worth parsing in parallel:
+#define HWDBG_DW_MIN_PARALLEL_SUBPROGRAMS 4
+
+/// Microseconds since the epoch of the steady clock, for the parse timings:
+static HwDbgUInt64 GetSteadyTimeUs()
+{
+    return (HwDbgUInt64)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/// Sets the libelf version. libelf keeps it in a global, so every caller (the parse threads and
+/// KernelBinary) goes through this once, before opening its own ELF handle:
+static void SetElfVersion()
+{
+    static std::once_flag elfVersionFlag;
+    std::call_once(elfVersionFlag, []() { elf_version(EV_CURRENT); });
+}
+
 /// -----------------------------------------------------------------------------------------------
 /// Initialize
 /// \brief Description: Init function - as cannot have constructor in Union
@@ -289,7 +319,7 @@ bool DbgInfoDwarfParser::FillLineMappingFromDwarf(Dwarf_Die cuDIE, const std::st
 /// \param[out] o_scope - Out param scope to fill
 /// \return void
 /// ---------------------------------------------------------------------------
-void DbgInfoDwarfParser::FillCodeScopeFromDwarf(Dwarf_Die programDIE, const std::string& firstSourceFileRealPath, Dwarf_Debug pDwarf, DwarfCodeScope* pParentScope, const DwarfCodeScopeType& scopeType, DwarfCodeScope& o_scope)
+void DbgInfoDwarfParser::FillCodeScopeFromDwarf(Dwarf_Die programDIE, const std::string& firstSourceFileRealPath, Dwarf_Debug pDwarf, DwarfCodeScope* pParentScope, const DwarfCodeScopeType& scopeType, DwarfCodeScope& o_scope, const KernelBinary* pParallelBinary)
 {
     o_scope.m_scopeType = scopeType;
     o_scope.m_pParentScope = pParentScope;
@@ -307,7 +337,7 @@ void DbgInfoDwarfParser::FillCodeScopeFromDwarf(Dwarf_Die programDIE, const std:
     FillFrameBase(programDIE, pDwarf, o_scope);
 
     // Iterate over children and fill the scope with them:
-    FillChildren(programDIE, firstSourceFileRealPath, pDwarf, o_scope);
+    FillChildren(programDIE, firstSourceFileRealPath, pDwarf, o_scope, pParallelBinary);
 
     // Intersect the variables in this program:
     o_scope.IntersectVariablesInScope();
@@ -321,10 +351,11 @@ void DbgInfoDwarfParser::FillCodeScopeFromDwarf(Dwarf_Die programDIE, const std:
 /// \param[in] pDwarf - Allocation/Deallocation object
 /// \param[in] err - Error container
 /// \param[out] o_scope - Output parameter the scope with the child vars and scopes filled in
+/// \param[in] pParallelBinary - if not nullptr, the binary to parse the child subprograms from in parallel
 /// \return void
 /// ---------------------------------------------------------------------------
 
-void DbgInfoDwarfParser::FillChildren(Dwarf_Die programDIE, const std::string& firstSourceFileRealPath, Dwarf_Debug pDwarf, DwarfCodeScope& o_scope)
+void DbgInfoDwarfParser::FillChildren(Dwarf_Die programDIE, const std::string& firstSourceFileRealPath, Dwarf_Debug pDwarf, DwarfCodeScope& o_scope, const KernelBinary* pParallelBinary)
 {
     // Iterate this DIE's Children, and create program and variable data objects for them:
     Dwarf_Die currentChild = nullptr;
@@ -332,6 +363,10 @@ void DbgInfoDwarfParser::FillChildren(Dwarf_Die programDIE, const std::string& f
     int rc = dwarf_child(programDIE, &currentChild, &err);
     bool goOn = ((rc == DW_DLV_OK) && (currentChild != nullptr));
 
+    // The subprograms left for the parallel parse, and their placeholders in the children:
+    std::vector<Dwarf_Off> subprogramOffsets;
+    std::vector<size_t> subprogramChildIndices;
+
     while (goOn)
     {
         // Get the current child's DWARF TAG:
@@ -366,8 +401,21 @@ void DbgInfoDwarfParser::FillChildren(Dwarf_Die programDIE, const std::string& f
                 case DW_TAG_subprogram:
                 case DW_TAG_HSA_argument_scope:
                 {
-                    // Add the child scope:
-                    AddChildScope(currentChild, firstSourceFileRealPath, pDwarf, GetScopeTypeFromTAG(currentChildTag), o_scope);
+                    Dwarf_Off childOffset = 0;
+
+                    if ((nullptr != pParallelBinary) && (DW_TAG_subprogram == currentChildTag) &&
+                        (DW_DLV_OK == dwarf_dieoffset(currentChild, &childOffset, &err)))
+                    {
+                        // Keep the child's place, it is filled after the other children:
+                        subprogramOffsets.push_back(childOffset);
+                        subprogramChildIndices.push_back(o_scope.m_children.size());
+                        o_scope.m_children.push_back(nullptr);
+                    }
+                    else
+                    {
+                        // Add the child scope:
+                        AddChildScope(currentChild, firstSourceFileRealPath, pDwarf, GetScopeTypeFromTAG(currentChildTag), o_scope);
+                    }
                 }
                 break;
 
@@ -456,6 +504,77 @@ void DbgInfoDwarfParser::FillChildren(Dwarf_Die programDIE, const std::string& f
     // Uri, 27/1/14: There's a bug in our libDWARF implementation, where dwarf_child() sometimes returns the error code instead
     // or reporting it via the error output parameter. Thus, we need to check it here:
     HWDBG_ASSERT((DW_DLV_NO_ENTRY == rc) || (DW_DLE_NO_ENTRY == rc) || (DW_DLV_OK == rc));
+
+    if (!subprogramOffsets.empty())
+    {
+        FillSubprogramsInParallel(*pParallelBinary, subprogramOffsets, subprogramChildIndices, firstSourceFileRealPath, o_scope);
+    }
+}
+
+/// ---------------------------------------------------------------------------
+/// DbgInfoDwarfParser::FillSubprogramsInParallel
+/// \brief Description: Fill the subprograms FillChildren left placeholders for. libDWARF handles
+///                     cannot be shared between threads, so each thread opens its own handle on the
+///                     binary and finds the subprograms by their DIE offsets. The parent scope is only
+///                     read while the threads run, and the children keep the order of their DIEs.
+/// \param[in] kernelBinary - the binary the subprogram offsets refer to
+/// \param[in] subprogramOffsets - the DIE offsets of the subprograms
+/// \param[in] childIndices - the placeholder in o_scope.m_children of each subprogram
+/// \param[in] firstSourceFileRealPath - default source file path
+/// \param[out] o_scope - Output parameter the scope whose placeholders are filled
+/// \return void
+/// ---------------------------------------------------------------------------
+void DbgInfoDwarfParser::FillSubprogramsInParallel(const KernelBinary& kernelBinary, const std::vector<Dwarf_Off>& subprogramOffsets, const std::vector<size_t>& childIndices, const std::string& firstSourceFileRealPath, DwarfCodeScope& o_scope)
+{
+    size_t subprogramCount = subprogramOffsets.size();
+    unsigned int threadCount = std::min((unsigned int)HWDBG_DW_MAX_PARSE_THREADS, std::max(1u, std::thread::hardware_concurrency()));
+
+    if (HWDBG_DW_MIN_PARALLEL_SUBPROGRAMS > subprogramCount)
+    {
+        threadCount = 1;
+    }
+
+    // Each task parses every threadCount'th subprogram, with a handle of its own:
+    std::vector<DwarfCodeScope*> subprogramScopes(subprogramCount, nullptr);
+    std::vector<std::function<void()>> tasks;
+
+    for (unsigned int t = 0; t < threadCount; t++)
+    {
+        tasks.push_back([&, t]()
+        {
+            Elf* pElf = nullptr;
+            Dwarf_Debug pDwarf = nullptr;
+            Dwarf_Error err = {0};
+            Dwarf_Unsigned cuHeaderOffset = 0;
+
+            if (OpenDwarf(kernelBinary, pElf, pDwarf) &&
+                (DW_DLV_OK == dwarf_next_cu_header(pDwarf, nullptr, nullptr, nullptr, nullptr, &cuHeaderOffset, &err)))
+            {
+                for (size_t i = t; i < subprogramCount; i += threadCount)
+                {
+                    Dwarf_Die subprogramDIE = nullptr;
+
+                    if (DW_DLV_OK == dwarf_offdie(pDwarf, subprogramOffsets[i], &subprogramDIE, &err))
+                    {
+                        subprogramScopes[i] = CreateChildScope(subprogramDIE, firstSourceFileRealPath, pDwarf, GetScopeTypeFromTAG(DW_TAG_subprogram), o_scope);
+                        dwarf_dealloc(pDwarf, (Dwarf_Ptr)subprogramDIE, DW_DLA_DIE);
+                    }
+                }
+            }
+
+            CloseDwarf(pElf, pDwarf);
+        });
+    }
+
+    run_tasks_in_parallel(tasks, threadCount);
+
+    // Fill the placeholders, and drop the ones of subprograms that are not added (abstract inlined functions):
+    for (size_t i = 0; i < subprogramCount; i++)
+    {
+        o_scope.m_children[childIndices[i]] = subprogramScopes[i];
+    }
+
+    o_scope.m_children.erase(std::remove(o_scope.m_children.begin(), o_scope.m_children.end(), (DwarfCodeScope*)nullptr), o_scope.m_children.end());
 }
 
 /// ---------------------------------------------------------------------------
@@ -472,6 +591,28 @@ void DbgInfoDwarfParser::FillChildren(Dwarf_Die programDIE, const std::string& f
 /// ---------------------------------------------------------------------------
 void DbgInfoDwarfParser::AddChildScope(Dwarf_Die childDIE, const std::string& firstSourceFileRealPath, Dwarf_Debug pDwarf, const DwarfCodeScopeType& childScopeType, DwarfCodeScope& o_scope)
 {
+    DwarfCodeScope* pChildScope = CreateChildScope(childDIE, firstSourceFileRealPath, pDwarf, childScopeType, o_scope);
+
+    if (nullptr != pChildScope)
+    {
+        // Add the child scope:
+        o_scope.m_children.push_back(pChildScope);
+    }
+}
+
+/// ---------------------------------------------------------------------------
+/// DbgInfoDwarfParser::CreateChildScope
+/// \brief Description: Fill a child scope from the die recursively, without adding it to its parent.
+/// \param[in] childDIE - Input die
+/// \param[in] firstSourceFileRealPath - default source file path
+/// \param[in] pDwarf - Allocation/Deallocation object
+/// \param[in] childScopeType - the type of child scope to create
+/// \param[in] o_scope - The scope the child scope belongs to
+/// \return The child scope, or nullptr if it is the abstract representation of an inlined function
+/// ---------------------------------------------------------------------------
+DbgInfoDwarfParser::DwarfCodeScope* DbgInfoDwarfParser::CreateChildScope(Dwarf_Die childDIE, const std::string& firstSourceFileRealPath, Dwarf_Debug pDwarf, const DwarfCodeScopeType& childScopeType, DwarfCodeScope& o_scope)
+{
+    DwarfCodeScope* pChildScope = nullptr;
     bool shouldAddSubprogram = true;
     Dwarf_Error err = {0};
 
@@ -490,7 +631,7 @@ void DbgInfoDwarfParser::AddChildScope(Dwarf_Die childDIE, const std::string& fi
 
     if (shouldAddSubprogram)
     {
-        DwarfCodeScope* pChildScope = new DwarfCodeScope;
+        pChildScope = new DwarfCodeScope;
         pChildScope->m_scopeType = childScopeType;
 
         if (DwarfCodeScope::DID_SCT_INLINED_FUNCTION == childScopeType)
@@ -500,10 +641,9 @@ void DbgInfoDwarfParser::AddChildScope(Dwarf_Die childDIE, const std::string& fi
 
         // Recursively fill the program objects:
         FillCodeScopeFromDwarf(childDIE, firstSourceFileRealPath, pDwarf, &o_scope, childScopeType, *pChildScope);
-
-        // Add the child scope:
-        o_scope.m_children.push_back(pChildScope);
     }
+
+    return pChildScope;
 }
 
 /// ---------------------------------------------------------------------------
@@ -1259,6 +1399,7 @@ void DbgInfoDwarfParser::FillInlinedFunctionData(Dwarf_Die programDIE, const std
                         *o_scope.m_inlineInfo.m_inlinedAt.m_fullPath = pSourceFilesAsCharArrays[callFileNumber - 1];
                     }
 
+#if !HWDBGINFO_LIBDWARF_ELFTOOLCHAIN
                     // Release the strings:
                     for (Dwarf_Signed i = 0; i < numberOfSourceFiles; i++)
                     {
@@ -1268,6 +1409,7 @@ void DbgInfoDwarfParser::FillInlinedFunctionData(Dwarf_Die programDIE, const std
 
                     // Release the string list:
                     dwarf_dealloc(pDwarf, (Dwarf_Ptr)pSourceFilesAsCharArrays, DW_DLA_LIST);
+#endif
                 }
 
                 // Release the CU DIE:
@@ -1773,7 +1915,7 @@ void DbgInfoDwarfParser::FillTypeNameAndDetailsFromTypeDIE(Dwarf_Die typeDIE, Dw
 
                 // Variables do not have locations that are scoped, so ignore them for this:
                 std::vector<DwarfVariableLocation> ignoredAdditionalLocations;
-                FillVariableWithInformationFromDIE(currentChild, pDwarf, true, currentMember, ignoredAdditionalLocations);
+                FillVariableWithInformationFromDIE(currentChild, pDwarf, true, currentMember, ignoredAdditionalLocations, o_variable.m_varMembers.size());
                 HWDBG_ASSERT(ignoredAdditionalLocations.size() == 0);
 
                 // If const, we calculate the buffer by taking the parent buffer and adding the member offset:
@@ -1815,92 +1957,154 @@ void DbgInfoDwarfParser::FillTypeNameAndDetailsFromTypeDIE(Dwarf_Die typeDIE, Dw
 }
 
 /// ---------------------------------------------------------------------------
-/// DbgInfoDwarfParser::InitializeWithBinary
-/// \brief Description: Main function: Looks for DWARF sections in the supplied ELF binary and initializes the reading from it.
+/// DbgInfoDwarfParser::OpenDwarf
+/// \brief Description: Opens the ELF and DWARF handles of a binary. The handles belong to the calling
+///                     thread, a binary parsed by several threads is opened by each of them.
 /// \param[in] kernelBinary - the data containing the ELF, including size
-/// \param[out] o_scope - Out Param -the top code scope
-/// \param[out] o_lineNumberMapping - Out Param the line <-> address mapping
-/// \param[in] firstSourceFileRealPath - the path to the original source file for the mapping
-/// \return Success / failure.
+/// \param[out] o_pElf - Out Param - the ELF handle
+/// \param[out] o_pDwarf - Out Param - the DWARF handle
+/// \return Success / failure. The handles are released on failure.
 /// ---------------------------------------------------------------------------
-bool DbgInfoDwarfParser::InitializeWithBinary(const KernelBinary& kernelBinary, DwarfCodeScope& o_scope, DwarfLineMapping& o_lineNumberMapping, const std::string& firstSourceFileRealPath)
+bool DbgInfoDwarfParser::OpenDwarf(const KernelBinary& kernelBinary, Elf*& o_pElf, Dwarf_Debug& o_pDwarf)
 {
     bool retVal = false;
 
     // Set the version of elf:
-    elf_version(EV_CURRENT);
+    SetElfVersion();
 
     // Initialize an Elf object with the buffer:
-    Elf* pElf = elf_memory((char*)(kernelBinary.m_pBinaryData), kernelBinary.m_binarySize);
+    o_pElf = elf_memory((char*)(kernelBinary.m_pBinaryData), kernelBinary.m_binarySize);
+    o_pDwarf = nullptr;
     Dwarf_Error err = {0};
-    Dwarf_Debug pDwarf = nullptr;
 
-    HWDBG_ASSERT(pElf != nullptr);
+    HWDBG_ASSERT(o_pElf != nullptr);
 
-    if (pElf != nullptr)
+    if (o_pElf != nullptr)
     {
         // Initialize a D with this Elf object:
-        int rcDW = dwarf_elf_init(pElf, DW_DLC_READ, nullptr, nullptr, &pDwarf, &err);
+        int rcDW = dwarf_elf_init(o_pElf, DW_DLC_READ, nullptr, nullptr, &o_pDwarf, &err);
+        retVal = ((rcDW == DW_DLV_OK) && (o_pDwarf != nullptr));
 
-        if ((rcDW == DW_DLV_OK) && (pDwarf != nullptr))
+        if (!retVal)
         {
-            // Mark that we succeeded:
-            retVal = true;
+            // Report initialization errors:
+            HWDBG_DW_REPORT_ERROR(err, false);
+        }
+    }
 
-            // Get the offset for the compilation unit. Note that we expect OpenCL kernels
-            // to only have one CU. Check that we have one at all:
-            Dwarf_Unsigned cuHeaderOffset = 0;
+    if (!retVal)
+    {
+        CloseDwarf(o_pElf, o_pDwarf);
+    }
 
-            int rc = dwarf_next_cu_header(pDwarf, nullptr, nullptr, nullptr, nullptr, &cuHeaderOffset, &err);
+    return retVal;
+}
 
-            if (rc == DW_DLV_OK)
-            {
-                // Get the DIE for the first CU by calling for the sibling of nullptr:
-                Dwarf_Die cuDIE = nullptr;
-                rc = dwarf_siblingof(pDwarf, nullptr, &cuDIE, &err);
+/// ---------------------------------------------------------------------------
+/// DbgInfoDwarfParser::CloseDwarf
+/// \brief Description: Releases the handles opened by OpenDwarf
+/// \param[in,out] io_pElf - the ELF handle, set to nullptr
+/// \param[in,out] io_pDwarf - the DWARF handle, set to nullptr
+/// \return void
+/// ---------------------------------------------------------------------------
+void DbgInfoDwarfParser::CloseDwarf(Elf*& io_pElf, Dwarf_Debug& io_pDwarf)
+{
+    if (io_pDwarf != nullptr)
+    {
+        Dwarf_Error err = {0};
+        int rcDF = dwarf_finish(io_pDwarf, &err);
+        HWDBG_ASSERT(DW_DLV_OK == rcDF);
+        io_pDwarf = nullptr;
+    }
 
-                if (rc == DW_DLV_OK)
-                {
-                    FillCodeScopeFromDwarf(cuDIE, firstSourceFileRealPath, pDwarf, nullptr, DwarfCodeScope::DID_SCT_COMPILATION_UNIT, o_scope);
+    if (io_pElf != nullptr)
+    {
+        int rcEF = elf_end(io_pElf);
+        HWDBG_ASSERT(rcEF == 0);
+        io_pElf = nullptr;
+    }
+}
 
-                    // Use the CU DIE to get the line number information. This needs to happen after the programs are
-                    // initialized, since each entry must be associated with a program:
-                    DwarfLineMapping lineNumberMapping;
-                    bool rcLn = FillLineMappingFromDwarf(cuDIE, firstSourceFileRealPath, pDwarf, o_lineNumberMapping);
-                    HWDBG_ASSERT(rcLn);
+/// ---------------------------------------------------------------------------
+/// DbgInfoDwarfParser::InitializeWithBinary
+/// \brief Description: Main function: Looks for DWARF sections in the supplied ELF binary and initializes the reading from it.
+/// \param[in] kernelBinary - the data containing the ELF, including size
+/// \param[out] o_scope - Out Param -the top code scope
+/// \param[out] o_lineNumberMapping - Out Param the line <-> address mapping
+/// \param[in] firstSourceFileRealPath - the path to the original source file for the mapping
+/// \param[in] parallelSubprograms - parse the subprograms of the CU on a pool of threads
+/// \param[out] o_pTimings - Out Param, optional - the time spent in each phase
+/// \return Success / failure.
+/// ---------------------------------------------------------------------------
+bool DbgInfoDwarfParser::InitializeWithBinary(const KernelBinary& kernelBinary, DwarfCodeScope& o_scope, DwarfLineMapping& o_lineNumberMapping, const std::string& firstSourceFileRealPath, bool parallelSubprograms, DwarfParseTimings* o_pTimings)
+{
+    DwarfParseTimings timings;
+    HwDbgUInt64 startUs = GetSteadyTimeUs();
+    HwDbgUInt64 phaseStartUs = startUs;
 
-                    // Fill addresses from mapping:
-                    std::vector<DwarfAddrType> addresses;
-                    o_lineNumberMapping.GetMappedAddresses(addresses);
-                    retVal = o_scope.MapAddressesToCodeScopes(addresses);
+    Elf* pElf = nullptr;
+    Dwarf_Error err = {0};
+    Dwarf_Debug pDwarf = nullptr;
 
-                    // Release the CU DIE:
-                    dwarf_dealloc(pDwarf, (Dwarf_Ptr)cuDIE, DW_DLA_DIE);
-                }
-            }
-        }
-        else
+    // Mark whether we succeeded:
+    bool retVal = OpenDwarf(kernelBinary, pElf, pDwarf);
+
+    timings.m_initUs = GetSteadyTimeUs() - phaseStartUs;
+
+    if (retVal)
+    {
+        // Get the offset for the compilation unit. Note that we expect OpenCL kernels
+        // to only have one CU. Check that we have one at all:
+        Dwarf_Unsigned cuHeaderOffset = 0;
+
+        int rc = dwarf_next_cu_header(pDwarf, nullptr, nullptr, nullptr, nullptr, &cuHeaderOffset, &err);
+
+        if (rc == DW_DLV_OK)
         {
-            // Report initialization errors:
-            HWDBG_DW_REPORT_ERROR(err, false);
+            // Get the DIE for the first CU by calling for the sibling of nullptr:
+            Dwarf_Die cuDIE = nullptr;
+            rc = dwarf_siblingof(pDwarf, nullptr, &cuDIE, &err);
+
+            if (rc == DW_DLV_OK)
+            {
+                phaseStartUs = GetSteadyTimeUs();
+                FillCodeScopeFromDwarf(cuDIE, firstSourceFileRealPath, pDwarf, nullptr, DwarfCodeScope::DID_SCT_COMPILATION_UNIT, o_scope, parallelSubprograms ? &kernelBinary : nullptr);
+                timings.m_codeScopeUs = GetSteadyTimeUs() - phaseStartUs;
+
+                // Use the CU DIE to get the line number information. This needs to happen after the programs are
+                // initialized, since each entry must be associated with a program:
+                phaseStartUs = GetSteadyTimeUs();
+                bool rcLn = FillLineMappingFromDwarf(cuDIE, firstSourceFileRealPath, pDwarf, o_lineNumberMapping);
+                HWDBG_ASSERT(rcLn);
+                o_lineNumberMapping.FinalizeMappings();
+                timings.m_lineMappingUs = GetSteadyTimeUs() - phaseStartUs;
+
+                // Fill addresses from mapping:
+                phaseStartUs = GetSteadyTimeUs();
+                std::vector<DwarfAddrType> addresses;
+                o_lineNumberMapping.GetMappedAddresses(addresses);
+                retVal = o_scope.MapAddressesToCodeScopes(addresses);
+                o_scope.BuildAddressIndex();
+                o_scope.BuildVariableIndex();
+                timings.m_addressMappingUs = GetSteadyTimeUs() - phaseStartUs;
+
+                // Release the CU DIE:
+                dwarf_dealloc(pDwarf, (Dwarf_Ptr)cuDIE, DW_DLA_DIE);
+            }
         }
     }
 
     // If we failed, clean up:
     if (!retVal)
     {
-        if (pDwarf != nullptr)
-        {
-            int rcDF = dwarf_finish(pDwarf, &err);
-            HWDBG_ASSERT(DW_DLV_OK == rcDF);
-        }
+        CloseDwarf(pElf, pDwarf);
+    }
 
-        if (pElf != nullptr)
-        {
-            int rcEF = elf_end(pElf);
-            HWDBG_ASSERT(rcEF == 0);
-            pElf = nullptr;
-        }
+    timings.m_totalUs = GetSteadyTimeUs() - startUs;
+
+    if (nullptr != o_pTimings)
+    {
+        *o_pTimings = timings;
     }
 
     return retVal;
@@ -1915,9 +2119,10 @@ bool DbgInfoDwarfParser::InitializeWithBinary(const KernelBinary& kernelBinary,
 /// \param[in] isMember - whether this variable is a member of another
 /// \param[out] o_variableData - Output Param the filled variable
 /// \param[out] o_variableAdditionalLocations - additional locations of this same variable added so that we know if we have at least one location.
+/// \param[in] memberIndex - the ordinal of the member in its parent, used to name unnamed members
 /// \return void
 /// ---------------------------------------------------------------------------
-void DbgInfoDwarfParser::FillVariableWithInformationFromDIE(Dwarf_Die variableDIE, Dwarf_Debug pDwarf, bool isMember, DwarfVariableInfo& o_variableData, std::vector<DwarfVariableLocation>& o_variableAdditionalLocations)
+void DbgInfoDwarfParser::FillVariableWithInformationFromDIE(Dwarf_Die variableDIE, Dwarf_Debug pDwarf, bool isMember, DwarfVariableInfo& o_variableData, std::vector<DwarfVariableLocation>& o_variableAdditionalLocations, size_t memberIndex)
 {
     Dwarf_Error err = {0};
     // Get the variable's location attribute:
@@ -2067,7 +2272,7 @@ void DbgInfoDwarfParser::FillVariableWithInformationFromDIE(Dwarf_Die variableDI
             // Do not allow members to have no name:
             if (isMember && (o_variableData.m_varName.empty()))
             {
-                CreateVarNameFromType(typeDIE, o_variableData);
+                CreateVarNameFromType(typeDIE, memberIndex, o_variableData);
             }
 
             // Release the DIE:
@@ -2107,7 +2312,7 @@ void DbgInfoDwarfParser::FillVariableWithInformationFromDIE(Dwarf_Die variableDI
         {
             // Fill any data you can from the abstract origin. We do not need locations, since the abstract origin has none:
             std::vector<DwarfVariableLocation> ignoredAdditionalLocations;
-            FillVariableWithInformationFromDIE(variableAbstractOriginDIE, pDwarf, isMember, o_variableData, ignoredAdditionalLocations);
+            FillVariableWithInformationFromDIE(variableAbstractOriginDIE, pDwarf, isMember, o_variableData, ignoredAdditionalLocations, memberIndex);
             HWDBG_ASSERT(ignoredAdditionalLocations.size() == 0);
 
             // Release the DIE:
@@ -2306,11 +2511,11 @@ void DbgInfoDwarfParser::FillVarName(Dwarf_Die variableDIE, Dwarf_Debug pDwarf,
 /// DbgInfoDwarfParser::CreateVarNameFromType
 /// \brief Description: Generate a var name from the type information
 /// \param[in] typeDIE - Input Parameter
-/// \param[in] err - Error container
+/// \param[in] memberIndex - the ordinal of the member in its parent
 /// \param[out] o_variable - Output parameter variable info
 /// \return void
 /// ---------------------------------------------------------------------------
-void DbgInfoDwarfParser::CreateVarNameFromType(Dwarf_Die typeDIE, DwarfVariableInfo& o_variable)
+void DbgInfoDwarfParser::CreateVarNameFromType(Dwarf_Die typeDIE, size_t memberIndex, DwarfVariableInfo& o_variable)
 {
     Dwarf_Error err = {0};
     o_variable.m_varName = "unnamed_";
@@ -2375,9 +2580,8 @@ void DbgInfoDwarfParser::CreateVarNameFromType(Dwarf_Die typeDIE, DwarfVariableI
         o_variable.m_varName += "member_";
     }
 
-    // Add a serial number (spanning between types, etc):
-    static int unknownMemberIndex = 0;
-    o_variable.m_varName += string_format("%d", unknownMemberIndex++);
+    // Add the member ordinal, so the name does not depend on the parse order:
+    o_variable.m_varName += string_format("%u", (unsigned int)memberIndex);
 }
 
 /// ---------------------------------------------------------------------------
@@ -2548,19 +2752,19 @@ bool DbgInfoDwarfParser::DwarfLocationResolver(
 /// \param[in]          pBinaryData - buffer
 /// \param[in]          binarySize - size
 /// -----------------------------------------------------------------------------------------------
-KernelBinary::KernelBinary(void* pBinaryData, size_t binarySize) : m_pBinaryData(nullptr), m_binarySize(0)
+KernelBinary::KernelBinary(void* pBinaryData, size_t binarySize) : m_pBinaryData(nullptr), m_binarySize(0), m_ownsBinaryData(false), m_wasElfSectionTableBuilt(false)
 {
     setBinary(pBinaryData, binarySize);
 }
 
 /// -----------------------------------------------------------------------------------------------
 /// KernelBinary
-/// \brief Description: Copy Constructor
+/// \brief Description: Copy Constructor. A copy of a view is a view of the same buffer.
 /// \param[in]          rhs - other KernelBinary
 /// -----------------------------------------------------------------------------------------------
-KernelBinary::KernelBinary(const KernelBinary& rhs) : m_pBinaryData(nullptr), m_binarySize(0)
+KernelBinary::KernelBinary(const KernelBinary& rhs) : m_pBinaryData(nullptr), m_binarySize(0), m_ownsBinaryData(false), m_wasElfSectionTableBuilt(false)
 {
-    setBinary(rhs.m_pBinaryData, rhs.m_binarySize);
+    operator=(rhs);
 }
 
 /// -----------------------------------------------------------------------------------------------
@@ -2569,17 +2773,27 @@ KernelBinary::KernelBinary(const KernelBinary& rhs) : m_pBinaryData(nullptr), m_
 /// -----------------------------------------------------------------------------------------------
 KernelBinary::~KernelBinary()
 {
-    setBinary(nullptr, 0);
+    releaseBinary();
 }
 
 /// -----------------------------------------------------------------------------------------------
 /// operator=
-/// \brief Description: Copy assignment operator
+/// \brief Description: Copy assignment operator. A copy of a view is a view of the same buffer.
 /// \param[in]          rhs - other KernelBinary
 /// -----------------------------------------------------------------------------------------------
 KernelBinary& KernelBinary::operator=(const KernelBinary& rhs)
 {
-    setBinary(rhs.m_pBinaryData, rhs.m_binarySize);
+    if (this != &rhs)
+    {
+        if (rhs.m_ownsBinaryData)
+        {
+            setBinary(rhs.m_pBinaryData, rhs.m_binarySize);
+        }
+        else
+        {
+            setBinaryView(rhs.m_pBinaryData, rhs.m_binarySize);
+        }
+    }
 
     return *this;
 }
@@ -2590,10 +2804,15 @@ KernelBinary& KernelBinary::operator=(const KernelBinary& rhs)
 /// \brief Description: Move Constructor
 /// \param[in]          xhs - other KernelBinary
 /// -----------------------------------------------------------------------------------------------
-KernelBinary::KernelBinary(KernelBinary&& xhs) : m_pBinaryData(xhs.m_pBinaryData), m_binarySize(xhs.m_binarySize)
+KernelBinary::KernelBinary(KernelBinary&& xhs) : m_pBinaryData(xhs.m_pBinaryData), m_binarySize(xhs.m_binarySize), m_ownsBinaryData(xhs.m_ownsBinaryData),
+    m_elfSections(std::move(xhs.m_elfSections)), m_elfSectionsByName(std::move(xhs.m_elfSectionsByName)), m_wasElfSectionTableBuilt(xhs.m_wasElfSectionTableBuilt)
 {
     xhs.m_pBinaryData = nullptr;
     xhs.m_binarySize = 0;
+    xhs.m_ownsBinaryData = false;
+    xhs.m_elfSections.clear();
+    xhs.m_elfSectionsByName.clear();
+    xhs.m_wasElfSectionTableBuilt = false;
 }
 
 /// -----------------------------------------------------------------------------------------------
@@ -2603,10 +2822,24 @@ KernelBinary::KernelBinary(KernelBinary&& xhs) : m_pBinaryData(xhs.m_pBinaryData
 /// -----------------------------------------------------------------------------------------------
 KernelBinary& KernelBinary::operator=(KernelBinary&& xhs)
 {
-    m_pBinaryData = xhs.m_pBinaryData;
-    m_binarySize = xhs.m_binarySize;
-    xhs.m_pBinaryData = nullptr;
-    xhs.m_binarySize = 0;
+    if (this != &xhs)
+    {
+        releaseBinary();
+
+        m_pBinaryData = xhs.m_pBinaryData;
+        m_binarySize = xhs.m_binarySize;
+        m_ownsBinaryData = xhs.m_ownsBinaryData;
+        m_elfSections = std::move(xhs.m_elfSections);
+        m_elfSectionsByName = std::move(xhs.m_elfSectionsByName);
+        m_wasElfSectionTableBuilt = xhs.m_wasElfSectionTableBuilt;
+
+        xhs.m_pBinaryData = nullptr;
+        xhs.m_binarySize = 0;
+        xhs.m_ownsBinaryData = false;
+        xhs.m_elfSections.clear();
+        xhs.m_elfSectionsByName.clear();
+        xhs.m_wasElfSectionTableBuilt = false;
+    }
 
     return *this;
 }
@@ -2620,12 +2853,7 @@ KernelBinary& KernelBinary::operator=(KernelBinary&& xhs)
 /// -----------------------------------------------------------------------------------------------
 void KernelBinary::setBinary(void* pBinaryData, size_t binarySize)
 {
-    if (nullptr != m_pBinaryData)
-    {
-        delete [](char*)m_pBinaryData;
-        m_pBinaryData = nullptr;
-        m_binarySize = 0;
-    }
+    releaseBinary();
 
     m_binarySize = binarySize;
 
@@ -2633,9 +2861,45 @@ void KernelBinary::setBinary(void* pBinaryData, size_t binarySize)
     {
         m_pBinaryData = new unsigned char[m_binarySize];
         ::memcpy(m_pBinaryData, pBinaryData, m_binarySize);
+        m_ownsBinaryData = true;
     }
 }
 
+/// -----------------------------------------------------------------------------------------------
+/// setBinaryView
+/// \brief Description: Releases the previous buffer and borrows the new one. The buffer must
+///                     outlive this object and any view obtained from it.
+/// \param[in]          pBinaryData
+/// \param[in]          binarySize
+/// -----------------------------------------------------------------------------------------------
+void KernelBinary::setBinaryView(const void* pBinaryData, size_t binarySize)
+{
+    releaseBinary();
+
+    m_pBinaryData = const_cast<void*>(pBinaryData);
+    m_binarySize = binarySize;
+}
+
+/// -----------------------------------------------------------------------------------------------
+/// releaseBinary
+/// \brief Description: Releases the buffer if we own it, and the ELF section table built from it
+/// -----------------------------------------------------------------------------------------------
+void KernelBinary::releaseBinary()
+{
+    if (m_ownsBinaryData && (nullptr != m_pBinaryData))
+    {
+        delete [](unsigned char*)m_pBinaryData;
+    }
+
+    m_pBinaryData = nullptr;
+    m_binarySize = 0;
+    m_ownsBinaryData = false;
+
+    m_elfSections.clear();
+    m_elfSectionsByName.clear();
+    m_wasElfSectionTableBuilt = false;
+}
+
 /// -----------------------------------------------------------------------------------------------
 /// isElf32Binary
 /// \brief Description: Checks if the binary is a 32-bit elf (ELF32) format
@@ -2691,7 +2955,8 @@ bool KernelBinary::isElf64Binary() const
 /// \param[in]          offset
 /// \param[in]          size
 /// \param[out]         o_bufferAsBinary
-/// \brief Description: Gets the sub buffer as a binary of itself:
+/// \brief Description: Gets the sub buffer as a binary of itself. The output is a view into this
+///                     binary's buffer and must not outlive it.
 /// \return bool success
 /// -----------------------------------------------------------------------------------------------
 bool KernelBinary::getSubBufferAsBinary(size_t offset, size_t size, KernelBinary& o_bufferAsBinary) const
@@ -2699,10 +2964,10 @@ bool KernelBinary::getSubBufferAsBinary(size_t offset, size_t size, KernelBinary
     bool retVal = false;
 
     // Validate the values:
-    if (offset + size <= m_binarySize)
+    if ((offset <= m_binarySize) && (size <= m_binarySize - offset))
     {
-        // Copy the data:
-        o_bufferAsBinary.setBinary((void*)((size_t)m_pBinaryData + offset), size);
+        // Borrow the data:
+        o_bufferAsBinary.setBinaryView((const void*)((size_t)m_pBinaryData + offset), size);
         retVal = true;
     }
 
@@ -2731,54 +2996,157 @@ bool KernelBinary::getTrimmedBufferAsBinary(size_t start_trim, size_t end_trim,
 }
 
 /// -----------------------------------------------------------------------------------------------
-/// getElfSectionAsBinary
-/// \param[in]          sectionIndex
-/// \param[out]         o_sectionAsBinary
-/// \brief Description: Extract an ELF section as a binary itself
-/// \return bool success
+/// buildElfSectionTable
+/// \brief Description: Reads the ELF section headers once, so section queries do not need to
+///                     re-open the ELF or copy section data
+/// \return bool - true if the binary has sections
 /// -----------------------------------------------------------------------------------------------
-bool KernelBinary::getElfSectionAsBinary(int sectionIndex, KernelBinary& o_sectionAsBinary) const
+bool KernelBinary::buildElfSectionTable() const
 {
-    bool retVal = false;
-
-    // Set the version of elf:
-    elf_version(EV_CURRENT);
-
-    // Initialize the binary as ELF from memory:
-    Elf* pContainerElf = elf_memory((char*)m_pBinaryData, m_binarySize);
-
-    if (nullptr != pContainerElf)
+    if (!m_wasElfSectionTableBuilt)
     {
-        // Iterate the sections:
-        Elf_Scn* pCurrentSection = nullptr;
+        m_wasElfSectionTableBuilt = true;
+
+        // Only support ELF32 and ELF64:
+        bool isElf32 = isElf32Binary();
+        bool isElf64 = isElf64Binary();
 
-        for (int i = 0; i < sectionIndex; i++)
+        if ((nullptr != m_pBinaryData) && (isElf32 || isElf64))
         {
-            pCurrentSection = elf_nextscn(pContainerElf, pCurrentSection);
+            // Set the version of elf:
+            SetElfVersion();
 
-            if (nullptr == pCurrentSection)
+            // Initialize the binary as ELF from memory:
+            Elf* pContainerElf = elf_memory((char*)m_pBinaryData, m_binarySize);
+
+            if (nullptr != pContainerElf)
             {
-                break;
-            }
-        }
+                // Get the section count and the shared strings section:
+                size_t sectionCount = 0;
+                size_t sharedStringSectionIndex = (size_t)(-1);
+                int rcShnum = elf_getshdrnum(pContainerElf, &sectionCount);
+                int rcShrstr = elf_getshdrstrndx(pContainerElf, &sharedStringSectionIndex);
 
-        // If the section exists:
-        if (nullptr != pCurrentSection)
-        {
-            // Get the section's data:
-            Elf_Data* pSectionData = elf_getdata(pCurrentSection, nullptr);
+                if ((0 == rcShnum) && (0 == rcShrstr) && ((size_t)(-1) != sharedStringSectionIndex))
+                {
+                    ElfSectionEntry noSection = { "", 0, 0, 0, false };
+                    m_elfSections.resize(sectionCount, noSection);
 
-            if (nullptr != pSectionData)
-            {
-                // Copy the values to the output parameter:
-                o_sectionAsBinary.setBinary(pSectionData->d_buf, (size_t)pSectionData->d_size);
+                    // Iterate the sections:
+                    Elf_Scn* pCurrentSection = elf_nextscn(pContainerElf, nullptr);
+
+                    while (nullptr != pCurrentSection)
+                    {
+                        size_t sectionIndex = elf_ndxscn(pCurrentSection);
+                        bool supportedBinaryFormat = false;
+                        size_t strOffset = 0;
+                        size_t shOffset = 0;
+                        size_t shSize = 0;
+                        size_t shLink = 0;
+                        bool shHasBits = false;
+
+                        if (isElf32)
+                        {
+                            // Get the section header:
+                            Elf32_Shdr* pCurrentSectionHeader = elf32_getshdr(pCurrentSection);
+
+                            if (nullptr != pCurrentSectionHeader)
+                            {
+                                strOffset = pCurrentSectionHeader->sh_name;
+                                shOffset = (size_t)pCurrentSectionHeader->sh_offset;
+                                shSize = (size_t)pCurrentSectionHeader->sh_size;
+                                shLink = pCurrentSectionHeader->sh_link;
+                                shHasBits = (SHT_NOBITS != pCurrentSectionHeader->sh_type);
+                                supportedBinaryFormat = true;
+                            }
+                        }
+                        else
+                        {
+                            // Get the section header:
+                            Elf64_Shdr* pCurrentSectionHeader = elf64_getshdr(pCurrentSection);
+
+                            if (nullptr != pCurrentSectionHeader)
+                            {
+                                strOffset = pCurrentSectionHeader->sh_name;
+                                shOffset = (size_t)pCurrentSectionHeader->sh_offset;
+                                shSize = (size_t)pCurrentSectionHeader->sh_size;
+                                shLink = pCurrentSectionHeader->sh_link;
+                                shHasBits = (SHT_NOBITS != pCurrentSectionHeader->sh_type);
+                                supportedBinaryFormat = true;
+                            }
+                        }
+
+                        if (supportedBinaryFormat && (sectionIndex < sectionCount))
+                        {
+                            ElfSectionEntry& currentSection = m_elfSections[sectionIndex];
+                            currentSection.m_offset = shOffset;
+                            currentSection.m_size = shSize;
+                            currentSection.m_link = (int)shLink;
+
+                            // The section data is used in place, so it must be inside the buffer:
+                            currentSection.m_hasData = shHasBits && (shOffset <= m_binarySize) && (shSize <= m_binarySize - shOffset);
+
+                            // Get the current section's name:
+                            const char* pCurrentSectionName = elf_strptr(pContainerElf, sharedStringSectionIndex, strOffset);
 
-                // Report success:
-                retVal = true;
+                            if ((nullptr != pCurrentSectionName) && ('\0' != pCurrentSectionName[0]))
+                            {
+                                currentSection.m_name = pCurrentSectionName;
+                                m_elfSectionsByName.insert(std::make_pair(currentSection.m_name, sectionIndex));
+                            }
+                        }
+
+                        // Get the next section:
+                        pCurrentSection = elf_nextscn(pContainerElf, pCurrentSection);
+                    }
+                }
+
+                // The table does not refer to the ELF object:
+                elf_end(pContainerElf);
             }
         }
     }
 
+    return !m_elfSections.empty();
+}
+
+/// -----------------------------------------------------------------------------------------------
+/// getElfSectionEntryAsBinary
+/// \param[in]          section
+/// \param[out]         o_sectionAsBinary
+/// \brief Description: Gets a section from the table as a view into this binary's buffer
+/// \return bool success
+/// -----------------------------------------------------------------------------------------------
+bool KernelBinary::getElfSectionEntryAsBinary(const ElfSectionEntry& section, KernelBinary& o_sectionAsBinary) const
+{
+    bool retVal = false;
+
+    if (section.m_hasData)
+    {
+        retVal = getSubBufferAsBinary(section.m_offset, section.m_size, o_sectionAsBinary);
+    }
+
+    return retVal;
+}
+
+/// -----------------------------------------------------------------------------------------------
+/// getElfSectionAsBinary
+/// \param[in]          sectionIndex
+/// \param[out]         o_sectionAsBinary
+/// \brief Description: Extract an ELF section as a binary itself. The output is a view into this
+///                     binary's buffer and must not outlive it.
+/// \return bool success
+/// -----------------------------------------------------------------------------------------------
+bool KernelBinary::getElfSectionAsBinary(int sectionIndex, KernelBinary& o_sectionAsBinary) const
+{
+    bool retVal = false;
+
+    // Section 0 is the ELF null section:
+    if (buildElfSectionTable() && (0 < sectionIndex) && ((size_t)sectionIndex < m_elfSections.size()))
+    {
+        retVal = getElfSectionEntryAsBinary(m_elfSections[sectionIndex], o_sectionAsBinary);
+    }
+
     return retVal;
 }
 
@@ -2787,101 +3155,67 @@ bool KernelBinary::getElfSectionAsBinary(int sectionIndex, KernelBinary& o_secti
 /// \param[in]          sectionName
 /// \param[out]         o_sectionAsBinary
 /// \param[out]         o_pSectionLinkIndex
-/// \brief Description: Extract an ELF section as a binary itself
+/// \brief Description: Extract an ELF section as a binary itself. The output is a view into this
+///                     binary's buffer and must not outlive it.
 /// \return bool success
 /// -----------------------------------------------------------------------------------------------
 bool KernelBinary::getElfSectionAsBinary(const std::string& sectionName, KernelBinary& o_sectionAsBinary, int* o_pSectionLinkIndex) const
 {
     bool retVal = false;
 
-    // Set the version of elf:
-    elf_version(EV_CURRENT);
-
-    // Initialize the binary as ELF from memory:
-    Elf* pContainerElf = elf_memory((char*)m_pBinaryData, m_binarySize);
-
-    if (nullptr != pContainerElf)
+    if (buildElfSectionTable())
     {
-        // Get the shared strings section:
-        size_t sharedStringSectionIndex = (size_t)(-1);
-        int rcShrstr = elf_getshdrstrndx(pContainerElf, &sharedStringSectionIndex);
+        std::map<std::string, size_t>::const_iterator findIter = m_elfSectionsByName.find(sectionName);
 
-        if ((0 == rcShrstr) && ((size_t)(-1) != sharedStringSectionIndex))
+        if (m_elfSectionsByName.end() != findIter)
         {
-            // Iterate the sections:
-            Elf_Scn* pCurrentSection = elf_nextscn(pContainerElf, nullptr);
+            const ElfSectionEntry& section = m_elfSections[findIter->second];
+            retVal = getElfSectionEntryAsBinary(section, o_sectionAsBinary);
 
-            while (nullptr != pCurrentSection)
+            // Return the link if requested:
+            if (retVal && (nullptr != o_pSectionLinkIndex))
             {
-                // Only support ELF32 and ELF64:
-                bool supportedBinaryFormat = false;
-                size_t strOffset = 0;
-                size_t shLink = 0;
-
-                if (isElf32Binary())
-                {
-                    // Get the section header:
-                    Elf32_Shdr* pCurrentSectionHeader = elf32_getshdr(pCurrentSection);
-
-                    if (nullptr != pCurrentSectionHeader)
-                    {
-                        // Get the name and link if needed:
-                        strOffset = pCurrentSectionHeader->sh_name;
-                        shLink = pCurrentSectionHeader->sh_link;
-                        supportedBinaryFormat = true;
-                    }
-                }
-                else if (isElf64Binary())
-                {
-                    // Get the section header:
-                    Elf64_Shdr* pCurrentSectionHeader = elf64_getshdr(pCurrentSection);
-
-                    if (nullptr != pCurrentSectionHeader)
-                    {
-                        // Get the name and link if needed:
-                        strOffset = pCurrentSectionHeader->sh_name;
-                        shLink = pCurrentSectionHeader->sh_link;
-                        supportedBinaryFormat = true;
-                    }
-                }
+                *o_pSectionLinkIndex = section.m_link;
+            }
+        }
+    }
 
-                if (supportedBinaryFormat)
-                {
-                    // Get the current section's name:
-                    char* pCurrentSectionName = elf_strptr(pContainerElf, sharedStringSectionIndex, strOffset);
+    return retVal;
+}
 
-                    if (nullptr != pCurrentSectionName)
-                    {
-                        std::string currentSectionName;
-                        currentSectionName = pCurrentSectionName;
+/// -----------------------------------------------------------------------------------------------
+/// getElfSymbolTable
+/// \param[out]         o_symTabSection
+/// \param[out]         o_symStrTabSection
+/// \brief Description: Gets the symbol table and its string table as views into this binary's buffer
+/// \return bool success
+/// -----------------------------------------------------------------------------------------------
+bool KernelBinary::getElfSymbolTable(KernelBinary& o_symTabSection, KernelBinary& o_symStrTabSection) const
+{
+    bool retVal = false;
+    int symbolStringTableIndex = -1;
+    bool rcST = getElfSectionAsBinary(".symtab", o_symTabSection, &symbolStringTableIndex);
 
-                        if ((!currentSectionName.empty()) && (sectionName == currentSectionName))
-                        {
-                            // Get the section's data:
-                            Elf_Data* pSectionData = elf_getdata(pCurrentSection, nullptr);
+    if (rcST && (0 < symbolStringTableIndex))
+    {
+        retVal = getElfSectionAsBinary(symbolStringTableIndex, o_symStrTabSection);
+    }
 
-                            if (nullptr != pSectionData)
-                            {
-                                // Copy the values to the output parameter:
-                                o_sectionAsBinary.setBinary(pSectionData->d_buf, (size_t)pSectionData->d_size);
+    return retVal;
+}
 
-                                // Return the link if requested:
-                                if (nullptr != o_pSectionLinkIndex)
-                                {
-                                    *o_pSectionLinkIndex = (int)shLink;
-                                }
+// Gets a NULL-terminated string from an ELF string table, or nullptr if it is out of its bounds:
+static const char* GetElfStringTableEntry(const KernelBinary& strTabSection, size_t strOffset)
+{
+    const char* retVal = nullptr;
 
-                                // Report success:
-                                retVal = true;
-                                break;
-                            }
-                        }
-                    }
-                }
+    if (strOffset < strTabSection.m_binarySize)
+    {
+        const char* pString = (const char*)strTabSection.m_pBinaryData + strOffset;
 
-                // Get the next section:
-                pCurrentSection = elf_nextscn(pContainerElf, pCurrentSection);
-            }
+        if (nullptr != ::memchr(pString, '\0', strTabSection.m_binarySize - strOffset))
+        {
+            retVal = pString;
         }
     }
 
@@ -2892,97 +3226,86 @@ bool KernelBinary::getElfSectionAsBinary(const std::string& sectionName, KernelB
 /// getElfSymbolAsBinary
 /// \param[in]          symbol
 /// \param[out]         o_symbolAsBinary
-/// \brief Description: Extract an ELF symbol as a binary itself
+/// \brief Description: Extract an ELF symbol as a binary itself. The output is a view into this
+///                     binary's buffer and must not outlive it.
 /// \return bool success
 /// -----------------------------------------------------------------------------------------------
 bool KernelBinary::getElfSymbolAsBinary(const std::string& symbol, KernelBinary& o_symbolAsBinary) const
 {
     bool retVal = false;
 
-    // Set the version of elf:
-    elf_version(EV_CURRENT);
-
-    // Initialize the binary as ELF from memory:
-    Elf* pContainerElf = elf_memory((char*)m_pBinaryData, m_binarySize);
+    // First get the symbol table section:
+    KernelBinary symTabSection(nullptr, 0);
+    KernelBinary symStrTabSection(nullptr, 0);
+    bool rcST = getElfSymbolTable(symTabSection, symStrTabSection);
 
-    if (nullptr != pContainerElf)
+    if (rcST && !symbol.empty())
     {
-        // First get the symbol table section:
-        KernelBinary symTabSection(nullptr, 0);
-        int symbolStringTableIndex = -1;
-        bool rcST = getElfSectionAsBinary(".symtab", symTabSection, &symbolStringTableIndex);
+        // Get the symbol data:
+        int sectionIndex = -1;
+        size_t offsetInSection = 0;
+        size_t symbolSize = 0;
 
-        if (rcST && (0 < symbolStringTableIndex))
+        if (isElf32Binary())
         {
-            if (!symbol.empty())
+            int numberOfSymbols = (int)(symTabSection.m_binarySize / sizeof(Elf32_Sym));
+            const Elf32_Sym* pCurrentSymbol = (const Elf32_Sym*)symTabSection.m_pBinaryData;
+
+            for (int i = 0; i < numberOfSymbols; i++)
             {
-                // Get the symbol data:
-                int sectionIndex = -1;
-                size_t offsetInSection = 0;
-                size_t symbolSize = 0;
+                // Get the symbol name as a string:
+                const char* pCurrentSymbolName = GetElfStringTableEntry(symStrTabSection, (size_t)pCurrentSymbol->st_name);
 
-                if (isElf32Binary())
+                if ((nullptr != pCurrentSymbolName) && (symbol == pCurrentSymbolName))
                 {
-                    int numberOfSymbols = (int)(symTabSection.m_binarySize / sizeof(Elf32_Sym));
-                    Elf32_Sym* pCurrentSymbol = (Elf32_Sym*)symTabSection.m_pBinaryData;
-
-                    for (int i = 0; i < numberOfSymbols; i++)
-                    {
-                        // Get the symbol name as a string:
-                        char* pCurrentSymbolName = elf_strptr(pContainerElf, symbolStringTableIndex, pCurrentSymbol->st_name);
+                    // Get the parameters:
+                    sectionIndex = (int)pCurrentSymbol->st_shndx;
+                    offsetInSection = (size_t)pCurrentSymbol->st_value;
+                    symbolSize = (size_t)pCurrentSymbol->st_size;
 
-                        if (symbol == pCurrentSymbolName)
-                        {
-                            // Get the parameters:
-                            sectionIndex = (int)pCurrentSymbol->st_shndx;
-                            offsetInSection = (size_t)pCurrentSymbol->st_value;
-                            symbolSize = (size_t)pCurrentSymbol->st_size;
-
-                            // Stop searching:
-                            break;
-                        }
-
-                        // Move the pointer ahead:
-                        pCurrentSymbol++;
-                    }
+                    // Stop searching:
+                    break;
                 }
-                else if (isElf64Binary())
-                {
-                    int numberOfSymbols = (int)(symTabSection.m_binarySize / sizeof(Elf64_Sym));
-                    Elf64_Sym* pCurrentSymbol = (Elf64_Sym*)symTabSection.m_pBinaryData;
 
-                    for (int i = 0; i < numberOfSymbols; i++)
-                    {
-                        // Get the symbol name as a string:
-                        char* pCurrentSymbolName = elf_strptr(pContainerElf, symbolStringTableIndex, pCurrentSymbol->st_name);
+                // Move the pointer ahead:
+                pCurrentSymbol++;
+            }
+        }
+        else if (isElf64Binary())
+        {
+            int numberOfSymbols = (int)(symTabSection.m_binarySize / sizeof(Elf64_Sym));
+            const Elf64_Sym* pCurrentSymbol = (const Elf64_Sym*)symTabSection.m_pBinaryData;
 
-                        if (symbol == pCurrentSymbolName)
-                        {
-                            // Get the parameters:
-                            sectionIndex = (int)pCurrentSymbol->st_shndx;
-                            offsetInSection = (size_t)pCurrentSymbol->st_value;
-                            symbolSize = (size_t)pCurrentSymbol->st_size;
+            for (int i = 0; i < numberOfSymbols; i++)
+            {
+                // Get the symbol name as a string:
+                const char* pCurrentSymbolName = GetElfStringTableEntry(symStrTabSection, (size_t)pCurrentSymbol->st_name);
 
-                            // Stop searching:
-                            break;
-                        }
+                if ((nullptr != pCurrentSymbolName) && (symbol == pCurrentSymbolName))
+                {
+                    // Get the parameters:
+                    sectionIndex = (int)pCurrentSymbol->st_shndx;
+                    offsetInSection = (size_t)pCurrentSymbol->st_value;
+                    symbolSize = (size_t)pCurrentSymbol->st_size;
 
-                        // Move the pointer ahead:
-                        pCurrentSymbol++;
-                    }
+                    // Stop searching:
+                    break;
                 }
 
-                // Get the containing section:
-                KernelBinary containingSection(nullptr, 0);
-                bool rcSc = getElfSectionAsBinary(sectionIndex, containingSection);
-
-                if (rcSc)
-                {
-                    // Get the data from it:
-                    retVal = containingSection.getSubBufferAsBinary(offsetInSection, symbolSize, o_symbolAsBinary);
-                }
+                // Move the pointer ahead:
+                pCurrentSymbol++;
             }
         }
+
+        // Get the containing section:
+        KernelBinary containingSection(nullptr, 0);
+        bool rcSc = getElfSectionAsBinary(sectionIndex, containingSection);
+
+        if (rcSc)
+        {
+            // Get the data from it:
+            retVal = containingSection.getSubBufferAsBinary(offsetInSection, symbolSize, o_symbolAsBinary);
+        }
     }
 
     return retVal;
@@ -2996,79 +3319,18 @@ bool KernelBinary::getElfSymbolAsBinary(const std::string& symbol, KernelBinary&
 /// -----------------------------------------------------------------------------------------------
 void KernelBinary::listELFSectionNames(std::vector<std::string>& o_sectionNames) const
 {
-    bool retVal = false;
-
-    // Set the version of elf:
-    elf_version(EV_CURRENT);
-
-    // Initialize the binary as ELF from memory:
-    Elf* pContainerElf = elf_memory((char*)m_pBinaryData, m_binarySize);
-
-    if (nullptr != pContainerElf)
+    if (buildElfSectionTable())
     {
-        // Get the shared strings section:
-        size_t sharedStringSectionIndex = (size_t)(-1);
-        int rcShrstr = elf_getshdrstrndx(pContainerElf, &sharedStringSectionIndex);
+        size_t sectionCount = m_elfSections.size();
 
-        if ((0 == rcShrstr) && ((size_t)(-1) != sharedStringSectionIndex))
+        for (size_t i = 0; i < sectionCount; i++)
         {
-            // Iterate the sections:
-            Elf_Scn* pCurrentSection = elf_nextscn(pContainerElf, nullptr);
+            // If it's not empty, add it to the vector:
+            const std::string& currentSectionName = m_elfSections[i].m_name;
 
-            while (nullptr != pCurrentSection)
+            if (!currentSectionName.empty())
             {
-                // Only support ELF32 and ELF64:
-                bool supportedBinaryFormat = false;
-                size_t strOffset = 0;
-                size_t shLink = 0;
-
-                if (isElf32Binary())
-                {
-                    // Get the section header:
-                    Elf32_Shdr* pCurrentSectionHeader = elf32_getshdr(pCurrentSection);
-
-                    if (nullptr != pCurrentSectionHeader)
-                    {
-                        // Get the name and link if needed:
-                        strOffset = pCurrentSectionHeader->sh_name;
-                        shLink = pCurrentSectionHeader->sh_link;
-                        supportedBinaryFormat = true;
-                    }
-                }
-                else if (isElf64Binary())
-                {
-                    // Get the section header:
-                    Elf64_Shdr* pCurrentSectionHeader = elf64_getshdr(pCurrentSection);
-
-                    if (nullptr != pCurrentSectionHeader)
-                    {
-                        // Get the name and link if needed:
-                        strOffset = pCurrentSectionHeader->sh_name;
-                        shLink = pCurrentSectionHeader->sh_link;
-                        supportedBinaryFormat = true;
-                    }
-                }
-
-                if (supportedBinaryFormat)
-                {
-                    // Get the current section's name:
-                    char* pCurrentSectionName = elf_strptr(pContainerElf, sharedStringSectionIndex, strOffset);
-
-                    if (nullptr != pCurrentSectionName)
-                    {
-                        // If it's not empty, add it to the vector:
-                        std::string currentSectionName;
-                        currentSectionName = pCurrentSectionName;
-
-                        if (!currentSectionName.empty())
-                        {
-                            o_sectionNames.push_back(currentSectionName);
-                        }
-                    }
-                }
-
-                // Get the next section:
-                pCurrentSection = elf_nextscn(pContainerElf, pCurrentSection);
+                o_sectionNames.push_back(currentSectionName);
             }
         }
     }
@@ -3082,75 +3344,51 @@ void KernelBinary::listELFSectionNames(std::vector<std::string>& o_sectionNames)
 /// -----------------------------------------------------------------------------------------------
 void KernelBinary::listELFSymbolNames(std::vector<std::string>& o_symbolNames) const
 {
-    // Set the version of elf:
-    elf_version(EV_CURRENT);
-
-    // Initialize the binary as ELF from memory:
-    Elf* pContainerElf = elf_memory((char*)m_pBinaryData, m_binarySize);
+    // First get the symbol table section:
+    KernelBinary symTabSection(nullptr, 0);
+    KernelBinary symStrTabSection(nullptr, 0);
+    bool rcST = getElfSymbolTable(symTabSection, symStrTabSection);
 
-    if (nullptr != pContainerElf)
+    if (rcST)
     {
-        // First get the symbol table section:
-        KernelBinary symTabSection(nullptr, 0);
-        int symbolStringTableIndex = -1;
-        bool rcST = getElfSectionAsBinary(".symtab", symTabSection, &symbolStringTableIndex);
-
-        if (rcST && (0 < symbolStringTableIndex))
+        if (isElf32Binary())
         {
-            // Get the symbol data:
-            int sectionIndex = -1;
-            size_t offsetInSection = 0;
-            size_t symbolSize = 0;
+            int numberOfSymbols = (int)(symTabSection.m_binarySize / sizeof(Elf32_Sym));
+            const Elf32_Sym* pCurrentSymbol = (const Elf32_Sym*)symTabSection.m_pBinaryData;
 
-            if (isElf32Binary())
+            for (int i = 0; i < numberOfSymbols; i++)
             {
-                int numberOfSymbols = (int)(symTabSection.m_binarySize / sizeof(Elf32_Sym));
-                Elf32_Sym* pCurrentSymbol = (Elf32_Sym*)symTabSection.m_pBinaryData;
+                // Get the symbol name as a string:
+                const char* pCurrentSymbolName = GetElfStringTableEntry(symStrTabSection, (size_t)pCurrentSymbol->st_name);
 
-                for (int i = 0; i < numberOfSymbols; i++)
+                // If it's not empty, add it to the vector:
+                if ((nullptr != pCurrentSymbolName) && ('\0' != pCurrentSymbolName[0]))
                 {
-                    // Get the symbol name as a string:
-                    char* pCurrentSymbolName = elf_strptr(pContainerElf, symbolStringTableIndex, pCurrentSymbol->st_name);
-
-                    if (nullptr != pCurrentSymbolName)
-                    {
-                        // If it's not empty, add it to the vector:
-                        std::string currentSymbolName = pCurrentSymbolName;
-
-                        if (!currentSymbolName.empty())
-                        {
-                            o_symbolNames.push_back(currentSymbolName);
-                        }
-                    }
-
-                    // Move the pointer ahead:
-                    pCurrentSymbol++;
+                    o_symbolNames.push_back(pCurrentSymbolName);
                 }
+
+                // Move the pointer ahead:
+                pCurrentSymbol++;
             }
-            else if (isElf64Binary())
+        }
+        else if (isElf64Binary())
+        {
+            int numberOfSymbols = (int)(symTabSection.m_binarySize / sizeof(Elf64_Sym));
+            const Elf64_Sym* pCurrentSymbol = (const Elf64_Sym*)symTabSection.m_pBinaryData;
+
+            for (int i = 0; i < numberOfSymbols; i++)
             {
-                int numberOfSymbols = (int)(symTabSection.m_binarySize / sizeof(Elf64_Sym));
-                Elf64_Sym* pCurrentSymbol = (Elf64_Sym*)symTabSection.m_pBinaryData;
+                // Get the symbol name as a string:
+                const char* pCurrentSymbolName = GetElfStringTableEntry(symStrTabSection, (size_t)pCurrentSymbol->st_name);
 
-                for (int i = 0; i < numberOfSymbols; i++)
+                // If it's not empty, add it to the vector:
+                if ((nullptr != pCurrentSymbolName) && ('\0' != pCurrentSymbolName[0]))
                 {
-                    // Get the symbol name as a string:
-                    char* pCurrentSymbolName = elf_strptr(pContainerElf, symbolStringTableIndex, pCurrentSymbol->st_name);
-
-                    if (nullptr != pCurrentSymbolName)
-                    {
-                        // If it's not empty, add it to the vector:
-                        std::string currentSymbolName = pCurrentSymbolName;
-
-                        if (!currentSymbolName.empty())
-                        {
-                            o_symbolNames.push_back(currentSymbolName);
-                        }
-                    }
-
-                    // Move the pointer ahead:
-                    pCurrentSymbol++;
+                    o_symbolNames.push_back(pCurrentSymbolName);
                 }
+
+                // Move the pointer ahead:
+                pCurrentSymbol++;
             }
         }
     }
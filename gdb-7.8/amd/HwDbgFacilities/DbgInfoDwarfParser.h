@@ -21,6 +21,7 @@ typedef struct _Dwarf_Die* Dwarf_Die;
 #include <dwarf.h>
 
 /// STL:
+#include <map>
 #include <string>
 #include <vector>
 
@@ -66,7 +67,10 @@ enum PointerAddressSpace
 
 /// -----------------------------------------------------------------------------------------------
 /// \struct KernelBinary
-/// \brief Description: A simple structure for holding a chunk of memory and its size
+/// \brief Description: A simple structure for holding a chunk of memory and its size.
+///                     The binary either owns a copy of the memory or is a view borrowing memory
+///                     owned by someone else (e.g. a section of another binary), in which case
+///                     the owner must outlive the view. Copies of a view are views themselves.
 /// -----------------------------------------------------------------------------------------------
 struct DBGINF_API KernelBinary
 {
@@ -83,7 +87,12 @@ public:
     KernelBinary& operator=(KernelBinary&& other);
 #endif
 
+    /// Copy the buffer, the binary owns the copy:
     void setBinary(void* pBinaryData, size_t binarySize);
+    /// Borrow the buffer without copying it:
+    void setBinaryView(const void* pBinaryData, size_t binarySize);
+    /// Is this a view of memory owned by someone else:
+    bool isBinaryView() const { return !m_ownsBinaryData; };
 
     /// Check conformance to ELF classes:
     bool isElf32Binary() const;
@@ -108,6 +117,30 @@ public:
 
     void* m_pBinaryData; ///< A buffer containing the elf binary data
     size_t m_binarySize; ///< The size of the buffer
+
+private:
+    /// An ELF section, by its location in the buffer:
+    struct ElfSectionEntry
+    {
+        std::string m_name;
+        size_t m_offset;
+        size_t m_size;
+        int m_link;
+        bool m_hasData;
+    };
+
+    void releaseBinary();
+    bool buildElfSectionTable() const;
+    bool getElfSectionEntryAsBinary(const ElfSectionEntry& section, KernelBinary& o_sectionAsBinary) const;
+    bool getElfSymbolTable(KernelBinary& o_symTabSection, KernelBinary& o_symStrTabSection) const;
+
+    bool m_ownsBinaryData; ///< Do we need to release the buffer
+
+    /// The section headers, indexed by the ELF section index. Built by the first ELF query:
+    mutable std::vector<ElfSectionEntry> m_elfSections;
+    /// Section name -> index in m_elfSections, the first section wins if a name repeats:
+    mutable std::map<std::string, size_t> m_elfSectionsByName;
+    mutable bool m_wasElfSectionTableBuilt;
 };
 
 /// -----------------------------------------------------------------------------------------------
@@ -190,6 +223,22 @@ public:
     HwDbgUInt64 m_locationResource; ///< The ALU which this variable is mapped to*/
 };
 
+/// -----------------------------------------------------------------------------------------------
+/// \struct DwarfParseTimings
+/// \brief Description: The time, in microseconds, spent in each phase of InitializeWithBinary
+/// -----------------------------------------------------------------------------------------------
+struct DBGINF_API DwarfParseTimings
+{
+public:
+    DwarfParseTimings() : m_initUs(0), m_codeScopeUs(0), m_lineMappingUs(0), m_addressMappingUs(0), m_totalUs(0) {};
+
+    HwDbgUInt64 m_initUs;           ///< Opening the ELF and DWARF handles
+    HwDbgUInt64 m_codeScopeUs;      ///< FillCodeScopeFromDwarf over the CU
+    HwDbgUInt64 m_lineMappingUs;    ///< FillLineMappingFromDwarf and finalizing the mapping
+    HwDbgUInt64 m_addressMappingUs; ///< Mapping the addresses to the code scopes and indexing them
+    HwDbgUInt64 m_totalUs;          ///< All of the above
+};
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 /// \class DbgInfoDwarfParser
 /// \brief Description: Used to convert Dwarf to DbgInfo Structures, all methods are static, this class should only be used to parse the data
@@ -217,19 +266,20 @@ public:
     typedef DwarfVariableInfo::VariableIndirection DwarfVariableIndirectionType;
     //@}
     /// The main function - fills the scope and line mapping from the binary, the filepath, if provided, is the path to the file from which the source was taken
-    static bool InitializeWithBinary(const KernelBinary& kernelBinary, DwarfCodeScope& o_scope, DwarfLineMapping& o_lineNumberMapping, const std::string& firstSourceFileRealPath = "");
+    /// If parallelSubprograms is true, the subprograms of the CU are parsed by a pool of threads, each with its own libDWARF handle
+    static bool InitializeWithBinary(const KernelBinary& kernelBinary, DwarfCodeScope& o_scope, DwarfLineMapping& o_lineNumberMapping, const std::string& firstSourceFileRealPath = "", bool parallelSubprograms = false, DwarfParseTimings* o_pTimings = nullptr);
     /// Given a scope, return all the locations of the variables whose type is REGISTER in the scope
     static bool ListVariableRegisterLocations(const DwarfCodeScope* pTopScope, std::vector<DwarfAddrType>& variableLocations);
 
 private:
     /// Fills the variable info from DWARF, also returns a vector of additional location in case of several instances of the variable
-    static void FillVariableWithInformationFromDIE(Dwarf_Die variableDIE, Dwarf_Debug pDwarf, bool isMember, DwarfVariableInfo& o_variableData, std::vector<DwarfVariableLocation>& o_variableAdditionalLocations);
+    static void FillVariableWithInformationFromDIE(Dwarf_Die variableDIE, Dwarf_Debug pDwarf, bool isMember, DwarfVariableInfo& o_variableData, std::vector<DwarfVariableLocation>& o_variableAdditionalLocations, size_t memberIndex = 0);
     /// Fills various fields of a variable
     static void FillTypeNameAndDetailsFromTypeDIE(Dwarf_Die typeDIE, Dwarf_Debug pDwarf, bool expandIndirectMembers, bool isRegisterParamter, DwarfVariableInfo& o_variable);
     /// Fills the LineNumberMapping from DWARF
     static bool FillLineMappingFromDwarf(Dwarf_Die cuDIE, const std::string& firstSourceFileRealPath, Dwarf_Debug pDwarf, DwarfLineMapping& o_lineNumberMapping);
-    /// Fills the Scope from DWARF
-    static void FillCodeScopeFromDwarf(Dwarf_Die programDIE, const std::string& firstSourceFileRealPath, Dwarf_Debug pDwarf, DwarfCodeScope* pParentScope, const DwarfCodeScopeType& scopeType, DwarfCodeScope& o_scope);
+    /// Fills the Scope from DWARF, pParallelBinary is the binary to parse the child subprograms from in parallel, if any
+    static void FillCodeScopeFromDwarf(Dwarf_Die programDIE, const std::string& firstSourceFileRealPath, Dwarf_Debug pDwarf, DwarfCodeScope* pParentScope, const DwarfCodeScopeType& scopeType, DwarfCodeScope& o_scope, const KernelBinary* pParallelBinary = nullptr);
     /// Fills the address ranges from DWARF
     static void FillAddressRanges(Dwarf_Die programDIE, Dwarf_Debug pDwarf, DwarfCodeScope& o_scope);
     /// Fills the scope name from DWARF
@@ -241,7 +291,9 @@ private:
     /// In case this is an inlined function, fill the Inlined data which is the line in which the function is defined, from DWARF
     static void FillInlinedFunctionData(Dwarf_Die programDIE, const std::string& firstSourceFileRealPath, Dwarf_Debug pDwarf, DwarfCodeScope& o_scope);
     /// Fills the child scopes recursively
-    static void FillChildren(Dwarf_Die programDIE, const std::string& firstSourceFileRealPath, Dwarf_Debug pDwarf, DwarfCodeScope& o_scope);
+    static void FillChildren(Dwarf_Die programDIE, const std::string& firstSourceFileRealPath, Dwarf_Debug pDwarf, DwarfCodeScope& o_scope, const KernelBinary* pParallelBinary = nullptr);
+    /// Fills the subprograms found by FillChildren into their placeholders in the scope's children, each thread with its own libDWARF handle
+    static void FillSubprogramsInParallel(const KernelBinary& kernelBinary, const std::vector<Dwarf_Off>& subprogramOffsets, const std::vector<size_t>& childIndices, const std::string& firstSourceFileRealPath, DwarfCodeScope& o_scope);
     /// Fills the Indirection of a variable from DWARF
     static void FillVarIndirectionDetails(Dwarf_Die variableDIE, DwarfVariableInfo& o_variable);
     /// Fills the Encoding of a variable from DWARF
@@ -251,9 +303,15 @@ private:
     /// Fills the const value of a variable from DWARF (if it is const)
     static void FillConstValue(Dwarf_Die variableDIE, Dwarf_Debug pDwarf, DwarfVariableInfo& o_variable);
     /// Create the name of a variable from type from DWARF
-    static void CreateVarNameFromType(Dwarf_Die typeDIE, DwarfVariableInfo& o_variable);
+    static void CreateVarNameFromType(Dwarf_Die typeDIE, size_t memberIndex, DwarfVariableInfo& o_variable);
     /// Add a child scope from DWARF
     static void AddChildScope(Dwarf_Die childDIE, const std::string& firstSourceFileRealPath, Dwarf_Debug pDwarf, const DwarfCodeScopeType& childScopeType, DwarfCodeScope& o_scope);
+    /// Create a child scope from DWARF, returns nullptr if the DIE should not be added to the scope
+    static DwarfCodeScope* CreateChildScope(Dwarf_Die childDIE, const std::string& firstSourceFileRealPath, Dwarf_Debug pDwarf, const DwarfCodeScopeType& childScopeType, DwarfCodeScope& o_scope);
+    /// Open the ELF and DWARF handles of a binary and move to its first CU
+    static bool OpenDwarf(const KernelBinary& kernelBinary, Elf*& o_pElf, Dwarf_Debug& o_pDwarf);
+    /// Release the handles opened by OpenDwarf
+    static void CloseDwarf(Elf*& io_pElf, Dwarf_Debug& io_pDwarf);
     /// Get the variable type from DWARF
     static DwarfVariableValueType GetVariableValueTypeFromTAG(int dwarfTAG);
     /// Get the scope type from DWARF tag
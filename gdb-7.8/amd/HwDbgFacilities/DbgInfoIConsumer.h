@@ -95,11 +95,31 @@ public:
         return (nullptr != matchData) ? (var.CanMatchMemberName(*(const std::string*)matchData, pFoundMember)) : false;
     };
 
-    /// Given an address and a variable name returns the corresponding variable info, using the above (implementation-specific) overload
-    bool GetVariableInfoInCurrentScope(const AddrType& startAddr, const std::string& variableName, ConsumedVariableInfo& o_variable) const
+    /// Variable matching function for the BRIG offset field:
+    static bool MatchVariableByBrigOffset(const ConsumedVariableInfo& var, const void* matchData, const ConsumedVariableInfo*& pFoundMember)
+    {
+        bool retVal = (nullptr != matchData) ? (var.m_brigOffset == *(const unsigned int*)matchData) : false;
+
+        if (retVal)
+        {
+            pFoundMember = &var;
+        }
+
+        return retVal;
+    };
+
+    /// Given an address and a variable name returns the corresponding variable info. By default this uses the above (implementation-specific) overload,
+    /// implementations that index their variables by name override it:
+    virtual bool GetVariableInfoInCurrentScope(const AddrType& startAddr, const std::string& variableName, ConsumedVariableInfo& o_variable) const
     {
         return GetMatchingVariableInfoInCurrentScope(startAddr, MatchVariableByName, (const void*)(&variableName), o_variable);
     };
+
+    /// Given an address and a BRIG offset returns the corresponding variable info, by default also using the matching overload:
+    virtual bool GetVariableInfoByBrigOffsetInCurrentScope(const AddrType& startAddr, unsigned int brigOffset, ConsumedVariableInfo& o_variable) const
+    {
+        return GetMatchingVariableInfoInCurrentScope(startAddr, MatchVariableByBrigOffset, (const void*)(&brigOffset), o_variable);
+    };
 };
 } // namespace HwDbg
 #endif //__DBGINFOICONSUMER_H
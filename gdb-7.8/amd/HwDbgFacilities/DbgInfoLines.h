@@ -22,7 +22,7 @@
 #include <DbgInfoDefinitions.h>
 
 /// STL:
-#include <map>
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -90,10 +90,13 @@ template <typename AddrType, typename LineType> class LineNumberMapping
 public:
     /// Constructor: Set the number of lines/addresses to read back/forward when searching
     LineNumberMapping(int addrReadAhead = DIL_DEFAULT_ADDR_READAHEAD, int addrReadBack = DIL_DEFAULT_ADDR_READBACK, int lineReadAhead = DIL_DEFAULT_LINE_READAHEAD, int lineReadBack = DIL_DEFAULT_LINE_READBACK)
-        : m_addrReadAhead(addrReadAhead), m_addrReadBack(addrReadBack), m_lineReadAhead(lineReadAhead), m_lineReadBack(lineReadBack) {}
+        : m_isLineIndexBuilt(false), m_addrReadAhead(addrReadAhead), m_addrReadBack(addrReadBack), m_lineReadAhead(lineReadAhead), m_lineReadBack(lineReadBack) {}
     virtual ~LineNumberMapping() {};
     /// Given a line and an address, add them to the internal mappings
     bool AddLineMapping(const LineType& line, const AddrType& addr);
+    /// Build the line to addresses index and release the insertion buffers. Called once all the mappings were added,
+    /// the queries which need the index build it themselves if it was not called
+    void FinalizeMappings();
     /// Clear internal mappings
     void ClearMap();
     /// Gets the line mapped to the specified address and returns it as an out param, return false if not found
@@ -112,20 +115,45 @@ public:
     bool GetNearestMappedAddress(const AddrType& addr, AddrType& o_mappedAddr) const;
 
 private:
-    /// 1:1 mapping of address to line
-    typedef std::map<AddrType, LineType> atlMap;
-    /// 1:N mapping of line to addresses
-    typedef std::map<LineType, std::vector<AddrType> > ltaMap;
+    /// Index into m_mappedLines
+    typedef unsigned int LineIndex;
+    /// Orders line indices by the lines they refer to
+    struct LineIndexLess
+    {
+        LineIndexLess(const std::vector<LineType>& lines) : m_lines(lines) {};
+        bool operator()(LineIndex lineIndex, const LineType& line) const { return m_lines[lineIndex] < line; };
+        const std::vector<LineType>& m_lines;
+    };
     /// Disallow use of assignment operator
     LineNumberMapping& operator=(const LineNumberMapping& other);
     /// Disallow use of copy constructor:
     LineNumberMapping(const LineNumberMapping& other);
 
-    atlMap m_addrToLine;                ///< 1:1 Mapping of AddrType toLineType
-    ltaMap m_lineToAddr;                ///< 1:N Mapping of LineType to AddrType
-    std::vector<AddrType> m_mappedAddrs;        ///< Vector of all mapped addresses
-    std::vector<AddrType> m_mappedFirstAddrs;   ///< Vector of all mapped first addresses
-    std::vector<LineType> m_mappedLines;        ///< Vector of all mapped lines
+    /// Find a line in m_mappedLines, return false if it is not mapped
+    bool FindLineIndex(const LineType& line, LineIndex& o_lineIndex) const;
+    /// Build the line to addresses index from the insertion buffers
+    void BuildLineIndex() const;
+    /// Move the line to addresses index back into the insertion buffers, so more mappings can be added
+    void ReopenLineIndex();
+    /// Get the value nearest to value within the read ahead / read back window, given the first mapped value
+    /// not smaller than it and the last mapped value smaller than it (either may be nullptr)
+    template<typename ValueType>
+    static const ValueType* GetNearestInWindow(const ValueType& value, const ValueType* pNext, const ValueType* pPrev, int readAhead, int readBack);
+
+    /// Lines, in the order they were first mapped. The other members refer to lines by their index in this vector:
+    std::vector<LineType> m_mappedLines;
+    std::vector<LineIndex> m_sortedLineIndices;             ///< Indices of m_mappedLines, sorted by line
+    /// 1:1 Mapping of AddrType to LineType, as two columns sorted by address:
+    std::vector<AddrType> m_sortedAddrs;
+    std::vector<LineIndex> m_sortedAddrLineIndices;
+    /// 1:N Mapping of LineType to AddrType. The addresses of line i are m_lineAddrs[m_lineAddrOffsets[i]] up
+    /// to m_lineAddrs[m_lineAddrOffsets[i + 1]], in the order they were added. Built by BuildLineIndex:
+    mutable std::vector<unsigned int> m_lineAddrOffsets;
+    mutable std::vector<AddrType> m_lineAddrs;
+    /// The mappings added since the index was last built, in the order they were added:
+    mutable std::vector<AddrType> m_addedAddrs;
+    mutable std::vector<LineIndex> m_addedAddrLineIndices;
+    mutable bool m_isLineIndexBuilt;                        ///< Are m_lineAddrOffsets and m_lineAddrs up to date
     const int m_addrReadAhead;          ///< Number of addresses to look ahead - Default is DIL_DEFAULT_ADDR_READAHEAD
     const int m_addrReadBack;           ///< Number of addresses to look back - Default is DIL_DEFAULT_ADDR_READBACK
     const int m_lineReadAhead;          ///< Number of lines to look ahead - Default is DIL_DEFAULT_LINE_READAHEAD
@@ -173,56 +201,52 @@ public:
 /// \brief Description: Add a line to address mapping
 /// \param[in]          line - The line
 /// \param[in]          addr - The address
-/// \return True if :   We are trying to add a new address
-/// \return False if:   We have already added this address
+/// \return True if :   We are trying to add a new address, or the address is already mapped to this line
+/// \return False if:   We have already mapped this address to a different line
 /// -----------------------------------------------------------------------------------------------
 template<typename AddrType, typename LineType>
 bool LineNumberMapping<AddrType, LineType>::AddLineMapping(const LineType& line, const AddrType& addr)
 {
     bool retVal = false;
-    typename atlMap::iterator firstMapFindIter = m_addrToLine.find(addr);
-    typename atlMap::iterator firstMapEndIter = m_addrToLine.end();
-    bool isNewAddr = (firstMapEndIter == firstMapFindIter);
+
+    // Line tables are mostly emitted in address order, so this is usually an insertion at the end:
+    typename std::vector<AddrType>::iterator addrIter = std::lower_bound(m_sortedAddrs.begin(), m_sortedAddrs.end(), addr);
+    bool isNewAddr = (m_sortedAddrs.end() == addrIter) || (addr < *addrIter);
 
     // An address may only be mapped once!:
     if (isNewAddr)
     {
         retVal = true;
-        // Add address to the vector of mapped addresses:
-        m_mappedAddrs.push_back(addr);
 
-        // Add address to line the mapping:
-        m_addrToLine[addr] = line;
+        if (m_isLineIndexBuilt)
+        {
+            ReopenLineIndex();
+        }
 
-        typename ltaMap::iterator secondMapFindIter = m_lineToAddr.find(line);
-        typename ltaMap::iterator secondMapEndIter = m_lineToAddr.end();
-        bool isNewLine = (secondMapEndIter == secondMapFindIter);
+        LineIndex lineIndex = 0;
 
-        //If we have a new line, we need to add it to the lines vector and initialize a new address vector for this specific line:
-        if (isNewLine)
+        //If we have a new line, we need to add it to the lines vector and to the sorted line indices:
+        if (!FindLineIndex(line, lineIndex))
         {
-            // Add Line to vector:
+            lineIndex = (LineIndex)m_mappedLines.size();
+            m_sortedLineIndices.insert(std::lower_bound(m_sortedLineIndices.begin(), m_sortedLineIndices.end(), line, LineIndexLess(m_mappedLines)), lineIndex);
             m_mappedLines.push_back(line);
+        }
 
-            // This is a new "first" address:
-            m_mappedFirstAddrs.push_back(addr);
+        // Add address to line the mapping:
+        size_t addrPos = addrIter - m_sortedAddrs.begin();
+        m_sortedAddrs.insert(addrIter, addr);
+        m_sortedAddrLineIndices.insert(m_sortedAddrLineIndices.begin() + addrPos, lineIndex);
 
-            // Create & initialize new addresses vector for the new line:
-            std::vector<AddrType> addressesMappedToLine;
-            addressesMappedToLine.push_back(addr);
-            m_lineToAddr[line] = addressesMappedToLine;
-        }
-        else // If this is not a new line, add the address to the existing line's address vector
-        {
-            secondMapFindIter->second.push_back(addr);
-        }
+        m_addedAddrs.push_back(addr);
+        m_addedAddrLineIndices.push_back(lineIndex);
     }
     else // !isNewAddr
     {
         // If the address is already mapped, return success if it's simply a duplicate mapping to the same line number.
         // Since we enforce a one-to-many relation of line to addresses, any other value means information is discarded,
         // so we will consider it a failure:
-        if (firstMapFindIter->second == line)
+        if (m_mappedLines[m_sortedAddrLineIndices[addrIter - m_sortedAddrs.begin()]] == line)
         {
             retVal = true;
         }
@@ -231,6 +255,25 @@ bool LineNumberMapping<AddrType, LineType>::AddLineMapping(const LineType& line,
     return retVal;
 };
 
+/// -----------------------------------------------------------------------------------------------
+/// FinalizeMappings
+/// \brief Description: Builds the line to addresses index and releases the insertion buffers
+/// -----------------------------------------------------------------------------------------------
+template<typename AddrType, typename LineType>
+void LineNumberMapping<AddrType, LineType>::FinalizeMappings()
+{
+    if (!m_isLineIndexBuilt)
+    {
+        BuildLineIndex();
+    }
+
+    // The lines and addresses will not grow anymore:
+    m_mappedLines.shrink_to_fit();
+    m_sortedLineIndices.shrink_to_fit();
+    m_sortedAddrs.shrink_to_fit();
+    m_sortedAddrLineIndices.shrink_to_fit();
+};
+
 /// -----------------------------------------------------------------------------------------------
 /// ClearMap
 /// \brief Description: Clears the mappings
@@ -238,11 +281,15 @@ bool LineNumberMapping<AddrType, LineType>::AddLineMapping(const LineType& line,
 template<typename AddrType, typename LineType>
 void LineNumberMapping<AddrType, LineType>::ClearMap()
 {
-    m_addrToLine.clear();
-    m_lineToAddr.clear();
-    m_mappedAddrs.clear();
-    m_mappedFirstAddrs.clear();
     m_mappedLines.clear();
+    m_sortedLineIndices.clear();
+    m_sortedAddrs.clear();
+    m_sortedAddrLineIndices.clear();
+    m_lineAddrOffsets.clear();
+    m_lineAddrs.clear();
+    m_addedAddrs.clear();
+    m_addedAddrLineIndices.clear();
+    m_isLineIndexBuilt = false;
 };
 
 /// -----------------------------------------------------------------------------------------------
@@ -258,13 +305,12 @@ bool LineNumberMapping<AddrType, LineType>::GetLineFromAddress(const AddrType& a
 {
     bool retVal = false;
 
-    typename atlMap::const_iterator findIter = m_addrToLine.find(addr);
-    typename atlMap::const_iterator endIter = m_addrToLine.end();
+    typename std::vector<AddrType>::const_iterator findIter = std::lower_bound(m_sortedAddrs.begin(), m_sortedAddrs.end(), addr);
 
-    if (endIter != findIter)
+    if ((m_sortedAddrs.end() != findIter) && !(addr < *findIter))
     {
         retVal = true;
-        o_line = findIter->second;
+        o_line = m_mappedLines[m_sortedAddrLineIndices[findIter - m_sortedAddrs.begin()]];
     }
 
     return retVal;
@@ -272,7 +318,7 @@ bool LineNumberMapping<AddrType, LineType>::GetLineFromAddress(const AddrType& a
 
 /// -----------------------------------------------------------------------------------------------
 /// GetAddressesFromLine
-/// \brief Description: Gets the addresses mapped to the current line
+/// \brief Description: Gets the addresses mapped to the current line, in the order they were mapped
 /// \param[in]          line - the line for which to retrieve the addresses
 /// \param[out]         o_addrs - the vector of addresses mapped to the line
 /// \param[in]          append - Whether to append to the received vector (Default: true)
@@ -287,20 +333,18 @@ bool LineNumberMapping<AddrType, LineType>::GetAddressesFromLine(const LineType&
         o_addrs.clear();
     }
 
-    typename ltaMap::const_iterator findIter = m_lineToAddr.find(line);
-    typename ltaMap::const_iterator endIter = m_lineToAddr.end();
+    LineIndex lineIndex = 0;
 
     // If this line has valid addresses:
-    if (endIter != findIter)
+    if (FindLineIndex(line, lineIndex))
     {
-        // Add the addresses to the output parameter:
-        const std::vector<AddrType>& addrs = findIter->second;
-        int numOfAddrs = (int)addrs.size();
-
-        for (int i = 0; i < numOfAddrs; i++)
+        if (!m_isLineIndexBuilt)
         {
-            o_addrs.push_back(addrs[i]);
+            BuildLineIndex();
         }
+
+        // Add the addresses to the output parameter:
+        o_addrs.insert(o_addrs.end(), m_lineAddrs.begin() + m_lineAddrOffsets[lineIndex], m_lineAddrs.begin() + m_lineAddrOffsets[lineIndex + 1]);
     }
 
     // Return true if we have at least one mapped address:
@@ -309,7 +353,7 @@ bool LineNumberMapping<AddrType, LineType>::GetAddressesFromLine(const LineType&
 
 /// -----------------------------------------------------------------------------------------------
 /// GetMappedLines
-/// \brief Description: Return all the lines which are mapped to addresses
+/// \brief Description: Return all the lines which are mapped to addresses, in the order they were first mapped
 /// \param[out]         o_lines - mapped lines
 /// \return True : If at least one line was found
 /// \return False: Otherwise
@@ -317,22 +361,14 @@ bool LineNumberMapping<AddrType, LineType>::GetAddressesFromLine(const LineType&
 template<typename AddrType, typename LineType>
 bool LineNumberMapping<AddrType, LineType>::GetMappedLines(std::vector<LineType>& o_lines) const
 {
-    o_lines.clear();
-
-    // Get lines from mapped lines vector
-    int numberOfMappedLines = (int)m_mappedLines.size();
-
-    for (int i = 0; i < numberOfMappedLines; i++)
-    {
-        o_lines.push_back(m_mappedLines[i]);
-    }
+    o_lines = m_mappedLines;
 
     return (0 != o_lines.size());
 };
 
 /// -----------------------------------------------------------------------------------------------
 /// GetMappedAddresses
-/// \brief Description: Return all the addresses which are mapped to lines
+/// \brief Description: Return all the addresses which are mapped to lines, sorted by address
 /// \param[out]         o_addrs - Mapped addresses
 /// \return True : If at least one address was found
 /// \return False: Otherwise
@@ -340,15 +376,7 @@ bool LineNumberMapping<AddrType, LineType>::GetMappedLines(std::vector<LineType>
 template<typename AddrType, typename LineType>
 bool LineNumberMapping<AddrType, LineType>::GetMappedAddresses(std::vector<AddrType>& o_addrs) const
 {
-    o_addrs.clear();
-
-    // Get addresses from mapped addresses vector
-    int numberOfMappedAddrs = (int)m_mappedAddrs.size();
-
-    for (int i = 0; i < numberOfMappedAddrs; i++)
-    {
-        o_addrs.push_back(m_mappedAddrs[i]);
-    }
+    o_addrs = m_sortedAddrs;
 
     return (0 != o_addrs.size());
 };
@@ -365,12 +393,18 @@ bool LineNumberMapping<AddrType, LineType>::GetMappedFirstAddresses(std::vector<
 {
     o_addrs.clear();
 
-    // Get addresses from mapped addresses vector
-    int numberOfMappedAddrs = (int)m_mappedFirstAddrs.size();
+    if (!m_isLineIndexBuilt)
+    {
+        BuildLineIndex();
+    }
+
+    // Every mapped line has at least one address, the first one starts its range:
+    size_t numberOfMappedLines = m_mappedLines.size();
+    o_addrs.reserve(numberOfMappedLines);
 
-    for (int i = 0; i < numberOfMappedAddrs; i++)
+    for (size_t i = 0; i < numberOfMappedLines; i++)
     {
-        o_addrs.push_back(m_mappedFirstAddrs[i]);
+        o_addrs.push_back(m_lineAddrs[m_lineAddrOffsets[i]]);
     }
 
     return (0 != o_addrs.size());
@@ -390,53 +424,16 @@ bool LineNumberMapping<AddrType, LineType>::GetNearestMappedLine(const LineType&
 {
     bool retVal = false;
 
-    LineType foundLine = line;
-    typename ltaMap::const_iterator endIter = m_lineToAddr.end();
+    typename std::vector<LineIndex>::const_iterator nextIter = std::lower_bound(m_sortedLineIndices.begin(), m_sortedLineIndices.end(), line, LineIndexLess(m_mappedLines));
+    const LineType* pNextLine = (m_sortedLineIndices.end() != nextIter) ? &m_mappedLines[*nextIter] : nullptr;
+    const LineType* pPrevLine = (m_sortedLineIndices.begin() != nextIter) ? &m_mappedLines[*(nextIter - 1)] : nullptr;
 
-    // First, try to read ahead - including current line:
-    for (int i = 0; i < m_lineReadAhead; i++)
-    {
-        // Check if the current line has a mapping:
-        typename ltaMap::const_iterator findIter = m_lineToAddr.find(foundLine);
-
-        if (endIter != findIter)
-        {
-            retVal = true;
-            o_mappedLine = foundLine;
-            break;
-        }
-
-        ++foundLine;
-    }
+    const LineType* pFoundLine = GetNearestInWindow(line, pNextLine, pPrevLine, m_lineReadAhead, m_lineReadBack);
 
-    // After m_lineReadAhead steps, if we have not found a mapped line, start looking back behind the line:
-    if (!retVal)
+    if (nullptr != pFoundLine)
     {
-        // Do not include the original line:
-        foundLine = line;
-        -- foundLine;
-
-        for (int i = 1; i < m_lineReadBack; i++)
-        {
-            // Check if the current line has a mapping:
-            typename ltaMap::const_iterator findIter = m_lineToAddr.find(foundLine);
-
-            if (endIter != findIter)
-            {
-                retVal = true;
-                o_mappedLine = foundLine;
-                break;
-            }
-
-            // If we have reached the beginning - Line is supposed to be false at the beginning:
-            if (!foundLine)
-            {
-                break;
-            }
-
-            // decrement line:
-            --foundLine;
-        }
+        retVal = true;
+        o_mappedLine = *pFoundLine;
     }
 
     return retVal;
@@ -456,54 +453,156 @@ bool LineNumberMapping<AddrType, LineType>::GetNearestMappedAddress(const AddrTy
 {
     bool retVal = false;
 
-    AddrType foundAddr = addr;
-    typename atlMap::const_iterator endIter = m_addrToLine.end();
+    typename std::vector<AddrType>::const_iterator nextIter = std::lower_bound(m_sortedAddrs.begin(), m_sortedAddrs.end(), addr);
+    const AddrType* pNextAddr = (m_sortedAddrs.end() != nextIter) ? &*nextIter : nullptr;
+    const AddrType* pPrevAddr = (m_sortedAddrs.begin() != nextIter) ? &*(nextIter - 1) : nullptr;
 
-    // Look ahead for the address:
-    for (int i = 0; i < m_addrReadAhead; i++)
+    const AddrType* pFoundAddr = GetNearestInWindow(addr, pNextAddr, pPrevAddr, m_addrReadAhead, m_addrReadBack);
+
+    if (nullptr != pFoundAddr)
     {
-        typename atlMap::const_iterator findIter = m_addrToLine.find(foundAddr);
+        retVal = true;
+        o_mappedAddr = *pFoundAddr;
+    }
 
-        // If we have found the address:
-        if (endIter != findIter)
+    return retVal;
+};
+
+/// -----------------------------------------------------------------------------------------------
+/// FindLineIndex
+/// \brief Description: Binary search for a line in the sorted line indices
+/// \param[in]          line - The line to look for
+/// \param[out]         o_lineIndex - The index of the line in m_mappedLines
+/// \return True : If the line is mapped
+/// \return False: Otherwise
+/// -----------------------------------------------------------------------------------------------
+template<typename AddrType, typename LineType>
+bool LineNumberMapping<AddrType, LineType>::FindLineIndex(const LineType& line, LineIndex& o_lineIndex) const
+{
+    bool retVal = false;
+
+    typename std::vector<LineIndex>::const_iterator findIter = std::lower_bound(m_sortedLineIndices.begin(), m_sortedLineIndices.end(), line, LineIndexLess(m_mappedLines));
+
+    if ((m_sortedLineIndices.end() != findIter) && !(line < m_mappedLines[*findIter]))
+    {
+        retVal = true;
+        o_lineIndex = *findIter;
+    }
+
+    return retVal;
+};
+
+/// -----------------------------------------------------------------------------------------------
+/// BuildLineIndex
+/// \brief Description: Counting sort of the added addresses by line, into m_lineAddrOffsets and
+/// m_lineAddrs. The addresses of each line keep the order in which they were added
+/// -----------------------------------------------------------------------------------------------
+template<typename AddrType, typename LineType>
+void LineNumberMapping<AddrType, LineType>::BuildLineIndex() const
+{
+    size_t numberOfMappedLines = m_mappedLines.size();
+    size_t numberOfAddedAddrs = m_addedAddrs.size();
+
+    // Count the addresses of each line, offset by one so the prefix sum yields the range starts:
+    m_lineAddrOffsets.assign(numberOfMappedLines + 1, 0);
+
+    for (size_t i = 0; i < numberOfAddedAddrs; i++)
+    {
+        m_lineAddrOffsets[m_addedAddrLineIndices[i] + 1]++;
+    }
+
+    for (size_t i = 0; i < numberOfMappedLines; i++)
+    {
+        m_lineAddrOffsets[i + 1] += m_lineAddrOffsets[i];
+    }
+
+    // Scatter the addresses into their line's range:
+    std::vector<unsigned int> nextSlot(m_lineAddrOffsets.begin(), m_lineAddrOffsets.end() - 1);
+    m_lineAddrs.resize(numberOfAddedAddrs);
+
+    for (size_t i = 0; i < numberOfAddedAddrs; i++)
+    {
+        m_lineAddrs[nextSlot[m_addedAddrLineIndices[i]]++] = m_addedAddrs[i];
+    }
+
+    // Release the insertion buffers:
+    std::vector<AddrType>().swap(m_addedAddrs);
+    std::vector<LineIndex>().swap(m_addedAddrLineIndices);
+    m_isLineIndexBuilt = true;
+};
+
+/// -----------------------------------------------------------------------------------------------
+/// ReopenLineIndex
+/// \brief Description: Moves the line to addresses index back into the insertion buffers, line by
+/// line. This keeps the order of each line's addresses, which is all BuildLineIndex preserves
+/// -----------------------------------------------------------------------------------------------
+template<typename AddrType, typename LineType>
+void LineNumberMapping<AddrType, LineType>::ReopenLineIndex()
+{
+    size_t numberOfMappedLines = m_mappedLines.size();
+
+    m_addedAddrs.swap(m_lineAddrs);
+    m_addedAddrLineIndices.resize(m_addedAddrs.size());
+
+    for (size_t i = 0; i < numberOfMappedLines; i++)
+    {
+        std::fill(m_addedAddrLineIndices.begin() + m_lineAddrOffsets[i], m_addedAddrLineIndices.begin() + m_lineAddrOffsets[i + 1], (LineIndex)i);
+    }
+
+    std::vector<AddrType>().swap(m_lineAddrs);
+    std::vector<unsigned int>().swap(m_lineAddrOffsets);
+    m_isLineIndexBuilt = false;
+};
+
+/// -----------------------------------------------------------------------------------------------
+/// GetNearestInWindow
+/// \brief Description: Checks the mapped values around a value against the search window. The window
+/// ahead is value and the (readAhead - 1) values following it, the window back is the (readBack - 1)
+/// values preceding value, stopping at the zero value. Values ahead are preferred.
+/// \param[in]          value - The value to look for
+/// \param[in]          pNext - The smallest mapped value not smaller than value, or nullptr
+/// \param[in]          pPrev - The largest mapped value smaller than value, or nullptr
+/// \param[in]          readAhead - The size of the window ahead
+/// \param[in]          readBack - The size of the window back, plus one
+/// \return The nearest mapped value in the window, nullptr if there is none
+/// -----------------------------------------------------------------------------------------------
+template<typename AddrType, typename LineType>
+template<typename ValueType>
+const ValueType* LineNumberMapping<AddrType, LineType>::GetNearestInWindow(const ValueType& value, const ValueType* pNext, const ValueType* pPrev, int readAhead, int readBack)
+{
+    const ValueType* retVal = nullptr;
+
+    // First, try to read ahead - including current value:
+    if ((nullptr != pNext) && (0 < readAhead))
+    {
+        ValueType lastInWindow = value;
+
+        for (int i = 1; i < readAhead; i++)
         {
-            // Return true and output the address:
-            retVal = true;
-            o_mappedAddr = foundAddr;
-            break;
+            ++lastInWindow;
         }
 
-        ++foundAddr;
+        if (!(lastInWindow < *pNext))
+        {
+            retVal = pNext;
+        }
     }
 
-    // If the address is not ahead, look behind:
-    if (!retVal)
+    // If we have not found a mapped value, look back - not including the current value:
+    if ((nullptr == retVal) && (nullptr != pPrev) && (1 < readBack))
     {
-        // Do not include the original address:
-        foundAddr = addr;
-        --foundAddr;
+        ValueType firstInWindow = value;
+        --firstInWindow;
+
+        // If we have reached the beginning - value is supposed to be false at the beginning:
+        for (int i = 2; (i < readBack) && firstInWindow; i++)
+        {
+            --firstInWindow;
+        }
 
-        for (int i = 1; i < m_addrReadBack; i++)
+        if (!(*pPrev < firstInWindow))
         {
-            typename atlMap::const_iterator findIter = m_addrToLine.find(foundAddr);
-
-            // If we have found the address:
-            if (endIter != findIter)
-            {
-                // Return true and output the address:
-                retVal = true;
-                o_mappedAddr = foundAddr;
-                break;
-            }
-
-            // If we have reached the beginning break- Address is supposed to be false at the beginning:
-            if (!foundAddr)
-            {
-                break;
-            }
-
-            // decrement Address:
-            --foundAddr;
+            retVal = pPrev;
         }
     }
 
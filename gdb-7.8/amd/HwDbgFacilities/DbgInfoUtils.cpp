@@ -9,8 +9,12 @@
 #include <DbgInfoUtils.h>
 
 /// STL:
+#include <algorithm>
+#include <atomic>
 #include <string>
 #include <memory>
+#include <system_error>
+#include <thread>
 #include <stdarg.h>
 #include <string.h>
 
@@ -94,3 +98,53 @@ std::string& HwDbg::string_remove_trailing(std::string& str, char c)
 //@}
 
 
+
+//@{
+/// Helper function, runs tasks on a small pool of threads:
+void HwDbg::run_tasks_in_parallel(const std::vector<std::function<void()>>& tasks, unsigned int maxThreads)
+{
+    size_t taskCount = tasks.size();
+    std::atomic<size_t> nextTask(0);
+
+    // Each thread takes the next task until there are none left:
+    auto worker = [&tasks, &nextTask, taskCount]()
+    {
+        for (size_t i = nextTask++; i < taskCount; i = nextTask++)
+        {
+            tasks[i]();
+        }
+    };
+
+    // More threads than the hardware runs at once would only take turns:
+    unsigned int hardwareThreads = std::thread::hardware_concurrency();
+
+    if ((0 < hardwareThreads) && (hardwareThreads < maxThreads))
+    {
+        maxThreads = hardwareThreads;
+    }
+
+    size_t threadCount = std::min((size_t)std::max(1u, maxThreads), taskCount);
+    std::vector<std::thread> threads;
+
+    // The calling thread is one of the workers:
+    for (size_t i = 1; i < threadCount; i++)
+    {
+        try
+        {
+            threads.push_back(std::thread(worker));
+        }
+        catch (const std::system_error&)
+        {
+            // Could not create the thread, the other workers take its tasks:
+            break;
+        }
+    }
+
+    worker();
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+}
+//@}
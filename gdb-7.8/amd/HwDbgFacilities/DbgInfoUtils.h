@@ -12,7 +12,9 @@
 #include <DbgInfoDefinitions.h>
 
 // STL:
+#include <functional>
 #include <string>
+#include <vector>
 
 /// The HSA Device default name:
 #define HSA_DEVICE_STRING "HSA"
@@ -37,6 +39,9 @@ DBGINF_API std::string& string_prepend(std::string& str, std::string prefixStr);
 
 /// Helper function, removes trailing characters:
 DBGINF_API std::string& string_remove_trailing(std::string& str, char c);
+
+/// Helper function, runs the tasks on up to maxThreads threads (counting the calling thread) and returns when all of them are done:
+DBGINF_API void run_tasks_in_parallel(const std::vector<std::function<void()>>& tasks, unsigned int maxThreads);
 }
 
 #endif //__DBGINFOUTILS_H
@@ -6,8 +6,12 @@
 /// \brief Description: A simple test of a C interface to HwDbgFacilities
 //==============================================================================
 // C / C++:
+#include <atomic>
 #include <cassert>
+#include <cctype>
+#include <chrono>
 #include <cstdint>
+#include <functional>
 
 // Brig:
 #include <BrigSectionHeader.h>
@@ -77,31 +81,113 @@
 
 using namespace HwDbg;
 
+// The HWDBGINFO_PARSE_ options, see hwdbginfo_set_parse_options:
+static std::atomic<unsigned int> gs_parseOptions(HWDBGINFO_PARSE_DEFAULT);
+
+// Microseconds since the epoch of the steady clock, for the parse timings:
+static HwDbgUInt64 HwDbgInfoGetTimeUs()
+{
+    return (HwDbgUInt64)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
 // Shorthand typedefs:
 typedef DbgInfoIConsumer<HwDbgUInt64, FileLocation, DwarfVariableLocation> DbgInfoConsumerInterface;
 typedef DbgInfoConsumerImpl<HwDbgUInt64, FileLocation, DwarfVariableLocation> DbgInfoOneLevelConsumer;
 typedef DbgInfoCompoundConsumer<HwDbgUInt64, FileLocation, DwarfVariableLocation, HwDbgUInt64, DwarfVariableLocation, FileLocation> DbgInfoTwoLevelConsumer;
 typedef VariableInfo<HwDbgUInt64, DwarfVariableLocation> DbgInfoVariable;
 
+// Resolvers for the two-level debug information consumer, defined below:
+FileLocation HwDbgInfoAddressResolver(const HwDbgUInt64& hlAddr, void* dbg);
+HwDbgUInt64 HwDbgInfoLineResolver(const FileLocation& llLine, void* dbg);
+bool HwDbgInfoLocationResolver(const HwDbg::DwarfVariableLocation& hVarLoc, const HwDbgUInt64& lAddr, const HwDbg::DbgInfoIConsumer<HwDbgUInt64, HwDbg::FileLocation, HwDbg::DwarfVariableLocation>& lConsumer, HwDbg::DwarfVariableLocation& o_lVarLocation, void* dbg);
+
 // Helper structs:
+
+// A code object inside the binary. Only the cheap data is gathered when the binary is loaded,
+// the debug information is parsed the first time a query needs this module:
+struct HwDbgInfo_FacInt_Module
+{
+public:
+    // Ctor
+    HwDbgInfo_FacInt_Module(const std::string& name, const KernelBinary& hlBin) :
+        m_name(name), m_hlBin(hlBin), m_wasParsed(false), m_parseUs(0), tl_cn(nullptr) {};
+
+    // Dtor
+    ~HwDbgInfo_FacInt_Module()
+    {
+        // The two-level consumer owns the one-level consumers:
+        delete tl_cn; tl_cn = nullptr;
+    };
+
+    // Returns true if the HSAIL text of this module defines the kernel
+    bool DefinesKernel(const std::string& kernelName) const
+    {
+        size_t kernelCount = m_kernelNames.size();
+
+        for (size_t i = 0; i < kernelCount; i++)
+            if (m_kernelNames[i] == kernelName)
+            {
+                return true;
+            }
+
+        return false;
+    }
+
+    // The name of the code object section
+    const std::string m_name;
+
+    // The HL DWARF container, released once it is parsed. This is usually a view into the code object
+    KernelBinary m_hlBin;
+
+    // Was parsing attempted? tl_cn is nullptr if it failed
+    bool m_wasParsed;
+
+    // The time the HL parse took, and the time until both levels were parsed:
+    DwarfParseTimings m_hlTimings;
+    HwDbgUInt64 m_parseUs;
+
+    // High-level debug information
+    DbgInfoDwarfParser::DwarfCodeScope hl_sc;   // High-level variable debug info
+    DbgInfoDwarfParser::DwarfLineMapping hl_lm; // High-level line debug info
+
+    // Two-level debug information consumer, combining the two levels
+    DbgInfoTwoLevelConsumer* tl_cn;
+
+    // The "default" file name - or main CU file name. It is the first file mapped in the HL line table:
+    std::string m_firstMappedFileName;
+
+    // The HSAIL source found inside the code object, if any:
+    std::string m_hsailSource;
+
+    // The kernels defined in the HSAIL source, with their '&' prefix:
+    std::vector<std::string> m_kernelNames;
+
+private:
+    // Disallow copying, the consumers point into the scope and line mapping:
+    HwDbgInfo_FacInt_Module(const HwDbgInfo_FacInt_Module&) = delete;
+    HwDbgInfo_FacInt_Module& operator=(const HwDbgInfo_FacInt_Module&) = delete;
+};
+
 struct HwDbgInfo_FacInt_Debug
 {
 public:
     // Ctor
     HwDbgInfo_FacInt_Debug() :
-        hl_cn(nullptr), ll_cn(nullptr), ol_cn_owned(false), tl_cn(nullptr), llFileName(HWDBGFAC_INTERFACE_DUMMY_FILE_PATH), brig_code(nullptr, 0), brig_strtab(nullptr, 0) {};
+        m_codeObject(nullptr, 0), ll_cn(nullptr), m_llBin(nullptr, 0), m_wasLLParsed(false), llFileName(HWDBGFAC_INTERFACE_DUMMY_FILE_PATH), m_activeModule(0), brig_code(nullptr, 0), brig_strtab(nullptr, 0) {};
 
     // Dtor
     ~HwDbgInfo_FacInt_Debug()
     {
-        delete tl_cn; tl_cn = nullptr;
+        size_t moduleCount = m_modules.size();
 
-        if (ol_cn_owned)
+        for (size_t i = 0; i < moduleCount; i++)
         {
-            delete hl_cn; delete ll_cn;
+            delete m_modules[i];
         }
 
-        hl_cn = nullptr; ll_cn = nullptr;
+        m_modules.clear();
+
+        delete ll_cn; ll_cn = nullptr;
 
         size_t allocVarCount = m_allocatedVariableObjects.size();
 
@@ -113,6 +199,162 @@ public:
         m_allocatedVariableObjects.clear();
     };
 
+    // Parses the low-level debug information, which is shared by all the modules
+    bool ParseLowLevel()
+    {
+        if (!m_wasLLParsed)
+        {
+            m_wasLLParsed = true;
+
+            bool parallelSubprograms = (0 != (gs_parseOptions & HWDBGINFO_PARSE_PARALLEL_SUBPROGRAMS));
+
+            bool retVal = DbgInfoDwarfParser::InitializeWithBinary(m_llBin, ll_sc, ll_lm, llFileName, parallelSubprograms, &m_llTimings);
+
+            if (retVal)
+            {
+                ll_cn = new(std::nothrow) DbgInfoOneLevelConsumer;
+
+                if (nullptr != ll_cn)
+                {
+                    ll_cn->SetCodeScope(&ll_sc);
+                    ll_cn->SetLineNumberMap(&ll_lm);
+                }
+            }
+
+            // The parsed data does not refer to the container:
+            m_llBin.setBinary(nullptr, 0);
+        }
+
+        return (nullptr != ll_cn);
+    }
+
+    // Parses a module's high-level debug information and creates its consumers.
+    // Returns HWDBGINFO_E_SUCCESS if the module can be queried.
+    HwDbgInfo_err ParseModule(HwDbgInfo_FacInt_Module& module)
+    {
+        if (module.m_wasParsed)
+        {
+            return (nullptr != module.tl_cn) ? HWDBGINFO_E_SUCCESS : HWDBGINFO_E_HLINFO;
+        }
+
+        module.m_wasParsed = true;
+
+        unsigned int parseOptions = gs_parseOptions;
+        bool parallelSubprograms = (0 != (parseOptions & HWDBGINFO_PARSE_PARALLEL_SUBPROGRAMS));
+        HwDbgUInt64 parseStartUs = HwDbgInfoGetTimeUs();
+        bool retVal = false;
+
+        // Parse. The LL debug information is parsed with the first module, and as the two levels
+        // are independent DWARF containers, each parsed with its own libDWARF handles, they can be
+        // parsed at the same time:
+        auto parseHighLevel = [&]()
+        {
+            retVal = DbgInfoDwarfParser::InitializeWithBinary(module.m_hlBin, module.hl_sc, module.hl_lm, "", parallelSubprograms, &module.m_hlTimings);
+        };
+
+        if (!m_wasLLParsed && (0 != (parseOptions & HWDBGINFO_PARSE_PARALLEL_LEVELS)))
+        {
+            std::vector<std::function<void()>> parseTasks;
+            parseTasks.push_back(parseHighLevel);
+            parseTasks.push_back([this]() { ParseLowLevel(); });
+            run_tasks_in_parallel(parseTasks, 2);
+        }
+        else
+        {
+            parseHighLevel();
+        }
+
+        module.m_hlBin.setBinary(nullptr, 0);
+
+        if (!retVal)
+        {
+            return HWDBGINFO_E_HLINFO;
+        }
+
+        if (!ParseLowLevel())
+        {
+            return HWDBGINFO_E_LLINFO;
+        }
+
+        module.m_parseUs = HwDbgInfoGetTimeUs() - parseStartUs;
+
+        // Initialize consumers, the LL consumer of each module shares the LL debug info:
+        DbgInfoOneLevelConsumer* hl_cn = new(std::nothrow) DbgInfoOneLevelConsumer;
+        DbgInfoOneLevelConsumer* module_ll_cn = new(std::nothrow) DbgInfoOneLevelConsumer;
+
+        if (nullptr == hl_cn || nullptr == module_ll_cn)
+        {
+            delete hl_cn; delete module_ll_cn;
+            return HWDBGINFO_E_OUTOFMEMORY;
+        }
+
+        hl_cn->SetCodeScope(&module.hl_sc);
+        hl_cn->SetLineNumberMap(&module.hl_lm);
+        module_ll_cn->SetCodeScope(&ll_sc);
+        module_ll_cn->SetLineNumberMap(&ll_lm);
+
+        // Transfer ownership of the one-level consumers to the two-level consumer:
+        module.tl_cn = new(std::nothrow) DbgInfoTwoLevelConsumer(hl_cn, module_ll_cn, HwDbgInfoLocationResolver, HwDbgInfoAddressResolver, HwDbgInfoLineResolver, (void*)this);
+
+        if (nullptr == module.tl_cn)
+        {
+            delete hl_cn; delete module_ll_cn;
+            return HWDBGINFO_E_OUTOFMEMORY;
+        }
+
+        // Set the default file name:
+        std::vector<FileLocation> hl_fileLocs;
+        bool rcHLLM = module.hl_lm.GetMappedLines(hl_fileLocs);
+
+        if (rcHLLM)
+        {
+            size_t fileLocCount = hl_fileLocs.size();
+
+            for (size_t i = 0; i < fileLocCount; i++)
+            {
+                const std::string* currentFileName = hl_fileLocs[i].m_fullPath;
+
+                if (nullptr != currentFileName && !currentFileName->empty())
+                {
+                    module.m_firstMappedFileName = *currentFileName;
+                    break;
+                }
+            }
+        }
+
+        return HWDBGINFO_E_SUCCESS;
+    }
+
+    // Gets the module to run a query on: the active module is queried first (queryIndex 0), then
+    // the rest of the modules in order. The module is parsed if this is the first query to reach it.
+    // Returns nullptr when there are no more modules to query. The module's tl_cn is nullptr if it
+    // could not be parsed.
+    HwDbgInfo_FacInt_Module* GetQueryModule(size_t queryIndex)
+    {
+        size_t moduleCount = m_modules.size();
+
+        if (queryIndex >= moduleCount)
+        {
+            return nullptr;
+        }
+
+        size_t moduleIndex = queryIndex;
+
+        if (0 == queryIndex)
+        {
+            moduleIndex = m_activeModule;
+        }
+        else if (queryIndex <= m_activeModule)
+        {
+            moduleIndex = queryIndex - 1;
+        }
+
+        HwDbgInfo_FacInt_Module* pModule = m_modules[moduleIndex];
+        ParseModule(*pModule);
+
+        return pModule;
+    }
+
     // Adds a variable to the allocated variables list
     void AddVariable(DbgInfoTwoLevelConsumer::LowLvlVariableInfo* pVar)
     {
@@ -151,27 +393,27 @@ public:
         return retVal;
     }
 
-    // High-level debug information
-    DbgInfoDwarfParser::DwarfCodeScope hl_sc;   // High-level variable debug info
-    DbgInfoDwarfParser::DwarfLineMapping hl_lm; // High-level line debug info
-    DbgInfoOneLevelConsumer* hl_cn;             // High-level debug info consumer
+    // Our copy of the HSA code object. The modules' HL containers and the LL container are views into it
+    KernelBinary m_codeObject;
 
-    // Low-level debug information
+    // Low-level debug information, shared by all the modules
     DbgInfoDwarfParser::DwarfCodeScope ll_sc;   // Low-level variable debug info
     DbgInfoDwarfParser::DwarfLineMapping ll_lm; // Low-level line debug info
     DbgInfoOneLevelConsumer* ll_cn;             // Low-level debug info consumer
+    DwarfParseTimings m_llTimings; // The time the LL parse took
 
-    // Ownership of the one-level consumers:
-    bool ol_cn_owned;
-
-    // Two-level debug information consumer, combining the two levels
-    DbgInfoTwoLevelConsumer* tl_cn;
+    // The LL DWARF container, released once it is parsed. This is usually a view into the code object
+    KernelBinary m_llBin;
+    bool m_wasLLParsed;
 
     // The file name used for the "source locations" in the low-level debug information
     const std::string llFileName;
 
-    // The "default" file name - or main CU file name. It is the first file mapped in the HL line table:
-    std::string m_firstMappedFileName;
+    // The code objects found in the binary:
+    std::vector<HwDbgInfo_FacInt_Module*> m_modules;
+
+    // The module queried first and whose HSAIL text is returned:
+    size_t m_activeModule;
 
     // Pointers to the BRIG code and string table sections
     KernelBinary brig_code;
@@ -179,9 +421,18 @@ public:
 
     // A vector of the variable objects allocated by the C API:
     std::vector<DbgInfoTwoLevelConsumer::LowLvlVariableInfo*> m_allocatedVariableObjects;
+};
 
-    // The HSAIL source found inside the binary, if any:
-    std::string m_hsailSource;
+// A query result (HwDbgInfo_result). The query runs once and its results are kept here, in one arena per
+// result, so the caller reads them in place and releases them all with hwdbginfo_release_result:
+struct HwDbgInfo_FacInt_Result
+{
+    // Address query results, the vector the query built:
+    std::vector<DwarfAddrType> m_addrs;
+
+    // Variable query results. The variables are owned by the result, not by the debug info struct:
+    std::vector<DbgInfoTwoLevelConsumer::LowLvlVariableInfo> m_varObjects;
+    std::vector<HwDbgInfo_variable> m_vars;
 };
 
 // Helper functions:
@@ -209,22 +460,6 @@ HwDbgUInt64 HwDbgInfoLineResolver(const FileLocation& llLine, void* dbg)
     return hAddr;
 }
 
-// Matching function for variable by BRIG offset:
-bool MatchByBrigOffset(const DbgInfoTwoLevelConsumer::LowLvlVariableInfo& var, const void* matchData, const DbgInfoTwoLevelConsumer::LowLvlVariableInfo*& pFoundMember)
-{
-    // TODO: Uri, May 14th, 2015 - Currently, we do not handle members of HLL variables. If we want to support such code, we would need to attach the member names to the
-    // match data to get them in the future.
-    bool retVal = (var.m_brigOffset == (*(unsigned int*)matchData));
-
-    // Output the found "member":
-    if (retVal)
-    {
-        pFoundMember = &var;
-    }
-
-    return retVal;
-}
-
 // Varibale location resolver for the two-level debug information consumer:
 bool HwDbgInfoLocationResolver(const HwDbg::DwarfVariableLocation& hVarLoc, const HwDbgUInt64& lAddr, const HwDbg::DbgInfoIConsumer<HwDbgUInt64, HwDbg::FileLocation, HwDbg::DwarfVariableLocation>& lConsumer, HwDbg::DwarfVariableLocation& o_lVarLocation, void* dbg)
 {
@@ -240,8 +475,8 @@ bool HwDbgInfoLocationResolver(const HwDbg::DwarfVariableLocation& hVarLoc, cons
     DbgInfoVariable tempLocation;
     tempLocation.m_varValue.m_varValueLocation.Initialize();
 
-    // Find the variable information using the low level consumer using the variable brig offset:
-    bool rc = lConsumer.GetMatchingVariableInfoInCurrentScope(lAddr, MatchByBrigOffset, &hVarLoc.m_locationOffset, tempLocation);
+    // Find the variable information using the low level consumer's BRIG offset index:
+    bool rc = lConsumer.GetVariableInfoByBrigOffsetInCurrentScope(lAddr, hVarLoc.m_locationOffset, tempLocation);
 
     // Validations:
     // Offset should be identical:
@@ -283,11 +518,209 @@ bool HwDbgInfoLocationResolver(const HwDbg::DwarfVariableLocation& hVarLoc, cons
     return true;
 }
 
+// Gets the HSAIL text from a BRIG code object, if available:
+static void HwDbgInfoGetHsailText(const KernelBinary& brigCodeObject, std::string& o_hsailSource)
+{
+    KernelBinary hsailText(nullptr, 0);
+    KernelBinary hsailTextBrigSection(nullptr, 0);
+    static const std::string hsailTextSectionName = ".source";
+    bool rcText = brigCodeObject.getElfSectionAsBinary(hsailTextSectionName, hsailTextBrigSection);
+
+    if (rcText && hsailTextBrigSection.m_pBinaryData && sizeof(BrigSectionHeader) < hsailTextBrigSection.m_binarySize)
+    {
+        // If this has a BRIG section header:
+        const BrigSectionHeader* pHsailTextSecHdr = (const BrigSectionHeader*)hsailTextBrigSection.m_pBinaryData;
+
+        if (((uint64_t)pHsailTextSecHdr->headerByteCount < pHsailTextSecHdr->byteCount) &&
+            (pHsailTextSecHdr->headerByteCount > 0) &&
+            (pHsailTextSecHdr->byteCount <= (uint64_t)hsailTextBrigSection.m_binarySize))
+        {
+            // Skip the BRIG section header:
+            rcText = hsailTextBrigSection.getTrimmedBufferAsBinary((size_t)pHsailTextSecHdr->headerByteCount, 0, hsailText);
+        }
+        else
+        {
+#ifdef HWDBGINFO_MOVE_SEMANTICS
+            // Move the data:
+            hsailText = static_cast < KernelBinary && >(hsailTextBrigSection);
+#else
+            // Copy the data:
+            hsailText = hsailTextBrigSection;
+#endif
+        }
+    }
+
+    if ((nullptr != hsailText.m_pBinaryData) && (0 < hsailText.m_binarySize))
+    {
+        // Save it for access:
+        o_hsailSource.assign((char*)hsailText.m_pBinaryData, hsailText.m_binarySize);
+    }
+}
+
+// Lists the kernels declared in HSAIL text ("kernel &name(..."), keeping the '&' prefix:
+static void HwDbgInfoListKernelNames(const std::string& hsailSource, std::vector<std::string>& o_kernelNames)
+{
+    static const std::string kernelKeyword = "kernel";
+    static const size_t kernelKeywordLen = kernelKeyword.length();
+    size_t sourceLen = hsailSource.length();
+    size_t pos = hsailSource.find(kernelKeyword);
+
+    o_kernelNames.clear();
+
+    while (std::string::npos != pos)
+    {
+        size_t nameStart = pos + kernelKeywordLen;
+
+        // The keyword must be a whole word followed by the name:
+        if ((0 == pos || isspace((unsigned char)hsailSource[pos - 1])) && nameStart < sourceLen && isspace((unsigned char)hsailSource[nameStart]))
+        {
+            while (nameStart < sourceLen && isspace((unsigned char)hsailSource[nameStart]))
+            {
+                nameStart++;
+            }
+
+            size_t nameEnd = nameStart;
+
+            if (nameEnd < sourceLen && '&' == hsailSource[nameEnd])
+            {
+                nameEnd++;
+
+                while (nameEnd < sourceLen && (isalnum((unsigned char)hsailSource[nameEnd]) || '_' == hsailSource[nameEnd] || '$' == hsailSource[nameEnd] || '.' == hsailSource[nameEnd]))
+                {
+                    nameEnd++;
+                }
+
+                if (nameEnd > nameStart + 1)
+                {
+                    o_kernelNames.push_back(hsailSource.substr(nameStart, nameEnd - nameStart));
+                }
+            }
+        }
+
+        pos = hsailSource.find(kernelKeyword, pos + kernelKeywordLen);
+    }
+}
+
+// The queries behind the C API. Each one runs on the modules in query order, and both the sized-buffer entry
+// points and the HwDbgInfo_result entry points use them.
+
+// Get the LL addresses of a HL line. A breakpoint line can be in any module:
+static bool HwDbgInfoQueryLineToAddrs(HwDbgInfo_FacInt_Debug& dbg, const FileLocation& loc, std::vector<DwarfAddrType>& o_addrs)
+{
+    HwDbgInfo_FacInt_Module* pModule = nullptr;
+    bool rc = false;
+
+    // All HL addresses, first LL address for each one:
+    for (size_t i = 0; !rc && (nullptr != (pModule = dbg.GetQueryModule(i))); i++)
+        if (nullptr != pModule->tl_cn)
+        {
+            rc = pModule->tl_cn->GetAddressesFromLine(loc, o_addrs, true, false);
+        }
+
+    return rc;
+}
+
+// Get all the mapped LL addresses:
+static bool HwDbgInfoQueryAllMappedAddrs(HwDbgInfo_FacInt_Debug& dbg, std::vector<DwarfAddrType>& o_addrs)
+{
+    HwDbgInfo_FacInt_Module* pModule = nullptr;
+    bool rc = false;
+
+    for (size_t i = 0; !rc && (nullptr != (pModule = dbg.GetQueryModule(i))); i++)
+        if (nullptr != pModule->tl_cn)
+        {
+            rc = pModule->tl_cn->GetMappedAddresses(o_addrs);
+        }
+
+    return rc;
+}
+
+// Get the step (over or out) target addresses from a LL address:
+static bool HwDbgInfoQueryStepAddresses(HwDbgInfo_FacInt_Debug& dbg, HwDbgInfo_addr startAddr, bool stepOut, std::vector<DwarfAddrType>& o_addrs)
+{
+    HwDbgInfo_FacInt_Module* pModule = nullptr;
+    bool rc = false;
+
+    for (size_t i = 0; !rc && (nullptr != (pModule = dbg.GetQueryModule(i))); i++)
+        if (nullptr != pModule->tl_cn)
+        {
+            rc = pModule->tl_cn->GetCachedAddresses(startAddr, !stepOut, o_addrs);
+        }
+
+    return rc;
+}
+
+// Get the names of the variables in the scope of a LL address:
+static bool HwDbgInfoQueryFrameVariableNames(HwDbgInfo_FacInt_Debug& dbg, HwDbgInfo_addr startAddr, int stackDepth, bool leafMembers, std::vector<std::string>& o_varNames)
+{
+    HwDbgInfo_FacInt_Module* pModule = nullptr;
+    bool rc = false;
+
+    for (size_t i = 0; !rc && (nullptr != (pModule = dbg.GetQueryModule(i))); i++)
+        if (nullptr != pModule->tl_cn)
+        {
+            rc = pModule->tl_cn->ListVariablesFromAddress(startAddr, stackDepth, leafMembers, o_varNames);
+        }
+
+    return rc;
+}
+
+// Get a (HL to LL) variable by name:
+static bool HwDbgInfoQueryVariable(HwDbgInfo_FacInt_Debug& dbg, HwDbgInfo_addr startAddr, const char* varName, DbgInfoTwoLevelConsumer::LowLvlVariableInfo& o_var)
+{
+    HwDbgInfo_FacInt_Module* pModule = nullptr;
+    bool rc = false;
+
+    for (size_t i = 0; !rc && (nullptr != (pModule = dbg.GetQueryModule(i))); i++)
+        if (nullptr != pModule->tl_cn)
+        {
+            rc = pModule->tl_cn->GetVariableInfoInCurrentScope(startAddr, varName, o_var);
+        }
+
+    return rc;
+}
+
+// Output the results of an address query to a sized buffer / count output parameter combination:
+static HwDbgInfo_err HwDbgInfoOutputAddrs(const std::vector<DwarfAddrType>& queryAddrs, size_t buf_len, HwDbgInfo_addr* addrs, size_t* addr_count)
+{
+    size_t queryAddrCount = queryAddrs.size();
+
+    HwDbgInfo_err err = HWDBGINFO_E_SUCCESS;
+    HWDBGFAC_INTERFACE_VALIDATE_OUTPUT_ARRAY(queryAddrCount, addrs, buf_len, err);
+    HWDBGFAC_INTERFACE_CHECKRETURN(err);
+
+    const void* queryAddrBuf = (const void*)queryAddrs.data();
+    HWDBGFAC_INTERFACE_OUTPUT_ARRAY(queryAddrBuf, DwarfAddrType, queryAddrCount, addrs, buf_len, addr_count);
+
+    return HWDBGINFO_E_SUCCESS;
+}
+
+// Create a result for an address query that succeeded, taking its addresses:
+static HwDbgInfo_result HwDbgInfoMakeAddrsResult(std::vector<DwarfAddrType>& io_queryAddrs, HwDbgInfo_err* err)
+{
+    HwDbgInfo_FacInt_Result* pResult = new(std::nothrow) HwDbgInfo_FacInt_Result;
+
+    if (nullptr == pResult)
+    {
+        HWDBGFAC_INTERFACE_SET_ERR_AND_RETURN_NULL(err, HWDBGINFO_E_OUTOFMEMORY);
+    }
+
+    pResult->m_addrs.swap(io_queryAddrs);
+
+    if (nullptr != err)
+    {
+        *err = HWDBGINFO_E_SUCCESS;
+    }
+
+    return (HwDbgInfo_result)pResult;
+}
+
 //////////////////////////////////////////////////////////////////////////
 // C API functions                                                      //
 //////////////////////////////////////////////////////////////////////////
 
 // Initialize a HwDbgInfo_debug from an HSA 1.0 (May 2015 design) binary:
+// Each code object is registered as a module, its DWARF is parsed by the first query that reaches it.
 HwDbgInfo_debug hwdbginfo_init_with_hsa_1_0_binary(void* bin, size_t bin_size, HwDbgInfo_err* err)
 {
     // Validate input:
@@ -296,13 +729,22 @@ HwDbgInfo_debug hwdbginfo_init_with_hsa_1_0_binary(void* bin, size_t bin_size, H
         HWDBGFAC_INTERFACE_SET_ERR_AND_RETURN_NULL(err, HWDBGINFO_E_NOBINARY);
     }
 
-    // Create the binary object:
-    KernelBinary hsa10Bin(bin, bin_size);
+    // Create the output struct:
+    HwDbgInfo_FacInt_Debug* dbg = new(std::nothrow) HwDbgInfo_FacInt_Debug;
 
-    // The HL DWARF is inside the BRIG Code object, which is section .hsa.brig:
+    if (nullptr == dbg)
+    {
+        HWDBGFAC_INTERFACE_SET_ERR_AND_RETURN_NULL(err, HWDBGINFO_E_OUTOFMEMORY);
+    }
+
+    // Copy the binary once, since the caller's buffer may be reused after we return.
+    // Everything else we keep from it (code objects, DWARF containers) is a view into this copy:
+    dbg->m_codeObject.setBinary(bin, bin_size);
+    const KernelBinary& hsa10Bin = dbg->m_codeObject;
+
+    // The HL DWARF is inside the BRIG Code objects, which are the .hsahldebug_ sections:
     static const std::string brigCodeObjectSectionNamePrefix = ".hsahldebug_";
     static const size_t brigCodeObjectSectionNamePrefixLen = brigCodeObjectSectionNamePrefix.length();
-    std::string brigCodeObjectSectionName;
     std::vector<std::string> hsa10BinSections;
     hsa10Bin.listELFSectionNames(hsa10BinSections);
     size_t secCount = hsa10BinSections.size();
@@ -312,66 +754,46 @@ HwDbgInfo_debug hwdbginfo_init_with_hsa_1_0_binary(void* bin, size_t bin_size, H
         // See if the prefix is valid:
         const std::string& currSec = hsa10BinSections[i];
 
-        if (0 == currSec.compare(0, brigCodeObjectSectionNamePrefixLen, brigCodeObjectSectionNamePrefix))
+        if (0 != currSec.compare(0, brigCodeObjectSectionNamePrefixLen, brigCodeObjectSectionNamePrefix))
         {
-            // Found a code object!
-            // TO_DO: support multiple code objects
-            brigCodeObjectSectionName = currSec;
-            break;
+            continue;
         }
-    }
 
-    // If no code object was found:
-    if (brigCodeObjectSectionName.empty())
-    {
-        HWDBGFAC_INTERFACE_SET_ERR_AND_RETURN_NULL(err, HWDBGINFO_E_NOHLBINARY);
-    }
-
-    KernelBinary brigCodeObject(nullptr, 0);
-    bool retVal = hsa10Bin.getElfSectionAsBinary(brigCodeObjectSectionName, brigCodeObject);
-
-    if (!retVal)
-    {
-        HWDBGFAC_INTERFACE_SET_ERR_AND_RETURN_NULL(err, HWDBGINFO_E_NOHLBINARY);
-    }
+        // Found a code object!
+        KernelBinary brigCodeObject(nullptr, 0);
+        bool retVal = hsa10Bin.getElfSectionAsBinary(currSec, brigCodeObject);
 
-    // In the HSA 1.0 spec, the debug information is saved under the code object:
-    KernelBinary& hlBin = brigCodeObject;
-
-    // Get the HSAIL text, if available:
-    KernelBinary hsailText(nullptr, 0);
-    KernelBinary hsailTextBrigSection(nullptr, 0);
-    static const std::string hsailTextSectionName = ".source";
-    bool rcText = brigCodeObject.getElfSectionAsBinary(hsailTextSectionName, hsailTextBrigSection);
-
-    if (rcText && hsailTextBrigSection.m_pBinaryData && sizeof(BrigSectionHeader) < hsailTextBrigSection.m_binarySize)
-    {
-        // If this has a BRIG section header:
-        const BrigSectionHeader* pHsailTextSecHdr = (const BrigSectionHeader*)hsailTextBrigSection.m_pBinaryData;
-
-        if (((uint64_t)pHsailTextSecHdr->headerByteCount < pHsailTextSecHdr->byteCount) &&
-            (pHsailTextSecHdr->headerByteCount > 0) &&
-            (pHsailTextSecHdr->byteCount <= (uint64_t)hsailTextBrigSection.m_binarySize))
+        if (!retVal)
         {
-            // Skip the BRIG section header:
-            rcText = hsailTextBrigSection.getTrimmedBufferAsBinary((size_t)pHsailTextSecHdr->headerByteCount, 0, hsailText);
+            continue;
         }
-        else
+
+        // In the HSA 1.0 spec, the debug information is saved under the code object:
+        HwDbgInfo_FacInt_Module* pModule = new(std::nothrow) HwDbgInfo_FacInt_Module(currSec, brigCodeObject);
+
+        if (nullptr == pModule)
         {
-#ifdef HWDBGINFO_MOVE_SEMANTICS
-            // Move the data:
-            hsailText = static_cast < KernelBinary && >(hsailTextBrigSection);
-#else
-            // Copy the data:
-            hsailText = hsailTextBrigSection;
-#endif
+            delete dbg;
+            HWDBGFAC_INTERFACE_SET_ERR_AND_RETURN_NULL(err, HWDBGINFO_E_OUTOFMEMORY);
         }
+
+        // Get the HSAIL text, if available:
+        HwDbgInfoGetHsailText(brigCodeObject, pModule->m_hsailSource);
+        HwDbgInfoListKernelNames(pModule->m_hsailSource, pModule->m_kernelNames);
+
+        dbg->m_modules.push_back(pModule);
+    }
+
+    // If no code object was found:
+    if (dbg->m_modules.empty())
+    {
+        delete dbg;
+        HWDBGFAC_INTERFACE_SET_ERR_AND_RETURN_NULL(err, HWDBGINFO_E_NOHLBINARY);
     }
 
     // The LL DWARF is in section .debug_.sc_elf:
     static const std::string llSectionName = ".debug_.sc_elf";
-    KernelBinary llBin(nullptr, 0);
-    retVal = hsa10Bin.getElfSectionAsBinary(llSectionName, llBin);
+    bool retVal = hsa10Bin.getElfSectionAsBinary(llSectionName, dbg->m_llBin);
 
     if (!retVal)
     {
@@ -399,44 +821,36 @@ HwDbgInfo_debug hwdbginfo_init_with_hsa_1_0_binary(void* bin, size_t bin_size, H
         // If both debug sections are present (no need to pass them on, just check they are there:
         if (foundSection1 && foundSection2)
         {
-            // Copy the entire buffer, since it is the debug info container:
-            hsa10Bin.getSubBufferAsBinary(0, hsa10Bin.m_binarySize, llBin);
+            // Use the entire buffer, since it is the debug info container:
+            hsa10Bin.getSubBufferAsBinary(0, hsa10Bin.m_binarySize, dbg->m_llBin);
         }
         else
         {
             // LL debug info not found:
+            delete dbg;
             HWDBGFAC_INTERFACE_SET_ERR_AND_RETURN_NULL(err, HWDBGINFO_E_NOLLBINARY);
         }
     }
 
-    // Initialize with the sub-binaries and BRIG data:
-    HwDbgInfo_debug dbg = hwdbginfo_init_with_two_binaries(hlBin.m_pBinaryData, hlBin.m_binarySize, llBin.m_pBinaryData, llBin.m_binarySize, err);
-
-    // If this succeeded:
-    HwDbgInfo_FacInt_Debug* pDbg = (HwDbgInfo_FacInt_Debug*)dbg;
-
-    if (nullptr != pDbg)
+    /*
+    // Uri, May 13th, 2015: the .hsatext section seems to be the BRIG code, as it is
+    // binary data. If there are problems in the future with the code object, look into this.
+    // If the HSAIL text was not in the code object:
+    if ((nullptr != hsailText.m_pBinaryData) && (0 < hsailText.m_binarySize))
     {
-        /*
-        // Uri, May 13th, 2015: the .hsatext section seems to be the BRIG code, as it is
-        // binary data. If there are problems in the future with the code object, look into this.
-        // If the HSAIL text was not in the code object:
-        if ((nullptr != hsailText.m_pBinaryData) && (0 < hsailText.m_binarySize))
-        {
-            // Try to get the HSAIL text from the HSA text section:
-            static const std::string hsailTextSectionName = ".hsatext";
-            hsa10Bin.getElfSectionAsBinary(hsailTextSectionName);
-        }
-        */
+        // Try to get the HSAIL text from the HSA text section:
+        static const std::string hsailTextSectionName = ".hsatext";
+        hsa10Bin.getElfSectionAsBinary(hsailTextSectionName);
+    }
+    */
 
-        if ((nullptr != hsailText.m_pBinaryData) && (0 < hsailText.m_binarySize))
-        {
-            // Save it for access:
-            pDbg->m_hsailSource.assign((char*)hsailText.m_pBinaryData, hsailText.m_binarySize);
-        }
+    // Report success:
+    if (nullptr != err)
+    {
+        *err = HWDBGINFO_E_SUCCESS;
     }
 
-    return dbg;
+    return (HwDbgInfo_debug)dbg;
 }
 
 // Initialize a HwDbgInfo_debug from two binaries containing debug information(without pointers to the BRIG information):
@@ -453,88 +867,99 @@ HwDbgInfo_debug hwdbginfo_init_with_two_binaries(void* hl_bin, size_t hl_bin_siz
         HWDBGFAC_INTERFACE_SET_ERR_AND_RETURN_NULL(err, HWDBGINFO_E_NOLLBINARY);
     }
 
-    KernelBinary hlBin(hl_bin, hl_bin_size);
-    KernelBinary llBin(ll_bin, ll_bin_size);
+    // The containers are parsed before we return, so there is no need to copy them:
+    KernelBinary hlBin(nullptr, 0);
+    hlBin.setBinaryView(hl_bin, hl_bin_size);
 
     // Create the output struct:
     HwDbgInfo_FacInt_Debug* dbg = new(std::nothrow) HwDbgInfo_FacInt_Debug;
+    HwDbgInfo_FacInt_Module* pModule = new(std::nothrow) HwDbgInfo_FacInt_Module("", hlBin);
 
-    if (nullptr == dbg)
+    if (nullptr == dbg || nullptr == pModule)
     {
+        delete dbg; delete pModule;
         HWDBGFAC_INTERFACE_SET_ERR_AND_RETURN_NULL(err, HWDBGINFO_E_OUTOFMEMORY);
     }
 
-    // Parse:
-    bool retVal = DbgInfoDwarfParser::InitializeWithBinary(hlBin, dbg->hl_sc, dbg->hl_lm);
+    dbg->m_modules.push_back(pModule);
+    dbg->m_llBin.setBinaryView(ll_bin, ll_bin_size);
 
-    if (!retVal)
+    // The caller gave us the DWARF containers directly, so parse them now to report errors:
+    HwDbgInfo_err parseErr = dbg->ParseModule(*pModule);
+
+    if (HWDBGINFO_E_SUCCESS != parseErr)
     {
         delete dbg;
-        HWDBGFAC_INTERFACE_SET_ERR_AND_RETURN_NULL(err, HWDBGINFO_E_HLINFO);
+        HWDBGFAC_INTERFACE_SET_ERR_AND_RETURN_NULL(err, parseErr);
     }
 
-    retVal = DbgInfoDwarfParser::InitializeWithBinary(llBin, dbg->ll_sc, dbg->ll_lm, dbg->llFileName);
-
-    if (!retVal)
+    // Report success:
+    if (nullptr != err)
     {
-        delete dbg;
-        HWDBGFAC_INTERFACE_SET_ERR_AND_RETURN_NULL(err, HWDBGINFO_E_LLINFO);
+        *err = HWDBGINFO_E_SUCCESS;
     }
 
-    // Initialize consumers:
-    dbg->hl_cn = new(std::nothrow) DbgInfoOneLevelConsumer;
-    dbg->ll_cn = new(std::nothrow) DbgInfoOneLevelConsumer;
-    dbg->ol_cn_owned = true;
+    return (HwDbgInfo_debug)dbg;
+}
 
-    if (nullptr == dbg->hl_cn || nullptr == dbg->ll_cn)
-    {
-        delete dbg;
-        HWDBGFAC_INTERFACE_SET_ERR_AND_RETURN_NULL(err, HWDBGINFO_E_OUTOFMEMORY);
-    }
+// Set the options of the parses that follow:
+unsigned int hwdbginfo_set_parse_options(unsigned int options)
+{
+    return gs_parseOptions.exchange(options);
+}
 
-    dbg->hl_cn->SetCodeScope(&dbg->hl_sc);
-    dbg->hl_cn->SetLineNumberMap(&dbg->hl_lm);
-    dbg->ll_cn->SetCodeScope(&dbg->ll_sc);
-    dbg->ll_cn->SetLineNumberMap(&dbg->ll_lm);
+// Add a line for the phases of one level's parse to a timings report:
+static void HwDbgInfoAppendParseTimings(const char* levelName, const DwarfParseTimings& timings, std::string& io_report)
+{
+    io_report += string_format("  %s: init %llu us, scopes %llu us, lines %llu us, address map %llu us, total %llu us\n", levelName,
+                               (unsigned long long)timings.m_initUs, (unsigned long long)timings.m_codeScopeUs,
+                               (unsigned long long)timings.m_lineMappingUs, (unsigned long long)timings.m_addressMappingUs,
+                               (unsigned long long)timings.m_totalUs);
+}
 
-    dbg->tl_cn = new(std::nothrow) DbgInfoTwoLevelConsumer(dbg->hl_cn, dbg->ll_cn, HwDbgInfoLocationResolver, HwDbgInfoAddressResolver, HwDbgInfoLineResolver, (void*)dbg);
+// Report the time each phase of the parses took:
+HwDbgInfo_err hwdbginfo_parse_timings_report(HwDbgInfo_debug dbg, size_t buf_len, char* report, size_t* report_len)
+{
+    // Parameter validation:
+    HwDbgInfo_FacInt_Debug* pDbg = (HwDbgInfo_FacInt_Debug*)dbg;
 
-    if (nullptr == dbg->tl_cn)
+    if (nullptr == pDbg)
     {
-        delete dbg;
-        HWDBGFAC_INTERFACE_SET_ERR_AND_RETURN_NULL(err, HWDBGINFO_E_OUTOFMEMORY);
+        return HWDBGINFO_E_PARAMETER;
     }
 
-    // Transfer ownership of the one-level consumers to the two-level consumer:
-    dbg->ol_cn_owned = false;
+    HWDBGFAC_INTERFACE_VALIDATE_OUTPUT_BUFFER(buf_len, report);
 
-    // Set the default file name:
-    std::vector<FileLocation> hl_fileLocs;
-    bool rcHLLM = dbg->hl_lm.GetMappedLines(hl_fileLocs);
+    std::string reportStr;
+    size_t moduleCount = pDbg->m_modules.size();
 
-    if (rcHLLM)
+    for (size_t i = 0; i < moduleCount; i++)
     {
-        size_t fileLocCount = hl_fileLocs.size();
+        const HwDbgInfo_FacInt_Module* pModule = pDbg->m_modules[i];
 
-        for (size_t i = 0; i < fileLocCount; i++)
+        if (pModule->m_wasParsed)
         {
-            const std::string* currentFileName = hl_fileLocs[i].m_fullPath;
-
-            if (nullptr != currentFileName && !currentFileName->empty())
-            {
-                dbg->m_firstMappedFileName = *currentFileName;
-                break;
-            }
+            reportStr += string_format("Code object %s: parsed in %llu us\n", pModule->m_name.empty() ? "(BRIG DWARF)" : pModule->m_name.c_str(),
+                                       (unsigned long long)pModule->m_parseUs);
+            HwDbgInfoAppendParseTimings("HL", pModule->m_hlTimings, reportStr);
         }
     }
 
-    // Report success:
-    if (nullptr != err)
+    if (pDbg->m_wasLLParsed)
     {
-        *err = HWDBGINFO_E_SUCCESS;
+        reportStr += "ISA DWARF, shared by the code objects:\n";
+        HwDbgInfoAppendParseTimings("LL", pDbg->m_llTimings, reportStr);
     }
 
-    return (HwDbgInfo_debug)dbg;
+    if (reportStr.empty())
+    {
+        return HWDBGINFO_E_NOTFOUND;
+    }
+
+    HwDbgInfo_err retVal = HWDBGINFO_E_SUCCESS;
+    HWDBGFAC_INTERFACE_OUTPUT_STRING(reportStr, report, buf_len, report_len, retVal);
+
+    return retVal;
 }
 
 // Get the HSAIL source from the binary:
@@ -548,21 +973,55 @@ HwDbgInfo_err hwdbginfo_get_hsail_text(HwDbgInfo_debug dbg, const char** hsail_s
         return HWDBGINFO_E_PARAMETER;
     }
 
-    if (pDbg->m_hsailSource.empty())
+    // The text of the active module:
+    const std::string& hsailSource = pDbg->m_modules[pDbg->m_activeModule]->m_hsailSource;
+
+    if (hsailSource.empty())
     {
         return HWDBGINFO_E_NOSOURCE;
     }
 
-    *hsail_source = pDbg->m_hsailSource.c_str();
+    *hsail_source = hsailSource.c_str();
 
     if (nullptr != hsail_source_len)
     {
-        *hsail_source_len = pDbg->m_hsailSource.length() + 1;
+        *hsail_source_len = hsailSource.length() + 1;
     }
 
     return HWDBGINFO_E_SUCCESS;
 }
 
+// Select the module that defines a kernel:
+HwDbgInfo_err hwdbginfo_set_active_kernel(HwDbgInfo_debug dbg, const char* kernel_name)
+{
+    // Parameter validation:
+    HwDbgInfo_FacInt_Debug* pDbg = (HwDbgInfo_FacInt_Debug*)dbg;
+
+    if (nullptr == pDbg || nullptr == kernel_name)
+    {
+        return HWDBGINFO_E_PARAMETER;
+    }
+
+    // The kernel names are kept with their '&' prefix:
+    std::string kernelName(kernel_name);
+
+    if (kernelName.empty() || '&' != kernelName[0])
+    {
+        kernelName.insert(0, 1, '&');
+    }
+
+    size_t moduleCount = pDbg->m_modules.size();
+
+    for (size_t i = 0; i < moduleCount; i++)
+        if (pDbg->m_modules[i]->DefinesKernel(kernelName))
+        {
+            pDbg->m_activeModule = i;
+            return HWDBGINFO_E_SUCCESS;
+        }
+
+    return HWDBGINFO_E_NOTFOUND;
+}
+
 // Create a HwDbgInfo_code_location:
 HwDbgInfo_code_location hwdbginfo_make_code_location(const char* file_name, HwDbgInfo_linenum line_num)
 {
@@ -683,7 +1142,14 @@ HwDbgInfo_err hwdbginfo_addr_to_line(HwDbgInfo_debug dbg, HwDbgInfo_addr addr, H
 
     // Query the debug info:
     FileLocation matchedLine;
-    bool rc = pDbg->tl_cn->GetLineFromAddress(addr, matchedLine);
+    HwDbgInfo_FacInt_Module* pModule = nullptr;
+    bool rc = false;
+
+    for (size_t i = 0; !rc && (nullptr != (pModule = pDbg->GetQueryModule(i))); i++)
+        if (nullptr != pModule->tl_cn)
+        {
+            rc = pModule->tl_cn->GetLineFromAddress(addr, matchedLine);
+        }
 
     if (!rc)
     {
@@ -718,9 +1184,8 @@ HwDbgInfo_err hwdbginfo_line_to_addrs(HwDbgInfo_debug dbg, HwDbgInfo_code_locati
 
     // Query the debug info:
     std::vector<DwarfAddrType> matchedAddrs;
-    bool rc = pDbg->tl_cn->GetAddressesFromLine(*pLoc, matchedAddrs, true, false); // All HL addresses, first LL address for each one
 
-    if (!rc)
+    if (!HwDbgInfoQueryLineToAddrs(*pDbg, *pLoc, matchedAddrs))
     {
         if (nullptr != addr_count)
         {
@@ -731,16 +1196,7 @@ HwDbgInfo_err hwdbginfo_line_to_addrs(HwDbgInfo_debug dbg, HwDbgInfo_code_locati
     }
 
     // Output the addresses:
-    size_t matchAddrCount = matchedAddrs.size();
-
-    HwDbgInfo_err err = HWDBGINFO_E_SUCCESS;
-    HWDBGFAC_INTERFACE_VALIDATE_OUTPUT_ARRAY(matchAddrCount, addrs, buf_len, err);
-    HWDBGFAC_INTERFACE_CHECKRETURN(err);
-
-    void* matchAddrBuf = (void*)(&(matchedAddrs[0]));
-    HWDBGFAC_INTERFACE_OUTPUT_ARRAY(matchAddrBuf, DwarfAddrType, matchAddrCount, addrs, buf_len, addr_count);
-
-    return HWDBGINFO_E_SUCCESS;
+    return HwDbgInfoOutputAddrs(matchedAddrs, buf_len, addrs, addr_count);
 }
 
 // Finds the closest valid line number to an input line number:
@@ -755,24 +1211,29 @@ HwDbgInfo_err hwdbginfo_nearest_mapped_line(HwDbgInfo_debug dbg, HwDbgInfo_code_
         return HWDBGINFO_E_PARAMETER;
     }
 
-    // If the mapped line does not have a file name:
-    bool wasEmptyPath = false;
+    // If the mapped line does not have a file name, each module uses its first mapped file name:
+    bool wasEmptyPath = (nullptr == pBaseLine->m_fullPath || pBaseLine->m_fullPath->empty());
 
-    if (nullptr == pBaseLine->m_fullPath || pBaseLine->m_fullPath->empty())
+    // Query the debug info:
+    FileLocation matchedLine;
+    HwDbgInfo_FacInt_Module* pModule = nullptr;
+    bool rc = false;
+
+    for (size_t i = 0; !rc && (nullptr != (pModule = pDbg->GetQueryModule(i))); i++)
     {
-        wasEmptyPath = true;
+        if (nullptr == pModule->tl_cn)
+        {
+            continue;
+        }
 
-        // Get the first file name:
-        if (!pDbg->m_firstMappedFileName.empty())
+        if (wasEmptyPath)
         {
             delete pBaseLine->m_fullPath;
-            pBaseLine->m_fullPath = new std::string(pDbg->m_firstMappedFileName);
+            pBaseLine->m_fullPath = pModule->m_firstMappedFileName.empty() ? nullptr : new std::string(pModule->m_firstMappedFileName);
         }
-    }
 
-    // Query the debug info:
-    FileLocation matchedLine;
-    bool rc = pDbg->tl_cn->GetNearestMappedLine(*pBaseLine, matchedLine);
+        rc = pModule->tl_cn->GetNearestMappedLine(*pBaseLine, matchedLine);
+    }
 
     // Restore the value before even checking for validity:
     if (wasEmptyPath)
@@ -811,7 +1272,14 @@ HwDbgInfo_err hwdbginfo_nearest_mapped_addr(HwDbgInfo_debug dbg, HwDbgInfo_addr
 
     // Query the debug info:
     HwDbgUInt64 matchedAddr = 0;
-    bool rc = pDbg->tl_cn->GetNearestMappedAddress(base_addr, matchedAddr);
+    HwDbgInfo_FacInt_Module* pModule = nullptr;
+    bool rc = false;
+
+    for (size_t i = 0; !rc && (nullptr != (pModule = pDbg->GetQueryModule(i))); i++)
+        if (nullptr != pModule->tl_cn)
+        {
+            rc = pModule->tl_cn->GetNearestMappedAddress(base_addr, matchedAddr);
+        }
 
     if (!rc)
     {
@@ -839,9 +1307,8 @@ HwDbgInfo_err hwdbginfo_all_mapped_addrs(HwDbgInfo_debug dbg, size_t buf_len, Hw
 
     // Query the debug info:
     std::vector<DwarfAddrType> mappedAddrs;
-    bool rc = pDbg->tl_cn->GetMappedAddresses(mappedAddrs);
 
-    if (!rc)
+    if (!HwDbgInfoQueryAllMappedAddrs(*pDbg, mappedAddrs))
     {
         if (nullptr != addr_count)
         {
@@ -852,16 +1319,7 @@ HwDbgInfo_err hwdbginfo_all_mapped_addrs(HwDbgInfo_debug dbg, size_t buf_len, Hw
     }
 
     // Output the addresses:
-    size_t mappedAddrCount = mappedAddrs.size();
-
-    HwDbgInfo_err err = HWDBGINFO_E_SUCCESS;
-    HWDBGFAC_INTERFACE_VALIDATE_OUTPUT_ARRAY(mappedAddrCount, addrs, buf_len, err);
-    HWDBGFAC_INTERFACE_CHECKRETURN(err);
-
-    void* mappedAddrBuf = (void*)(&(mappedAddrs[0]));
-    HWDBGFAC_INTERFACE_OUTPUT_ARRAY(mappedAddrBuf, DwarfAddrType, mappedAddrCount, addrs, buf_len, addr_count);
-
-    return HWDBGINFO_E_SUCCESS;
+    return HwDbgInfoOutputAddrs(mappedAddrs, buf_len, addrs, addr_count);
 }
 
 // Gets an address's virtual call stack (of inlined functions):
@@ -879,7 +1337,14 @@ HwDbgInfo_err hwdbginfo_addr_call_stack(HwDbgInfo_debug dbg, HwDbgInfo_addr star
 
     // Query the debug info:
     std::vector<DbgInfoTwoLevelConsumer::TwoLvlCallStackFrame> cs;
-    bool rc = pDbg->tl_cn->GetAddressVirtualCallStack(start_addr, cs);
+    HwDbgInfo_FacInt_Module* pModule = nullptr;
+    bool rc = false;
+
+    for (size_t i = 0; !rc && (nullptr != (pModule = pDbg->GetQueryModule(i))); i++)
+        if (nullptr != pModule->tl_cn)
+        {
+            rc = pModule->tl_cn->GetAddressVirtualCallStack(start_addr, cs);
+        }
 
     if (!rc)
     {
@@ -956,9 +1421,8 @@ HwDbgInfo_err hwdbginfo_step_addresses(HwDbgInfo_debug dbg, HwDbgInfo_addr start
 
     // Query the debug info:
     std::vector<DwarfAddrType> stepAddrs;
-    bool rc = pDbg->tl_cn->GetCachedAddresses(start_addr, !step_out, stepAddrs);
 
-    if (!rc)
+    if (!HwDbgInfoQueryStepAddresses(*pDbg, start_addr, step_out, stepAddrs))
     {
         if (nullptr != addr_count)
         {
@@ -969,16 +1433,7 @@ HwDbgInfo_err hwdbginfo_step_addresses(HwDbgInfo_debug dbg, HwDbgInfo_addr start
     }
 
     // Output the addresses:
-    size_t stepAddrCount = stepAddrs.size();
-
-    HwDbgInfo_err err = HWDBGINFO_E_SUCCESS;
-    HWDBGFAC_INTERFACE_VALIDATE_OUTPUT_ARRAY(stepAddrCount, addrs, buf_len, err);
-    HWDBGFAC_INTERFACE_CHECKRETURN(err);
-
-    void* stepAddrBuf = (void*)(&(stepAddrs[0]));
-    HWDBGFAC_INTERFACE_OUTPUT_ARRAY(stepAddrBuf, DwarfAddrType, stepAddrCount, addrs, buf_len, addr_count);
-
-    return HWDBGINFO_E_SUCCESS;
+    return HwDbgInfoOutputAddrs(stepAddrs, buf_len, addrs, addr_count);
 }
 
 // Query a variable for general info:
@@ -1035,6 +1490,41 @@ HwDbgInfo_err hwdbginfo_variable_data(HwDbgInfo_variable var, size_t name_buf_le
     return HWDBGINFO_E_SUCCESS;
 }
 
+// Query a variable for its name and type name, in place:
+HwDbgInfo_err hwdbginfo_variable_names(HwDbgInfo_variable var, const char** var_name, size_t* var_name_len, const char** type_name, size_t* type_name_len)
+{
+    // Parameter validation:
+    const DbgInfoTwoLevelConsumer::LowLvlVariableInfo* pVar = (const DbgInfoTwoLevelConsumer::LowLvlVariableInfo*)var;
+
+    if (nullptr == pVar || (nullptr == var_name && nullptr == var_name_len && nullptr == type_name && nullptr == type_name_len))
+    {
+        return HWDBGINFO_E_PARAMETER;
+    }
+
+    // The strings belong to the variable:
+    if (nullptr != var_name)
+    {
+        *var_name = pVar->m_varName.c_str();
+    }
+
+    if (nullptr != var_name_len)
+    {
+        *var_name_len = pVar->m_varName.length();
+    }
+
+    if (nullptr != type_name)
+    {
+        *type_name = pVar->m_typeName.c_str();
+    }
+
+    if (nullptr != type_name_len)
+    {
+        *type_name_len = pVar->m_typeName.length();
+    }
+
+    return HWDBGINFO_E_SUCCESS;
+}
+
 // Queries a variable (with a non-const value) for location information:
 HwDbgInfo_err hwdbginfo_variable_location(HwDbgInfo_variable var, HwDbgInfo_locreg* reg_type, unsigned int* reg_num, bool* deref_value, unsigned int* offset, unsigned int* resource, unsigned int* isa_memory_region, unsigned int* piece_offset, unsigned int* piece_size, int* const_add)
 {
@@ -1259,10 +1749,11 @@ HwDbgInfo_variable hwdbginfo_variable(HwDbgInfo_debug dbg, HwDbgInfo_addr start_
     pDbg->AddVariable(pVar);
 
     // Query the debug info:
-    bool rc = pDbg->tl_cn->GetVariableInfoInCurrentScope(start_addr, var_name, *pVar);
+    bool rc = HwDbgInfoQueryVariable(*pDbg, start_addr, var_name, *pVar);
 
     if (!rc)
     {
+        pDbg->RemoveVariable(pVar);
         delete pVar;
         HWDBGFAC_INTERFACE_SET_ERR_AND_RETURN_NULL(err, HWDBGINFO_E_NOTFOUND);
     }
@@ -1301,10 +1792,11 @@ HwDbgInfo_variable hwdbginfo_low_level_variable(HwDbgInfo_debug dbg, HwDbgInfo_a
     pDbg->AddVariable(pVar);
 
     // Query the debug info:
-    bool rc = pDbg->ll_cn->GetVariableInfoInCurrentScope(start_addr, var_name, *pVar);
+    bool rc = pDbg->ParseLowLevel() && pDbg->ll_cn->GetVariableInfoInCurrentScope(start_addr, var_name, *pVar);
 
     if (!rc)
     {
+        pDbg->RemoveVariable(pVar);
         delete pVar;
         HWDBGFAC_INTERFACE_SET_ERR_AND_RETURN_NULL(err, HWDBGINFO_E_NOTFOUND);
     }
@@ -1332,7 +1824,7 @@ HwDbgInfo_err hwdbginfo_frame_variables(HwDbgInfo_debug dbg, HwDbgInfo_addr star
 
     // Query the debug info:
     std::vector<std::string> varNames;
-    bool rc = pDbg->tl_cn->ListVariablesFromAddress(start_addr, stack_depth, leaf_members, varNames);
+    bool rc = HwDbgInfoQueryFrameVariableNames(*pDbg, start_addr, stack_depth, leaf_members, varNames);
 
     if (!rc)
     {
@@ -1377,6 +1869,166 @@ HwDbgInfo_err hwdbginfo_frame_variables(HwDbgInfo_debug dbg, HwDbgInfo_addr star
     return HWDBGINFO_E_SUCCESS;
 }
 
+// Gets the addresses a line maps to, as a result:
+HwDbgInfo_result hwdbginfo_query_line_to_addrs(HwDbgInfo_debug dbg, HwDbgInfo_code_location loc, HwDbgInfo_err* err)
+{
+    // Parameter validation:
+    HwDbgInfo_FacInt_Debug* pDbg = (HwDbgInfo_FacInt_Debug*)dbg;
+    FileLocation* pLoc = (FileLocation*)loc;
+
+    if (nullptr == pDbg || nullptr == pLoc)
+    {
+        HWDBGFAC_INTERFACE_SET_ERR_AND_RETURN_NULL(err, HWDBGINFO_E_PARAMETER);
+    }
+
+    // Query the debug info:
+    std::vector<DwarfAddrType> matchedAddrs;
+
+    if (!HwDbgInfoQueryLineToAddrs(*pDbg, *pLoc, matchedAddrs))
+    {
+        HWDBGFAC_INTERFACE_SET_ERR_AND_RETURN_NULL(err, HWDBGINFO_E_NOTFOUND);
+    }
+
+    return HwDbgInfoMakeAddrsResult(matchedAddrs, err);
+}
+
+// Gets all mapped addresses, as a result:
+HwDbgInfo_result hwdbginfo_query_all_mapped_addrs(HwDbgInfo_debug dbg, HwDbgInfo_err* err)
+{
+    // Parameter validation:
+    HwDbgInfo_FacInt_Debug* pDbg = (HwDbgInfo_FacInt_Debug*)dbg;
+
+    if (nullptr == pDbg)
+    {
+        HWDBGFAC_INTERFACE_SET_ERR_AND_RETURN_NULL(err, HWDBGINFO_E_PARAMETER);
+    }
+
+    // Query the debug info:
+    std::vector<DwarfAddrType> mappedAddrs;
+
+    if (!HwDbgInfoQueryAllMappedAddrs(*pDbg, mappedAddrs))
+    {
+        HWDBGFAC_INTERFACE_SET_ERR_AND_RETURN_NULL(err, HWDBGINFO_E_NOTFOUND);
+    }
+
+    return HwDbgInfoMakeAddrsResult(mappedAddrs, err);
+}
+
+// Gets the step (over or out) target addresses from a base address, as a result:
+HwDbgInfo_result hwdbginfo_query_step_addresses(HwDbgInfo_debug dbg, HwDbgInfo_addr start_addr, bool step_out, HwDbgInfo_err* err)
+{
+    // Parameter validation:
+    HwDbgInfo_FacInt_Debug* pDbg = (HwDbgInfo_FacInt_Debug*)dbg;
+
+    if (nullptr == pDbg)
+    {
+        HWDBGFAC_INTERFACE_SET_ERR_AND_RETURN_NULL(err, HWDBGINFO_E_PARAMETER);
+    }
+
+    // Query the debug info:
+    std::vector<DwarfAddrType> stepAddrs;
+
+    if (!HwDbgInfoQueryStepAddresses(*pDbg, start_addr, step_out, stepAddrs))
+    {
+        HWDBGFAC_INTERFACE_SET_ERR_AND_RETURN_NULL(err, HWDBGINFO_E_NOTFOUND);
+    }
+
+    return HwDbgInfoMakeAddrsResult(stepAddrs, err);
+}
+
+// Gets the "local" variables from a starting address virtual stack frame, as a result:
+HwDbgInfo_result hwdbginfo_query_frame_variables(HwDbgInfo_debug dbg, HwDbgInfo_addr start_addr, int stack_depth, bool leaf_members, HwDbgInfo_err* err)
+{
+    // Parameter validation:
+    HwDbgInfo_FacInt_Debug* pDbg = (HwDbgInfo_FacInt_Debug*)dbg;
+
+    if (nullptr == pDbg)
+    {
+        HWDBGFAC_INTERFACE_SET_ERR_AND_RETURN_NULL(err, HWDBGINFO_E_PARAMETER);
+    }
+
+    // Query the debug info:
+    std::vector<std::string> varNames;
+
+    if (!HwDbgInfoQueryFrameVariableNames(*pDbg, start_addr, stack_depth, leaf_members, varNames))
+    {
+        HWDBGFAC_INTERFACE_SET_ERR_AND_RETURN_NULL(err, HWDBGINFO_E_NOTFOUND);
+    }
+
+    HwDbgInfo_FacInt_Result* pResult = new(std::nothrow) HwDbgInfo_FacInt_Result;
+
+    if (nullptr == pResult)
+    {
+        HWDBGFAC_INTERFACE_SET_ERR_AND_RETURN_NULL(err, HWDBGINFO_E_OUTOFMEMORY);
+    }
+
+    // Get each variable from its name, into the result's variables:
+    size_t varCount = varNames.size();
+    pResult->m_varObjects.resize(varCount);
+    pResult->m_vars.resize(varCount, nullptr);
+
+    for (size_t i = 0; i < varCount; i++)
+    {
+        // The variable name is supposed to be valid:
+        if (!HwDbgInfoQueryVariable(*pDbg, start_addr, varNames[i].c_str(), pResult->m_varObjects[i]))
+        {
+            delete pResult;
+            HWDBGFAC_INTERFACE_SET_ERR_AND_RETURN_NULL(err, HWDBGINFO_E_NOTFOUND);
+        }
+
+        pResult->m_vars[i] = (HwDbgInfo_variable)(&(pResult->m_varObjects[i]));
+    }
+
+    if (nullptr != err)
+    {
+        *err = HWDBGINFO_E_SUCCESS;
+    }
+
+    return (HwDbgInfo_result)pResult;
+}
+
+// Gets the addresses of a result:
+const HwDbgInfo_addr* hwdbginfo_result_addrs(HwDbgInfo_result res, size_t* addr_count)
+{
+    const HwDbgInfo_FacInt_Result* pResult = (const HwDbgInfo_FacInt_Result*)res;
+    const HwDbgInfo_addr* retVal = nullptr;
+    size_t addrCount = 0;
+
+    if (nullptr != pResult && !pResult->m_addrs.empty())
+    {
+        retVal = (const HwDbgInfo_addr*)pResult->m_addrs.data();
+        addrCount = pResult->m_addrs.size();
+    }
+
+    if (nullptr != addr_count)
+    {
+        *addr_count = addrCount;
+    }
+
+    return retVal;
+}
+
+// Gets the variables of a result:
+const HwDbgInfo_variable* hwdbginfo_result_variables(HwDbgInfo_result res, size_t* var_count)
+{
+    const HwDbgInfo_FacInt_Result* pResult = (const HwDbgInfo_FacInt_Result*)res;
+    const HwDbgInfo_variable* retVal = nullptr;
+    size_t varCount = 0;
+
+    if (nullptr != pResult && !pResult->m_vars.empty())
+    {
+        retVal = pResult->m_vars.data();
+        varCount = pResult->m_vars.size();
+    }
+
+    if (nullptr != var_count)
+    {
+        *var_count = varCount;
+    }
+
+    return retVal;
+}
+
 // Release the debug info struct:
 void hwdbginfo_release_debug_info(HwDbgInfo_debug* dbg)
 {
@@ -1449,3 +2101,15 @@ void hwdbginfo_release_variables(HwDbgInfo_debug dbg, HwDbgInfo_variable* vars,
         }
     }
 }
+
+// Release a query result:
+void hwdbginfo_release_result(HwDbgInfo_result* res)
+{
+    assert(nullptr != res);
+
+    if (nullptr != res)
+    {
+        delete(HwDbgInfo_FacInt_Result*)(*res);
+        *res = nullptr;
+    }
+}
@@ -37,6 +37,8 @@ typedef unsigned int HwDbgInfo_indirection;
 typedef unsigned int HwDbgInfo_indirectiondetail;
 /* Variable location register (HWDBGINFO_VLOC_REG_*         */
 typedef unsigned int HwDbgInfo_locreg;
+/* A query result, whose data stays valid until released    */
+typedef void* HwDbgInfo_result;
 
 /***************/
 /* Error codes */
@@ -134,19 +136,32 @@ typedef unsigned int HwDbgInfo_locreg;
 /* Undefined / uninitialized            */
 #define HWDBGINFO_VLOC_REG_UNINIT 3
 
+/* Parse options, for hwdbginfo_set_parse_options: */
+/* Parse the HL and LL DWARF of a code object concurrently */
+#define HWDBGINFO_PARSE_PARALLEL_LEVELS         0x1
+/* Parse the subprograms of each CU on a pool of threads, for very large kernels */
+#define HWDBGINFO_PARSE_PARALLEL_SUBPROGRAMS    0x2
+#define HWDBGINFO_PARSE_DEFAULT                 HWDBGINFO_PARSE_PARALLEL_LEVELS
+
 /*******************/
 /* Initialization: */
 /*******************/
-/* Create a HwDbgInfo_debug from an HSA 1.0 (May) binary */
+/* Create a HwDbgInfo_debug from an HSA 1.0 (May) binary, the DWARF of each code object is parsed on first use */
 HwDbgInfo_debug hwdbginfo_init_with_hsa_1_0_binary(void* bin, size_t bin_size, HwDbgInfo_err* err);
 /* Create a HwDbgInfo_debug directly from the BRIG DWARF container and ISA DWARF container */
 HwDbgInfo_debug hwdbginfo_init_with_two_binaries(void* hl_bin, size_t hl_bin_size, void* const ll_bin, size_t ll_bin_size, HwDbgInfo_err* err);
+/* Set the HWDBGINFO_PARSE_ options of the DWARF parses that follow, returns the previous options */
+unsigned int hwdbginfo_set_parse_options(unsigned int options);
+/* Get a text report of the time each phase of the DWARF parses done so far took */
+HwDbgInfo_err hwdbginfo_parse_timings_report(HwDbgInfo_debug dbg, size_t buf_len, char* report, size_t* report_len);
 
 /***********************/
 /* Binary data access: */
 /***********************/
-/* Get the HSAIL text source, if it was available */
+/* Get the HSAIL text source of the active code object, if it was available */
 HwDbgInfo_err hwdbginfo_get_hsail_text(HwDbgInfo_debug dbg, const char** hsail_source, size_t* hsail_source_len);
+/* Make the code object that defines a kernel the active one. It is queried first and its HSAIL text is returned */
+HwDbgInfo_err hwdbginfo_set_active_kernel(HwDbgInfo_debug dbg, const char* kernel_name);
 
 /*******************/
 /* Debug lines API */
@@ -195,6 +210,26 @@ HwDbgInfo_variable hwdbginfo_variable(HwDbgInfo_debug dbg, HwDbgInfo_addr start_
 HwDbgInfo_variable hwdbginfo_low_level_variable(HwDbgInfo_debug dbg, HwDbgInfo_addr start_addr, bool current_scope_only, const char* var_name, HwDbgInfo_err* err);
 /* Get all variables defined in the scope of a LL address */
 HwDbgInfo_err hwdbginfo_frame_variables(HwDbgInfo_debug dbg, HwDbgInfo_addr start_addr, int stack_depth, bool leaf_members, size_t buf_len, HwDbgInfo_variable* vars, size_t* var_count);
+/* Query a variable / constant for its name and type name. The strings belong to the variable */
+HwDbgInfo_err hwdbginfo_variable_names(HwDbgInfo_variable var, const char** var_name, size_t* var_name_len, const char** type_name, size_t* type_name_len);
+
+/*****************************************************************************/
+/* Query results API:                                                        */
+/* These queries run once and keep their results in the returned handle, to */
+/* be read in place instead of sized by a first call and copied by a second. */
+/*****************************************************************************/
+/* Translate a HL line to LL address(es) */
+HwDbgInfo_result hwdbginfo_query_line_to_addrs(HwDbgInfo_debug dbg, HwDbgInfo_code_location loc, HwDbgInfo_err* err);
+/* Get all legal (mapped) LL addresses */
+HwDbgInfo_result hwdbginfo_query_all_mapped_addrs(HwDbgInfo_debug dbg, HwDbgInfo_err* err);
+/* Get all the addresses that can be the target of a step operation from a LL address */
+HwDbgInfo_result hwdbginfo_query_step_addresses(HwDbgInfo_debug dbg, HwDbgInfo_addr start_addr, bool step_out, HwDbgInfo_err* err);
+/* Get all variables defined in the scope of a LL address. The variables are released with the result */
+HwDbgInfo_result hwdbginfo_query_frame_variables(HwDbgInfo_debug dbg, HwDbgInfo_addr start_addr, int stack_depth, bool leaf_members, HwDbgInfo_err* err);
+/* Get the addresses of an address query result */
+const HwDbgInfo_addr* hwdbginfo_result_addrs(HwDbgInfo_result res, size_t* addr_count);
+/* Get the variables of a variable query result */
+const HwDbgInfo_variable* hwdbginfo_result_variables(HwDbgInfo_result res, size_t* var_count);
 
 /***************************/
 /* Release allocated data: */
@@ -203,6 +238,7 @@ void hwdbginfo_release_debug_info(HwDbgInfo_debug* dbg);
 void hwdbginfo_release_code_locations(HwDbgInfo_code_location* locs, size_t loc_count);
 void hwdbginfo_release_frame_contexts(HwDbgInfo_frame_context* frames, size_t frame_count);
 void hwdbginfo_release_variables(HwDbgInfo_debug dbg, HwDbgInfo_variable* vars, size_t var_count);
+void hwdbginfo_release_result(HwDbgInfo_result* res);
 
 #ifdef __cplusplus
 }
@@ -16,6 +16,7 @@
     #define HSAIL_UNREFERENCED_PARAMETER( x )
 #endif
 
+#include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include <sys/shm.h>
@@ -32,6 +33,8 @@ typedef enum
     HSAIL_COMMAND_MOMENTARY_BREAKPOINT, // Set an HSAIL momentary breakpoint (which is automatically deleted)
     HSAIL_COMMAND_CONTINUE,             // Continue the inferior process
     HSAIL_COMMAND_SET_LOGGING,          // Configure the logging in the Agent
+    HSAIL_COMMAND_READ_VARIABLES,       // Read all the variable locations in the variable read buffer
+    HSAIL_COMMAND_GATHER_VARIABLE,      // Read the variable in the variable gather buffer from every active work-item of a scope
 } HsailCommand;
 
 typedef enum
@@ -55,7 +58,9 @@ typedef enum
     HSAIL_NOTIFY_START_DEBUG_THREAD,// The debug thread has been started
     HSAIL_NOTIFY_PREDISPATCH_STATE, // Information about the predispatch callback
     HSAIL_NOTIFY_AGENT_ERROR,        // Some error from the agent or the DBE - let gdb know
-    HSAIL_NOTIFY_KILL_COMPLETE       // Notification to let GDB know about kill finishing
+    HSAIL_NOTIFY_KILL_COMPLETE,      // Notification to let GDB know about kill finishing
+    HSAIL_NOTIFY_PROTOCOL_VERSION,   // The command protocol version the agent accepts, in reply to HSAIL_COMMAND_BEGIN_DEBUGGING
+    HSAIL_NOTIFY_COMMAND_BATCH_COMPLETE // The agent has applied a batch of framed commands
 } HsailNotification;
 
 typedef enum
@@ -88,6 +93,24 @@ typedef enum
 
 #define HSAIL_MAX_REPORTABLE_BREAKPOINTS 64
 
+// Versions of the GDB -> Agent command protocol:
+// HSAIL_PROTOCOL_VERSION_LEGACY: each command is a fixed size HsailCommandPacket
+// HSAIL_PROTOCOL_VERSION_FRAMED: commands are sent in batches, a HsailCommandBatchHeader followed
+//                                by variable length HsailCommandRecord records
+// HSAIL_PROTOCOL_VERSION_CONDITIONS: as framed, breakpoint records can also carry a
+//                                    HSAIL_BREAKPOINT_CONDITION_BYTECODE condition
+#define HSAIL_PROTOCOL_VERSION_LEGACY 0
+#define HSAIL_PROTOCOL_VERSION_FRAMED 1
+#define HSAIL_PROTOCOL_VERSION_CONDITIONS 2
+#define HSAIL_PROTOCOL_VERSION HSAIL_PROTOCOL_VERSION_CONDITIONS
+
+// The first word of a command batch ("HSAB"). It is never a valid HsailCommand, so an agent
+// can tell a batch from a legacy packet sent before the version was negotiated
+#define HSAIL_COMMAND_BATCH_MAGIC 0x48534142
+
+// The records in a batch, and the strings following each record, are aligned to this
+#define HSAIL_COMMAND_RECORD_ALIGNMENT 8
+
 // Shared definition of structures between Agent and GDB
 // The following structures are mirrors of their versions in AMDGPUDebug.h
 // This is necessary so that we don't have to include the DBE in gdb
@@ -170,6 +193,20 @@ typedef struct _HsailNotificationPayload
             bool isQuitCommandIssued;   // Used by handle_hsail_event if kill / quit command was originally issued
         } KillCompleteNotification;
 
+        // HSAIL_NOTIFY_PROTOCOL_VERSION
+        struct
+        {
+            uint32_t m_protocolVersion; // The version GDB should use, no higher than the one GDB offered
+        } ProtocolVersionNotification;
+
+        // HSAIL_NOTIFY_COMMAND_BATCH_COMPLETE
+        struct
+        {
+            uint32_t m_batchId;         // The m_batchId of the batch
+            uint32_t m_numCommandsApplied; // The number of records the agent could apply
+            HsailAgentStatus m_status;  // HSAIL_AGENT_STATUS_SUCCESS if all the records were applied
+        } CommandBatchCompleteNotification;
+
     } payload;
 } HsailNotificationPayload;
 
@@ -184,9 +221,32 @@ typedef enum
 {
     HSAIL_BREAKPOINT_CONDITION_UNKNOWN, // Unknown condition,
     HSAIL_BREAKPOINT_CONDITION_ANY,     // No condition, always returns true
-    HSAIL_BREAKPOINT_CONDITION_EQUAL    // The workgroup and workitem are present in the waveinfo buffer
+    HSAIL_BREAKPOINT_CONDITION_EQUAL,   // The workgroup and workitem are present in the waveinfo buffer
+    HSAIL_BREAKPOINT_CONDITION_BYTECODE // Evaluate the condition bytecode sent with the breakpoint
 } HsailConditionCode;
 
+// Breakpoint condition bytecode:
+// The condition is a GDB agent expression (see gdb/common/ax.def for the opcode values), which the
+// agent evaluates for each active work-item of a wave that reaches the breakpoint. The wave stops
+// if the result is non-zero for any of its work-items, or if the evaluation fails (for instance
+// on a division by zero). Stack entries are 64 bits wide.
+// Only these operations are used: add, sub, mul, div_signed, div_unsigned, rem_signed, rem_unsigned,
+// log_not, equal, less_signed, less_unsigned, ext, zero_ext, const8, const16, const32, const64, swap,
+// getv, if_goto, goto and end. div_unsigned, rem_unsigned and less_unsigned pop b then a and push
+// a / b, a % b and a < b, like their signed versions but on the entries taken as unsigned 64 bit.
+// && and || jump over their right operand with if_goto and goto when the left one decides the result.
+// getv pushes one of the condition variables below:
+#define HSAIL_CONDITION_VAR_WORKITEM_ID_X 0
+#define HSAIL_CONDITION_VAR_WORKITEM_ID_Y 1
+#define HSAIL_CONDITION_VAR_WORKITEM_ID_Z 2
+#define HSAIL_CONDITION_VAR_WORKGROUP_ID_X 3
+#define HSAIL_CONDITION_VAR_WORKGROUP_ID_Y 4
+#define HSAIL_CONDITION_VAR_WORKGROUP_ID_Z 5
+#define HSAIL_CONDITION_VAR_HIT_COUNT 6     // The number of waves that reached the breakpoint, including this one
+// The value of the kernel variable at this index in the condition's variable locations,
+// zero extended from m_varSize bytes
+#define HSAIL_CONDITION_VAR_KERNEL_VARIABLE_BASE 16
+
 typedef struct _HsailConditionPacket
 {
     HsailConditionCode m_conditionCode;
@@ -207,18 +267,261 @@ typedef struct
     int m_hitCount;                 // The number of times the breakpoint was hit
     int m_lineNum;                  // The line number for kernel source breakpoints
     int m_numMomentaryBP;           // The number of momentary Breakpoints needed
+    int m_numVariables;             // The number of variable locations in the variable read buffer
     HsailConditionPacket m_conditionPacket;         // The condition info for this breakpoint
     char m_sourceLine[AGENT_MAX_SOURCE_LINE_LEN];   // The source line for kernel source breakpoints
     char m_kernelName[AGENT_MAX_FUNC_NAME_LEN];     // The kernel name for kernel function breakpoints
 } HsailCommandPacket;
 
+// The HSAIL_COMMAND_BEGIN_DEBUGGING packet is always sent as a HsailCommandPacket, right after
+// GDB opens the fifo. Its m_pc field holds HSAIL_PROTOCOL_VERSION. An agent that supports a
+// newer protocol replies with HSAIL_NOTIFY_PROTOCOL_VERSION, older agents do not reply and
+// GDB keeps sending HsailCommandPacket structures.
+
+// A batch of framed commands, written by GDB in one go
+// The header is followed by m_numRecords records, m_payloadSize bytes in total
+typedef struct _HsailCommandBatchHeader
+{
+    uint32_t m_magic;               // HSAIL_COMMAND_BATCH_MAGIC
+    uint32_t m_version;             // The negotiated protocol version
+    uint32_t m_batchId;             // Echoed back in HSAIL_NOTIFY_COMMAND_BATCH_COMPLETE
+    uint32_t m_numRecords;          // The number of records in the batch
+    uint64_t m_payloadSize;         // The size of the records following the header
+} HsailCommandBatchHeader;
+
+// One framed command. The record is followed by m_sourceLineLen bytes of source line and
+// m_kernelNameLen bytes of kernel name, each NULL terminated (the lengths include the
+// terminator, 0 if the string is not sent) and padded to HSAIL_COMMAND_RECORD_ALIGNMENT.
+// If the condition code is HSAIL_BREAKPOINT_CONDITION_BYTECODE, the strings are followed by a
+// HsailConditionBytecodeHeader, the bytecode padded to HSAIL_COMMAND_RECORD_ALIGNMENT and the
+// variable locations.
+typedef struct _HsailCommandRecord
+{
+    uint32_t m_recordSize;          // The size of the record including its strings and padding
+    HsailCommand m_command;         // Command Type
+    HsailLogCommand m_loggingInfo;  // Logging configuration
+    int m_gdbBreakpointID;          // GDB breakpoint number
+    uint64_t m_pc;                  // Program counter
+    int m_lineNum;                  // The line number for kernel source breakpoints
+    int m_numMomentaryBP;           // The number of momentary Breakpoints needed
+    int m_numVariables;             // The number of variable locations in the variable read buffer
+    HsailConditionPacket m_conditionPacket;         // The condition info for this breakpoint
+    uint32_t m_sourceLineLen;       // The length of the source line following the record
+    uint32_t m_kernelNameLen;       // The length of the kernel name following the source line
+} HsailCommandRecord;
+
+// One variable location in the variable read buffer
+// The location fields mirror hwdbginfo_variable_location in HwDbgFacilities
+typedef struct _HsailVariableLocation
+{
+    int m_regType;                  // The location register type
+    unsigned int m_regNum;          // The register number
+    bool m_derefValue;              // True if the register holds the address of the value
+    unsigned int m_offset;          // Offset from the register value
+    unsigned int m_resource;        // The memory resource
+    unsigned int m_isaMemoryRegion; // The ISA memory region
+    unsigned int m_pieceOffset;     // Offset of the piece, if the variable is split
+    unsigned int m_pieceSize;       // Size of the piece, if the variable is split
+    int m_constAdd;                 // Constant added to the value
+    uint64_t m_varSize;             // The size of the value in bytes
+    uint64_t m_valueOffset;         // Where the agent writes the value, from the start of the value area
+    HsailAgentStatus m_readStatus;  // Written by the agent once the value is read
+} HsailVariableLocation;
+
+// The condition bytecode of a breakpoint record
+typedef struct _HsailConditionBytecodeHeader
+{
+    uint32_t m_bytecodeLen;         // The size of the bytecode in bytes
+    uint32_t m_numVariables;        // The number of HsailVariableLocation following the bytecode
+} HsailConditionBytecodeHeader;
+
+// Layout of the variable read buffer:
+// The header, followed by m_numVariables HsailVariableLocation structures, followed by the value area
+typedef struct _HsailVariableReadHeader
+{
+    uint32_t m_numVariables;        // The number of locations, written by GDB
+    uint32_t m_numValuesRead;       // The number of values read, written by the agent
+    uint64_t m_valueAreaOffset;     // Offset of the value area from the start of the buffer
+    uint64_t m_valueAreaSize;       // Size of the value area in bytes
+} HsailVariableReadHeader;
+
+// Layout of the variable gather buffer:
+// GDB writes a HsailVariableGatherHeader describing one scalar variable and the work-items to read
+// it from, then sends HSAIL_COMMAND_GATHER_VARIABLE. The agent reads the variable from every active
+// lane of the scope, the waves in the order of the wave buffer snapshot and the lanes of each wave
+// in increasing order, and fills in the rest of the header.
+//
+// HSAIL_GATHER_MODE_PACKED: the values are written one after the other, m_location.m_varSize bytes
+// each, from m_valueAreaOffset. The values that do not fit in m_valueAreaSize are left out, and
+// m_numValuesWritten is then smaller than m_numLanes.
+// HSAIL_GATHER_MODE_REDUCE: only the reductions are written. They are computed on int64_t, uint64_t
+// or double values as given by m_encoding (a float is widened to a double), and stored in the
+// uint64_t fields with their bits unchanged. Integer sums wrap around, NaN values are left out of the
+// min, the max and the histogram. Bucket i of the histogram counts the values in
+// [m_min + i * m_bucketWidth, m_min + (i + 1) * m_bucketWidth), the last bucket also counts m_max.
+#define HSAIL_VARIABLE_GATHER_VERSION 1
+
+#define HSAIL_GATHER_HISTOGRAM_BUCKETS 16
+
+typedef enum
+{
+    HSAIL_GATHER_SCOPE_WAVE,        // The lanes of the wave m_waveIndex
+    HSAIL_GATHER_SCOPE_WORK_GROUP,  // The lanes of the waves of the work-group m_workGroupId
+    HSAIL_GATHER_SCOPE_DISPATCH     // The lanes of all the waves of the dispatch
+} HsailGatherScope;
+
+typedef enum
+{
+    HSAIL_GATHER_MODE_PACKED,       // Write the value of each lane
+    HSAIL_GATHER_MODE_REDUCE        // Only write the reductions of the values
+} HsailGatherMode;
+
+typedef enum
+{
+    HSAIL_GATHER_ENCODING_SIGNED,   // A signed integer, sign extended from m_varSize bytes
+    HSAIL_GATHER_ENCODING_UNSIGNED, // An unsigned integer, zero extended from m_varSize bytes
+    HSAIL_GATHER_ENCODING_FLOAT     // A float (4 bytes) or a double (8 bytes)
+} HsailGatherEncoding;
+
+typedef struct _HsailVariableGatherHeader
+{
+    uint32_t m_version;             // HSAIL_VARIABLE_GATHER_VERSION
+    HsailGatherScope m_scope;       // The work-items to read the variable from
+    HsailGatherMode m_mode;         // Packed values or reductions
+    HsailGatherEncoding m_encoding; // How the values are compared and added up
+    uint32_t m_waveIndex;           // The wave of HSAIL_GATHER_SCOPE_WAVE, in the order of the snapshot
+    HsailWaveDim3 m_workGroupId;    // The work-group of HSAIL_GATHER_SCOPE_WORK_GROUP
+    HsailVariableLocation m_location; // The variable, at most 8 bytes, m_valueOffset is not used
+    uint64_t m_valueAreaOffset;     // Offset of the packed values from the start of the buffer
+    uint64_t m_valueAreaSize;       // Size of the value area in bytes
+
+    // Written by the agent
+    HsailAgentStatus m_status;      // HSAIL_AGENT_STATUS_SUCCESS if the variable was read from every lane
+    uint32_t m_reserved;
+    uint64_t m_numLanes;            // The number of active lanes in the scope
+    uint64_t m_numValuesWritten;    // The number of packed values in the value area
+    uint64_t m_min;
+    uint64_t m_max;
+    uint64_t m_sum;
+    uint64_t m_numUnique;           // The number of distinct values
+    uint64_t m_bucketWidth;         // The width of each histogram bucket
+    uint32_t m_minWaveIndex;        // The first lane holding the minimum, the wave in the order of the snapshot
+    uint32_t m_minLane;
+    uint32_t m_maxWaveIndex;        // The first lane holding the maximum
+    uint32_t m_maxLane;
+    uint64_t m_histogram[HSAIL_GATHER_HISTOGRAM_BUCKETS];
+} HsailVariableGatherHeader;
+
+// Layout of the breakpoint statistics buffer:
+// The header, followed by m_numEntries HsailBreakpointStatistics entries indexed by GDB breakpoint number.
+// The agent creates the buffer zeroed and increments the counters of a breakpoint atomically each time
+// a wave reaches it, whether or not the wave stops. GDB only reads the buffer.
+#define HSAIL_BREAKPOINT_STATISTICS_VERSION 1
+
+// Bucket i of the wave histogram counts the waves that reached the breakpoint with
+// 2^i to 2^(i+1)-1 active work-items, the last bucket also counts the larger waves
+#define HSAIL_BREAKPOINT_HISTOGRAM_BUCKETS 8
+
+typedef struct _HsailBreakpointStatisticsHeader
+{
+    uint32_t m_version;             // HSAIL_BREAKPOINT_STATISTICS_VERSION
+    uint32_t m_numEntries;          // The number of entries, breakpoints with a larger number are not counted
+} HsailBreakpointStatisticsHeader;
+
+typedef struct _HsailBreakpointStatistics
+{
+    uint64_t m_hitCount;            // The number of waves that reached the breakpoint
+    uint64_t m_workItemHitCount;    // The number of active work-items in those waves
+    uint64_t m_waveHistogram[HSAIL_BREAKPOINT_HISTOGRAM_BUCKETS];
+} HsailBreakpointStatistics;
+
 // the hardware wave address
 typedef uint32_t HsailWaveAddress;
 
 // the program counter (byte offset in the ISA binary)
 typedef uint64_t HsailProgramCounter;
 
-// We have filtered out the Databreakpointinfo for now
+// Layout of the wave buffer:
+// A HsailWaveSnapshotHeader, followed by one array per wave field (struct of arrays), each holding
+// m_numWaves entries at the offset given in the header, followed by m_numLaneOverrides
+// HsailWaveLaneOverride entries sorted by wave and lane. Offsets are from the start of the
+// buffer and aligned to 8 bytes.
+//
+// The work-item IDs of a wave are not sent: the local work-item ID of lane L is the ID of the
+// work-item following the wave's base work-item ID by L in the work-group (x varies fastest),
+// unless the wave has an override for the lane.
+//
+// The agent starts with a segment of g_WAVE_BUFFER_INITIAL_SIZE bytes. When a snapshot does not
+// fit, it removes the segment and creates a larger one with the same key, GDB attaches to the
+// new segment when it sees the key refers to another segment.
+//
+// Delta snapshots (version 2):
+// Each snapshot has a sequence number. When only some waves changed since the previous snapshot,
+// the agent updates their entries in place, and lists them in the changed-waves bitmap and in
+// the delta records, with m_baseSequence set to the sequence of the previous snapshot. The other
+// entries are left as they were, so a reader that has the base snapshot only needs to look at
+// the waves in the delta records. The agent writes a full snapshot (m_baseSequence 0) when the
+// number of waves, the layout, the lane overrides or the segment change. In a full snapshot
+// m_numDeltaRecords is 0 and the bitmap has a bit set for every wave that may have changed.
+#define HSAIL_WAVE_SNAPSHOT_MAGIC 0x48534157    // "HSAW"
+#define HSAIL_WAVE_SNAPSHOT_VERSION_FULL 1
+#define HSAIL_WAVE_SNAPSHOT_VERSION_DELTA 2
+#define HSAIL_WAVE_SNAPSHOT_VERSION HSAIL_WAVE_SNAPSHOT_VERSION_DELTA
+
+// The fields of a wave changed by a delta record
+#define HSAIL_WAVE_FIELD_WORK_GROUP_ID 0x1
+#define HSAIL_WAVE_FIELD_BASE_WORK_ITEM_ID 0x2
+#define HSAIL_WAVE_FIELD_EXEC_MASK 0x4
+#define HSAIL_WAVE_FIELD_WAVE_ADDRESS 0x8
+#define HSAIL_WAVE_FIELD_PC 0x10
+
+typedef struct _HsailWaveSnapshotHeader
+{
+    uint32_t m_magic;               // HSAIL_WAVE_SNAPSHOT_MAGIC
+    uint32_t m_version;             // HSAIL_WAVE_SNAPSHOT_VERSION
+    uint32_t m_headerSize;          // sizeof(HsailWaveSnapshotHeader) of the agent
+    uint32_t m_numWaves;            // The number of waves in the snapshot
+    uint64_t m_snapshotSize;        // The bytes used in the buffer, including the header
+    HsailWaveDim3 m_workGroupSize;  // The work-group size of the dispatch
+    uint32_t m_numLaneOverrides;    // The number of HsailWaveLaneOverride entries
+    uint64_t m_workGroupIdOffset;   // HsailWaveDim3 work-group ID of each wave
+    uint64_t m_baseWorkItemIdOffset; // HsailWaveDim3 local work-item ID of lane 0 of each wave
+    uint64_t m_execMaskOffset;      // uint64_t execution mask of each wave
+    uint64_t m_waveAddressOffset;   // HsailWaveAddress hw wave slot address of each wave (not unique for the dispatch)
+    uint64_t m_pcOffset;            // HsailProgramCounter program counter of each wave
+    uint64_t m_laneOverrideOffset;  // The HsailWaveLaneOverride entries
+
+    // Version 2, the header of a version 1 snapshot ends here
+    uint64_t m_sequence;            // Incremented for each snapshot of the segment, never 0
+    uint64_t m_baseSequence;        // The snapshot this one updates, 0 for a full snapshot
+    uint64_t m_changedWaveBitmapOffset; // Bit i % 8 of byte i / 8 is set if wave i changed since the previous snapshot
+    uint64_t m_deltaRecordOffset;   // The HsailWaveDeltaRecord entries, sorted by wave
+    uint32_t m_numDeltaRecords;     // The number of HsailWaveDeltaRecord entries
+    uint32_t m_reserved;
+} HsailWaveSnapshotHeader;
+
+// The size of a version 1 header
+#define HSAIL_WAVE_SNAPSHOT_HEADER_SIZE_FULL offsetof(HsailWaveSnapshotHeader, m_sequence)
+
+// A wave whose entries in the arrays changed since the base snapshot
+typedef struct _HsailWaveDeltaRecord
+{
+    uint32_t m_waveIndex;           // The wave, in the order of the snapshot
+    uint32_t m_changedFields;       // HSAIL_WAVE_FIELD_ bits of the fields that changed
+} HsailWaveDeltaRecord;
+
+// A lane whose local work-item ID does not follow from the base work-item ID of its wave,
+// for instance in the partial work-groups at the edge of the grid
+typedef struct _HsailWaveLaneOverride
+{
+    uint32_t m_waveIndex;           // The wave, in the order of the snapshot
+    uint32_t m_lane;                // The lane in the wave
+    HsailWaveDim3 m_workItemId;     // The local work-item ID of the lane
+} HsailWaveLaneOverride;
+
+// Layout of the wave buffer written by the agents that predate the snapshot:
+// m_numActiveWaves of the breakpoint notification HsailAgentWaveInfo entries, with no header.
+// GDB reads the buffer this way when it does not start with HSAIL_WAVE_SNAPSHOT_MAGIC.
 typedef struct _HsailAgentWaveInfo
 {
     HsailWaveDim3           workGroupId;         /**< work-group id */
@@ -20,14 +20,30 @@ const int g_MOMENTARY_BP_BUFFER_SHMKEY = 1111;
 
 const int g_ISASTREAM_SHMKEY = 4567;
 
+// SHM Segment used for batched variable reads, GDB writes the locations and the agent fills in the values
+const int g_VARIABLE_READ_BUFFER_SHMKEY = 3333;
+
+// SHM Segment with the hit counters of each breakpoint, written by the agent and read by GDB
+const int g_BREAKPOINT_STATISTICS_SHMKEY = 5555;
+
+// SHM Segment used to gather a variable from many work-items, GDB writes the request and the agent the values
+const int g_VARIABLE_GATHER_BUFFER_SHMKEY = 6666;
+
 const size_t g_MOMENTARY_BP_BUFFER_MAXSIZE = 1024 * 1024 * 20;
 
 const size_t g_BINARY_BUFFER_MAXSIZE = 1024 * 1024 * 10;
 
-const size_t g_WAVE_BUFFER_MAXSIZE = 1024 * 1024;
+// The agent grows the wave buffer when a snapshot does not fit, see HsailWaveSnapshotHeader
+const size_t g_WAVE_BUFFER_INITIAL_SIZE = 64 * 1024;
 
 const size_t g_ISASTREAM_MAXSIZE = 1024 * 1024;
 
+const size_t g_VARIABLE_READ_BUFFER_MAXSIZE = 1024 * 1024;
+const size_t g_BREAKPOINT_STATISTICS_MAXSIZE = 1024 * 1024;
+
+// Room for the 8 byte values of a million work-items
+const size_t g_VARIABLE_GATHER_BUFFER_MAXSIZE = 1024 * 1024 * 8 + 4096;
+
 // The names of the Fifos - opened in GDB and the agent
 
 // The FIFO written to by the agent and read by GDB (For things like bp statistics)
@@ -6364,6 +6364,10 @@ print_one_breakpoint_location (struct breakpoint *b,
   
   if (!part_of_multiple)
     {
+      /* The HSAIL hit counts are only read from the agent when they are printed */
+      if (b->type == bp_hsail)
+	hsail_breakpoint_refresh_statistics (b);
+
       if (b->hit_count)
 	{
 	  /* FIXME should make an annotation for this.  */
@@ -6386,6 +6390,9 @@ print_one_breakpoint_location (struct breakpoint *b,
 	  if (ui_out_is_mi_like_p (uiout))
 	    ui_out_field_int (uiout, "times", b->hit_count);
 	}
+
+      if (b->type == bp_hsail)
+	hsail_breakpoint_print_statistics (b);
     }
 
   if (!part_of_multiple && b->ignore_count)
@@ -10059,10 +10066,10 @@ delete_breakpoint_hsail(struct breakpoint *bpt)
         {
           hsail_enqueue_delete_breakpoint_packet(bpt->number);
         }
-      else
-        {
-          hsail_enqueue_delete_breakpoint_request_buffer(bpt->number);
-        }
+
+      /* A source breakpoint stays pending after hsail is initialized,
+       * until the debug information is loaded */
+      hsail_enqueue_delete_breakpoint_request_buffer(bpt->number);
 
       if (bpt->hsail_bp_request != NULL)
         {
@@ -16437,7 +16444,7 @@ break hsail\t\t\t Break on every HSAIL dispatch \n\
 break hsail:[Kernel_name]\t Break when kernel [Kernel_name] is about to \n\
 \t\t\t\t begin execution\n\
 break hsail:[Line_number]\t Break when execution hits line [Line_number] \n\
-\t\t\t\t in temp_source\n\n\
+\t\t\t\t in temp_source (\"hsail save-source\" writes it)\n\n\
 "
 
 
@@ -47,6 +47,8 @@
 /* HSAIL-GDB headers*/
 #include "hsail-breakpoint.h"
 #include "hsail-cmd.h"
+#include "hsail-condition.h"
+#include "hsail-dbginfo-cache.h"
 #include "hsail-fifo-control.h"
 #include "hsail-tdep.h"
 #include "hsail-utils.h"
@@ -58,6 +60,18 @@
 /* This buffer is static and managed by HwDbgFacilities */
 static HwDbgInfo_debug gs_DbgInfo = NULL;
 static char* gs_hsail_source = NULL;
+static size_t gs_hsail_source_len = 0;
+
+/* The code object gs_hsail_source was read from and its text in the debug info */
+static uint64_t gs_hsail_source_hash = 0;
+static size_t gs_hsail_source_binary_size = 0;
+static const char* gs_hsail_source_text = NULL;
+
+/* Start offsets of the lines in gs_hsail_source, line N starts at
+ * gs_hsail_source_line_offsets[N-1]. The index is rebuilt for each new binary
+ * and has one extra entry holding the length of the source */
+static size_t* gs_hsail_source_line_offsets = NULL;
+static size_t gs_hsail_source_num_lines = 0;
 static const HsailWaveDim3 gs_unknown_wave_dim = {-1,-1,-1};
 
 int is_hsail_breakpoint(char *arg)
@@ -111,51 +125,26 @@ bool hsail_breakpoint_compare_bp_request(const HsailBreakpointRequest* request_1
   switch (request_1->type)
   {
   case HSAIL_BP_TYPE_KERNEL_FUNCTION:
-    ret_code = false;
     /*okay to use strcmp here since we expect the strings to be properly terminated*/
-    if( request_1->bp.source_location.file_name == NULL ||
-        request_2->bp.source_location.file_name == NULL)
-      {
-        if(strcmp(request_1->bp.kernel_func.func_name,
-                  request_2->bp.kernel_func.func_name) == 0)
-          {
-            ret_code = true;
-          }
-      }
-    else
-      {
-        ret_code = false;
-      }
+    ret_code = (request_1->bp.kernel_func.func_name != NULL &&
+                request_2->bp.kernel_func.func_name != NULL &&
+                strcmp(request_1->bp.kernel_func.func_name,
+                       request_2->bp.kernel_func.func_name) == 0);
     break;
 
   case HSAIL_BP_TYPE_SOURCE_LOCATION:
     ret_code = false;
-    if( request_1->bp.source_location.file_name != NULL &&
-        request_2->bp.source_location.file_name != NULL)
+    if (request_1->bp.source_location.line_num ==
+        request_2->bp.source_location.line_num)
       {
-        /*Do the compare*/
-        if(strcmp(request_1->bp.source_location.file_name,
-                  request_2->bp.source_location.file_name) == 0
-            &&
-            request_1->bp.source_location.line_num ==
-            request_2->bp.source_location.line_num)
-          {
-            ret_code = true;
-          }
-      }
-    /* A null is reasonable since the user will not have entered a filename */
-    if( request_1->bp.source_location.file_name == NULL &&
-        request_2->bp.source_location.file_name == NULL)
-      {
-        /*Do the compare*/
-        if(strcmp(request_1->bp.source_location.file_name,
-                  request_2->bp.source_location.file_name) == 0
-            &&
-            request_1->bp.source_location.line_num ==
-            request_2->bp.source_location.line_num)
-          {
-            ret_code = true;
-          }
+        /* A null is reasonable since the user will not have entered a filename,
+         * the saved requests get the placeholder name instead */
+        const char* file_name_1 = (request_1->bp.source_location.file_name != NULL) ?
+                                  request_1->bp.source_location.file_name : "temp_source";
+        const char* file_name_2 = (request_2->bp.source_location.file_name != NULL) ?
+                                  request_2->bp.source_location.file_name : "temp_source";
+
+        ret_code = (strcmp(file_name_1, file_name_2) == 0);
       }
     break;
 
@@ -337,6 +326,24 @@ void hsail_breakpoint_clear_bp_request(HsailBreakpointRequest* bp_request)
     bp_request->type = HSAIL_BP_TYPE_UNKNOWN;
 }
 
+/* The expression of a condition: the condition string after " if " and its following spaces */
+static const char* hsail_breakpoint_condition_expression(const HsailBreakpointCondition* condition)
+{
+  const char* expression = NULL;
+
+  gdb_assert(condition != NULL);
+  gdb_assert(condition->condition_string != NULL);
+  gdb_assert(strncmp(condition->condition_string, " if ", 4) == 0);
+
+  expression = &(condition->condition_string[4]);
+  while (*expression == ' ')
+    {
+      ++expression;
+    }
+
+  return expression;
+}
+
 static bool hsail_breakpoint_encode_condition(HsailBreakpointCondition* condition)
 {
   bool ret_code = false;
@@ -394,6 +401,16 @@ static bool hsail_breakpoint_encode_condition(HsailBreakpointCondition* conditio
            * of "wg", or the first "w" of "wi" for "if wi:1,0,0 wg:0,0,0".*/
           condition_string = &(condition->condition_string[first_valid_arg_location]);
 
+          /* Anything but the "wg:x,y,z wi:x,y,z" form is an expression, which the agent
+           * evaluates from its bytecode. The bytecode is compiled once the breakpoint
+           * is resolved, since it needs the kernel variables in scope */
+          if (strncmp(condition_string, "wg:", 3) != 0 &&
+              strncmp(condition_string, "wi:", 3) != 0)
+            {
+              condition->condition_code = HSAIL_BREAKPOINT_CONDITION_BYTECODE;
+              return hsail_condition_check(condition_string);
+            }
+
           bool wg_ret_code = false;
           bool wi_ret_code = false;
           wg_ret_code = hsail_command_get_argument(
@@ -725,124 +742,151 @@ char* hsail_dbginfo_get_source_buffer(void)
   return gs_hsail_source;
 }
 
-/* This function takes in the debuginfo handle so that it can
- * get the source buffer for gdb.
+/* Build the line start offsets for the source buffer,
+ * a line ends with a '\n' or at the end of the buffer */
+static void hsail_dbginfo_index_source_lines(void)
+{
+  const char* line_end = NULL;
+  size_t num_lines = 0;
+  size_t offset = 0;
+
+  free_current_contents(&gs_hsail_source_line_offsets);
+  gs_hsail_source_num_lines = 0;
+
+  gdb_assert(gs_hsail_source != NULL);
+
+  /* Count the lines first so that the offsets are allocated once */
+  for (offset = 0; offset < gs_hsail_source_len; num_lines++)
+    {
+      line_end = memchr(gs_hsail_source + offset, '\n', gs_hsail_source_len - offset);
+      offset = (line_end == NULL) ? gs_hsail_source_len : (size_t)(line_end - gs_hsail_source) + 1;
+    }
+
+  gs_hsail_source_line_offsets = XNEWVEC(size_t, num_lines + 1);
+  gdb_assert(gs_hsail_source_line_offsets != NULL);
+
+  for (offset = 0; offset < gs_hsail_source_len; gs_hsail_source_num_lines++)
+    {
+      gs_hsail_source_line_offsets[gs_hsail_source_num_lines] = offset;
+      line_end = memchr(gs_hsail_source + offset, '\n', gs_hsail_source_len - offset);
+      offset = (line_end == NULL) ? gs_hsail_source_len : (size_t)(line_end - gs_hsail_source) + 1;
+    }
+
+  gdb_assert(gs_hsail_source_num_lines == num_lines);
+  gs_hsail_source_line_offsets[num_lines] = gs_hsail_source_len;
+}
+
+size_t hsail_dbginfo_get_source_num_lines(void)
+{
+  return gs_hsail_source_num_lines;
+}
+
+/* Get a line of the HSAIL source without copying it.
+ * The line points into the source buffer, it is not NUL terminated and
+ * the length does not include the newline.
  */
-char* hsail_dbginfo_get_srcline_from_buffer(const HwDbgInfo_debug dbg,
-                                            const HwDbgInfo_linenum line_num)
+bool hsail_dbginfo_get_source_line(const HwDbgInfo_linenum line_num,
+                                   const char** line,
+                                   size_t* line_len)
 {
+  size_t line_start = 0;
+  size_t line_end = 0;
 
-  char* op_str = NULL;
-  HwDbgInfo_linenum count = 0;
-  char* temp_file_name = NULL;
-  int status = 0;
-  FILE* temp_file_handle = NULL;
-  int raw_index = 0;
-  char* raw_line = NULL;
-  char* get_line_array = NULL;
-  char* op_line = NULL;
-  int i = 0;
-  gdb_assert(dbg != NULL);
+  gdb_assert(line != NULL);
+  gdb_assert(line_len != NULL);
 
-  /*
-   * GDB's build gives a warning that tmpnam is unsafe since it is only valid for TMP_MAX
-   * calls to the function.
-   * However, on Linux, TMP_MAX is 238328 so we are fine. This is only called when user
-   * creates a source breakpoint
-   *
-   * The problem with mkstemp which is recommended to be used here is that I dont know if
-   * it can be opened for both read and write.
-   *
-   * Note: as per the man page, temp_file_name is a static buffer internally
-   * and should not be 'freed'
-   */
-  temp_file_name = tmpnam(NULL);
-  gdb_assert(temp_file_name != NULL);
+  *line = NULL;
+  *line_len = 0;
 
-  temp_file_handle = fopen(temp_file_name,"wb");
-  gdb_assert(temp_file_handle != NULL);
+  if (gs_hsail_source_line_offsets == NULL ||
+      line_num < 1 || line_num > gs_hsail_source_num_lines)
+    {
+      return false;
+    }
 
-  fprintf(temp_file_handle, "%s",gs_hsail_source);
-  rewind(temp_file_handle);
-  fclose(temp_file_handle);
+  line_start = gs_hsail_source_line_offsets[line_num - 1];
+  line_end = gs_hsail_source_line_offsets[line_num];
 
-  temp_file_handle = fopen(temp_file_name,"rt");
-  gdb_assert(temp_file_handle != NULL);
-  count = 1;
+  if (line_end > line_start && gs_hsail_source[line_end - 1] == '\n')
+    {
+      line_end--;
+    }
 
-  raw_line = xmalloc(sizeof(char)*AGENT_MAX_SOURCE_LINE_LEN);
-  op_line = xmalloc(sizeof(char)*AGENT_MAX_SOURCE_LINE_LEN);
+  *line = gs_hsail_source + line_start;
+  *line_len = line_end - line_start;
 
-  gdb_assert(NULL != raw_line);
-  gdb_assert(NULL != op_line);
+  return true;
+}
 
-  memset(raw_line, '\0', AGENT_MAX_SOURCE_LINE_LEN);
-  memset(op_line, '\0', AGENT_MAX_SOURCE_LINE_LEN);
+/* Write the source buffer to a file, only done when the user asks for it */
+bool hsail_dbginfo_save_source_to_file(const char* file_name)
+{
+  FILE* file_handle = NULL;
+  size_t bytes_written = 0;
 
-  size_t len =0;
-  while (!feof(temp_file_handle))
+  gdb_assert(file_name != NULL);
+
+  if (gs_hsail_source == NULL)
     {
-      /* We copy the get_line_array into the raw_line array since we
-       * want to keep the line limited to AGENT_MAX_SOURCE_LINE_LEN
-       * */
-      if (getline(&get_line_array, &len, temp_file_handle) == -1)
-        {
-          break;
-        }
-      if (count == line_num)
-        {
-          /* AGENT_MAX_SOURCE_LINE_LEN-1 since we don't want smash the \0 */
-          strncpy(raw_line, get_line_array, AGENT_MAX_SOURCE_LINE_LEN-1);
-          break;
-        }
-      count++;
+      return false;
     }
 
-  /* note: getline reallocates the array if not null, so we only need to free it at the end*/
-  if (get_line_array != NULL)
+  file_handle = fopen(file_name, "wb");
+  if (file_handle == NULL)
     {
-      free_current_contents(&get_line_array);
+      return false;
     }
 
-  /* We need to remove the last newline character and the leading space */
-  raw_index=0;
-  i=0;
-  while(raw_line[raw_index] != '\0')
+  bytes_written = fwrite(gs_hsail_source, sizeof(char), gs_hsail_source_len, file_handle);
+  fclose(file_handle);
+
+  return bytes_written == gs_hsail_source_len;
+}
+
+/* This function takes in the debuginfo handle so that it can
+ * get the source buffer for gdb.
+ */
+char* hsail_dbginfo_get_srcline_from_buffer(const HwDbgInfo_debug dbg,
+                                            const HwDbgInfo_linenum line_num)
+{
+  const char* raw_line = NULL;
+  size_t raw_line_len = 0;
+  size_t raw_index = 0;
+  char* op_line = NULL;
+  int i = 0;
+  gdb_assert(dbg != NULL);
+
+  op_line = xmalloc(sizeof(char)*AGENT_MAX_SOURCE_LINE_LEN);
+  gdb_assert(NULL != op_line);
+  memset(op_line, '\0', AGENT_MAX_SOURCE_LINE_LEN);
+
+  if (hsail_dbginfo_get_source_line(line_num, &raw_line, &raw_line_len))
     {
-      if(isspace(raw_line[raw_index]))
+      /* Keep the line limited to AGENT_MAX_SOURCE_LINE_LEN-1 since we don't want smash the \0 */
+      if (raw_line_len > AGENT_MAX_SOURCE_LINE_LEN - 1)
         {
-          raw_index++;
+          raw_line_len = AGENT_MAX_SOURCE_LINE_LEN - 1;
         }
-      else
+
+      /* We need to remove the leading space */
+      while (raw_index < raw_line_len && isspace(raw_line[raw_index]))
         {
-          break;
+          raw_index++;
         }
-    }
 
-  /*Move string to beginning since we want to use same pointer to delete*/
-  for(i=0; raw_line[i] != '\0';i++)
-    {
-      /* We dont want to copy a new line character over,
-       * but we do want a semi-colon if present so we don't check for semi-colon
+      /* We do want a semi-colon if present so we don't check for semi-colon
        * before the copy */
-      if (raw_line[raw_index+i] == '\n')
+      for (i = 0; raw_index + i < raw_line_len; i++)
         {
-          break;
-        }
-      op_line[i]=raw_line[raw_index+i];
+          op_line[i] = raw_line[raw_index + i];
 
-      /*If we see a semicolon, end it*/
-      if (op_line[i] == ';')
-        {
-          break;
+          /*If we see a semicolon, end it*/
+          if (op_line[i] == ';')
+            {
+              break;
+            }
         }
     }
-  op_line[i+1]='\0';
-
-  free_current_contents(&raw_line);
-
-  status = remove(temp_file_name);
-  gdb_assert(status == 0);
 
   /* It is possible that the op_line string is now empty if the input line
    * number had only space or line feeds.
@@ -892,9 +936,8 @@ void hsail_free_hwdbginfo(void)
     {
       gdb_assert(gs_DbgInfo!= NULL);
 
-      /* Release the debug info handle: */
-      hwdbginfo_release_debug_info(&gs_DbgInfo);
-
+      /* The debug info handle is owned by the debug info cache,
+       * it is released when it is evicted from the cache */
       gs_DbgInfo = NULL;
     }
 }
@@ -903,6 +946,9 @@ void hsail_free_hwdbginfo(void)
  * Initialize the hwdbginfo handle by calling the debug Facilities API
  * with the binary found in a shmem segment.
  *
+ * The HwDbgInfo_debug object of each code object is kept in the debug info
+ * cache, a code object that is dispatched again is not parsed again.
+ *
  * The HwDbgInfo_debug object is cached. If there is already a binary loaded,
  * then this function will return a copy of the HwDbgInfo_debug object.
  * If you expect that a binary has already been loaded, then this function can
@@ -941,73 +987,71 @@ HwDbgInfo_debug hsail_init_hwdbginfo(HsailNotificationPayload* payload)
       /* A copy of the shared memory segment */
       void* dbe_binary = NULL;
       size_t dbe_binary_size = 0;
+      uint64_t dbe_binary_hash = 0;
 
-      int shmid = -1;
+      /* Get shm pointer, the segment stays attached for the debugging session */
+      pShm = hsail_tdep_map_binary_buffer();
 
-      /*1M used is hard wired for now*/
-      shmid = shmget(hsail_get_agent_binary_shmem_key(), max_shared_mem_size, 0666);
+      gdb_assert(pShm != NULL);
 
-      if (shmid <= 0)
-        {
-          ui_out_text(uiout, "GDB: HwDbgFacilities init: shmid is invalid\n");
-        }
+      dbe_binary_size = ((size_t*)pShm)[0];
 
-      gdb_assert(shmid > 0);
+      gdb_assert(dbe_binary_size > 0 && dbe_binary_size < max_shared_mem_size);
 
-      /* Get shm pointer */
-      pShm = (int*)shmat(shmid, NULL, 0);
+      /* Redispatching a known code object reuses its debug info */
+      dbe_binary_hash = hsail_dbginfo_cache_hash((size_t*)pShm+1, dbe_binary_size);
+      dbg_op = hsail_dbginfo_cache_lookup(dbe_binary_hash, dbe_binary_size);
 
-      if (pShm == NULL)
+      if (dbg_op == NULL)
         {
-          ui_out_text(uiout, "GDB: HwDbgFacilities init: pShm is NULL\n");
-        }
-
-      gdb_assert(pShm != NULL);
+          dbe_binary = xmalloc(dbe_binary_size);
 
-      dbe_binary_size = ((size_t*)pShm)[0];
-
-      gdb_assert(dbe_binary_size > 0 && dbe_binary_size < max_shared_mem_size);
+          gdb_assert(dbe_binary != NULL);
 
-      dbe_binary = xmalloc(dbe_binary_size);
+          memcpy(dbe_binary,(size_t*)pShm+1,dbe_binary_size);
 
-      gdb_assert(dbe_binary != NULL);
+          /* Granite (HSA 0.95) needs a hard-wired kernel name: */
+          /* dbg_op = hwdbginfo_init_with_hsa_1_0_binary(dbe_binary, dbe_binary_size, "&__Gdt_vectoradd_kernel", &errOut); */
+          /* Use Obsidian (HSA 1.0) binary format (May. 2015): */
+          dbg_op = hwdbginfo_init_with_hsa_1_0_binary(dbe_binary,
+                                                      dbe_binary_size,
+                                                      &errOut);
 
-      memcpy(dbe_binary,(size_t*)pShm+1,dbe_binary_size);
+          /* Keep this printf here as a reminder for a
+           * quick way to check that the IPC happened correctly*/
 
-      /* Granite (HSA 0.95) needs a hard-wired kernel name: */
-      /* dbg_op = hwdbginfo_init_with_hsa_1_0_binary(dbe_binary, dbe_binary_size, "&__Gdt_vectoradd_kernel", &errOut); */
-      /* Use Obsidian (HSA 1.0) binary format (May. 2015): */
-      dbg_op = hwdbginfo_init_with_hsa_1_0_binary(dbe_binary,
-                                                  dbe_binary_size,
-                                                  &errOut);
+          /*
+          int i = 0;
+          for(i = 0; i<10;i++)
+            {
+              printf("%d \t %d\n",i,*((int*)dbe_binary + i));
+            } */
 
-      /* Keep this printf here as a reminder for a
-       * quick way to check that the IPC happened correctly*/
+          if (errOut != HWDBGINFO_E_SUCCESS)
+            {
+              /* HwDbgFacilities init: Called DebugFacilities InCorrectly.
+               * We can add more detailed messages such as low-level dwarf or high level dwarf missing in the future
+               * */
+              ui_out_text(uiout, "[hsail-gdb]: The code object for the current dispatch does not contain debug information\n");
 
-      /*
-      int i = 0;
-      for(i = 0; i<10;i++)
-        {
-          printf("%d \t %d\n",i,*((int*)dbe_binary + i));
-        } */
+              fflush(stdout);
 
-      if (errOut != HWDBGINFO_E_SUCCESS)
-        {
-          /* HwDbgFacilities init: Called DebugFacilities InCorrectly.
-           * We can add more detailed messages such as low-level dwarf or high level dwarf missing in the future
-           * */
-          ui_out_text(uiout, "[hsail-gdb]: The code object for the current dispatch does not contain debug information\n");
+              free_current_contents(&dbe_binary);
+              hsail_tdep_unmap_binary_buffer(pShm);
+              return NULL;
+            }
 
-          fflush(stdout);
+          gdb_assert(errOut == HWDBGINFO_E_SUCCESS);
 
+          /* We can clear the dbe_binary buffer once we have initialized HWDbgFacilities */
           free_current_contents(&dbe_binary);
-          return NULL;
-        }
 
-      gdb_assert(errOut == HWDBGINFO_E_SUCCESS);
+          hsail_dbginfo_cache_insert(dbe_binary_hash, dbe_binary_size, dbg_op);
+        }
 
-      /* We can clear the dbe_binary buffer once we have initialized HWDbgFacilities */
-      free_current_contents(&dbe_binary);
+      /* The binary can hold several code objects, the one that defines the
+       * dispatched kernel is queried first and provides the source */
+      hwdbginfo_set_active_kernel(dbg_op, payload->payload.BinaryNotification.m_KernelName);
 
       /* Get the kernel source */
       hsail_source_len = 0;
@@ -1020,21 +1064,34 @@ HwDbgInfo_debug hsail_init_hwdbginfo(HsailNotificationPayload* payload)
       gdb_assert(temp_hsail_src != NULL);
       gdb_assert(hsail_source_len != 0);
 
-      if (gs_hsail_source == NULL)
+      if (gs_hsail_source != NULL &&
+          gs_hsail_source_hash == dbe_binary_hash &&
+          gs_hsail_source_binary_size == dbe_binary_size &&
+          gs_hsail_source_text == temp_hsail_src)
         {
-          gs_hsail_source = xmalloc(hsail_source_len*sizeof(char)+1);
+          /* The source buffer and its line index are already for this code object */
+          hsail_tdep_unmap_binary_buffer(pShm);
+          gs_DbgInfo = dbg_op;
+          return gs_DbgInfo;
         }
 
+      /* A new binary can have a longer source than the previous one */
+      free_current_contents(&gs_hsail_source);
+      gs_hsail_source = xmalloc(hsail_source_len*sizeof(char)+1);
+
       gdb_assert(gs_hsail_source != NULL);
       memset(gs_hsail_source, '\0', hsail_source_len*sizeof(char) + 1);
       memcpy(gs_hsail_source, temp_hsail_src, hsail_source_len);
+      /* The text can be NUL terminated inside the reported length */
+      gs_hsail_source_len = strlen(gs_hsail_source);
       /*printf("====Static HSAIL Source len %d\n===\n %s\n",hsail_source_len, gs_hsail_source);*/
 
-      /* Detach shared memory */
-      if (shmdt(pShm) == -1)
-        {
-          ui_out_text(uiout, "GDB: HwDbgFacilities init: Error detaching shm\n");
-        }
+      hsail_dbginfo_index_source_lines();
+      gs_hsail_source_hash = dbe_binary_hash;
+      gs_hsail_source_binary_size = dbe_binary_size;
+      gs_hsail_source_text = temp_hsail_src;
+
+      hsail_tdep_unmap_binary_buffer(pShm);
 
 
     }
@@ -1177,7 +1234,8 @@ static int hsail_breakpoint_from_line_resolve(const HsailBreakpointRequest* hsai
   HwDbgInfo_code_location loc = NULL;
   HwDbgInfo_code_location resolvedLoc = NULL;
 
-  HwDbgInfo_addr* addrs = NULL;
+  HwDbgInfo_result addrs_result = NULL;
+  const HwDbgInfo_addr* addrs = NULL;
   size_t addrCount = 0;
 
   size_t i = 0;
@@ -1188,6 +1246,7 @@ static int hsail_breakpoint_from_line_resolve(const HsailBreakpointRequest* hsai
   char* target_file_name = NULL;
   HwDbgInfo_linenum line_num = 0;
   struct breakpoint *gdb_bkpt_handle = NULL;
+  struct hsail_condition_bytecode* condition_bytecode = NULL;
 
   gdb_assert(is_hsail_linux_initialized());
   gdb_assert(hsail_is_debug_facilities_loaded());
@@ -1235,49 +1294,47 @@ static int hsail_breakpoint_from_line_resolve(const HsailBreakpointRequest* hsai
       return -1; /* unexpected error */
     }
 
-  /* Get the number of ISA addresses for this location: */
-  addrCount = 0;
-  err = hwdbginfo_line_to_addrs(hsail_facilities, resolvedLoc, 0, NULL, &addrCount);
+  /* Get the ISA addresses for this location, they stay in the query result
+   * until the breakpoint is enqueued: */
+  addrs_result = hwdbginfo_query_line_to_addrs(hsail_facilities, resolvedLoc, &err);
+  hwdbginfo_release_code_locations(&resolvedLoc, 1);
+  addrs = hwdbginfo_result_addrs(addrs_result, &addrCount);
 
-  if (0 == addrCount && HWDBGINFO_E_NOTFOUND == err)
+  if (0 == addrCount && (HWDBGINFO_E_NOTFOUND == err || HWDBGINFO_E_SUCCESS == err))
     {
-      hwdbginfo_release_code_locations(&resolvedLoc, 1);
+      hwdbginfo_release_result(&addrs_result);
       return 0; /* file / line combination not mapped */
     }
   else if (HWDBGINFO_E_SUCCESS != err)
     {
-      hwdbginfo_release_code_locations(&resolvedLoc, 1);
+      hwdbginfo_release_result(&addrs_result);
       gdb_assert(HWDBGINFO_E_SUCCESS == err);
       return -1; /* unexpected error */
     }
 
-
-  addrs = (HwDbgInfo_addr*)xmalloc(addrCount * sizeof(HwDbgInfo_addr));
-  gdb_assert(NULL != addrs);
-
-  memset(addrs, 0, addrCount * sizeof(HwDbgInfo_addr));
-
-  /* Get the ISA addresses for this location: */
-  err = hwdbginfo_line_to_addrs(hsail_facilities, resolvedLoc, addrCount, addrs, NULL);
-  hwdbginfo_release_code_locations(&resolvedLoc, 1);
-  if (HWDBGINFO_E_SUCCESS != err)
-    {
-      gdb_assert(HWDBGINFO_E_SUCCESS == err);
-      return -1; /* error */
-    }
-
   gdb_bkpt_handle->hsail_pc = addrs[0];
 
   /* Mechanism to update the breakpoint's HSAIL request structure with source line */
   src_line = hsail_dbginfo_get_srcline_from_buffer(hsail_facilities,
                                                    line_num);
 
+  /* The kernel variables in the condition are resolved in the scope of the breakpoint */
+  if (HSAIL_BREAKPOINT_CONDITION_BYTECODE == hsail_bp_req->condition.condition_code)
+    {
+      condition_bytecode = hsail_condition_compile(hsail_breakpoint_condition_expression(&(hsail_bp_req->condition)),
+                                                   hsail_facilities,
+                                                   addrs[0]);
+    }
+
   /* We only need to send the 1st one */
   hsail_enqueue_create_breakpoint_packet(addrs[0],
                                          gdb_bkpt_handle->number,
                                          src_line,
                                          line_num,
-                                         &(hsail_bp_req->condition));
+                                         &(hsail_bp_req->condition),
+                                         condition_bytecode);
+
+  hsail_condition_free(condition_bytecode);
 
 
   /*
@@ -1312,7 +1369,7 @@ static int hsail_breakpoint_from_line_resolve(const HsailBreakpointRequest* hsai
   gdb_bkpt_handle->hsail_bp_request->bp.source_location.src_line = src_line;
 
 
-  xfree(addrs);
+  hwdbginfo_release_result(&addrs_result);
 
   return 0;
 }
@@ -1390,6 +1447,156 @@ void hsail_breakpoint_update_statistics(const int* breakpoint_id, const int* hit
 
 }
 
+/* The agent's counters for a breakpoint in the mapped statistics buffer,
+ * or NULL if the agent does not count this breakpoint */
+static const HsailBreakpointStatistics* hsail_breakpoint_get_statistics(const void* statistics_buffer,
+                                                                        const int gdb_bkpt_num)
+{
+  const HsailBreakpointStatisticsHeader* header = (const HsailBreakpointStatisticsHeader*)statistics_buffer;
+  const HsailBreakpointStatistics* entries = NULL;
+  size_t max_entries = 0;
+
+  gdb_assert(header != NULL);
+
+  max_entries = (hsail_get_breakpoint_statistics_shmem_max_size() - sizeof(HsailBreakpointStatisticsHeader))
+                / sizeof(HsailBreakpointStatistics);
+
+  if (header->m_version != HSAIL_BREAKPOINT_STATISTICS_VERSION ||
+      gdb_bkpt_num < 0 ||
+      (uint32_t)gdb_bkpt_num >= header->m_numEntries ||
+      (size_t)gdb_bkpt_num >= max_entries)
+    {
+      return NULL;
+    }
+
+  entries = (const HsailBreakpointStatistics*)(header + 1);
+
+  return &entries[gdb_bkpt_num];
+}
+
+/* Read the hit count of an HSAIL breakpoint from the agent's counters.
+ * The counters are only read when the breakpoint is printed, not on every hit,
+ * so that breakpoints that do not stop cost GDB nothing */
+void hsail_breakpoint_refresh_statistics(struct breakpoint* p_bp)
+{
+  void* statistics_buffer = NULL;
+  const HsailBreakpointStatistics* statistics = NULL;
+  uint64_t hit_count = 0;
+
+  gdb_assert(p_bp != NULL);
+  gdb_assert(p_bp->type == bp_hsail);
+
+  statistics_buffer = hsail_tdep_map_breakpoint_statistics_buffer();
+  if (statistics_buffer == NULL)
+    {
+      return;
+    }
+
+  statistics = hsail_breakpoint_get_statistics(statistics_buffer, p_bp->number);
+  if (statistics != NULL)
+    {
+      /* The agent is still incrementing the counter, one aligned read gets a consistent value */
+      hit_count = *(volatile const uint64_t*)&statistics->m_hitCount;
+      p_bp->hit_count = (hit_count > INT_MAX) ? INT_MAX : (int)hit_count;
+    }
+
+  hsail_tdep_unmap_breakpoint_statistics_buffer(statistics_buffer);
+}
+
+static int hsail_breakpoint_refresh_statistics_callback(struct breakpoint* p_bp, void* data)
+{
+  if (p_bp->type == bp_hsail)
+    {
+      hsail_breakpoint_refresh_statistics(p_bp);
+    }
+
+  /* Keep iterating */
+  return 0;
+}
+
+void hsail_breakpoint_refresh_all_statistics(void)
+{
+  iterate_over_breakpoints(hsail_breakpoint_refresh_statistics_callback, NULL);
+}
+
+/* Print how many work-items were active in the waves that reached the breakpoint.
+ * The caller of the function needs to handle the spacing before, the line feed
+ * after is printed if anything is */
+void hsail_breakpoint_print_statistics(const struct breakpoint* p_bp)
+{
+  struct ui_out *uiout = current_uiout;
+  void* statistics_buffer = NULL;
+  const HsailBreakpointStatistics* statistics = NULL;
+  char histogram_str[512] = {0};
+  size_t histogram_len = 0;
+  uint64_t num_waves = 0;
+  uint64_t num_work_items = 0;
+  int i = 0;
+
+  gdb_assert(p_bp != NULL);
+  gdb_assert(p_bp->type == bp_hsail);
+
+  statistics_buffer = hsail_tdep_map_breakpoint_statistics_buffer();
+  if (statistics_buffer == NULL)
+    {
+      return;
+    }
+
+  statistics = hsail_breakpoint_get_statistics(statistics_buffer, p_bp->number);
+  if (statistics == NULL)
+    {
+      hsail_tdep_unmap_breakpoint_statistics_buffer(statistics_buffer);
+      return;
+    }
+
+  num_work_items = *(volatile const uint64_t*)&statistics->m_workItemHitCount;
+
+  for (i = 0; i < HSAIL_BREAKPOINT_HISTOGRAM_BUCKETS; i++)
+    {
+      unsigned int lo = 1u << i;
+      unsigned int hi = (1u << (i + 1)) - 1;
+
+      num_waves = *(volatile const uint64_t*)&statistics->m_waveHistogram[i];
+      if (num_waves == 0)
+        {
+          continue;
+        }
+
+      if (i == HSAIL_BREAKPOINT_HISTOGRAM_BUCKETS - 1)
+        {
+          snprintf(histogram_str + histogram_len, sizeof(histogram_str) - histogram_len,
+                   "%s%u+: %llu", (histogram_len > 0) ? ", " : "",
+                   lo, (unsigned long long)num_waves);
+        }
+      else if (lo == hi)
+        {
+          snprintf(histogram_str + histogram_len, sizeof(histogram_str) - histogram_len,
+                   "%s%u: %llu", (histogram_len > 0) ? ", " : "",
+                   lo, (unsigned long long)num_waves);
+        }
+      else
+        {
+          snprintf(histogram_str + histogram_len, sizeof(histogram_str) - histogram_len,
+                   "%s%u-%u: %llu", (histogram_len > 0) ? ", " : "",
+                   lo, hi, (unsigned long long)num_waves);
+        }
+      histogram_len = strlen(histogram_str);
+    }
+
+  hsail_tdep_unmap_breakpoint_statistics_buffer(statistics_buffer);
+
+  if (num_work_items == 0)
+    {
+      return;
+    }
+
+  ui_out_text(uiout, "\twork-items hit: ");
+  ui_out_field_fmt(uiout, "work-item-hits", "%llu", (unsigned long long)num_work_items);
+  ui_out_text(uiout, "\n\twaves by active work-items: ");
+  ui_out_field_string(uiout, "wave-histogram", histogram_str);
+  ui_out_text(uiout, "\n");
+}
+
 /* Return true if this is a condition worth printing */
 bool hsail_breakpoint_is_real_condition(const HsailBreakpointCondition* p_condition)
 {
@@ -1399,6 +1606,7 @@ bool hsail_breakpoint_is_real_condition(const HsailBreakpointCondition* p_condit
       switch (p_condition->condition_code)
       {
       case HSAIL_BREAKPOINT_CONDITION_EQUAL:
+      case HSAIL_BREAKPOINT_CONDITION_BYTECODE:
         ret_code = true;
         break;
       default:
@@ -1436,6 +1644,13 @@ void hsail_breakpoint_print_condition_string(const struct breakpoint* p_bp)
       ui_out_field_string (uiout, "cond", hsail_cond_str);
       break;
     }
+  case HSAIL_BREAKPOINT_CONDITION_BYTECODE:
+    {
+      snprintf(hsail_cond_str, sizeof(hsail_cond_str), "Stop only if: %s",
+               hsail_breakpoint_condition_expression(&(p_bp->hsail_bp_request->condition)));
+      ui_out_field_string (uiout, "cond", hsail_cond_str);
+      break;
+    }
   default:
     break;
   }
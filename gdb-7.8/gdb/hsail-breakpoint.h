@@ -109,6 +109,15 @@ char* hsail_dbginfo_get_source_buffer(void);
 char* hsail_dbginfo_get_srcline_from_buffer(const HwDbgInfo_debug dbg,
                                             const HwDbgInfo_linenum line_num);
 
+/* The HSAIL source lines are indexed when a new binary is loaded */
+size_t hsail_dbginfo_get_source_num_lines(void);
+
+bool hsail_dbginfo_get_source_line(const HwDbgInfo_linenum line_num,
+                                   const char** line,
+                                   size_t* line_len);
+
+bool hsail_dbginfo_save_source_to_file(const char* file_name);
+
 int hsail_breakpoint_set_from_kernel_name(const HsailBreakpointRequest* hsail_bp_req);
 
 int hsail_breakpoint_set_from_line(const HsailBreakpointRequest* hsail_bp_req);
@@ -117,6 +126,13 @@ int hsail_breakpoint_set_any(const HsailBreakpointRequest* hsail_bp_req);
 
 void hsail_breakpoint_update_statistics(const int* breakpoint_id, const int* hit_count, const int array_len);
 
+/* The agent's breakpoint counters are only read when these are called */
+void hsail_breakpoint_refresh_statistics(struct breakpoint* p_bp);
+
+void hsail_breakpoint_refresh_all_statistics(void);
+
+void hsail_breakpoint_print_statistics(const struct breakpoint* p_bp);
+
 void hsail_breakpoint_print_location(const struct breakpoint* p_bp);
 
 bool hsail_breakpoint_is_real_condition(const HsailBreakpointCondition* p_condition);
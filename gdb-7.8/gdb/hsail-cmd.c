@@ -42,12 +42,15 @@
 #include "value.h"
 
 /* hsail-gdb headers */
+#include "hsail-breakpoint.h"
 #include "hsail-cmd.h"
+#include "hsail-dbginfo-cache.h"
 #include "hsail-fifo-control.h"
 #include "hsail-kernel.h"
 #include "hsail-print.h"
 #include "hsail-tdep.h"
 #include "hsail-utils.h"
+#include "hsail-wave-index.h"
 
 /* The header files shared with the agent*/
 #include "CommunicationControl.h"
@@ -71,6 +74,16 @@ static const HsailWaveDim3 gs_unknown_wave_dim = {-1,-1,-1};
 static HsailWaveDim3 gs_active_work_group = {-1,-1,-1};
 static HsailWaveDim3 gs_active_work_item = {-1,-1,-1};
 
+/* The next source line printed by "list" without arguments,
+ * 0 to list around the focus work-item's line */
+static HwDbgInfo_linenum gs_list_next_line = 0;
+
+/* The number of lines printed by "list" */
+static const HwDbgInfo_linenum gs_list_num_lines = 10;
+
+/* The file written by "hsail save-source" when no name is given */
+static const char gs_hsail_default_source_file_name[] = "temp_source";
+
 static int hsail_info_command_index(char* arg, struct ui_out *uiout)
 {
   char index_buffer[256] = { 0 };
@@ -111,10 +124,14 @@ static int hsail_info_command_index(char* arg, struct ui_out *uiout)
 #define HSAIL_INFO_HELP_STRING()\
 "info hsail [kernels]: print all HSAIL kernel dispatches\n"\
 "info hsail [kernel <kernel name>]: print all HSAIL kernel dispatches with a specific kernel name\n"\
+"info hsail [dispatches]: print the most recent HSAIL kernel dispatches\n"\
 "info hsail [work-groups | wgs]: print all HSAIL work-group items\n"\
 "info hsail [work-group <flattened id> | wg <flattened id> | work-group <x,y,z> | wg <x,y,z>]: print a specific HSAIL work-group item\n"\
 "info hsail [work-item | wi | work-items | wis]: print the focus HSAIL work-item\n"\
 "info hsail [work-item <x,y,z> | wi <x,y,z>]: print a specific HSAIL work-item\n"\
+"info hsail [waves]: print all HSAIL waves and whether they moved since the previous stop\n"\
+"info hsail [waves moved]: print the HSAIL waves that moved since the previous stop\n"\
+"info hsail [cache]: print the HSAIL debug info cache statistics\n"\
 
 static void hsail_info_param_print_help(void)
 {
@@ -243,10 +260,13 @@ static bool hsail_info_parameter_check(char* arg)
   if (token != NULL)
     {
       if (strcmp(token, "kernel") != 0 && strcmp(token, "kernels") != 0 &&
+          strcmp(token, "dispatches") != 0 &&
           strcmp(token, "wgs") != 0 && strcmp(token, "wg") != 0 &&
           strcmp(token, "work-group") != 0 && strcmp(token, "work-groups") != 0 &&
           strcmp(token, "wis") != 0  && strcmp(token, "wi") != 0 &&
-          strcmp(token, "work-item") != 0  && strcmp(token, "work-items") != 0
+          strcmp(token, "work-item") != 0  && strcmp(token, "work-items") != 0 &&
+          strcmp(token, "waves") != 0 &&
+          strcmp(token, "cache") != 0
           )
         {
           ret_code = false;
@@ -298,6 +318,10 @@ static void hsail_info_command(char *arg, int from_tty)
     arg += 7;
     hsail_kernel_print_specific_info(arg, current_uiout, -1);
   }
+  else if (strcmp(arg,"dispatches") == 0)
+  {
+    hsail_kernel_print_dispatch_history(current_uiout, -1);
+  }
   else if (strncmp(arg,"work-groups", 11) == 0 || strncmp(arg,"wgs", 3) == 0)
   {
     hsail_print_workgroups_info (gs_active_work_group, current_uiout, -1);
@@ -379,6 +403,18 @@ static void hsail_info_command(char *arg, int from_tty)
       ui_out_text(uiout,"'info hsail work-item x,y,z'  will print info for work-item x,y,z\n");
     }
   }
+  else if (strcmp(arg,"waves") == 0)
+  {
+    hsail_print_waves_info (false, current_uiout, -1);
+  }
+  else if (strcmp(arg,"waves moved") == 0)
+  {
+    hsail_print_waves_info (true, current_uiout, -1);
+  }
+  else if (strcmp(arg,"cache") == 0)
+  {
+    hsail_dbginfo_cache_print_info(current_uiout);
+  }
   else
   {
     hsail_info_param_print_help();
@@ -388,53 +424,48 @@ static void hsail_info_command(char *arg, int from_tty)
 
 static bool hsail_thread_command_validate_active(const unsigned int* workGroup, const unsigned int* workItem)
 {
-  /* get the waves info */
-  int num_waves = hsail_tdep_get_active_wave_count();
-  HsailAgentWaveInfo* wave_info_buffer = (HsailAgentWaveInfo*)hsail_tdep_map_wave_buffer();
-  int nWave = 0;
-  int nExec = 0;
-  uint64_t current_bit = 0;
-  bool found = false;
-
-  /* A NULL is possible if no dispatch is active*/
-  if (NULL == wave_info_buffer)
-    {
-      return found;
-    }
+  HsailWaveDim3 work_group_id;
+  HsailWaveDim3 work_item_id;
 
   gdb_assert(NULL != workGroup);
   gdb_assert(NULL != workItem);
 
+  work_group_id.x = workGroup[0];
+  work_group_id.y = workGroup[1];
+  work_group_id.z = workGroup[2];
+  work_item_id.x = workItem[0];
+  work_item_id.y = workItem[1];
+  work_item_id.z = workItem[2];
 
-  for (nWave = 0 ; nWave < num_waves ; nWave++)
-  {
-      /* check the work-group first */
-      if (workGroup[0] == wave_info_buffer[nWave].workGroupId.x &&
-          workGroup[1] == wave_info_buffer[nWave].workGroupId.y &&
-          workGroup[2] == wave_info_buffer[nWave].workGroupId.z)
-      {
-        /* check all exec flags for the work item */
-        current_bit = 1;
-        for (nExec = 0 ; nExec < 64 ; nExec++)
-        {
-          if (wave_info_buffer[nWave].execMask & current_bit)
-          {
-            if (workItem[0] == wave_info_buffer[nWave].workItemId[nExec].x &&
-                workItem[1] == wave_info_buffer[nWave].workItemId[nExec].y &&
-                workItem[2] == wave_info_buffer[nWave].workItemId[nExec].z)
-            {
-              found = true;
-            }
-            current_bit = current_bit<<1;
-          }
-        }
-      }
-  }
+  /* false if no dispatch is active */
+  return hsail_wave_index_find_workitem(&work_group_id, &work_item_id, NULL, NULL);
+}
 
-  /* release the wave buffer */
-  hsail_tdep_unmap_wave_buffer((void*)wave_info_buffer);
+/* hsail save-source [file name] */
+static void hsail_command_save_source(char* arg)
+{
+  const char* file_name = gs_hsail_default_source_file_name;
+  int arg_length = 0;
 
-  return found;
+  gdb_assert(NULL != arg);
+  arg_length = strlen(arg);
+  SKIP_LEADING_SPACES(arg, arg_length);
+
+  if (arg_length > 0)
+    {
+      TRIM_TAILING_SPACES(arg, arg_length);
+      arg[arg_length] = '\0';
+      file_name = arg;
+    }
+
+  if (hsail_dbginfo_save_source_to_file(file_name))
+    {
+      printf_filtered("HSAIL kernel saved to %s\n", file_name);
+    }
+  else
+    {
+      printf_filtered("HSAIL kernel source could not be saved to %s\n", file_name);
+    }
 }
 
 static void hsail_command(char *arg, int from_tty)
@@ -449,6 +480,14 @@ static void hsail_command(char *arg, int from_tty)
   {
     ui_out_text(uiout,"hsail command needs a parameter \n");
     ui_out_text(uiout,"hsail thread wg:x,y,z wi:x,y,z\n");
+    ui_out_text(uiout,"hsail save-source [file name]\n");
+    return ;
+  }
+
+  /* The subcommand is followed by the end of the string or a space */
+  if (strncmp(arg, "save-source", 11) == 0 && ('\0' == arg[11] || isspace(arg[11])))
+  {
+    hsail_command_save_source(arg + 11);
     return ;
   }
 
@@ -563,6 +602,29 @@ static void hsail_set_config_command (char *args, int from_tty, struct cmd_list_
                 }
             }
         }
+      /*set hsail parse*/
+      else if (strcmp(pch,"parse") == 0)
+        {
+          pch = strtok(NULL, " ");
+          if (pch != NULL && strcmp(pch,"serial") == 0)
+            {
+              hwdbginfo_set_parse_options(0);
+            }
+          else if (pch != NULL && strcmp(pch,"levels") == 0)
+            {
+              hwdbginfo_set_parse_options(HWDBGINFO_PARSE_PARALLEL_LEVELS);
+            }
+          else if (pch != NULL && strcmp(pch,"subprograms") == 0)
+            {
+              hwdbginfo_set_parse_options(HWDBGINFO_PARSE_PARALLEL_LEVELS | HWDBGINFO_PARSE_PARALLEL_SUBPROGRAMS);
+            }
+          else
+            {
+              printf_filtered("HSAIL debug information parse options, for the code objects parsed next\n");
+              printf_filtered("set hsail parse [serial|levels|subprograms] \n");
+              printf_filtered("levels parses the HSAIL and ISA DWARF concurrently, subprograms also parses the functions of each level concurrently\n");
+            }
+        }
     }
 
   xfree(temp_hsail_argument_buff);
@@ -590,6 +652,7 @@ void hsail_command_clear_argument_buff(void)
 /* Clear the focus wave and work item at the end of the dispatch */
 void hsail_cmd_clear_focus(void)
 {
+  gs_list_next_line = 0;
   hsail_utils_copy_wavedim3(&gs_active_work_group, &gs_unknown_wave_dim);
   hsail_utils_copy_wavedim3(&gs_active_work_item, &gs_unknown_wave_dim);
 }
@@ -605,6 +668,9 @@ void hsail_cmd_set_focus(HsailWaveDim3 focusWg, HsailWaveDim3 focusWi)
 
   struct ui_out *uiout = current_uiout;
 
+  /* "list" starts again from the new focus line */
+  gs_list_next_line = 0;
+
   wg_buff[0] = focusWg.x;
   wg_buff[1] = focusWg.y;
   wg_buff[2] = focusWg.z;
@@ -635,11 +701,125 @@ void hsail_cmd_set_focus(HsailWaveDim3 focusWg, HsailWaveDim3 focusWi)
    * */
 }
 
+/* Get the focus work-group and work-item, false if the agent has not sent them yet */
+bool hsail_cmd_get_focus(HsailWaveDim3* focusWg, HsailWaveDim3* focusWi)
+{
+  if (hsail_utils_compare_wavedim3(&gs_active_work_group, &gs_unknown_wave_dim) ||
+      hsail_utils_compare_wavedim3(&gs_active_work_item, &gs_unknown_wave_dim))
+    {
+      return false;
+    }
+
+  if (NULL != focusWg)
+    {
+      hsail_utils_copy_wavedim3(focusWg, &gs_active_work_group);
+    }
+
+  if (NULL != focusWi)
+    {
+      hsail_utils_copy_wavedim3(focusWi, &gs_active_work_item);
+    }
+
+  return true;
+}
+
+/* Get the source line of the focus work-item's pc, 0 if it is not known */
+static HwDbgInfo_linenum hsail_cmd_get_focus_line(void)
+{
+  HwDbgInfo_debug dbg = hsail_init_hwdbginfo(NULL);
+  HwDbgInfo_err dbg_err = HWDBGINFO_E_SUCCESS;
+  HwDbgInfo_addr addr = 0;
+  HwDbgInfo_code_location loc = NULL;
+  HwDbgInfo_linenum line_num = 0;
+  int wave_index = -1;
+
+  if (NULL == dbg ||
+      !hsail_wave_index_find_workitem(&gs_active_work_group, &gs_active_work_item, &wave_index, NULL))
+    {
+      return 0;
+    }
+
+  dbg_err = hwdbginfo_nearest_mapped_addr(dbg, hsail_wave_index_pc(wave_index), &addr);
+  if (dbg_err == HWDBGINFO_E_SUCCESS)
+    {
+      dbg_err = hwdbginfo_addr_to_line(dbg, addr, &loc);
+    }
+
+  if (dbg_err == HWDBGINFO_E_SUCCESS)
+    {
+      dbg_err = hwdbginfo_code_location_details(loc, &line_num, 0, NULL, NULL);
+      hwdbginfo_release_code_locations(&loc, 1);
+    }
+
+  return (dbg_err == HWDBGINFO_E_SUCCESS) ? line_num : 0;
+}
+
 /* Command for printing hsail source within gdb's terminal
+ *
+ * list         : lines around the focus work-item, then the lines after the last listed
+ * list <line>  : lines around a source line
  * */
 void hsail_cmd_list_command(char* arg, int from_tty)
 {
-  printf_filtered("HSAIL list command is not presently supported when in HSAIL dispatch\n");
+  HwDbgInfo_linenum num_lines = hsail_dbginfo_get_source_num_lines();
+  HwDbgInfo_linenum first_line = 0;
+  HwDbgInfo_linenum last_line = 0;
+  HwDbgInfo_linenum line_num = 0;
+  const char* line = NULL;
+  size_t line_len = 0;
+  int arg_length = 0;
+
+  if (num_lines == 0)
+    {
+      printf_filtered("HSAIL source is not available\n");
+      return;
+    }
+
+  arg_length = (arg != NULL) ? strlen(arg) : 0;
+  if (arg_length > 0)
+    {
+      SKIP_LEADING_SPACES(arg, arg_length);
+    }
+
+  if (arg_length > 0)
+    {
+      if (!isdigit(*arg) || atoi(arg) <= 0)
+        {
+          printf_filtered("HSAIL list command only supports \"list\" and \"list <line number>\"\n");
+          return;
+        }
+      gs_list_next_line = atoi(arg);
+      gs_list_next_line = (gs_list_next_line > gs_list_num_lines / 2) ? gs_list_next_line - gs_list_num_lines / 2 : 1;
+    }
+  else if (gs_list_next_line == 0)
+    {
+      line_num = hsail_cmd_get_focus_line();
+      gs_list_next_line = (line_num > gs_list_num_lines / 2) ? line_num - gs_list_num_lines / 2 : 1;
+    }
+
+  first_line = gs_list_next_line;
+  if (first_line > num_lines)
+    {
+      printf_filtered("Line number %llu out of range; HSAIL source has %llu lines.\n",
+                      (unsigned long long)first_line, (unsigned long long)num_lines);
+      return;
+    }
+
+  last_line = first_line + gs_list_num_lines - 1;
+  if (last_line > num_lines)
+    {
+      last_line = num_lines;
+    }
+
+  for (line_num = first_line; line_num <= last_line; line_num++)
+    {
+      if (hsail_dbginfo_get_source_line(line_num, &line, &line_len))
+        {
+          printf_filtered("%llu\t%.*s\n", (unsigned long long)line_num, (int)line_len, line);
+        }
+    }
+
+  gs_list_next_line = last_line + 1;
 }
 
 void
@@ -658,7 +838,11 @@ _initialize_hsailcmd (void)
 
   /* hsail thread .... */
   add_com ("hsail", class_stack, hsail_command, _("\
-  Switch focus for hsail variable printing.\n"));
+  Switch focus for hsail variable printing.\n\
+  hsail thread wg:x,y,z wi:x,y,z\n\
+  hsail save-source [file name]: save the HSAIL source, to temp_source by default\n\
+  To print a variable for every active work-item around the focus instead of switching focus:\n\
+  print hsail:var @wave|@workgroup|@dispatch [reduce]\n"));
   add_com_alias ("hl", "hsail", class_stack, 1);
 
 
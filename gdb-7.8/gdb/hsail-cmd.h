@@ -39,6 +39,9 @@ void hsail_cmd_clear_focus(void);
 /* Function to set the focus wave sent from the Agent */
 void hsail_cmd_set_focus(HsailWaveDim3 focusWg, HsailWaveDim3 focusWi);
 
+/* Get the focus work-group and work-item, false if they are not known yet */
+bool hsail_cmd_get_focus(HsailWaveDim3* focusWg, HsailWaveDim3* focusWi);
+
 bool hsail_command_get_argument(const char* cmdInfo, const char* argName, unsigned int* itemDim3, int* numItems);
 
 
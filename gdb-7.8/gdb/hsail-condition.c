@@ -0,0 +1,681 @@
+/*
+   HSAIL breakpoint condition bytecode
+
+   Copyright (c) 2015 ADVANCED MICRO DEVICES, INC.  All rights reserved.
+   This file includes code originally published under
+
+   Copyright (C) 1986-2014 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <string.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include <stdbool.h>
+
+/* GDB headers */
+#include "defs.h"
+#include "gdb_assert.h"
+#include "gdbarch.h"
+#include "ax.h"
+
+/* HSAIL-GDB headers*/
+#include "hsail-condition.h"
+#include "hsail-print.h"
+
+/* The names every condition can use, and the condition variable they read */
+struct hsail_condition_builtin
+{
+  const char* name;
+  int var_num;
+};
+
+static const struct hsail_condition_builtin gs_hsail_condition_builtins[] =
+{
+  {"wi.x", HSAIL_CONDITION_VAR_WORKITEM_ID_X},
+  {"wi.y", HSAIL_CONDITION_VAR_WORKITEM_ID_Y},
+  {"wi.z", HSAIL_CONDITION_VAR_WORKITEM_ID_Z},
+  {"wg.x", HSAIL_CONDITION_VAR_WORKGROUP_ID_X},
+  {"wg.y", HSAIL_CONDITION_VAR_WORKGROUP_ID_Y},
+  {"wg.z", HSAIL_CONDITION_VAR_WORKGROUP_ID_Z},
+  {"$hit_count", HSAIL_CONDITION_VAR_HIT_COUNT},
+};
+
+/* The state of one compilation. A NULL dbg only checks the syntax */
+struct hsail_condition_parser
+{
+  const char* condition;
+  const char* cursor;
+  struct agent_expr* expr;
+
+  HwDbgInfo_debug dbg;
+  HwDbgInfo_addr pc;
+
+  /* The kernel variables read so far, each one is read once */
+  char** variable_names;
+  HsailVariableLocation* variables;
+  int num_variables;
+  int variables_size;
+
+  /* Whether the value parsed last is unsigned, which selects the unsigned
+   * division, remainder and comparison. As in C, an operation on an unsigned
+   * operand is unsigned, and the result of a comparison or logical operation is not */
+  bool is_unsigned;
+
+  bool is_valid;
+};
+
+static bool hsail_condition_parse_or(struct hsail_condition_parser* parser);
+
+/* Report the first error only, the rest of the parse is moot */
+static void hsail_condition_error(struct hsail_condition_parser* parser, const char* message)
+{
+  if (parser->is_valid)
+    {
+      printf_filtered("Invalid HSAIL breakpoint condition \"%s\": %s at \"%s\"\n",
+                      parser->condition, message, parser->cursor);
+    }
+
+  parser->is_valid = false;
+}
+
+static void hsail_condition_skip_spaces(struct hsail_condition_parser* parser)
+{
+  while (isspace((unsigned char)*parser->cursor))
+    {
+      parser->cursor++;
+    }
+}
+
+/* Consume the token if it is next */
+static bool hsail_condition_accept(struct hsail_condition_parser* parser, const char* token)
+{
+  size_t token_len = strlen(token);
+
+  hsail_condition_skip_spaces(parser);
+
+  if (0 != strncmp(parser->cursor, token, token_len))
+    {
+      return false;
+    }
+
+  /* "<" is not "<=", ">" is not ">=" and "!" is not "!=" */
+  if (1 == token_len && ('<' == token[0] || '>' == token[0] || '!' == token[0])
+      && '=' == parser->cursor[1])
+    {
+      return false;
+    }
+
+  parser->cursor += token_len;
+  return true;
+}
+
+/* A % only starts a register or variable name, anywhere else it is the remainder */
+static bool hsail_condition_is_identifier_char(char c)
+{
+  return isalnum((unsigned char)c) || '_' == c || '.' == c || '$' == c;
+}
+
+/* Record a kernel variable and return its index in the variable locations */
+static int hsail_condition_add_variable(struct hsail_condition_parser* parser,
+                                        const char* name,
+                                        const HsailVariableLocation* location)
+{
+  if (parser->num_variables == parser->variables_size)
+    {
+      parser->variables_size = (0 == parser->variables_size) ? 4 : 2 * parser->variables_size;
+      parser->variable_names = (char**)xrealloc(parser->variable_names,
+                                                parser->variables_size * sizeof(char*));
+      parser->variables = (HsailVariableLocation*)xrealloc(parser->variables,
+                                                           parser->variables_size * sizeof(HsailVariableLocation));
+    }
+
+  parser->variable_names[parser->num_variables] = xstrdup(name);
+  parser->variables[parser->num_variables] = *location;
+
+  return parser->num_variables++;
+}
+
+/* Emit the read of a kernel variable, constants are folded into the expression */
+static void hsail_condition_emit_variable(struct hsail_condition_parser* parser, const char* name)
+{
+  HwDbgInfo_err err = HWDBGINFO_E_SUCCESS;
+  HwDbgInfo_variable var = NULL;
+  HwDbgInfo_encoding encoding = HWDBGINFO_VENC_NONE;
+  HsailVariableLocation location;
+  size_t var_size = 0;
+  bool is_constant = false;
+  bool is_output = false;
+  bool is_signed = false;
+  int var_index = 0;
+
+  parser->is_unsigned = false;
+
+  /* Only the syntax is checked, the variable may not be in scope yet */
+  if (NULL == parser->dbg)
+    {
+      ax_tsv(parser->expr, aop_getv, HSAIL_CONDITION_VAR_KERNEL_VARIABLE_BASE);
+      return;
+    }
+
+  var = hwdbginfo_variable(parser->dbg, parser->pc, true, name, &err);
+  if (HWDBGINFO_E_SUCCESS != err || NULL == var)
+    {
+      hsail_condition_error(parser, "no such variable in scope");
+      return;
+    }
+
+  err = hwdbginfo_variable_data(var, 0, NULL, NULL, 0, NULL, NULL, &var_size, &encoding, &is_constant, &is_output);
+  if (HWDBGINFO_E_SUCCESS != err)
+    {
+      hsail_condition_error(parser, "could not get the variable's type");
+    }
+  else if (HWDBGINFO_VENC_FLOAT == encoding || HWDBGINFO_VENC_POINTER == encoding
+           || HWDBGINFO_VENC_NONE == encoding || 0 == var_size || 8 < var_size)
+    {
+      hsail_condition_error(parser, "only scalar integer variables can be compared");
+    }
+  else
+    {
+      is_signed = (HWDBGINFO_VENC_INTEGER == encoding || HWDBGINFO_VENC_CHARACTER == encoding);
+      parser->is_unsigned = !is_signed;
+
+      if (is_constant)
+        {
+          LONGEST value = 0;
+          gdb_byte value_buffer[8];
+
+          memset(value_buffer, 0, sizeof(value_buffer));
+          err = hwdbginfo_variable_const_value(var, var_size, value_buffer);
+          if (HWDBGINFO_E_SUCCESS != err)
+            {
+              hsail_condition_error(parser, "could not get the variable's value");
+            }
+          else
+            {
+              value = (LONGEST)extract_unsigned_integer(value_buffer, var_size, BFD_ENDIAN_LITTLE);
+              if (is_signed && 8 > var_size && (value & ((LONGEST)1 << (var_size * 8 - 1))))
+                {
+                  value -= (LONGEST)1 << (var_size * 8);
+                }
+              ax_const_l(parser->expr, value);
+            }
+        }
+      else
+        {
+          for (var_index = 0; var_index < parser->num_variables; var_index++)
+            {
+              if (0 == strcmp(parser->variable_names[var_index], name))
+                {
+                  break;
+                }
+            }
+
+          if (var_index == parser->num_variables)
+            {
+              if (hsail_print_fill_var_location(var, var_size, &location))
+                {
+                  var_index = hsail_condition_add_variable(parser, name, &location);
+                }
+              else
+                {
+                  hsail_condition_error(parser, "could not get the variable's location");
+                }
+            }
+
+          if (parser->is_valid)
+            {
+              ax_tsv(parser->expr, aop_getv, HSAIL_CONDITION_VAR_KERNEL_VARIABLE_BASE + var_index);
+
+              /* The agent zero extends the value it reads */
+              if (is_signed && 8 > var_size)
+                {
+                  ax_ext(parser->expr, var_size * 8);
+                }
+            }
+        }
+    }
+
+  hwdbginfo_release_variables(parser->dbg, &var, 1);
+}
+
+static bool hsail_condition_parse_primary(struct hsail_condition_parser* parser)
+{
+  const char* token_start = NULL;
+  char* token_end = NULL;
+  char* name = NULL;
+  ULONGEST value = 0;
+  size_t name_len = 0;
+  size_t i = 0;
+
+  hsail_condition_skip_spaces(parser);
+  token_start = parser->cursor;
+  parser->is_unsigned = false;
+
+  if (hsail_condition_accept(parser, "("))
+    {
+      if (hsail_condition_parse_or(parser) && !hsail_condition_accept(parser, ")"))
+        {
+          hsail_condition_error(parser, "expected \")\"");
+        }
+      return parser->is_valid;
+    }
+
+  if (isdigit((unsigned char)*token_start))
+    {
+      value = strtoull(token_start, &token_end, 0);
+      if (hsail_condition_is_identifier_char(*token_end))
+        {
+          hsail_condition_error(parser, "invalid number");
+          return false;
+        }
+
+      /* A number too large for a signed 64 bit value is unsigned, as in C */
+      parser->is_unsigned = ((ULONGEST)LONGEST_MAX < value);
+      parser->cursor = token_end;
+      ax_const_l(parser->expr, (LONGEST)value);
+      return true;
+    }
+
+  /* HSAIL registers and variables start with % */
+  if ('%' == token_start[0])
+    {
+      name_len++;
+    }
+
+  while (hsail_condition_is_identifier_char(token_start[name_len]))
+    {
+      name_len++;
+    }
+
+  if (0 == name_len || (1 == name_len && '%' == token_start[0]))
+    {
+      hsail_condition_error(parser, "expected a number or a name");
+      return false;
+    }
+
+  name = savestring(token_start, name_len);
+  parser->cursor += name_len;
+
+  for (i = 0; i < ARRAY_SIZE(gs_hsail_condition_builtins); i++)
+    {
+      if (0 == strcmp(gs_hsail_condition_builtins[i].name, name))
+        {
+          ax_tsv(parser->expr, aop_getv, gs_hsail_condition_builtins[i].var_num);
+          break;
+        }
+    }
+
+  if (i == ARRAY_SIZE(gs_hsail_condition_builtins))
+    {
+      if ('$' == name[0])
+        {
+          hsail_condition_error(parser, "unknown convenience variable");
+        }
+      else
+        {
+          hsail_condition_emit_variable(parser, name);
+        }
+    }
+
+  xfree(name);
+  return parser->is_valid;
+}
+
+static bool hsail_condition_parse_unary(struct hsail_condition_parser* parser)
+{
+  if (hsail_condition_accept(parser, "!"))
+    {
+      if (hsail_condition_parse_unary(parser))
+        {
+          ax_simple(parser->expr, aop_log_not);
+          parser->is_unsigned = false;
+        }
+    }
+  else if (hsail_condition_accept(parser, "-"))
+    {
+      ax_const_l(parser->expr, 0);
+      if (hsail_condition_parse_unary(parser))
+        {
+          ax_simple(parser->expr, aop_sub);
+        }
+    }
+  else
+    {
+      hsail_condition_parse_primary(parser);
+    }
+
+  return parser->is_valid;
+}
+
+static bool hsail_condition_parse_mul(struct hsail_condition_parser* parser)
+{
+  enum agent_op op = aop_mul;
+  bool is_left_unsigned = false;
+
+  if (!hsail_condition_parse_unary(parser))
+    {
+      return false;
+    }
+
+  for (;;)
+    {
+      is_left_unsigned = parser->is_unsigned;
+
+      if (hsail_condition_accept(parser, "*"))
+        {
+          op = aop_mul;
+        }
+      else if (hsail_condition_accept(parser, "/"))
+        {
+          op = aop_div_signed;
+        }
+      else if (hsail_condition_accept(parser, "%"))
+        {
+          op = aop_rem_signed;
+        }
+      else
+        {
+          break;
+        }
+
+      if (!hsail_condition_parse_unary(parser))
+        {
+          return false;
+        }
+
+      parser->is_unsigned = is_left_unsigned || parser->is_unsigned;
+      if (parser->is_unsigned && aop_div_signed == op)
+        {
+          op = aop_div_unsigned;
+        }
+      else if (parser->is_unsigned && aop_rem_signed == op)
+        {
+          op = aop_rem_unsigned;
+        }
+      ax_simple(parser->expr, op);
+    }
+
+  return true;
+}
+
+static bool hsail_condition_parse_add(struct hsail_condition_parser* parser)
+{
+  enum agent_op op = aop_add;
+  bool is_left_unsigned = false;
+
+  if (!hsail_condition_parse_mul(parser))
+    {
+      return false;
+    }
+
+  for (;;)
+    {
+      is_left_unsigned = parser->is_unsigned;
+
+      if (hsail_condition_accept(parser, "+"))
+        {
+          op = aop_add;
+        }
+      else if (hsail_condition_accept(parser, "-"))
+        {
+          op = aop_sub;
+        }
+      else
+        {
+          break;
+        }
+
+      if (!hsail_condition_parse_mul(parser))
+        {
+          return false;
+        }
+      parser->is_unsigned = is_left_unsigned || parser->is_unsigned;
+      ax_simple(parser->expr, op);
+    }
+
+  return true;
+}
+
+/* The agent only has == and <, the other comparisons swap the
+ * operands and / or negate the result. < is unsigned if either operand is */
+static bool hsail_condition_parse_compare(struct hsail_condition_parser* parser)
+{
+  bool swap_operands = false;
+  bool negate_result = false;
+  bool is_left_unsigned = false;
+  enum agent_op op = aop_equal;
+
+  if (!hsail_condition_parse_add(parser))
+    {
+      return false;
+    }
+
+  for (;;)
+    {
+      is_left_unsigned = parser->is_unsigned;
+
+      if (hsail_condition_accept(parser, "=="))
+        {
+          op = aop_equal; swap_operands = false; negate_result = false;
+        }
+      else if (hsail_condition_accept(parser, "!="))
+        {
+          op = aop_equal; swap_operands = false; negate_result = true;
+        }
+      else if (hsail_condition_accept(parser, "<="))
+        {
+          op = aop_less_signed; swap_operands = true; negate_result = true;
+        }
+      else if (hsail_condition_accept(parser, ">="))
+        {
+          op = aop_less_signed; swap_operands = false; negate_result = true;
+        }
+      else if (hsail_condition_accept(parser, "<"))
+        {
+          op = aop_less_signed; swap_operands = false; negate_result = false;
+        }
+      else if (hsail_condition_accept(parser, ">"))
+        {
+          op = aop_less_signed; swap_operands = true; negate_result = false;
+        }
+      else
+        {
+          break;
+        }
+
+      if (!hsail_condition_parse_add(parser))
+        {
+          return false;
+        }
+
+      if (aop_less_signed == op && (is_left_unsigned || parser->is_unsigned))
+        {
+          op = aop_less_unsigned;
+        }
+      parser->is_unsigned = false;
+
+      if (swap_operands)
+        {
+          ax_simple(parser->expr, aop_swap);
+        }
+      ax_simple(parser->expr, op);
+      if (negate_result)
+        {
+          ax_simple(parser->expr, aop_log_not);
+        }
+    }
+
+  return true;
+}
+
+/* && and || short-circuit like in C, so that a guard such as n != 0 && 100 / n > 3
+ * does not evaluate the division, which would fail and stop the wave.
+ * The result is 0 or 1, the code follows gdb's for BINOP_LOGICAL_AND / OR */
+static bool hsail_condition_parse_and(struct hsail_condition_parser* parser)
+{
+  int if1 = 0;
+  int go1 = 0;
+  int if2 = 0;
+  int go2 = 0;
+  int end = 0;
+
+  if (!hsail_condition_parse_compare(parser))
+    {
+      return false;
+    }
+
+  while (hsail_condition_accept(parser, "&&"))
+    {
+      if1 = ax_goto(parser->expr, aop_if_goto);
+      go1 = ax_goto(parser->expr, aop_goto);
+      ax_label(parser->expr, if1, parser->expr->len);
+      if (!hsail_condition_parse_compare(parser))
+        {
+          return false;
+        }
+      if2 = ax_goto(parser->expr, aop_if_goto);
+      go2 = ax_goto(parser->expr, aop_goto);
+      ax_label(parser->expr, if2, parser->expr->len);
+      ax_const_l(parser->expr, 1);
+      end = ax_goto(parser->expr, aop_goto);
+      ax_label(parser->expr, go1, parser->expr->len);
+      ax_label(parser->expr, go2, parser->expr->len);
+      ax_const_l(parser->expr, 0);
+      ax_label(parser->expr, end, parser->expr->len);
+      parser->is_unsigned = false;
+    }
+
+  return true;
+}
+
+static bool hsail_condition_parse_or(struct hsail_condition_parser* parser)
+{
+  int if1 = 0;
+  int if2 = 0;
+  int end = 0;
+
+  if (!hsail_condition_parse_and(parser))
+    {
+      return false;
+    }
+
+  while (hsail_condition_accept(parser, "||"))
+    {
+      if1 = ax_goto(parser->expr, aop_if_goto);
+      if (!hsail_condition_parse_and(parser))
+        {
+          return false;
+        }
+      if2 = ax_goto(parser->expr, aop_if_goto);
+      ax_const_l(parser->expr, 0);
+      end = ax_goto(parser->expr, aop_goto);
+      ax_label(parser->expr, if1, parser->expr->len);
+      ax_label(parser->expr, if2, parser->expr->len);
+      ax_const_l(parser->expr, 1);
+      ax_label(parser->expr, end, parser->expr->len);
+      parser->is_unsigned = false;
+    }
+
+  return true;
+}
+
+static struct hsail_condition_bytecode* hsail_condition_build(const char* condition,
+                                                              HwDbgInfo_debug dbg,
+                                                              HwDbgInfo_addr pc)
+{
+  struct hsail_condition_parser parser;
+  struct hsail_condition_bytecode* bytecode = NULL;
+  int i = 0;
+
+  gdb_assert(NULL != condition);
+
+  memset(&parser, 0, sizeof(struct hsail_condition_parser));
+  parser.condition = condition;
+  parser.cursor = condition;
+  parser.dbg = dbg;
+  parser.pc = pc;
+  parser.is_valid = true;
+  parser.expr = new_agent_expr(target_gdbarch(), (CORE_ADDR)pc);
+
+  if (hsail_condition_parse_or(&parser))
+    {
+      hsail_condition_skip_spaces(&parser);
+      if ('\0' != *parser.cursor)
+        {
+          hsail_condition_error(&parser, "unexpected text");
+        }
+    }
+
+  if (parser.is_valid)
+    {
+      ax_simple(parser.expr, aop_end);
+      ax_reqs(parser.expr);
+      gdb_assert(agent_flaw_none == parser.expr->flaw);
+      gdb_assert(1 == parser.expr->final_height);
+    }
+
+  for (i = 0; i < parser.num_variables; i++)
+    {
+      xfree(parser.variable_names[i]);
+    }
+  xfree(parser.variable_names);
+
+  if (!parser.is_valid)
+    {
+      free_agent_expr(parser.expr);
+      xfree(parser.variables);
+      return NULL;
+    }
+
+  bytecode = (struct hsail_condition_bytecode*)xmalloc(sizeof(struct hsail_condition_bytecode));
+  bytecode->expr = parser.expr;
+  bytecode->variables = parser.variables;
+  bytecode->num_variables = parser.num_variables;
+
+  return bytecode;
+}
+
+bool hsail_condition_check(const char* condition)
+{
+  struct hsail_condition_bytecode* bytecode = hsail_condition_build(condition, NULL, 0);
+  bool is_valid = (NULL != bytecode);
+
+  hsail_condition_free(bytecode);
+
+  return is_valid;
+}
+
+struct hsail_condition_bytecode* hsail_condition_compile(const char* condition,
+                                                         HwDbgInfo_debug dbg,
+                                                         HwDbgInfo_addr pc)
+{
+  gdb_assert(NULL != dbg);
+
+  return hsail_condition_build(condition, dbg, pc);
+}
+
+void hsail_condition_free(struct hsail_condition_bytecode* bytecode)
+{
+  if (NULL == bytecode)
+    {
+      return;
+    }
+
+  free_agent_expr(bytecode->expr);
+  xfree(bytecode->variables);
+  xfree(bytecode);
+}
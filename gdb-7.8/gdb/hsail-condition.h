@@ -0,0 +1,68 @@
+/*
+   HSAIL breakpoint condition bytecode
+
+   Copyright (c) 2015 ADVANCED MICRO DEVICES, INC.  All rights reserved.
+   This file includes code originally published under
+
+   Copyright (C) 1986-2014 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#if !defined (HSAIL_CONDITION_H)
+#define HSAIL_CONDITION_H 1
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Include HwDbgFacilities C interface*/
+#include "FacilitiesInterface.h"
+
+#include "CommunicationControl.h"
+
+struct agent_expr;
+
+/*
+ * A breakpoint condition compiled to agent expression bytecode, which the
+ * agent evaluates for each work-item of the waves reaching the breakpoint.
+ *
+ * The condition language is a C subset:
+ *   || && == != < <= > >= + - * / % ! unary - and parentheses,
+ *   integer literals, wi.x wi.y wi.z wg.x wg.y wg.z, $hit_count
+ *   and the scalar integer kernel variables in scope at the breakpoint.
+ *
+ * For instance: "wg.x == 2 && wi.x % 64 == 0 && $hit_count > 10"
+ */
+struct hsail_condition_bytecode
+{
+  struct agent_expr* expr;
+
+  /* The kernel variables read by the expression, HSAIL_CONDITION_VAR_KERNEL_VARIABLE_BASE + i
+   * is variables[i] */
+  HsailVariableLocation* variables;
+  int num_variables;
+};
+
+/* Check the syntax of a condition, kernel variables are not looked up */
+bool hsail_condition_check(const char* condition);
+
+/* Compile a condition for the breakpoint at pc, returns NULL and prints why if it fails */
+struct hsail_condition_bytecode* hsail_condition_compile(const char* condition,
+                                                         HwDbgInfo_debug dbg,
+                                                         HwDbgInfo_addr pc);
+
+void hsail_condition_free(struct hsail_condition_bytecode* bytecode);
+
+#endif // HSAIL_CONDITION_H
@@ -0,0 +1,176 @@
+/*
+   HSAIL cache of the HwDbgFacilities debug info of the dispatched code objects
+
+   Copyright (c) 2015 ADVANCED MICRO DEVICES, INC.  All rights reserved.
+   This file includes code originally published under
+
+   Copyright (C) 1986-2014 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <string.h>
+#include <stdbool.h>
+
+/* GDB headers */
+#include "defs.h"
+#include "gdb_assert.h"
+#include "ui-out.h"
+
+#include "hsail-dbginfo-cache.h"
+#include "hsail-step-plan.h"
+
+struct hsail_dbginfo_cache_entry
+{
+  /* The code object the debug info was built from */
+  uint64_t hash;
+  size_t binary_size;
+
+  HwDbgInfo_debug dbg;
+
+  /* The cache use count of the last lookup or insert of this entry */
+  unsigned long long last_use;
+};
+
+static struct hsail_dbginfo_cache_entry gs_cache_entries[HSAIL_DBGINFO_CACHE_MAX_ENTRIES];
+static int gs_cache_num_entries = 0;
+static unsigned long long gs_cache_use_count = 0;
+
+/* Statistics for info hsail cache */
+static unsigned long long gs_cache_hits = 0;
+static unsigned long long gs_cache_misses = 0;
+static unsigned long long gs_cache_evictions = 0;
+
+/* 64-bit FNV-1a hash of the code object */
+uint64_t hsail_dbginfo_cache_hash(const void* binary, const size_t binary_size)
+{
+  const unsigned char* bytes = binary;
+  uint64_t hash = 14695981039346656037ULL;
+  size_t i = 0;
+
+  gdb_assert(binary != NULL);
+
+  for (i = 0; i < binary_size; i++)
+    {
+      hash ^= bytes[i];
+      hash *= 1099511628211ULL;
+    }
+
+  return hash;
+}
+
+HwDbgInfo_debug hsail_dbginfo_cache_lookup(const uint64_t hash, const size_t binary_size)
+{
+  int i = 0;
+
+  for (i = 0; i < gs_cache_num_entries; i++)
+    {
+      if (gs_cache_entries[i].hash == hash &&
+          gs_cache_entries[i].binary_size == binary_size)
+        {
+          gs_cache_entries[i].last_use = ++gs_cache_use_count;
+          gs_cache_hits++;
+          return gs_cache_entries[i].dbg;
+        }
+    }
+
+  gs_cache_misses++;
+  return NULL;
+}
+
+void hsail_dbginfo_cache_insert(const uint64_t hash,
+                                const size_t binary_size,
+                                HwDbgInfo_debug dbg)
+{
+  struct hsail_dbginfo_cache_entry* entry = NULL;
+  int i = 0;
+
+  gdb_assert(dbg != NULL);
+
+  if (gs_cache_num_entries < HSAIL_DBGINFO_CACHE_MAX_ENTRIES)
+    {
+      entry = &gs_cache_entries[gs_cache_num_entries++];
+    }
+  else
+    {
+      /* Evict the least recently used entry */
+      entry = &gs_cache_entries[0];
+      for (i = 1; i < gs_cache_num_entries; i++)
+        {
+          if (gs_cache_entries[i].last_use < entry->last_use)
+            {
+              entry = &gs_cache_entries[i];
+            }
+        }
+
+      hsail_step_plan_release(entry->dbg);
+      hwdbginfo_release_debug_info(&entry->dbg);
+      gs_cache_evictions++;
+    }
+
+  entry->hash = hash;
+  entry->binary_size = binary_size;
+  entry->dbg = dbg;
+  entry->last_use = ++gs_cache_use_count;
+}
+
+void hsail_dbginfo_cache_clear(void)
+{
+  int i = 0;
+
+  for (i = 0; i < gs_cache_num_entries; i++)
+    {
+      hsail_step_plan_release(gs_cache_entries[i].dbg);
+      hwdbginfo_release_debug_info(&gs_cache_entries[i].dbg);
+    }
+
+  memset(gs_cache_entries, 0, sizeof(gs_cache_entries));
+  gs_cache_num_entries = 0;
+}
+
+void hsail_dbginfo_cache_print_info(struct ui_out* uiout)
+{
+  char buffer[256] = "";
+  int i = 0;
+
+  gdb_assert(uiout != NULL);
+
+  snprintf(buffer, sizeof(buffer), "HSAIL debug info cache: %d of %d code objects\n",
+           gs_cache_num_entries, HSAIL_DBGINFO_CACHE_MAX_ENTRIES);
+  ui_out_text(uiout, buffer);
+
+  snprintf(buffer, sizeof(buffer), "Hits: %llu, Misses: %llu, Evictions: %llu\n",
+           gs_cache_hits, gs_cache_misses, gs_cache_evictions);
+  ui_out_text(uiout, buffer);
+
+  /* The time each phase of the code objects' DWARF parse took */
+  for (i = 0; i < gs_cache_num_entries; i++)
+    {
+      size_t report_len = 0;
+      char* report = NULL;
+
+      if (hwdbginfo_parse_timings_report(gs_cache_entries[i].dbg, 0, NULL, &report_len) != HWDBGINFO_E_SUCCESS)
+        {
+          continue;
+        }
+
+      report = (char*)xmalloc(report_len);
+      if (hwdbginfo_parse_timings_report(gs_cache_entries[i].dbg, report_len, report, NULL) == HWDBGINFO_E_SUCCESS)
+        {
+          ui_out_text(uiout, report);
+        }
+      xfree(report);
+    }
+}
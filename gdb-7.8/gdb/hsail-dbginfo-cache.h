@@ -0,0 +1,63 @@
+/*
+   HSAIL cache of the HwDbgFacilities debug info of the dispatched code objects
+
+   Copyright (c) 2015 ADVANCED MICRO DEVICES, INC.  All rights reserved.
+   This file includes code originally published under
+
+   Copyright (C) 1986-2014 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#if !defined (HSAIL_DBGINFO_CACHE_H)
+#define HSAIL_DBGINFO_CACHE_H 1
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Include HwDbgFacilities C interface*/
+#include "FacilitiesInterface.h"
+
+struct ui_out;
+
+/*
+ * The debug info objects are keyed by a hash of the code object bytes, so
+ * dispatching a code object again reuses its parsed debug info.
+ *
+ * The cache owns the debug info objects, they are released when they are
+ * evicted or when the cache is cleared.
+ */
+
+/* The maximum number of code objects kept in the cache */
+#define HSAIL_DBGINFO_CACHE_MAX_ENTRIES 8
+
+uint64_t hsail_dbginfo_cache_hash(const void* binary, const size_t binary_size);
+
+/* Get the debug info of a code object, NULL on a cache miss */
+HwDbgInfo_debug hsail_dbginfo_cache_lookup(const uint64_t hash, const size_t binary_size);
+
+/* Add the debug info of a code object, the least recently used entry is
+ * evicted if the cache is full */
+void hsail_dbginfo_cache_insert(const uint64_t hash,
+                                const size_t binary_size,
+                                HwDbgInfo_debug dbg);
+
+/* Release all the cached debug info objects */
+void hsail_dbginfo_cache_clear(void);
+
+/* info hsail cache */
+void hsail_dbginfo_cache_print_info(struct ui_out* uiout);
+
+#endif // HSAIL_DBGINFO_CACHE_H
@@ -27,12 +27,15 @@
 /* Headers for signals */
 #include <signal.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <time.h>
 
 /* GDB headers */
 #include "defs.h"
+#include "ax.h"
 #include "format.h"
 #include "gdb_assert.h"
+#include "hashtab.h"
 #include "ui-out.h"
 
 /* The agent header file */
@@ -40,26 +43,67 @@
 
 /* Hsail GDB headers */
 #include "hsail-breakpoint.h"
+#include "hsail-condition.h"
 #include "hsail-fifo-control.h"
 #include "hsail-tdep.h"
 #include "hsail-utils.h"
 
 
-/* Maybe nicer to use a gdb structure like the breakpoint chain
- * but seems like overkill for now.
- * This type will need to change HsailBreakpointRequest
- * This needs to be a linked list to make the flush function more efficient
- * We presently have to traverse this whole array everytime since elements may get
- * removed in different order to added in
- */
-static HsailBreakpointRequest* gs_hsail_request_buffer = NULL;
+/* The breakpoint requests made before they can be sent to the agent:
+ * the kernel function and any location requests wait for hsail to be initialized,
+ * the source location requests also wait for the debug information.
+ *
+ * Each pending request is indexed by its GDB breakpoint number, and by its kernel
+ * name or source line. The requests sharing a kernel name or a source line are
+ * chained from the index entry. Each type also has a queue in request order,
+ * so that a flush only visits the requests that can now be resolved.
+ * */
+struct hsail_pending_request
+{
+  HsailBreakpointRequest request;
+
+  /* The next request with the same kernel name or source line */
+  struct hsail_pending_request* next_same_location;
+
+  /* The queue of the request's type */
+  struct hsail_pending_request* prev;
+  struct hsail_pending_request* next;
+};
+
+struct hsail_pending_request_queue
+{
+  struct hsail_pending_request* head;
+  struct hsail_pending_request* tail;
+};
+
+static htab_t gs_hsail_pending_by_number = NULL;
+static htab_t gs_hsail_pending_by_kernel_name = NULL;
+static htab_t gs_hsail_pending_by_source_line = NULL;
+static struct hsail_pending_request_queue gs_hsail_pending_queues[HSAIL_BP_TYPE_ANY_LOCATION + 1];
 static int gs_hsail_command_buffer_len = 0;
 static bool gs_hsail_is_command_buffer_initialized = false;
 
-/* Const only relevant to this file, not in shared header since it does not need to be seen in the agent.
- * We will not have more than 1000 commands before hsail is even loaded.
+/* The file name copy_bp_request gives the source requests without one */
+static const char gs_hsail_unknown_file_name[] = "temp_source";
+
+/* The command protocol negotiated with the agent, see HSAIL_COMMAND_BEGIN_DEBUGGING */
+static uint32_t gs_hsail_protocol_version = HSAIL_PROTOCOL_VERSION_LEGACY;
+
+/* The commands pushed since the last write to the fifo.
+ * They are encoded in the negotiated protocol: an array of HsailCommandPacket
+ * for the legacy protocol, HsailCommandRecord records for the framed protocol.
  * */
-static const int gs_hsail_max_command_buffer_len = 1024;
+static gdb_byte* gs_hsail_batch_buffer = NULL;
+static size_t gs_hsail_batch_buffer_len = 0;
+static size_t gs_hsail_batch_buffer_size = 0;
+static uint32_t gs_hsail_batch_num_commands = 0;
+
+/* How many hsail_fifo_begin_batch calls are not yet ended,
+ * the commands are written when the outermost batch ends */
+static int gs_hsail_batch_depth = 0;
+
+/* The ID of the last batch sent, the agent's HSAIL_NOTIFY_COMMAND_BATCH_COMPLETE reports it */
+static uint32_t gs_hsail_last_batch_id = 0;
 
 /* Helper to consistently clear each packet'ss memory.
  * That way each hsail_enqueue_* function only needs to update its own fields
@@ -81,6 +125,7 @@ static void hsail_fifo_initialize_packet(HsailCommandPacket* packet)
   packet->m_pc = (uint64_t)HSAIL_ISA_PC_UNKOWN;
   packet->m_lineNum = -1;
   packet->m_numMomentaryBP =0;
+  packet->m_numVariables = 0;
 
   packet->m_conditionPacket.m_conditionCode = HSAIL_BREAKPOINT_CONDITION_UNKNOWN;
   packet->m_conditionPacket.m_workgroupID.x = -1;
@@ -125,6 +170,9 @@ static void hsail_validate_command_packet(const HsailCommandPacket packet)
     case HSAIL_COMMAND_CONTINUE:
         valid = 1;
         break;
+    case HSAIL_COMMAND_BEGIN_DEBUGGING:
+      valid = 1;
+      break;
     case HSAIL_COMMAND_DISABLE_BREAKPOINT:
       if(packet.m_gdbBreakpointID >= 0)
         {
@@ -140,6 +188,15 @@ static void hsail_validate_command_packet(const HsailCommandPacket packet)
     case HSAIL_COMMAND_KILL_ALL_WAVES:
       valid = 1;
       break;
+    case HSAIL_COMMAND_READ_VARIABLES:
+      if(packet.m_numVariables > 0)
+        {
+          valid = 1;
+        }
+      break;
+    case HSAIL_COMMAND_GATHER_VARIABLE:
+      valid = 1;
+      break;
     case HSAIL_COMMAND_UNKNOWN:
       valid = 0;
       break;
@@ -150,6 +207,178 @@ static void hsail_validate_command_packet(const HsailCommandPacket packet)
   gdb_assert(valid == 1);
 }
 
+static hashval_t hsail_pending_request_number_hash(const void* p)
+{
+  const struct hsail_pending_request* pending = p;
+  return (hashval_t)pending->request.number;
+}
+
+static int hsail_pending_request_number_eq(const void* p1, const void* p2)
+{
+  const struct hsail_pending_request* pending1 = p1;
+  const struct hsail_pending_request* pending2 = p2;
+  return pending1->request.number == pending2->request.number;
+}
+
+static hashval_t hsail_pending_request_kernel_name_hash(const void* p)
+{
+  const struct hsail_pending_request* pending = p;
+  return htab_hash_string(pending->request.bp.kernel_func.func_name);
+}
+
+static int hsail_pending_request_kernel_name_eq(const void* p1, const void* p2)
+{
+  const struct hsail_pending_request* pending1 = p1;
+  const struct hsail_pending_request* pending2 = p2;
+  return strcmp(pending1->request.bp.kernel_func.func_name,
+                pending2->request.bp.kernel_func.func_name) == 0;
+}
+
+static const char* hsail_pending_request_file_name(const HsailBreakpointRequest* request)
+{
+  return (request->bp.source_location.file_name == NULL) ?
+         gs_hsail_unknown_file_name : request->bp.source_location.file_name;
+}
+
+static hashval_t hsail_pending_request_source_line_hash(const void* p)
+{
+  const struct hsail_pending_request* pending = p;
+  hashval_t hash = htab_hash_string(hsail_pending_request_file_name(&pending->request));
+  return iterative_hash_object(pending->request.bp.source_location.line_num, hash);
+}
+
+static int hsail_pending_request_source_line_eq(const void* p1, const void* p2)
+{
+  const struct hsail_pending_request* pending1 = p1;
+  const struct hsail_pending_request* pending2 = p2;
+  return pending1->request.bp.source_location.line_num == pending2->request.bp.source_location.line_num
+         && strcmp(hsail_pending_request_file_name(&pending1->request),
+                   hsail_pending_request_file_name(&pending2->request)) == 0;
+}
+
+/* The location index of a request type, NULL if the type has none */
+static htab_t hsail_pending_request_location_index(const HsailBreakpointType type)
+{
+  switch (type)
+  {
+    case HSAIL_BP_TYPE_KERNEL_FUNCTION:
+      return gs_hsail_pending_by_kernel_name;
+    case HSAIL_BP_TYPE_SOURCE_LOCATION:
+      return gs_hsail_pending_by_source_line;
+    default:
+      return NULL;
+  }
+}
+
+/* Find the pending request of a GDB breakpoint */
+static struct hsail_pending_request* hsail_pending_request_find_by_number(const int gdb_bkpt_num)
+{
+  struct hsail_pending_request key;
+
+  key.request.number = gdb_bkpt_num;
+
+  return htab_find(gs_hsail_pending_by_number, &key);
+}
+
+static void hsail_pending_request_add(const HsailBreakpointRequest* request)
+{
+  struct hsail_pending_request* pending = NULL;
+  struct hsail_pending_request_queue* queue = NULL;
+  htab_t location_index = NULL;
+  void** slot = NULL;
+
+  gdb_assert(request->type > HSAIL_BP_TYPE_UNKNOWN && request->type <= HSAIL_BP_TYPE_ANY_LOCATION);
+
+  /* Do a deep copy of the HSAIL BP request passed to this function
+   * since its member arrays will be deallocated before we flush the request to
+   * the agent. The indexes point to the strings of this copy.
+   * */
+  pending = XCNEW(struct hsail_pending_request);
+  hsail_breakpoint_copy_bp_request(&pending->request, request);
+
+  /* A GDB breakpoint has a single request */
+  slot = htab_find_slot(gs_hsail_pending_by_number, pending, INSERT);
+  gdb_assert(*slot == NULL);
+  *slot = pending;
+
+  location_index = hsail_pending_request_location_index(pending->request.type);
+  if (location_index != NULL)
+    {
+      slot = htab_find_slot(location_index, pending, INSERT);
+      pending->next_same_location = *slot;
+      *slot = pending;
+    }
+
+  queue = &gs_hsail_pending_queues[pending->request.type];
+  pending->prev = queue->tail;
+  if (queue->tail != NULL)
+    {
+      queue->tail->next = pending;
+    }
+  else
+    {
+      queue->head = pending;
+    }
+  queue->tail = pending;
+
+  gs_hsail_command_buffer_len++;
+}
+
+static void hsail_pending_request_remove(struct hsail_pending_request* pending)
+{
+  struct hsail_pending_request_queue* queue = &gs_hsail_pending_queues[pending->request.type];
+  struct hsail_pending_request** link = NULL;
+  htab_t location_index = NULL;
+  void** slot = NULL;
+
+  htab_remove_elt(gs_hsail_pending_by_number, pending);
+
+  location_index = hsail_pending_request_location_index(pending->request.type);
+  if (location_index != NULL)
+    {
+      slot = htab_find_slot(location_index, pending, NO_INSERT);
+      gdb_assert(slot != NULL);
+
+      if (*slot == pending && pending->next_same_location == NULL)
+        {
+          htab_clear_slot(location_index, slot);
+        }
+      else
+        {
+          /* The index entry is the head of the chain */
+          link = (struct hsail_pending_request**)slot;
+          while (*link != pending)
+            {
+              gdb_assert(*link != NULL);
+              link = &(*link)->next_same_location;
+            }
+          *link = pending->next_same_location;
+        }
+    }
+
+  if (pending->prev != NULL)
+    {
+      pending->prev->next = pending->next;
+    }
+  else
+    {
+      queue->head = pending->next;
+    }
+  if (pending->next != NULL)
+    {
+      pending->next->prev = pending->prev;
+    }
+  else
+    {
+      queue->tail = pending->prev;
+    }
+
+  hsail_breakpoint_clear_bp_request(&pending->request);
+  xfree(pending);
+
+  gs_hsail_command_buffer_len--;
+}
+
 /* This function needs to be called really early but only once
  *
  * We have to initialize this once but it will need to be done from any of two places:
@@ -164,15 +393,17 @@ void hsail_initialize_command_buffer(void)
 {
   if (gs_hsail_is_command_buffer_initialized == false)
     {
-      /* allocate and zero out buffer */
-
-      int hsail_command_buffer_size = sizeof(HsailBreakpointRequest)*gs_hsail_max_command_buffer_len;
-
-      gs_hsail_request_buffer = (HsailBreakpointRequest*)xmalloc(hsail_command_buffer_size );
-
-      gdb_assert(gs_hsail_request_buffer != NULL);
-
-      memset(gs_hsail_request_buffer,0,hsail_command_buffer_size );
+      gs_hsail_pending_by_number = htab_create_alloc(16, hsail_pending_request_number_hash,
+                                                     hsail_pending_request_number_eq,
+                                                     NULL, xcalloc, xfree);
+      gs_hsail_pending_by_kernel_name = htab_create_alloc(16, hsail_pending_request_kernel_name_hash,
+                                                          hsail_pending_request_kernel_name_eq,
+                                                          NULL, xcalloc, xfree);
+      gs_hsail_pending_by_source_line = htab_create_alloc(16, hsail_pending_request_source_line_hash,
+                                                          hsail_pending_request_source_line_eq,
+                                                          NULL, xcalloc, xfree);
+      memset(gs_hsail_pending_queues, 0, sizeof(gs_hsail_pending_queues));
+      gs_hsail_command_buffer_len = 0;
 
       gs_hsail_is_command_buffer_initialized = true;
     }
@@ -181,6 +412,8 @@ void hsail_initialize_command_buffer(void)
 
 void hsail_free_command_buffer(void)
 {
+  int i = 0;
+
   /* We cannot assert that the buffer is empty
    * If the user chooses to exit gdb prematurely.
    *
@@ -192,21 +425,71 @@ void hsail_free_command_buffer(void)
       printf_filtered("The command buffer is not empty. Some HSAIL commands may not have been applied\n");
     }
 
-  if(gs_hsail_request_buffer != NULL)
+  if (gs_hsail_is_command_buffer_initialized)
     {
-      xfree((void*)gs_hsail_request_buffer);
-      gs_hsail_request_buffer = NULL;
+      for (i = 0; i <= HSAIL_BP_TYPE_ANY_LOCATION; i++)
+        {
+          while (gs_hsail_pending_queues[i].head != NULL)
+            {
+              hsail_pending_request_remove(gs_hsail_pending_queues[i].head);
+            }
+        }
+
+      htab_delete(gs_hsail_pending_by_number);
+      htab_delete(gs_hsail_pending_by_kernel_name);
+      htab_delete(gs_hsail_pending_by_source_line);
+      gs_hsail_pending_by_number = NULL;
+      gs_hsail_pending_by_kernel_name = NULL;
+      gs_hsail_pending_by_source_line = NULL;
     }
 
   gs_hsail_is_command_buffer_initialized = false;
+
+  xfree(gs_hsail_batch_buffer);
+  gs_hsail_batch_buffer = NULL;
+  gs_hsail_batch_buffer_len = 0;
+  gs_hsail_batch_buffer_size = 0;
+  gs_hsail_batch_num_commands = 0;
+}
+
+/* Send the pending requests of one type to the agent, in the order they were made */
+static void hsail_flush_pending_queue(const HsailBreakpointType type)
+{
+  struct hsail_pending_request_queue* queue = &gs_hsail_pending_queues[type];
+
+  while (queue->head != NULL)
+    {
+      struct hsail_pending_request* pending = queue->head;
+
+      switch (type)
+      {
+        case HSAIL_BP_TYPE_KERNEL_FUNCTION:
+          gdb_assert(pending->request.bp.kernel_func.func_name != NULL);
+          hsail_breakpoint_set_from_kernel_name(&pending->request);
+          break;
+        case HSAIL_BP_TYPE_SOURCE_LOCATION:
+          hsail_breakpoint_set_from_line(&pending->request);
+          break;
+        case HSAIL_BP_TYPE_ANY_LOCATION:
+          hsail_breakpoint_set_any(&pending->request);
+          break;
+        default:
+          gdb_assert(0);
+          break;
+      }
+
+      /* We can clear out the request now */
+      hsail_pending_request_remove(pending);
+    }
 }
 
 /* Added to allow us to push the pending commands to the agent as soon as the fifo is open.
- * This will be called just after the hsail initialization is done.
+ * This will be called just after the hsail initialization is done, and again when
+ * the debug information of a new binary is loaded.
  * */
 void hsail_flush_breakpoint_command_buffer(void)
 {
-  int i = 0;
+  struct cleanup* old_chain = NULL;
   int filedesc  = hsail_get_fifo_handler();
 
   if (gs_hsail_command_buffer_len == 0)
@@ -221,104 +504,350 @@ void hsail_flush_breakpoint_command_buffer(void)
 
   /* We can assert for a valid handler now */
   gdb_assert(filedesc > 0);
-  gdb_assert(gs_hsail_max_command_buffer_len > gs_hsail_command_buffer_len);
-  gdb_assert(gs_hsail_request_buffer != NULL);
-  /*We traverse the whole array for now*/
-  for (i = 0; i < gs_hsail_max_command_buffer_len; i++)
-    {
-      HsailBreakpointType bp_type = gs_hsail_request_buffer[i].type;
-
-      /*
-       * We will save commands that the user gave us and send them to the agent, hoping
-       * that the user knows the kernel names and so on
-       * */
-      switch (bp_type)
-      {
-        /* Checks that the location is zeroed out */
-        case HSAIL_BP_TYPE_UNKNOWN:
-          {
-            break;
-          }
-        case HSAIL_BP_TYPE_KERNEL_FUNCTION:
-          {
-            /* This request is already in the buffer
-             * We should do nothing if hsail isnt initialized since
-             * this function will enqueue another request if we call it
-             * when hsail is not initialized */
-            gdb_assert(gs_hsail_request_buffer[i].bp.kernel_func.func_name != NULL);
-            if (is_hsail_linux_initialized())
-              {
-                hsail_breakpoint_set_from_kernel_name(&gs_hsail_request_buffer[i]);
-
-                /* We can clear out the element of the request buffer now */
-                hsail_breakpoint_clear_bp_request(&gs_hsail_request_buffer[i]);
-                gs_hsail_command_buffer_len--;
-              }
-            break;
-          }
-        case HSAIL_BP_TYPE_SOURCE_LOCATION:
-          {
-            if (is_hsail_linux_initialized()
-                && hsail_is_debug_facilities_loaded())
-              {
-                hsail_breakpoint_set_from_line(&gs_hsail_request_buffer[i]);
-
-                /* We can clear out the element of the request buffer now */
-                hsail_breakpoint_clear_bp_request(&gs_hsail_request_buffer[i]);
-                gs_hsail_command_buffer_len--;
-              }
-            /*We have not added support for this type yet*/
-            break;
-          }
-        case HSAIL_BP_TYPE_ANY_LOCATION:
-          {
-            if (is_hsail_linux_initialized())
-              {
-                hsail_breakpoint_set_any(&gs_hsail_request_buffer[i]);
-
-                /* We can clear out the element of the request buffer now */
-                hsail_breakpoint_clear_bp_request(&gs_hsail_request_buffer[i]);
-                gs_hsail_command_buffer_len--;
-              }
-            break;
-          }
-        default:
-          {
-            gdb_assert(0);
-            break;
-          }
+  gdb_assert(gs_hsail_is_command_buffer_initialized);
+
+  /* All the pending breakpoints go to the agent in one batch */
+  old_chain = hsail_fifo_begin_batch();
+
+  /*
+   * We will save commands that the user gave us and send them to the agent, hoping
+   * that the user knows the kernel names and so on
+   * */
+  hsail_flush_pending_queue(HSAIL_BP_TYPE_KERNEL_FUNCTION);
+  hsail_flush_pending_queue(HSAIL_BP_TYPE_ANY_LOCATION);
+
+  /* The source locations can only be resolved once there is debug information */
+  if (hsail_is_debug_facilities_loaded())
+    {
+      hsail_flush_pending_queue(HSAIL_BP_TYPE_SOURCE_LOCATION);
+    }
+
+  do_cleanups(old_chain);
+}
+
+/* Make room for size more bytes in the batch buffer and return where they go */
+static gdb_byte* hsail_fifo_reserve_batch_bytes(size_t size)
+{
+  gdb_byte* reserved = NULL;
+
+  if (gs_hsail_batch_buffer_len + size > gs_hsail_batch_buffer_size)
+    {
+      size_t new_size = (0 == gs_hsail_batch_buffer_size) ? 4096 : gs_hsail_batch_buffer_size;
+
+      while (gs_hsail_batch_buffer_len + size > new_size)
+        {
+          new_size *= 2;
         }
+
+      gs_hsail_batch_buffer = (gdb_byte*)xrealloc(gs_hsail_batch_buffer, new_size);
+      gs_hsail_batch_buffer_size = new_size;
     }
 
-  /* The buffer is now empty*/
-//  gs_hsail_command_buffer_len = 0;
+  reserved = gs_hsail_batch_buffer + gs_hsail_batch_buffer_len;
+  gs_hsail_batch_buffer_len += size;
+
+  return reserved;
 }
 
-static void hsail_push_command(HsailCommandPacket packet)
+/* The size a string takes in a framed record, including its terminator */
+static uint32_t hsail_fifo_record_string_len(const char* str)
 {
-  int bytes_written = 0;
+  return (NULL == str) ? 0 : (uint32_t)(strlen(str) + 1);
+}
 
-  int file_desc = hsail_get_fifo_handler();
+static size_t hsail_fifo_record_align(size_t size)
+{
+  return (size + HSAIL_COMMAND_RECORD_ALIGNMENT - 1) & ~((size_t)HSAIL_COMMAND_RECORD_ALIGNMENT - 1);
+}
+
+/* The size the condition bytecode takes in a framed record */
+static size_t hsail_fifo_record_condition_size(const struct hsail_condition_bytecode* condition_bytecode)
+{
+  if (NULL == condition_bytecode)
+    {
+      return 0;
+    }
+
+  return hsail_fifo_record_align(sizeof(HsailConditionBytecodeHeader))
+         + hsail_fifo_record_align(condition_bytecode->expr->len)
+         + hsail_fifo_record_align(condition_bytecode->num_variables * sizeof(HsailVariableLocation));
+}
 
+/* Encode the packet as a framed record, followed by its strings and condition bytecode */
+static void hsail_fifo_append_record(const HsailCommandPacket* packet,
+                                     const char* source_line,
+                                     const char* kernel_name,
+                                     const struct hsail_condition_bytecode* condition_bytecode)
+{
+  HsailCommandRecord record;
+  HsailConditionBytecodeHeader condition_header;
+  uint32_t source_line_len = hsail_fifo_record_string_len(source_line);
+  uint32_t kernel_name_len = hsail_fifo_record_string_len(kernel_name);
+  size_t source_line_size = hsail_fifo_record_align(source_line_len);
+  size_t kernel_name_size = hsail_fifo_record_align(kernel_name_len);
+  size_t record_size = sizeof(HsailCommandRecord) + source_line_size + kernel_name_size
+                       + hsail_fifo_record_condition_size(condition_bytecode);
+  gdb_byte* dest = NULL;
+
+  gdb_assert(0 == sizeof(HsailCommandRecord) % HSAIL_COMMAND_RECORD_ALIGNMENT);
+
+  memset(&record, 0, sizeof(HsailCommandRecord));
+  record.m_recordSize = (uint32_t)record_size;
+  record.m_command = packet->m_command;
+  record.m_loggingInfo = packet->m_loggingInfo;
+  record.m_gdbBreakpointID = packet->m_gdbBreakpointID;
+  record.m_pc = packet->m_pc;
+  record.m_lineNum = packet->m_lineNum;
+  record.m_numMomentaryBP = packet->m_numMomentaryBP;
+  record.m_numVariables = packet->m_numVariables;
+  record.m_conditionPacket = packet->m_conditionPacket;
+  record.m_sourceLineLen = source_line_len;
+  record.m_kernelNameLen = kernel_name_len;
+
+  /* The padding is zeroed so that the fifo traffic is deterministic */
+  dest = hsail_fifo_reserve_batch_bytes(record_size);
+  memset(dest, 0, record_size);
+  memcpy(dest, &record, sizeof(HsailCommandRecord));
+  dest += sizeof(HsailCommandRecord);
+
+  if (0 < source_line_len)
+    {
+      memcpy(dest, source_line, source_line_len);
+    }
+  dest += source_line_size;
+
+  if (0 < kernel_name_len)
+    {
+      memcpy(dest, kernel_name, kernel_name_len);
+    }
+  dest += kernel_name_size;
+
+  if (NULL != condition_bytecode)
+    {
+      memset(&condition_header, 0, sizeof(HsailConditionBytecodeHeader));
+      condition_header.m_bytecodeLen = (uint32_t)condition_bytecode->expr->len;
+      condition_header.m_numVariables = (uint32_t)condition_bytecode->num_variables;
+
+      memcpy(dest, &condition_header, sizeof(HsailConditionBytecodeHeader));
+      dest += hsail_fifo_record_align(sizeof(HsailConditionBytecodeHeader));
+
+      memcpy(dest, condition_bytecode->expr->buf, condition_bytecode->expr->len);
+      dest += hsail_fifo_record_align(condition_bytecode->expr->len);
+
+      if (0 < condition_bytecode->num_variables)
+        {
+          memcpy(dest, condition_bytecode->variables,
+                 condition_bytecode->num_variables * sizeof(HsailVariableLocation));
+        }
+    }
+}
+
+/* Write all the iovecs to the fifo, retrying on partial writes and interruptions */
+static bool hsail_fifo_write_all(int file_desc, struct iovec* iov, int iov_count)
+{
+  while (0 < iov_count)
+    {
+      ssize_t bytes_written = writev(file_desc, iov, iov_count);
+
+      if (0 > bytes_written)
+        {
+          if (EINTR == errno)
+            {
+              continue;
+            }
+          return false;
+        }
+
+      /* Skip what was written */
+      while (0 < iov_count && (size_t)bytes_written >= iov->iov_len)
+        {
+          bytes_written -= iov->iov_len;
+          iov++;
+          iov_count--;
+        }
+
+      if (0 < iov_count)
+        {
+          iov->iov_base = (gdb_byte*)iov->iov_base + bytes_written;
+          iov->iov_len -= bytes_written;
+        }
+    }
+
+  return true;
+}
+
+/* Write the pending commands to the fifo, in one write */
+static void hsail_fifo_flush_batch(void)
+{
+  HsailCommandBatchHeader batch_header;
+  struct iovec iov[2];
+  int iov_count = 0;
+  bool is_written = false;
+  int file_desc = 0;
+
+  if (0 == gs_hsail_batch_num_commands)
+    {
+      return;
+    }
+
+  file_desc = hsail_get_fifo_handler();
   gdb_assert (file_desc > 0);
 
+  if (HSAIL_PROTOCOL_VERSION_LEGACY != gs_hsail_protocol_version)
+    {
+      memset(&batch_header, 0, sizeof(HsailCommandBatchHeader));
+      batch_header.m_magic = HSAIL_COMMAND_BATCH_MAGIC;
+      batch_header.m_version = gs_hsail_protocol_version;
+      batch_header.m_batchId = ++gs_hsail_last_batch_id;
+      batch_header.m_numRecords = gs_hsail_batch_num_commands;
+      batch_header.m_payloadSize = gs_hsail_batch_buffer_len;
+
+      iov[iov_count].iov_base = &batch_header;
+      iov[iov_count].iov_len = sizeof(HsailCommandBatchHeader);
+      iov_count++;
+    }
+
+  iov[iov_count].iov_base = gs_hsail_batch_buffer;
+  iov[iov_count].iov_len = gs_hsail_batch_buffer_len;
+  iov_count++;
+
+  /* The pending commands are dropped even if the write fails,
+   * so that a broken fifo does not make every later command fail too */
+  gs_hsail_batch_buffer_len = 0;
+  gs_hsail_batch_num_commands = 0;
+
+  is_written = hsail_fifo_write_all(file_desc, iov, iov_count);
+  gdb_assert(is_written);
+}
+
+/* Queue a command for the agent. It is written right away, unless a batch is open.
+ * The strings are sent in full by the framed protocol, and are truncated to the
+ * packet's fields by the legacy protocol.
+ * The condition bytecode can only be sent in a framed record.
+ * */
+static void hsail_push_command_with_condition(HsailCommandPacket* packet,
+                                              const char* source_line,
+                                              const char* kernel_name,
+                                              const struct hsail_condition_bytecode* condition_bytecode)
+{
+  gdb_assert(NULL != packet);
+
   /* It may be tempting to add the call to flush the command buffer here too
    * hsail_flush_command_buffer();
    * However that is logically wrong since the flush is triggered from linux_nat_wait
    * and adding this caused an infinite recursion.
    */
   /*
-  printf_filtered("HSAIL push command %d \n",packet.m_command);
+  printf_filtered("HSAIL push command %d \n",packet->m_command);
   fflush(stdout);
   */
 
-  hsail_validate_command_packet(packet);
+  hsail_validate_command_packet(*packet);
+
+  if (HSAIL_PROTOCOL_VERSION_LEGACY == gs_hsail_protocol_version)
+    {
+      gdb_assert(NULL == condition_bytecode);
+
+      if (NULL != source_line)
+        {
+          strncpy(packet->m_sourceLine, source_line, AGENT_MAX_SOURCE_LINE_LEN - 1);
+          packet->m_sourceLine[AGENT_MAX_SOURCE_LINE_LEN - 1] = '\0';
+        }
+      if (NULL != kernel_name)
+        {
+          strncpy(packet->m_kernelName, kernel_name, AGENT_MAX_FUNC_NAME_LEN - 1);
+          packet->m_kernelName[AGENT_MAX_FUNC_NAME_LEN - 1] = '\0';
+        }
+
+      memcpy(hsail_fifo_reserve_batch_bytes(sizeof(HsailCommandPacket)),
+             packet, sizeof(HsailCommandPacket));
+    }
+  else
+    {
+      hsail_fifo_append_record(packet, source_line, kernel_name, condition_bytecode);
+    }
+
+  gs_hsail_batch_num_commands++;
+
+  if (0 == gs_hsail_batch_depth)
+    {
+      hsail_fifo_flush_batch();
+    }
+}
+
+static void hsail_push_command(HsailCommandPacket* packet,
+                               const char* source_line,
+                               const char* kernel_name)
+{
+  hsail_push_command_with_condition(packet, source_line, kernel_name, NULL);
+}
+
+static void hsail_fifo_end_batch_cleanup(void* ignore)
+{
+  gdb_assert(0 < gs_hsail_batch_depth);
+
+  gs_hsail_batch_depth--;
+
+  if (0 == gs_hsail_batch_depth && is_hsail_linux_initialized())
+    {
+      hsail_fifo_flush_batch();
+    }
+}
+
+/* Hold the commands pushed until the returned cleanup is run, and then write them
+ * to the fifo as a single batch. Batches can be nested, the outermost one writes.
+ * */
+struct cleanup* hsail_fifo_begin_batch(void)
+{
+  gs_hsail_batch_depth++;
+
+  return make_cleanup(hsail_fifo_end_batch_cleanup, NULL);
+}
+
+/* Called once the write end of the fifo is open.
+ * The agent is offered our protocol version in a legacy packet, which all the agents can read,
+ * until it replies we keep to the legacy protocol.
+ * */
+void hsail_fifo_begin_debugging(void)
+{
+  HsailCommandPacket begin_packet;
+
+  gs_hsail_protocol_version = HSAIL_PROTOCOL_VERSION_LEGACY;
+  gs_hsail_batch_buffer_len = 0;
+  gs_hsail_batch_num_commands = 0;
+  gs_hsail_last_batch_id = 0;
+
+  hsail_fifo_initialize_packet(&begin_packet);
+  begin_packet.m_command = HSAIL_COMMAND_BEGIN_DEBUGGING;
+  begin_packet.m_pc = HSAIL_PROTOCOL_VERSION;
+
+  hsail_push_command(&begin_packet, NULL, NULL);
+}
+
+/* The agent's reply to HSAIL_COMMAND_BEGIN_DEBUGGING */
+void hsail_fifo_set_protocol_version(uint32_t agent_version)
+{
+  /* The commands already queued are encoded in the old protocol */
+  hsail_fifo_flush_batch();
 
-  gdb_assert(file_desc > 0);
-  bytes_written = 0;
+  if (HSAIL_PROTOCOL_VERSION < agent_version)
+    {
+      agent_version = HSAIL_PROTOCOL_VERSION;
+    }
 
-  bytes_written = write(file_desc, &packet ,sizeof(HsailCommandPacket));
-  gdb_assert(bytes_written == sizeof(HsailCommandPacket));
+  gs_hsail_protocol_version = agent_version;
+}
+
+/* The agent's acknowledgement of a framed batch */
+void hsail_fifo_command_batch_complete(uint32_t batch_id,
+                                       uint32_t num_commands_applied,
+                                       HsailAgentStatus status)
+{
+  if (HSAIL_AGENT_STATUS_SUCCESS != status)
+    {
+      printf_filtered("The agent applied %u of the HSAIL commands in batch %u\n",
+                      num_commands_applied, batch_id);
+    }
 }
 
 /*
@@ -329,7 +858,8 @@ void hsail_enqueue_create_breakpoint_packet(const int pc,
                                             const int gdb_bkpt_num,
                                             const char* src_line,
                                             const int line_num,
-                                            const HsailBreakpointCondition* condition)
+                                            const HsailBreakpointCondition* condition,
+                                            const struct hsail_condition_bytecode* condition_bytecode)
 {
   HsailCommandPacket breakpoint_packet;
 
@@ -350,9 +880,31 @@ void hsail_enqueue_create_breakpoint_packet(const int pc,
   hsail_utils_copy_wavedim3(&(breakpoint_packet.m_conditionPacket.m_workitemID),
                            &(condition->work_item_id));
 
-  strncpy(breakpoint_packet.m_sourceLine, src_line, AGENT_MAX_SOURCE_LINE_LEN);
+  /* Stopping too often is better than missing a stop the user asked for */
+  if (HSAIL_BREAKPOINT_CONDITION_BYTECODE == condition->condition_code)
+    {
+      if (HSAIL_PROTOCOL_VERSION_CONDITIONS > gs_hsail_protocol_version)
+        {
+          printf_filtered("The HSAIL agent cannot evaluate the condition of breakpoint %d, "
+                          "it will stop on every hit\n", gdb_bkpt_num);
+          condition_bytecode = NULL;
+        }
+      else if (NULL == condition_bytecode)
+        {
+          printf_filtered("Breakpoint %d will stop on every hit\n", gdb_bkpt_num);
+        }
+
+      if (NULL == condition_bytecode)
+        {
+          breakpoint_packet.m_conditionPacket.m_conditionCode = HSAIL_BREAKPOINT_CONDITION_ANY;
+        }
+    }
+  else
+    {
+      condition_bytecode = NULL;
+    }
 
-  hsail_push_command(breakpoint_packet);
+  hsail_push_command_with_condition(&breakpoint_packet, src_line, NULL, condition_bytecode);
 }
 
 void hsail_enqueue_continue_dispatch_packet(void)
@@ -361,7 +913,7 @@ void hsail_enqueue_continue_dispatch_packet(void)
   hsail_fifo_initialize_packet(&continue_packet);
   continue_packet.m_command = HSAIL_COMMAND_CONTINUE;
 
-  hsail_push_command(continue_packet);
+  hsail_push_command(&continue_packet, NULL, NULL);
 }
 
 /*
@@ -379,8 +931,7 @@ void hsail_enqueue_create_kernel_name_breakpoint_packet(const char* kernel_name,
   breakpoint_packet.m_command = HSAIL_COMMAND_CREATE_BREAKPOINT;
   breakpoint_packet.m_gdbBreakpointID = gdb_bkpt_num;
 
-  strncpy(breakpoint_packet.m_kernelName, kernel_name, AGENT_MAX_FUNC_NAME_LEN);
-  hsail_push_command(breakpoint_packet);
+  hsail_push_command(&breakpoint_packet, NULL, kernel_name);
 }
 
 /* We can only delete from the cache in the general case by referencing
@@ -391,8 +942,7 @@ void hsail_enqueue_create_kernel_name_breakpoint_packet(const char* kernel_name,
  * */
 void hsail_enqueue_delete_breakpoint_request_buffer(const int gdb_bkpt_id)
 {
-  int i = 0;
-  bool is_found = false;
+  struct hsail_pending_request* pending = NULL;
 
   /* It is possible for this function to be called if the hsail_request_buffer
    * has been deleted, such as when the inferior has terminated.
@@ -400,29 +950,62 @@ void hsail_enqueue_delete_breakpoint_request_buffer(const int gdb_bkpt_id)
    * to do anything more since subsequent runs of the inferior will not
    * enqueue anything to the buffer
    * */
-  if (NULL == gs_hsail_request_buffer)
+  if (!gs_hsail_is_command_buffer_initialized)
     {
       return;
     }
 
-  gdb_assert(NULL != gs_hsail_request_buffer);
+  pending = hsail_pending_request_find_by_number(gdb_bkpt_id);
+  if (pending != NULL)
+    {
+      hsail_pending_request_remove(pending);
+    }
+  else if (!is_hsail_linux_initialized())
+    {
+      /* Once hsail is initialized, only the unresolved source breakpoints are pending */
+      printf("Could not find breakpoint %d in the breakpoint cache\n", gdb_bkpt_id);
+    }
+}
+
+int hsail_find_pending_breakpoint_request(const HsailBreakpointRequest* request)
+{
+  struct hsail_pending_request key;
+  struct hsail_pending_request* pending = NULL;
+  htab_t location_index = NULL;
+
+  gdb_assert(NULL != request);
 
-  for (i = 0; i < gs_hsail_max_command_buffer_len; i++)
+  if (!gs_hsail_is_command_buffer_initialized ||
+      request->type <= HSAIL_BP_TYPE_UNKNOWN || request->type > HSAIL_BP_TYPE_ANY_LOCATION)
     {
+      return -1;
+    }
 
-      if (gs_hsail_request_buffer[i].number == gdb_bkpt_id)
+  /* The requests without a location index are only chained in their queue */
+  location_index = hsail_pending_request_location_index(request->type);
+  if (location_index == NULL)
+    {
+      for (pending = gs_hsail_pending_queues[request->type].head; pending != NULL; pending = pending->next)
         {
-          hsail_breakpoint_clear_bp_request(&gs_hsail_request_buffer[i]);
-          gs_hsail_command_buffer_len --;
-
-          is_found = true;
-          break;
+          if (hsail_breakpoint_compare_bp_request(&pending->request, request))
+            {
+              return pending->request.number;
+            }
         }
+
+      return -1;
     }
-  if (!is_found)
+
+  key.request = *request;
+  for (pending = htab_find(location_index, &key); pending != NULL; pending = pending->next_same_location)
     {
-      printf("Could not find breakpoint %d in the breakpoint cache\n", gdb_bkpt_id);
+      if (hsail_breakpoint_compare_bp_request(&pending->request, request))
+        {
+          return pending->request.number;
+        }
     }
+
+  return -1;
 }
 
 /* If the Fifo is not ready, we save the command to the pending hsail commands
@@ -431,51 +1014,20 @@ void hsail_enqueue_delete_breakpoint_request_buffer(const int gdb_bkpt_id)
 
 void hsail_enqueue_create_breakpoint_request_buffer(const HsailBreakpointRequest* request)
 {
-  /* Make a copy of the request structure to save in the buffer */
-  int kernel_function_name_len = 0;
-  int command_buffer_position = gs_hsail_command_buffer_len;
-
   gdb_assert(NULL != request);
-  gdb_assert(NULL != gs_hsail_request_buffer);
+  gdb_assert(gs_hsail_is_command_buffer_initialized);
 
-  /* Do a deep copy of the HSAIL BP request passed to this function
-   * since its member arrays will be deallocated before we flush the request to
-   * the agent*/
   switch (request->type)
   {
     case HSAIL_BP_TYPE_KERNEL_FUNCTION:
-      {
-        /*Save request to cache*/
-        hsail_breakpoint_copy_bp_request(&gs_hsail_request_buffer[command_buffer_position],
-                                         request);
-        /* This printf is helpful to debug the caching, leaving this around for now */
-        /*
-        printf("Enqueue Message %s \t %s\n",
-               request->bp.kernel_func.func_name,
-               gs_hsail_request_buffer[command_buffer_position].bp.kernel_func.func_name
-               );
-
-        printf("Strlen %d \t %d\n",
-               strlen(request->bp.kernel_func.func_name),
-               strlen(gs_hsail_request_buffer[command_buffer_position].bp.kernel_func.func_name)
-               );
-         */
-        break;
-      }
     case HSAIL_BP_TYPE_SOURCE_LOCATION:
     case HSAIL_BP_TYPE_ANY_LOCATION:
-      {
-        hsail_breakpoint_copy_bp_request(&gs_hsail_request_buffer[command_buffer_position],
-                                         request);
-        break;
-      }
+      hsail_pending_request_add(request);
+      break;
     default:
       gdb_assert(0);
       break;
   }
-
-  gs_hsail_command_buffer_len = gs_hsail_command_buffer_len + 1;
-
 }
 
 void hsail_enqueue_delete_breakpoint_packet(int gdb_bkpt_num)
@@ -487,7 +1039,7 @@ void hsail_enqueue_delete_breakpoint_packet(int gdb_bkpt_num)
   breakpoint_packet.m_command = HSAIL_COMMAND_DELETE_BREAKPOINT;
   breakpoint_packet.m_gdbBreakpointID = gdb_bkpt_num ;
 
-  hsail_push_command(breakpoint_packet);
+  hsail_push_command(&breakpoint_packet, NULL, NULL);
 }
 
 void hsail_enqueue_disable_breakpoint_packet(int gdb_bkpt_num)
@@ -500,7 +1052,7 @@ void hsail_enqueue_disable_breakpoint_packet(int gdb_bkpt_num)
     disable_packet.m_command = HSAIL_COMMAND_DISABLE_BREAKPOINT;
     disable_packet.m_gdbBreakpointID = gdb_bkpt_num ;
 
-    hsail_push_command(disable_packet);
+    hsail_push_command(&disable_packet, NULL, NULL);
 }
 
 /*
@@ -514,7 +1066,37 @@ void hsail_enqueue_momentary_breakpoint_packet(const int num_momentary_bp)
   breakpoint_packet.m_command = HSAIL_COMMAND_MOMENTARY_BREAKPOINT;
   breakpoint_packet.m_numMomentaryBP = num_momentary_bp;
 
-  hsail_push_command(breakpoint_packet);
+  hsail_push_command(&breakpoint_packet, NULL, NULL);
+}
+
+/*
+ * Let the agent know that the variable read buffer holds num_variables locations.
+ */
+void hsail_enqueue_read_variables_packet(const int num_variables)
+{
+  HsailCommandPacket read_packet;
+  gdb_assert(num_variables > 0);
+
+  hsail_fifo_initialize_packet(&read_packet);
+
+  read_packet.m_command = HSAIL_COMMAND_READ_VARIABLES;
+  read_packet.m_numVariables = num_variables;
+
+  hsail_push_command(&read_packet, NULL, NULL);
+}
+
+/*
+ * Let the agent know that the variable gather buffer holds a gather request.
+ */
+void hsail_enqueue_gather_variable_packet(void)
+{
+  HsailCommandPacket gather_packet;
+
+  hsail_fifo_initialize_packet(&gather_packet);
+
+  gather_packet.m_command = HSAIL_COMMAND_GATHER_VARIABLE;
+
+  hsail_push_command(&gather_packet, NULL, NULL);
 }
 
 void hsail_enqueue_set_logging(const HsailLogCommand logging_command)
@@ -525,7 +1107,7 @@ void hsail_enqueue_set_logging(const HsailLogCommand logging_command)
   logging_packet.m_command = HSAIL_COMMAND_SET_LOGGING;
   logging_packet.m_loggingInfo = logging_command;
 
-  hsail_push_command(logging_packet);
+  hsail_push_command(&logging_packet, NULL, NULL);
 }
 
 void hsail_enqueue_kill_all_waves(void)
@@ -537,5 +1119,5 @@ void hsail_enqueue_kill_all_waves(void)
   kill_packet.m_command = HSAIL_COMMAND_KILL_ALL_WAVES;
 
 
-  hsail_push_command(kill_packet);
+  hsail_push_command(&kill_packet, NULL, NULL);
 }
@@ -26,12 +26,23 @@
 #define _HSAILFIFO_CONTROL_H 1
 
 #include "hsail-breakpoint.h"
+#include "hsail-condition.h"
 
 /* The agent header file */
 #include "CommunicationControl.h"
 
 void hsail_initialize_command_buffer(void);
 
+struct cleanup* hsail_fifo_begin_batch(void);
+
+void hsail_fifo_begin_debugging(void);
+
+void hsail_fifo_set_protocol_version(uint32_t agent_version);
+
+void hsail_fifo_command_batch_complete(uint32_t batch_id,
+                                       uint32_t num_commands_applied,
+                                       HsailAgentStatus status);
+
 void hsail_free_command_buffer(void);
 
 void hsail_flush_breakpoint_command_buffer(void);
@@ -40,11 +51,15 @@ void hsail_enqueue_continue_dispatch_packet(void);
 
 void hsail_enqueue_create_breakpoint_request_buffer(const HsailBreakpointRequest* request);
 
+/* Return the GDB number of a pending request for the same location, -1 if there is none */
+int hsail_find_pending_breakpoint_request(const HsailBreakpointRequest* request);
+
 void hsail_enqueue_create_breakpoint_packet(const int pc,
                                             const int gdb_bkpt_num,
                                             const char* src_line,
                                             const int line_num,
-                                            const HsailBreakpointCondition* condition);
+                                            const HsailBreakpointCondition* condition,
+                                            const struct hsail_condition_bytecode* condition_bytecode);
 
 void hsail_enqueue_create_kernel_name_breakpoint_packet(const char* kernel_name,
                                                         const int gdb_bkpt_num);
@@ -59,6 +74,10 @@ void hsail_enqueue_kill_all_waves(void);
 
 void hsail_enqueue_momentary_breakpoint_packet(const int num_bp);
 
+void hsail_enqueue_read_variables_packet(const int num_variables);
+
+void hsail_enqueue_gather_variable_packet(void);
+
 void hsail_enqueue_set_logging(const HsailLogCommand loggingConfig);
 
 #endif // _HSAILFIFO_CONTROL_H
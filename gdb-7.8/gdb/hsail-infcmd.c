@@ -27,13 +27,14 @@
 #include "ui-out.h"
 #include "gdb_assert.h"
 
-/* Added for memset */
+/* Added for memcpy */
 #include <string.h>
 
 /* HSAIL-GDB headers*/
 #include "hsail-breakpoint.h"
 #include "hsail-fifo-control.h"
 #include "hsail-infcmd.h"
+#include "hsail-step-plan.h"
 #include "hsail-tdep.h"
 #include "CommunicationControl.h"
 
@@ -97,32 +98,25 @@ bool is_hsail_step(void)
 }
 #endif
 
-static void hsail_step_write_momentary_breakpoints(HwDbgInfo_debug dbg,
-                                                   size_t          step_addr_count,
-                                                   HwDbgInfo_addr* step_addrs)
+static void hsail_step_write_momentary_breakpoints(size_t                  step_bp_count,
+                                                   const HsailMomentaryBP* step_bps)
 {
-  int i = 0;
-  HwDbgInfo_code_location loc = NULL;
-  HwDbgInfo_linenum line_num = 0;
-
   HsailMomentaryBP* momentary_bp = NULL;
 
-  int momentary_bp_data_size = 0;
+  size_t momentary_bp_data_size = 0;
   int momentary_bp_shmem_size = 0;
 
-  gdb_assert(dbg != NULL);
-  gdb_assert(step_addrs != NULL);
-  gdb_assert(step_addr_count > 0);
-  momentary_bp = NULL;
+  gdb_assert(step_bps != NULL);
+  gdb_assert(step_bp_count > 0);
 
   /* Size checking for momentary breakpoint buffers */
-  momentary_bp_data_size = sizeof(HsailMomentaryBP)*step_addr_count;
+  momentary_bp_data_size = sizeof(HsailMomentaryBP)*step_bp_count;
   momentary_bp_shmem_size = hsail_get_momentary_bp_buffer_shmem_max_size();
   if (momentary_bp_data_size >= momentary_bp_shmem_size)
     {
       printf("Momentary breakpoint buffer overflow\n");
-      printf("No of Step Addresses: %lu\n", step_addr_count);
-      printf("Step Addresses Memory Required: %d\n", momentary_bp_data_size);
+      printf("No of Step Addresses: %lu\n", step_bp_count);
+      printf("Step Addresses Memory Required: %lu\n", momentary_bp_data_size);
     }
 
   gdb_assert(momentary_bp_data_size < momentary_bp_shmem_size);
@@ -130,31 +124,20 @@ static void hsail_step_write_momentary_breakpoints(HwDbgInfo_debug dbg,
   momentary_bp = (HsailMomentaryBP*)hsail_tdep_map_momentary_bp_buffer();
   gdb_assert(momentary_bp != NULL);
 
-  memset(momentary_bp, 0, momentary_bp_shmem_size);
-
-  for(i=0; i < step_addr_count; i++)
-    {
-      loc = NULL;
-      line_num = 0;
-
-      hwdbginfo_addr_to_line(dbg, step_addrs[i], &loc);
-      hwdbginfo_code_location_details(loc, &line_num, 0, NULL, NULL);
-
-      momentary_bp[i].m_pc      = step_addrs[i];
-      momentary_bp[i].m_lineNum = line_num;
-    }
+  /* The agent only reads the number of breakpoints sent with the packet */
+  memcpy(momentary_bp, step_bps, momentary_bp_data_size);
 
   hsail_tdep_unmap_momentary_bp_buffer((void*)momentary_bp);
 }
 
-void hsail_set_step_breakpoints(int step_type, int count)
+void hsail_set_step_breakpoints(int step_type)
 {
   struct ui_out* uiout = current_uiout;
   HwDbgInfo_debug dbg = hsail_init_hwdbginfo(NULL);
-  HwDbgInfo_err err = HWDBGINFO_E_SUCCESS;
   uint64_t addr = hsail_get_current_pc();
-  HwDbgInfo_addr* step_addrs = NULL;
-  size_t step_addr_count = 0;
+  const HsailMomentaryBP* step_bps = NULL;
+  size_t step_bp_count = 0;
+  struct cleanup* old_chain = NULL;
 
   /* At the initial breakpoint, we are emulating the behavior of having the PC at the
    * opening brace. Thus, a "step over" should behave like a "step in".
@@ -173,74 +156,31 @@ void hsail_set_step_breakpoints(int step_type, int count)
       return;
     }
 
-  /* TODO: support step "n" command */
-  if (1 != count)
-    {
-      ui_out_text(uiout, "GDB: Only single steps are currently supported in hsail\nConverting to single step\n");
-      count = 1;
-    }
+  /* The breakpoints are cached in the step plan of the code object */
+  step_bps = hsail_step_plan_get(dbg, step_type, addr, &step_bp_count);
 
-  if (HSAIL_STEP_IN == step_type)
-    {
-      err = hwdbginfo_all_mapped_addrs(dbg, 0, NULL, &step_addr_count);
-      gdb_assert(HWDBGINFO_E_SUCCESS == err);
-      gdb_assert(0 != step_addr_count);
-      step_addrs = step_addr_count > 0 ? (HwDbgInfo_addr*)malloc(step_addr_count * sizeof(HwDbgInfo_addr)) : NULL;
-      gdb_assert(NULL != step_addrs);
-
-      if ((HWDBGINFO_E_SUCCESS != err) || 0 == step_addr_count || NULL == step_addrs)
-        {
-          ui_out_text(uiout, "GDB: Could not perform hsail step-in\nContinuing execution...\n");
-          return;
-        }
-
-      memset(step_addrs, 0, step_addr_count * sizeof(HwDbgInfo_addr));
-
-      err = hwdbginfo_all_mapped_addrs(dbg, step_addr_count, step_addrs, NULL);
-      gdb_assert(HWDBGINFO_E_SUCCESS == err);
-      if (HWDBGINFO_E_SUCCESS != err)
-        {
-          ui_out_text(uiout, "GDB: Could not perform hsail step-in\nContinuing execution...\n");
-          free(step_addrs);
-          return;
-        }
-    }
-  else
+  if (NULL == step_bps || 0 == step_bp_count)
     {
-      /* Get the number of step addresses */
-      err = hwdbginfo_step_addresses(dbg, addr, (HSAIL_STEP_OUT == step_type), 0, NULL, &step_addr_count);
-      gdb_assert(HWDBGINFO_E_SUCCESS == err);
-      gdb_assert(0 != step_addr_count);
-      step_addrs = step_addr_count > 0 ? (HwDbgInfo_addr*)malloc(step_addr_count * sizeof(HwDbgInfo_addr)) : NULL;
-      gdb_assert(NULL != step_addrs);
-
-      if ((HWDBGINFO_E_SUCCESS != err) || 0 == step_addr_count || NULL == step_addrs)
-        {
-          ui_out_text(uiout, "GDB: Could not perform hsail step-over\nContinuing execution...\n");
-          return;
-        }
-
-      memset(step_addrs, 0, step_addr_count * sizeof(HwDbgInfo_addr));
-
-      /* Get the step addresses */
-      err = hwdbginfo_step_addresses(dbg, addr, (HSAIL_STEP_OUT == step_type), step_addr_count, step_addrs, NULL);
-      gdb_assert(HWDBGINFO_E_SUCCESS == err);
-      if (HWDBGINFO_E_SUCCESS != err)
-        {
-          ui_out_text(uiout, "GDB: Could not perform hsail step-over\nContinuing execution...\n");
-          free(step_addrs);
-          return;
-        }
+      if (HSAIL_STEP_IN == step_type)
+        ui_out_text(uiout, "GDB: Could not perform hsail step-in\nContinuing execution...\n");
+      else
+        ui_out_text(uiout, "GDB: Could not perform hsail step-over\nContinuing execution...\n");
+      return;
     }
 
   /* Write momentary breakpoints to shared memory */
-  hsail_step_write_momentary_breakpoints(dbg, step_addr_count,step_addrs);
+  hsail_step_write_momentary_breakpoints(step_bp_count, step_bps);
+
+  /* The breakpoints and the continue are sent together */
+  old_chain = hsail_fifo_begin_batch();
 
   /* Notify the agent */
-  hsail_enqueue_momentary_breakpoint_packet(step_addr_count);
+  hsail_enqueue_momentary_breakpoint_packet(step_bp_count);
 
   /* Prepare the agent to have the "continue" issued: */
   hsail_set_continue_dispatch();
+
+  do_cleanups(old_chain);
 }
 
 /* This command is needed to be sure that we are actually starting the inferior
@@ -30,7 +30,7 @@
 #define HSAIL_STEP_IN   2
 
 bool is_hsail_step(void);
-void hsail_set_step_breakpoints(int steptype, int count);
+void hsail_set_step_breakpoints(int steptype);
 
 void hsail_set_continue_dispatch(void);
 
@@ -29,35 +29,106 @@
 
 #include <string.h>
 #include <stdbool.h>
+#include "hashtab.h"
 #include "CommunicationControl.h"
 
 #include "hsail-breakpoint.h"
 #include "hsail-kernel.h"
 
 static struct hsail_kernel* gs_hsail_kernel_chain = NULL;
+static struct hsail_kernel* gs_hsail_kernel_chain_tail = NULL;
+
+/* The kernels of gs_hsail_kernel_chain hashed by kernel name */
+static htab_t gs_hsail_kernel_registry = NULL;
 
 /* active dispatch */
 static struct hsail_dispatch* gs_active_dispatch = NULL;
 
+/* Ring of the most recent dispatches, gs_dispatch_history_count is the
+ * total number of dispatches recorded since the kernel chain was cleared */
+static struct hsail_dispatch_record gs_dispatch_history[HSAIL_KERNEL_DISPATCH_HISTORY_SIZE];
+static ULONGEST gs_dispatch_history_count = 0;
+
+/* The time of the first dispatch, dispatch timestamps are printed relative to it */
+static struct timeval gs_dispatch_history_start;
+
 #define ALL_HSAIL_KERNELS(k)  for (k = gs_hsail_kernel_chain; NULL != k; k = k->next)
 
-/* mirror of add_to_breakpoint_chain*/
+static hashval_t
+hsail_kernel_hash (const void* p)
+{
+  const struct hsail_kernel* k = p;
+  return htab_hash_string(k->kernel_name);
+}
+
+static int
+hsail_kernel_eq (const void* a, const void* b)
+{
+  const struct hsail_kernel* ka = a;
+  const struct hsail_kernel* kb = b;
+  return strcmp(ka->kernel_name, kb->kernel_name) == 0;
+}
+
+static hashval_t
+hsail_dispatch_shape_hash (const void* p)
+{
+  const struct hsail_dispatch* d = p;
+  hashval_t h = iterative_hash_object(d->work_groups_size, 0);
+  return iterative_hash_object(d->work_items, h);
+}
+
+static int
+hsail_dispatch_shape_eq (const void* a, const void* b)
+{
+  const struct hsail_dispatch* da = a;
+  const struct hsail_dispatch* db = b;
+
+  return da->work_groups_size.x == db->work_groups_size.x &&
+         da->work_groups_size.y == db->work_groups_size.y &&
+         da->work_groups_size.z == db->work_groups_size.z &&
+         da->work_items.x == db->work_items.x &&
+         da->work_items.y == db->work_items.y &&
+         da->work_items.z == db->work_items.z;
+}
+
+/* mirror of add_to_breakpoint_chain, the registry keeps the tail so this is O(1)*/
 static void
 add_to_hsail_kernel_chain (struct hsail_kernel* b)
 {
-  /* Add this kernel to the end of the chain*/
-  struct hsail_kernel* b1 = gs_hsail_kernel_chain;
+  void** slot = NULL;
 
-  if (b1 == NULL)
+  if (gs_hsail_kernel_registry == NULL)
+    {
+      gs_hsail_kernel_registry = htab_create_alloc(64, hsail_kernel_hash, hsail_kernel_eq,
+                                                   NULL, xcalloc, xfree);
+    }
+
+  slot = htab_find_slot(gs_hsail_kernel_registry, b, INSERT);
+  gdb_assert(NULL != slot);
+  gdb_assert(NULL == *slot);
+  *slot = b;
+
+  /* Add this kernel to the end of the chain*/
+  if (gs_hsail_kernel_chain_tail == NULL)
     gs_hsail_kernel_chain = b;
   else
+    gs_hsail_kernel_chain_tail->next = b;
+
+  gs_hsail_kernel_chain_tail = b;
+}
+
+static struct hsail_kernel*
+hsail_kernel_find(const char* kernel_name)
+{
+  struct hsail_kernel key;
+
+  if (gs_hsail_kernel_registry == NULL)
     {
-      while (b1->next)
-        {
-          b1 = b1->next;
-        }
-      b1->next = b;
+      return NULL;
     }
+
+  key.kernel_name = (char*)kernel_name;
+  return htab_find(gs_hsail_kernel_registry, &key);
 }
 
 struct hsail_dispatch* hsail_kernel_active_dispatch(void)
@@ -65,91 +136,88 @@ struct hsail_dispatch* hsail_kernel_active_dispatch(void)
   return gs_active_dispatch;
 }
 
+static void
+hsail_kernel_record_dispatch(const struct hsail_kernel* k,
+                             HsailWaveDim3 workGroupSize,
+                             HsailWaveDim3 gridSize)
+{
+  struct hsail_dispatch_record* record =
+      &gs_dispatch_history[gs_dispatch_history_count % HSAIL_KERNEL_DISPATCH_HISTORY_SIZE];
+
+  record->kernel = k;
+  record->sequence = gs_dispatch_history_count;
+  record->work_groups_size = workGroupSize;
+  record->work_items = gridSize;
+  gettimeofday(&record->timestamp, NULL);
+
+  if (gs_dispatch_history_count == 0)
+    {
+      gs_dispatch_history_start = record->timestamp;
+    }
+
+  gs_dispatch_history_count++;
+}
+
 static bool
 hsail_kernel_append_dispatch_to_kernel(struct hsail_kernel* k,
-                                       struct hsail_dispatch* dispatch,
                                        HsailWaveDim3 workGroupSize,
                                        HsailWaveDim3 gridSize)
 {
-  bool dispatchFound = false;
-  struct hsail_dispatch* pCurrentDispatch = NULL;
-  struct hsail_dispatch* pLastDispatch = NULL;
+  struct hsail_dispatch key;
+  struct hsail_dispatch* dispatch = NULL;
+  void** slot = NULL;
 
   gdb_assert(k!= NULL);
-  gdb_assert(dispatch != NULL);
-
-  // mark active dispatch
-  gs_active_dispatch = dispatch;
-
-  // look in the current list of dispatched items
-  // if same work group size is there and the dispatch count and release the dispatch
-  // if not and the dispatch to the list
-
-  if (k->dispatch_list != NULL)
-  {
-    pCurrentDispatch = k->dispatch_list;
-  }
 
-  // Check the current dispatch for the same size workgroup size
-  while(pCurrentDispatch != NULL && !dispatchFound)
-  {
-    if (workGroupSize.x == pCurrentDispatch->work_groups_size.x &&
-        workGroupSize.y == pCurrentDispatch->work_groups_size.y &&
-        workGroupSize.z == pCurrentDispatch->work_groups_size.z)
+  if (k->dispatch_shapes == NULL)
     {
-      dispatchFound = true;
+      k->dispatch_shapes = htab_create_alloc(4, hsail_dispatch_shape_hash, hsail_dispatch_shape_eq,
+                                             NULL, xcalloc, xfree);
     }
-    else
-    {
-      // remember the last dispatch in the list so the new dispatch can be added after it
-      if (pCurrentDispatch->next == NULL)
-      {
-        pLastDispatch = pCurrentDispatch;
-      }
-      pCurrentDispatch = pCurrentDispatch->next;
-    }
-  };
 
-  // take the correct action based if it is a new dispatch or an old one
-  if (dispatchFound)
-  {
-    if (pCurrentDispatch != NULL) // sanity check
+  /* Dispatches with the same shape only bump the count of the existing shape */
+  key.work_groups_size = workGroupSize;
+  key.work_items = gridSize;
+  slot = htab_find_slot(k->dispatch_shapes, &key, INSERT);
+  gdb_assert(NULL != slot);
+
+  if (*slot != NULL)
     {
-      pCurrentDispatch->dispatch_count++;
-      xfree(dispatch);
+      dispatch = *slot;
     }
-  }
   else
-  {
-    if (pLastDispatch != NULL)
-    {
-      pLastDispatch->next = dispatch;
-    }
-    else
     {
-      k->dispatch_list = dispatch;
-      k->dispatch_list->dispatch_count = 0;
+      dispatch = XCNEW(struct hsail_dispatch);
+      dispatch->work_groups_size = workGroupSize;
+      dispatch->work_items = gridSize;
+      *slot = dispatch;
+
+      if (k->dispatch_tail == NULL)
+        k->dispatch_list = dispatch;
+      else
+        k->dispatch_tail->next = dispatch;
+
+      k->dispatch_tail = dispatch;
     }
-    dispatch->work_groups_size.x = workGroupSize.x;
-    dispatch->work_groups_size.y = workGroupSize.y;
-    dispatch->work_groups_size.z = workGroupSize.z;
-    dispatch->work_items.x = gridSize.x;
-    dispatch->work_items.y = gridSize.y;
-    dispatch->work_items.z = gridSize.z;
-    dispatch->dispatch_count++;
-  }
 
+  dispatch->dispatch_count++;
+  k->dispatch_count++;
+
+  // mark active dispatch
+  gs_active_dispatch = dispatch;
+  k->active_dispatch = dispatch;
+
+  hsail_kernel_record_dispatch(k, workGroupSize, gridSize);
 
   return true;
 }
 
-/* Updates the kernel_source_file_name and saves the kernel to the file
+/* Updates the kernel_source_file_name, the source is only written to
+ * the file when the user asks for it with "hsail save-source"
  * */
-static void hsail_kernel_save_source_to_file(struct hsail_kernel* k)
+static void hsail_kernel_set_source_file_name(struct hsail_kernel* k)
 {
   int filename_str_len = 0;
-  char* hsail_source_buffer = NULL;
-  FILE* temp_file_handle = NULL;
 
   const char hsail_ext[] = "temp_source";
   filename_str_len = strlen(hsail_ext) + 1;
@@ -207,96 +275,42 @@ static void hsail_kernel_save_source_to_file(struct hsail_kernel* k)
   strcat(k->kernel_source_file_name, hsail_ext);
   */
 
-  hsail_source_buffer = hsail_dbginfo_get_source_buffer();
-
-  gdb_assert(hsail_source_buffer!= NULL);
-
-  temp_file_handle = fopen(k->kernel_source_file_name,"wb");
-  gdb_assert(temp_file_handle != NULL);
-
-  fprintf(temp_file_handle, "%s",hsail_source_buffer);
-
-  rewind(temp_file_handle);
-  fclose(temp_file_handle);
-
-  printf_filtered("HSAIL kernel saved to %s\n",k->kernel_source_file_name);
-
-  /* Once we write, we should somehow change the permission of this file to be readonly
-   * */
+  printf_filtered("HSAIL kernel source is available with \"list\", "
+                  "\"hsail save-source\" saves it to %s\n",k->kernel_source_file_name);
 }
 
 bool hsail_kernel_add_dispatch(const HsailNotificationPayload* fifo_data)
 {
   struct hsail_kernel* k = NULL;
-  struct hsail_dispatch* active_dispatch = NULL;
-
   bool dispatch_added = false;
-  bool kernel_found = false;
 
   gdb_assert(NULL != fifo_data);
 
-  ALL_HSAIL_KERNELS(k)
-  {
-    gdb_assert(NULL != k->kernel_name);
-    if (strcmp(k->kernel_name,
-               fifo_data->payload.BinaryNotification.m_KernelName) == 0)
-      {
-        gdb_assert(k->kernel_source_file_name != NULL);
-
-        /* We dont print this since the source is saved on a per module basis
-         * printf("HSAIL kernel in %s\n",k->kernel_source_file_name);
-         * */
-
-        kernel_found = true;
-
-        active_dispatch = XNEW(struct hsail_dispatch);
-        gdb_assert(active_dispatch != NULL);
-        active_dispatch->next = NULL;
-
-        dispatch_added = hsail_kernel_append_dispatch_to_kernel(k,
-                                                                active_dispatch,
-                                                                fifo_data->payload.BinaryNotification.m_workGroupSize,
-                                                                fifo_data->payload.BinaryNotification.m_gridSize);
-        gdb_assert(dispatch_added == true);
-        break;
-      }
-  }
+  k = hsail_kernel_find(fifo_data->payload.BinaryNotification.m_KernelName);
 
-  if (kernel_found == false)
+  /* We dont print the source file name of a known kernel since the source is
+   * saved on a per module basis */
+  if (k == NULL)
     {
-      k = xmalloc(sizeof(struct hsail_kernel));
-      gdb_assert(NULL != k);
-      memset(k, 0, sizeof(struct hsail_kernel));
-
-      k->next = NULL;
-      add_to_hsail_kernel_chain(k);
-      kernel_found = true;
-
-      k->dispatch_list = NULL;
+      k = XCNEW(struct hsail_kernel);
 
       k->kernel_name = xmalloc(sizeof(char)*AGENT_MAX_FUNC_NAME_LEN);
       gdb_assert(k->kernel_name != NULL);
       strcpy(k->kernel_name, fifo_data->payload.BinaryNotification.m_KernelName);
 
-      hsail_kernel_save_source_to_file(k);
-
-      active_dispatch = XNEW(struct hsail_dispatch);
-      gdb_assert(active_dispatch != NULL);
-      active_dispatch->next = NULL;
-
-      dispatch_added = hsail_kernel_append_dispatch_to_kernel(k,
-                                                              active_dispatch,
-                                                              fifo_data->payload.BinaryNotification.m_workGroupSize,
-                                                              fifo_data->payload.BinaryNotification.m_gridSize);
+      add_to_hsail_kernel_chain(k);
 
+      hsail_kernel_set_source_file_name(k);
     }
 
-  if (kernel_found && dispatch_added )
-    {
-      return true;
-    }
+  gdb_assert(k->kernel_source_file_name != NULL);
 
-  return false;
+  dispatch_added = hsail_kernel_append_dispatch_to_kernel(k,
+                                                          fifo_data->payload.BinaryNotification.m_workGroupSize,
+                                                          fifo_data->payload.BinaryNotification.m_gridSize);
+  gdb_assert(dispatch_added == true);
+
+  return dispatch_added;
 }
 
 
@@ -306,6 +320,18 @@ void hsail_kernel_clear_chain(void)
   struct hsail_dispatch* currentDispatch = NULL;
   struct hsail_dispatch* freeDispatch = NULL;
 
+  gs_active_dispatch = NULL;
+  gs_dispatch_history_count = 0;
+  memset(gs_dispatch_history, 0, sizeof(gs_dispatch_history));
+
+  if (gs_hsail_kernel_registry != NULL)
+    {
+      htab_delete(gs_hsail_kernel_registry);
+      gs_hsail_kernel_registry = NULL;
+    }
+
+  gs_hsail_kernel_chain_tail = NULL;
+
   if (gs_hsail_kernel_chain == NULL)
     {
       return;
@@ -317,7 +343,13 @@ void hsail_kernel_clear_chain(void)
       /*remove the head of the list*/
       gs_hsail_kernel_chain = current->next;
 
-      /* free the dispatch list */
+      /* free the dispatch shapes, the hash table does not own them */
+      if (current->dispatch_shapes != NULL)
+        {
+          htab_delete(current->dispatch_shapes);
+          current->dispatch_shapes = NULL;
+        }
+
       currentDispatch = current->dispatch_list;
       while (currentDispatch != NULL)
       {
@@ -403,7 +435,7 @@ void hsail_kernel_print_info (struct ui_out* uiout, int from_tty)
 
 void hsail_kernel_print_specific_info(char* arg, struct ui_out* uiout, int from_tty)
 {
-  struct hsail_kernel* current_kernel = gs_hsail_kernel_chain;
+  struct hsail_kernel* current_kernel = NULL;
   struct hsail_dispatch* currentDispatch = NULL;
   int index_counter = 0;
   int arg_len = 0;
@@ -414,61 +446,109 @@ void hsail_kernel_print_specific_info(char* arg, struct ui_out* uiout, int from_
   char wg_buffer[30] = "";
   char wg_dim_buffer[30] = "";
 
-  bool kernel_found = false;
-
   gdb_assert(NULL != arg);
   gdb_assert(NULL != uiout);
   arg_len = strlen(arg);
 
-  if (NULL == current_kernel)
+  if (NULL == gs_hsail_kernel_chain)
   {
     ui_out_text(uiout, "No kernels are executed\n");
     return;
   }
 
   /* from arg copy the kernel name (all chars until the end or until the first space character */
-  while (kernel_name_len < arg_len && arg[kernel_name_len] != ' ' && arg[kernel_name_len] != '\n' && arg[kernel_name_len] != '\r' && arg[kernel_name_len] != '\t')
+  while (kernel_name_len < arg_len && kernel_name_len < (int)sizeof(kernel_name) - 1 &&
+         arg[kernel_name_len] != ' ' && arg[kernel_name_len] != '\n' && arg[kernel_name_len] != '\r' && arg[kernel_name_len] != '\t')
   {
     kernel_name[kernel_name_len] = arg[kernel_name_len];
     kernel_name_len++;
   }
   kernel_name[kernel_name_len] = '\0';
 
-  /* pass through the chain */
-  while (current_kernel != NULL)
+  current_kernel = hsail_kernel_find(kernel_name);
+  if (current_kernel == NULL)
   {
-    gdb_assert(NULL != current_kernel->kernel_name);
-    /* check if it is the kernel if the same name then print the information */
-    if (strcmp(current_kernel->kernel_name, kernel_name) == 0)
-    {
-      kernel_found = true;
-      /* print the information of the kernel */
-      currentDispatch = current_kernel->dispatch_list;
-      printf_filtered("Kernel %s info\n", current_kernel->kernel_name);
-      printf_filtered("%5s%25s%25s\n","Index","# of Work-groups","Work-group Dimensions");
-      index_counter = 0;
-      while (currentDispatch)
-      {
-        sprintf(index_buffer,"%s%d",currentDispatch == gs_active_dispatch ? "*" : "",index_counter);
-        sprintf(wg_buffer,"%d,%d,%d",
-                        hsail_kernel_compute_num_wg(currentDispatch->work_items.x, currentDispatch->work_groups_size.x),
-                        hsail_kernel_compute_num_wg(currentDispatch->work_items.y, currentDispatch->work_groups_size.y),
-                        hsail_kernel_compute_num_wg(currentDispatch->work_items.z, currentDispatch->work_groups_size.z));
-        sprintf(wg_dim_buffer,"%d,%d,%d",
-                        currentDispatch->work_groups_size.x,
-                        currentDispatch->work_groups_size.y,
-                        currentDispatch->work_groups_size.z);
-        printf_filtered("%5s%25s%25s\n",index_buffer, wg_buffer, wg_dim_buffer);
-        index_counter = index_counter+1;
-        currentDispatch = currentDispatch->next;
-      }
-    }
-    current_kernel = current_kernel->next;
+    printf_filtered("'%s' kernel not found. Please enter a kernel from executed kernels.\n",kernel_name);
+    printf_filtered("To list the executed kernels use 'info hsail kernels'.\n");
+    return;
   }
 
-  if (!kernel_found)
+  /* print the information of the kernel */
+  currentDispatch = current_kernel->dispatch_list;
+  printf_filtered("Kernel %s info, %s dispatches\n", current_kernel->kernel_name,
+                  pulongest(current_kernel->dispatch_count));
+  printf_filtered("%5s%25s%25s%15s\n","Index","# of Work-groups","Work-group Dimensions","DispatchCount");
+  index_counter = 0;
+  while (currentDispatch)
   {
-    printf_filtered("'%s' kernel not found. Please enter a kernel from executed kernels.\n",kernel_name);
-    printf_filtered("To list the executed kernels use 'info hsail kernels'.\n");
+    sprintf(index_buffer,"%s%d",currentDispatch == gs_active_dispatch ? "*" : "",index_counter);
+    sprintf(wg_buffer,"%d,%d,%d",
+                    hsail_kernel_compute_num_wg(currentDispatch->work_items.x, currentDispatch->work_groups_size.x),
+                    hsail_kernel_compute_num_wg(currentDispatch->work_items.y, currentDispatch->work_groups_size.y),
+                    hsail_kernel_compute_num_wg(currentDispatch->work_items.z, currentDispatch->work_groups_size.z));
+    sprintf(wg_dim_buffer,"%d,%d,%d",
+                    currentDispatch->work_groups_size.x,
+                    currentDispatch->work_groups_size.y,
+                    currentDispatch->work_groups_size.z);
+    printf_filtered("%5s%25s%25s%15d\n",index_buffer, wg_buffer, wg_dim_buffer, currentDispatch->dispatch_count);
+    index_counter = index_counter+1;
+    currentDispatch = currentDispatch->next;
+  }
+}
+
+void hsail_kernel_print_dispatch_history(struct ui_out* uiout, int from_tty)
+{
+  ULONGEST first = 0;
+  ULONGEST i = 0;
+  const struct hsail_dispatch_record* record = NULL;
+  long seconds = 0;
+  long microseconds = 0;
+  char grid_buffer[40] = "";
+  char wg_dim_buffer[30] = "";
+  char time_buffer[30] = "";
+
+  gdb_assert(NULL != uiout);
+
+  if (gs_dispatch_history_count == 0)
+  {
+    ui_out_text(uiout, "No kernels are executed\n");
+    return;
+  }
+
+  if (gs_dispatch_history_count > HSAIL_KERNEL_DISPATCH_HISTORY_SIZE)
+  {
+    first = gs_dispatch_history_count - HSAIL_KERNEL_DISPATCH_HISTORY_SIZE;
+  }
+
+  printf_filtered("Last %s of %s dispatches\n",
+                  pulongest(gs_dispatch_history_count - first),
+                  pulongest(gs_dispatch_history_count));
+  printf_filtered("%10s%14s%30s%20s%23s\n","Dispatch","Time(s)","KernelName","Grid Size","Work-group Dimensions");
+
+  for (i = first; i < gs_dispatch_history_count; i++)
+  {
+    record = &gs_dispatch_history[i % HSAIL_KERNEL_DISPATCH_HISTORY_SIZE];
+    gdb_assert(record->sequence == i);
+    gdb_assert(NULL != record->kernel);
+
+    seconds = record->timestamp.tv_sec - gs_dispatch_history_start.tv_sec;
+    microseconds = record->timestamp.tv_usec - gs_dispatch_history_start.tv_usec;
+    if (microseconds < 0)
+    {
+      seconds--;
+      microseconds += 1000000;
+    }
+
+    sprintf(time_buffer,"%ld.%06ld", seconds, microseconds);
+    sprintf(grid_buffer,"%u,%u,%u",
+                    record->work_items.x,
+                    record->work_items.y,
+                    record->work_items.z);
+    sprintf(wg_dim_buffer,"%u,%u,%u",
+                    record->work_groups_size.x,
+                    record->work_groups_size.y,
+                    record->work_groups_size.z);
+    printf_filtered("%10s%14s%30s%20s%23s\n", pulongest(record->sequence), time_buffer,
+                    record->kernel->kernel_name, grid_buffer, wg_dim_buffer);
   }
 }
@@ -24,13 +24,21 @@
 #if !defined (HSAIL_KERNEL_H)
 #define HSAIL_KERNEL_H 1
 
+#include <sys/time.h>
+
 #include "CommunicationControl.h"
 
+/* The number of most recent dispatches remembered for "info hsail dispatches" */
+#define HSAIL_KERNEL_DISPATCH_HISTORY_SIZE 64
+
+/* A dispatch shape of a kernel, all the dispatches of the kernel with the same
+ * work-group size and grid size are counted in the same hsail_dispatch */
 struct hsail_dispatch
 {
+  /* The next shape of the same kernel, in the order they were first dispatched */
   struct hsail_dispatch *next;
 
-  /* The number of times the kernel has been dispatched on this queue */
+  /* The number of times the kernel has been dispatched with this shape */
   int dispatch_count;
 
   /* A queue idenitifier*/
@@ -59,13 +67,36 @@ struct hsail_kernel
   /* Kernel file name */
   char* kernel_source_file_name;
 
-  /* A list of all possible dispatches*/
+  /* A list of all the dispatch shapes, and its last element so new shapes are appended in O(1) */
   struct hsail_dispatch* dispatch_list;
+  struct hsail_dispatch* dispatch_tail;
+
+  /* The dispatch shapes hashed by work-group size and grid size */
+  struct htab* dispatch_shapes;
+
+  /* The total number of dispatches of the kernel */
+  ULONGEST dispatch_count;
 
   /* active dispatch */
   struct hsail_dispatch* active_dispatch;
 };
 
+/* An entry of the ring of the most recent dispatches */
+struct hsail_dispatch_record
+{
+  /* The kernel, valid until the kernel chain is cleared */
+  const struct hsail_kernel* kernel;
+
+  /* The dispatch number since the kernel chain was last cleared, starting at 0 */
+  ULONGEST sequence;
+
+  HsailWaveDim3 work_groups_size;
+  HsailWaveDim3 work_items;
+
+  /* When gdb received the dispatch notification */
+  struct timeval timestamp;
+};
+
 
 void hsail_kernel_clear_chain(void);
 
@@ -75,6 +106,8 @@ void hsail_kernel_print_info (struct ui_out *uiout, int from_tty);
 
 void hsail_kernel_print_specific_info(char *arg, struct ui_out *uiout, int from_tty);
 
+void hsail_kernel_print_dispatch_history(struct ui_out *uiout, int from_tty);
+
 struct hsail_dispatch* hsail_kernel_active_dispatch(void);
 
 
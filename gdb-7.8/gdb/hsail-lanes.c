@@ -0,0 +1,131 @@
+/*
+   HSAIL helpers to decode the execution mask and work-item IDs of a wave
+
+   Copyright (c) 2015 ADVANCED MICRO DEVICES, INC.  All rights reserved.
+   This file includes code originally published under
+
+   Copyright (C) 1986-2014 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* GDB headers */
+#include "defs.h"
+#include "gdb_assert.h"
+
+#include "hsail-lanes.h"
+
+#include "CommunicationControl.h"
+
+int hsail_lanes_first(uint64_t mask)
+{
+  if (0 == mask)
+    {
+      return -1;
+    }
+
+  return __builtin_ctzll(mask);
+}
+
+int hsail_lanes_last(uint64_t mask)
+{
+  if (0 == mask)
+    {
+      return -1;
+    }
+
+  return HSAIL_WAVE_LANES - 1 - __builtin_clzll(mask);
+}
+
+/* A work-group dimension of 0 is taken as 1 */
+static uint64_t hsail_lanes_dim(uint32_t size)
+{
+  return (size == 0) ? 1 : size;
+}
+
+void hsail_lanes_workitem_id(const HsailWaveDim3* base_id,
+                             int lane,
+                             const HsailWaveDim3* work_group_size,
+                             HsailWaveDim3* work_item_id)
+{
+  uint64_t sizeX = 0;
+  uint64_t sizeY = 0;
+  uint64_t flat_id = 0;
+
+  gdb_assert(NULL != base_id);
+  gdb_assert(NULL != work_group_size);
+  gdb_assert(NULL != work_item_id);
+  gdb_assert(lane >= 0 && lane < HSAIL_WAVE_LANES);
+
+  sizeX = hsail_lanes_dim(work_group_size->x);
+  sizeY = hsail_lanes_dim(work_group_size->y);
+
+  flat_id = base_id->x + (base_id->y + base_id->z * sizeY) * sizeX + lane;
+
+  work_item_id->x = flat_id % sizeX;
+  work_item_id->y = (flat_id / sizeX) % sizeY;
+  work_item_id->z = flat_id / (sizeX * sizeY);
+}
+
+int hsail_lanes_workitem_lane(const HsailWaveDim3* base_id,
+                              const HsailWaveDim3* work_item,
+                              const HsailWaveDim3* work_group_size)
+{
+  uint64_t sizeX = 0;
+  uint64_t sizeY = 0;
+  uint64_t base_flat_id = 0;
+  uint64_t flat_id = 0;
+
+  gdb_assert(NULL != base_id);
+  gdb_assert(NULL != work_item);
+  gdb_assert(NULL != work_group_size);
+
+  sizeX = hsail_lanes_dim(work_group_size->x);
+  sizeY = hsail_lanes_dim(work_group_size->y);
+
+  /* IDs outside of the work-group would flatten to another work-item */
+  if (work_item->x >= sizeX || work_item->y >= sizeY)
+    {
+      return -1;
+    }
+
+  base_flat_id = base_id->x + (base_id->y + base_id->z * sizeY) * sizeX;
+  flat_id = work_item->x + (work_item->y + work_item->z * sizeY) * sizeX;
+
+  if (flat_id < base_flat_id || flat_id - base_flat_id >= HSAIL_WAVE_LANES)
+    {
+      return -1;
+    }
+
+  return (int)(flat_id - base_flat_id);
+}
+
+void hsail_lanes_absolute_workitem(const HsailWaveDim3* work_item_id,
+                                   const HsailWaveDim3* work_group_id,
+                                   const HsailWaveDim3* work_group_size,
+                                   HsailWaveDim3* absolute_id)
+{
+  gdb_assert(NULL != work_item_id);
+  gdb_assert(NULL != work_group_id);
+  gdb_assert(NULL != work_group_size);
+  gdb_assert(NULL != absolute_id);
+
+  absolute_id->x = work_group_id->x * work_group_size->x + work_item_id->x;
+  absolute_id->y = work_group_id->y * work_group_size->y + work_item_id->y;
+  absolute_id->z = work_group_id->z * work_group_size->z + work_item_id->z;
+}
@@ -0,0 +1,58 @@
+/*
+   HSAIL helpers to decode the execution mask and work-item IDs of a wave
+
+   Copyright (c) 2015 ADVANCED MICRO DEVICES, INC.  All rights reserved.
+   This file includes code originally published under
+
+   Copyright (C) 1986-2014 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#if !defined (HSAIL_LANES_H)
+#define HSAIL_LANES_H 1
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "CommunicationControl.h"
+
+/* The number of lanes (work-items) in a wave */
+#define HSAIL_WAVE_LANES 64
+
+/* First / last active lane in the mask, -1 if the mask is empty */
+int hsail_lanes_first(uint64_t mask);
+
+int hsail_lanes_last(uint64_t mask);
+
+/* The work-items of a wave follow each other in their work-group, x varying fastest.
+ * Decode the local work-item ID of a lane from the local work-item ID of lane 0 */
+void hsail_lanes_workitem_id(const HsailWaveDim3* base_id,
+                             int lane,
+                             const HsailWaveDim3* work_group_size,
+                             HsailWaveDim3* work_item_id);
+
+/* The lane whose decoded local work-item ID is work_item, -1 if no lane of the wave decodes to it */
+int hsail_lanes_workitem_lane(const HsailWaveDim3* base_id,
+                              const HsailWaveDim3* work_item,
+                              const HsailWaveDim3* work_group_size);
+
+/* Convert a local work-item ID to an absolute work-item ID */
+void hsail_lanes_absolute_workitem(const HsailWaveDim3* work_item_id,
+                                   const HsailWaveDim3* work_group_id,
+                                   const HsailWaveDim3* work_group_size,
+                                   HsailWaveDim3* absolute_id);
+
+#endif // HSAIL_LANES_H
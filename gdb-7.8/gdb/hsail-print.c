@@ -33,15 +33,20 @@
 #include "expression.h"
 #include "format.h"
 #include "gdb_assert.h"
+#include "gdbtypes.h"
 #include "ui-out.h"
 #include "valprint.h"
 #include "value.h"
 
 #include "hsail-breakpoint.h"
+#include "hsail-cmd.h"
+#include "hsail-fifo-control.h"
 #include "hsail-kernel.h"
+#include "hsail-lanes.h"
 #include "hsail-print.h"
 #include "hsail-tdep.h"
 #include "hsail-utils.h"
+#include "hsail-wave-index.h"
 
 #include "CommunicationControl.h"
 
@@ -53,10 +58,34 @@ static struct value* hsail_print_var_info_with_location(HwDbgInfo_variable dbgVa
 
 static struct value* hsail_print_var_with_addr(const char* print_name, uint64_t addr, char* printFormat, size_t* format_size);
 
+static bool hsail_print_parse_gather_request(const char* request, bool* is_gather, HsailGatherScope* scope, HsailGatherMode* mode);
+
+static struct value* hsail_print_var_gather(const char* print_name, uint64_t addr, HsailGatherScope scope, HsailGatherMode mode);
+
 static void hsail_print_all_vars_with_addr(uint64_t addr);
 
 static void hsail_print_no_wave_msg(struct ui_out* uiout, const char* param_str);
 
+static void hsail_print_clear_members(void);
+
+/* Members of the last printed variable, read in the same batch as the variable
+ * itself, printed by hsail_print_members once the variable has been printed and
+ * released by hsail_print_cleanup */
+typedef struct _HsailPrintMember
+{
+  char* name;
+  HwDbgInfo_encoding encoding;
+  size_t size;
+  bool is_valid;
+  gdb_byte value[8];
+} HsailPrintMember;
+
+static HsailPrintMember* gs_print_members = NULL;
+static size_t gs_num_print_members = 0;
+
+/* True if the last value was returned by the GetVarValue inferior call and needs FreeVarValue */
+static bool gs_print_used_inferior_call = false;
+
 HsailPrintStatus gLastPrintError = HSAIL_PRINT_UNKNOWN;
 
 HsailPrintStatus hsail_print_get_last_error(void)
@@ -123,11 +152,104 @@ bool hsail_parse_print_request(const char* pHsail_pr_expr, const char** var_name
   return true;
 }
 
+/* Parse what follows the variable name of a print request.
+ * Allowed formats:
+ * (nothing)                  print the variable for the focus work-item
+ * @wave [reduce]             every active work-item of the focus wave
+ * @workgroup [reduce]        every active work-item of the focus work-group
+ * @dispatch [reduce]         every active work-item of the dispatch
+ * The values are printed as an array, or as their min, max, sum, unique count and
+ * histogram with "reduce".
+ *
+ * Anything else not starting with @ is ignored, as it always was */
+static bool hsail_print_parse_gather_request(const char* request, bool* is_gather, HsailGatherScope* scope, HsailGatherMode* mode)
+{
+  static const struct
+  {
+    const char* name;
+    HsailGatherScope scope;
+  } scope_names[] =
+  {
+    {"wave", HSAIL_GATHER_SCOPE_WAVE},
+    {"workgroup", HSAIL_GATHER_SCOPE_WORK_GROUP},
+    {"dispatch", HSAIL_GATHER_SCOPE_DISPATCH},
+  };
+  size_t l = 0;
+  size_t word_len = 0;
+  int i = 0;
+
+  gdb_assert(NULL != request);
+  gdb_assert(NULL != is_gather);
+  gdb_assert(NULL != scope);
+  gdb_assert(NULL != mode);
+
+  *is_gather = false;
+  *mode = HSAIL_GATHER_MODE_PACKED;
+
+  l = strlen(request);
+  SKIP_LEADING_SPACES(request, l);
+
+  if (0 == l || '@' != request[0])
+    {
+      return true;
+    }
+
+  ++request;
+  --l;
+
+  for (word_len = 0; word_len < l && isalpha(request[word_len]); word_len++);
+
+  for (i = 0; i < ARRAY_SIZE(scope_names); i++)
+    {
+      if (strlen(scope_names[i].name) == word_len && 0 == strncmp(request, scope_names[i].name, word_len))
+        {
+          break;
+        }
+    }
+
+  if (i == ARRAY_SIZE(scope_names))
+    {
+      return false;
+    }
+
+  *scope = scope_names[i].scope;
+  request += word_len;
+  l -= word_len;
+  SKIP_LEADING_SPACES(request, l);
+
+  if (6 <= l && 0 == strncmp(request, "reduce", 6))
+    {
+      *mode = HSAIL_GATHER_MODE_REDUCE;
+      request += 6;
+      l -= 6;
+      SKIP_LEADING_SPACES(request, l);
+    }
+
+  /* Nothing else may follow the scope */
+  if (0 != l)
+    {
+      return false;
+    }
+
+  *is_gather = true;
+  return true;
+}
+
 void hsail_print_cleanup(void* pData)
 {
   char funcExp[256] = "";
   struct expression* expr = NULL;
 
+  /* The members were printed after the variable, or the print failed */
+  hsail_print_clear_members();
+
+  /* Values read through the variable read buffer do not hold anything in the agent */
+  if (!gs_print_used_inferior_call)
+  {
+    return;
+  }
+  gs_print_used_inferior_call = false;
+
   sprintf(funcExp, "FreeVarValue()");
 
   /* Create the expression */
@@ -145,6 +267,9 @@ struct value* hsail_print_expression(const char* exp, char* printFormat, size_t*
   int pos = 0;
   uint64_t addr = 0;
   struct value* retVal = NULL;
+  bool is_gather = false;
+  HsailGatherScope gather_scope = HSAIL_GATHER_SCOPE_WAVE;
+  HsailGatherMode gather_mode = HSAIL_GATHER_MODE_PACKED;
 
   gLastPrintError = HSAIL_PRINT_SUCCESS;
 
@@ -171,13 +296,21 @@ struct value* hsail_print_expression(const char* exp, char* printFormat, size_t*
   gdb_assert(NULL != clean_name);
 
   /* Trim trailing spaces */
-  for (;(NULL != var_name && ' ' != *var_name && '\t' != *var_name && '\r' != *var_name && '\n' != *var_name) && 0 < varNameLen;
+  for (;(NULL != var_name && ' ' != *var_name && '\t' != *var_name && '\r' != *var_name && '\n' != *var_name && '@' != *var_name) && 0 < varNameLen;
         ++var_name, --varNameLen, pos++)
   {
     clean_name[pos] = *var_name;
   }
   clean_name[pos] = '\0';
 
+  /* The work-items to print the variable for follow the name */
+  if (!hsail_print_parse_gather_request(var_name, &is_gather, &gather_scope, &gather_mode))
+  {
+    free(clean_name);
+    gLastPrintError = HSAIL_PRINT_WRONG_FORMAT;
+    return NULL;
+  }
+
   addr = hsail_get_current_pc();
 
   /* if addr is 0 then it is probably that there are no waves and the break point
@@ -192,7 +325,17 @@ struct value* hsail_print_expression(const char* exp, char* printFormat, size_t*
   // hsail_print_all_vars_with_addr(addr);
 
   /* do the actual printing of the data */
-  retVal = hsail_print_var_with_addr(clean_name, addr, printFormat, format_size);
+  if (is_gather)
+  {
+    /* The values have their own types, no format is forced on them */
+    printFormat[0] = 0;
+    *format_size = 0;
+    retVal = hsail_print_var_gather(clean_name, addr, gather_scope, gather_mode);
+  }
+  else
+  {
+    retVal = hsail_print_var_with_addr(clean_name, addr, printFormat, format_size);
+  }
 
   /* delete the cleaned var_name after using it */
   free(clean_name);
@@ -200,26 +343,16 @@ struct value* hsail_print_expression(const char* exp, char* printFormat, size_t*
   return retVal;
 }
 
-struct value* hsail_print_var_with_addr(const char* print_name, uint64_t addr, char* printFormat, size_t* format_size)
+/* Find a kernel variable, or a low level register such as $s0, visible at addr */
+static HwDbgInfo_variable hsail_print_find_variable(const char* print_name, uint64_t addr, HwDbgInfo_err* dbgErr)
 {
-  HwDbgInfo_err dbgErr = 0;
   HwDbgInfo_debug dbgInfo = NULL;
   HwDbgInfo_variable dbgVar = NULL;
-  char* var_name = NULL;
-  size_t var_name_len = 0;
-  char* type_name = NULL;
-  size_t type_name_len = 0;
-  size_t var_size = 0;
-  bool is_constant = false;
-  HwDbgInfo_encoding encoding = HWDBGINFO_VENC_NONE;
-  bool is_output = false;
-  struct value* retVal = NULL;
   bool isRegister = false;
   int printNameLength = 0;
 
   gdb_assert(NULL != print_name);
-  gdb_assert(0 != addr);
-  gdb_assert(NULL != printFormat);
+  gdb_assert(NULL != dbgErr);
 
   printNameLength = strlen(print_name);
 
@@ -243,13 +376,36 @@ struct value* hsail_print_var_with_addr(const char* print_name, uint64_t addr, c
 
   if (isRegister)
   {
-    dbgVar = hwdbginfo_low_level_variable(dbgInfo, addr, true, print_name, &dbgErr);
+    dbgVar = hwdbginfo_low_level_variable(dbgInfo, addr, true, print_name, dbgErr);
   }
   else
   {
-    dbgVar = hwdbginfo_variable(dbgInfo, addr, true, print_name, &dbgErr);
+    dbgVar = hwdbginfo_variable(dbgInfo, addr, true, print_name, dbgErr);
   }
 
+  return dbgVar;
+}
+
+struct value* hsail_print_var_with_addr(const char* print_name, uint64_t addr, char* printFormat, size_t* format_size)
+{
+  HwDbgInfo_err dbgErr = 0;
+  HwDbgInfo_variable dbgVar = NULL;
+  const char* var_name = NULL;
+  size_t var_name_len = 0;
+  const char* type_name = NULL;
+  size_t type_name_len = 0;
+  size_t var_size = 0;
+  bool is_constant = false;
+  HwDbgInfo_encoding encoding = HWDBGINFO_VENC_NONE;
+  bool is_output = false;
+  struct value* retVal = NULL;
+
+  gdb_assert(NULL != print_name);
+  gdb_assert(0 != addr);
+  gdb_assert(NULL != printFormat);
+
+  dbgVar = hsail_print_find_variable(print_name, addr, &dbgErr);
+
   if (dbgErr != HWDBGINFO_E_SUCCESS)
   {
     printf("hsail-printf var not found error %d\n", dbgErr);
@@ -257,23 +413,13 @@ struct value* hsail_print_var_with_addr(const char* print_name, uint64_t addr, c
     return NULL;
   }
 
-  dbgErr = hwdbginfo_variable_data(dbgVar, 0, var_name, &var_name_len, 0, type_name, &type_name_len, &var_size, &encoding, &is_constant, &is_output);
-  if (dbgErr != HWDBGINFO_E_SUCCESS)
+  /* The names are read in place, they belong to the variable */
+  dbgErr = hwdbginfo_variable_names(dbgVar, &var_name, &var_name_len, &type_name, &type_name_len);
+  if (dbgErr == HWDBGINFO_E_SUCCESS)
   {
-    printf("hsail-printf get var data info error %d\n", dbgErr);
-    return NULL;
+    dbgErr = hwdbginfo_variable_data(dbgVar, 0, NULL, NULL, 0, NULL, NULL, &var_size, &encoding, &is_constant, &is_output);
   }
 
-  var_name = (char*)malloc(var_name_len+1);
-  type_name = (char*)malloc(type_name_len+1);
-
-  gdb_assert(NULL != var_name);
-  gdb_assert(NULL != type_name);
-
-  memset(var_name, 0, var_name_len+1);
-  memset(type_name, 0, type_name_len+1);
-
-  dbgErr = hwdbginfo_variable_data(dbgVar, var_name_len, var_name, NULL, type_name_len, type_name, NULL, &var_size, &encoding, &is_constant, &is_output);
   if (dbgErr != HWDBGINFO_E_SUCCESS)
   {
     printf("hsail-printf get var data error %d\n", dbgErr);
@@ -295,8 +441,6 @@ struct value* hsail_print_var_with_addr(const char* print_name, uint64_t addr, c
     if(NULL == varValue)
     {
       printf("hsail-printf cannot malloc for varValue\n");
-      free_current_contents(&var_name);
-      free_current_contents(&type_name);
       return NULL;
     }
     memset(varValue, 0, 8);
@@ -309,16 +453,11 @@ struct value* hsail_print_var_with_addr(const char* print_name, uint64_t addr, c
     }
 
     free_current_contents(&varValue);
-    free_current_contents(&var_name);
-    free_current_contents(&type_name);
     return NULL;
   }
 
   retVal = hsail_print_var_info_with_location(dbgVar, var_size);
 
-  free_current_contents(&var_name);
-  free_current_contents(&type_name);
-
   /* set the format */
   printFormat[0] = 0;
   switch (encoding)
@@ -355,13 +494,285 @@ struct value* hsail_print_var_with_addr(const char* print_name, uint64_t addr, c
   return retVal;
 }
 
+/* Fill a shared location structure from the debug information of a variable */
+bool hsail_print_fill_var_location(HwDbgInfo_variable dbgVar, size_t var_size, HsailVariableLocation* location)
+{
+  HwDbgInfo_locreg reg_type = 0;
+  bool deref_value = false;
+  HwDbgInfo_err dbgErr = HWDBGINFO_E_SUCCESS;
+
+  gdb_assert(NULL != location);
+
+  memset(location, 0, sizeof(HsailVariableLocation));
+  dbgErr = hwdbginfo_variable_location(dbgVar, &reg_type, &location->m_regNum, &deref_value, &location->m_offset, &location->m_resource, &location->m_isaMemoryRegion, &location->m_pieceOffset, &location->m_pieceSize, &location->m_constAdd);
+
+  if (dbgErr != HWDBGINFO_E_SUCCESS)
+  {
+    return false;
+  }
+
+  location->m_regType = (int)reg_type;
+  location->m_derefValue = deref_value;
+  location->m_varSize = var_size;
+  location->m_readStatus = HSAIL_AGENT_STATUS_FAILURE;
+
+  return true;
+}
+
+static void hsail_print_clear_members(void)
+{
+  size_t nMember = 0;
+
+  for (nMember = 0 ; nMember < gs_num_print_members ; nMember++)
+  {
+    free_current_contents(&gs_print_members[nMember].name);
+  }
+
+  free_current_contents(&gs_print_members);
+  gs_num_print_members = 0;
+}
+
+void hsail_print_members(void)
+{
+  size_t nMember = 0;
+
+  for (nMember = 0 ; nMember < gs_num_print_members ; nMember++)
+  {
+    const HsailPrintMember* member = &gs_print_members[nMember];
+    LONGEST int_value = 0;
+    ULONGEST uint_value = 0;
+
+    if (!member->is_valid)
+    {
+      printf_filtered("  .%s = <unavailable>\n", member->name);
+      continue;
+    }
+
+    memcpy(&int_value, member->value, member->size);
+    memcpy(&uint_value, member->value, member->size);
+
+    switch (member->encoding)
+    {
+      case HWDBGINFO_VENC_FLOAT:
+      {
+        if (4 == member->size)
+        {
+          float float_value = 0;
+          memcpy(&float_value, member->value, 4);
+          printf_filtered("  .%s = %g\n", member->name, (double)float_value);
+        }
+        else
+        {
+          double double_value = 0;
+          memcpy(&double_value, member->value, sizeof(double));
+          printf_filtered("  .%s = %g\n", member->name, double_value);
+        }
+        break;
+      }
+
+      case HWDBGINFO_VENC_INTEGER:
+      case HWDBGINFO_VENC_CHARACTER:
+      {
+        /* sign extend the value from its actual size */
+        if (member->size < sizeof(LONGEST))
+        {
+          int shift = (int)(8 * (sizeof(LONGEST) - member->size));
+          int_value = (LONGEST)((ULONGEST)int_value << shift) >> shift;
+        }
+        printf_filtered("  .%s = %s\n", member->name, plongest(int_value));
+        break;
+      }
+
+      case HWDBGINFO_VENC_UINTEGER:
+      case HWDBGINFO_VENC_UCHARACTER:
+      case HWDBGINFO_VENC_BOOLEAN:
+      {
+        printf_filtered("  .%s = %s\n", member->name, pulongest(uint_value));
+        break;
+      }
+
+      case HWDBGINFO_VENC_POINTER:
+      default:
+      {
+        printf_filtered("  .%s = %s\n", member->name, hex_string(uint_value));
+        break;
+      }
+    }
+  }
+}
+
+/* Read a variable and all its members in one request to the agent.
+ *
+ * The locations are written to the variable read buffer and announced with a single
+ * HSAIL_COMMAND_READ_VARIABLES packet. The agent's debug thread only runs while the
+ * inferior does, so one GetVarValues call is still made to let the agent service the
+ * request, instead of one GetVarValue call for the variable and for each of its members.
+ *
+ * Returns false if the variable read buffer is not available
+ * */
+static bool hsail_print_var_batch(HwDbgInfo_variable dbgVar, size_t var_size, struct value** retVal)
+{
+  void* read_buffer = NULL;
+  HsailVariableReadHeader* header = NULL;
+  HsailVariableLocation* locations = NULL;
+  gdb_byte* value_area = NULL;
+  HwDbgInfo_variable* members = NULL;
+  size_t member_count = 0;
+  size_t max_locations = 0;
+  uint64_t value_offset = 0;
+  int num_locations = 0;
+  size_t nMember = 0;
+  gdb_byte top_value[8];
+
+  struct expression* expr = NULL;
+  char funcExp[256] = "";
+
+  HwDbgInfo_err dbgErr = HWDBGINFO_E_SUCCESS;
+  const size_t max_buffer_size = hsail_get_variable_read_buffer_shmem_max_size();
+
+  gdb_assert(NULL != retVal);
+  *retVal = NULL;
+
+  read_buffer = hsail_tdep_map_variable_read_buffer();
+  if (NULL == read_buffer)
+  {
+    return false;
+  }
+
+  /* Get the members, they do not need to be released */
+  dbgErr = hwdbginfo_variable_members(dbgVar, 0, NULL, &member_count);
+  if (dbgErr == HWDBGINFO_E_SUCCESS && 0 < member_count)
+  {
+    members = (HwDbgInfo_variable*)xmalloc(sizeof(HwDbgInfo_variable) * member_count);
+    dbgErr = hwdbginfo_variable_members(dbgVar, member_count, members, NULL);
+    if (dbgErr != HWDBGINFO_E_SUCCESS)
+    {
+      member_count = 0;
+    }
+  }
+  else
+  {
+    member_count = 0;
+  }
+
+  /* Each location needs its descriptor and at most 8 bytes of value */
+  max_locations = (max_buffer_size - sizeof(HsailVariableReadHeader)) / (sizeof(HsailVariableLocation) + 8);
+  if (member_count + 1 > max_locations)
+  {
+    member_count = max_locations - 1;
+  }
+
+  header = (HsailVariableReadHeader*)read_buffer;
+  locations = (HsailVariableLocation*)((gdb_byte*)read_buffer + sizeof(HsailVariableReadHeader));
+
+  /* The variable itself is always the first location */
+  if (!hsail_print_fill_var_location(dbgVar, var_size, &locations[num_locations]))
+  {
+    printf("dbgErr in getting the var location\n");
+    xfree(members);
+    hsail_tdep_unmap_variable_read_buffer(read_buffer);
+    return true;
+  }
+  locations[num_locations].m_valueOffset = value_offset;
+  value_offset += 8;
+  num_locations++;
+
+  hsail_print_clear_members();
+  if (0 < member_count)
+  {
+    gs_print_members = (HsailPrintMember*)xmalloc(sizeof(HsailPrintMember) * member_count);
+    memset(gs_print_members, 0, sizeof(HsailPrintMember) * member_count);
+  }
+
+  for (nMember = 0 ; nMember < member_count ; nMember++)
+  {
+    HsailPrintMember* member = &gs_print_members[gs_num_print_members];
+    const char* member_name = NULL;
+    size_t member_size = 0;
+    bool is_constant = false;
+    bool is_output = false;
+
+    dbgErr = hwdbginfo_variable_data(members[nMember], 0, NULL, NULL, 0, NULL, NULL, &member_size, &member->encoding, &is_constant, &is_output);
+    if (dbgErr == HWDBGINFO_E_SUCCESS)
+    {
+      dbgErr = hwdbginfo_variable_names(members[nMember], &member_name, NULL, NULL, NULL);
+    }
+
+    if (dbgErr != HWDBGINFO_E_SUCCESS || is_constant)
+    {
+      continue;
+    }
+
+    member->name = xstrdup(member_name);
+
+    /* temporary work around due to bug in dwarf missing data*/
+    if (0 == member_size || 8 < member_size)
+    {
+      member_size = 8;
+    }
+    member->size = member_size;
+
+    if (!hsail_print_fill_var_location(members[nMember], member_size, &locations[num_locations]))
+    {
+      free_current_contents(&member->name);
+      continue;
+    }
+
+    locations[num_locations].m_valueOffset = value_offset;
+    value_offset += 8;
+    num_locations++;
+    gs_num_print_members++;
+  }
+
+  xfree(members);
+
+  header->m_numVariables = num_locations;
+  header->m_numValuesRead = 0;
+  header->m_valueAreaOffset = sizeof(HsailVariableReadHeader) + num_locations * sizeof(HsailVariableLocation);
+  header->m_valueAreaSize = value_offset;
+  value_area = (gdb_byte*)read_buffer + header->m_valueAreaOffset;
+  memset(value_area, 0, value_offset);
+
+  /* Send the request and let the agent service it */
+  hsail_enqueue_read_variables_packet(num_locations);
+
+  sprintf(funcExp, "GetVarValues(%d)", num_locations);
+  expr = parse_expression (funcExp);
+  evaluate_expression (expr);
+  xfree (expr);
+
+  /* Collect the results */
+  memset(top_value, 0, sizeof(top_value));
+  if (HSAIL_AGENT_STATUS_SUCCESS == locations[0].m_readStatus)
+  {
+    memcpy(top_value, value_area + locations[0].m_valueOffset, var_size < 8 ? var_size : 8);
+    *retVal = value_from_contents(builtin_type (target_gdbarch ())->builtin_int64, top_value);
+  }
+
+  for (nMember = 0 ; nMember < gs_num_print_members ; nMember++)
+  {
+    const HsailVariableLocation* location = &locations[nMember + 1];
+    HsailPrintMember* member = &gs_print_members[nMember];
+
+    member->is_valid = (HSAIL_AGENT_STATUS_SUCCESS == location->m_readStatus);
+    if (member->is_valid)
+    {
+      memcpy(member->value, value_area + location->m_valueOffset, member->size);
+    }
+  }
+
+  hsail_tdep_unmap_variable_read_buffer(read_buffer);
+
+  return true;
+}
+
 struct value* hsail_print_var_info_with_location(HwDbgInfo_variable dbgVar, size_t var_size)
 {
   /* Exp data */
   struct expression* expr = NULL;
   struct value* retVal = NULL;
 
-  int reg_type = 0;
+  HwDbgInfo_locreg reg_type = 0;
   unsigned int reg_num = 0;
   bool deref_value = false;
   unsigned int offset = 0;
@@ -372,9 +783,18 @@ struct value* hsail_print_var_info_with_location(HwDbgInfo_variable dbgVar, size
   int const_add = 0;
 
   char funcExp[256] = "";
+  HwDbgInfo_err dbgErr = HWDBGINFO_E_SUCCESS;
+
+  gs_print_used_inferior_call = false;
+
+  /* Read the variable and its members through the variable read buffer if the agent provides it */
+  if (hsail_print_var_batch(dbgVar, var_size, &retVal))
+  {
+    return retVal;
+  }
 
   /* Get all the variable location information */
-  HwDbgInfo_err dbgErr = hwdbginfo_variable_location(dbgVar, &reg_type, &reg_num, &deref_value, &offset, &resource, &isa_memory_region, &piece_offset, &piece_size, &const_add);
+  dbgErr = hwdbginfo_variable_location(dbgVar, &reg_type, &reg_num, &deref_value, &offset, &resource, &isa_memory_region, &piece_offset, &piece_size, &const_add);
 
   if (dbgErr != HWDBGINFO_E_SUCCESS)
   {
@@ -385,7 +805,7 @@ struct value* hsail_print_var_info_with_location(HwDbgInfo_variable dbgVar, size
   /* build the buffer for the Exp eval for this function (safely assume that the initial buffer is max 256 char long):
    *void* GetVarValue(int reg_type, size_t var_size, unsigned int reg_num, bool deref_value, unsigned int offset, unsigned int resource, unsigned int isa_memory_region, unsigned int piece_offset, unsigned int piece_size, int const_add)
    */
-  sprintf(funcExp, "GetVarValue(%d,%d,%d,%d,%d,%d,%d,%d,%d,%d)",reg_type,((int)var_size), ((int)reg_num), ((int)deref_value ? 1 : 0), ((int)offset), ((int)resource), ((int)isa_memory_region), ((int)piece_offset), ((int)piece_size), ((int)const_add));
+  sprintf(funcExp, "GetVarValue(%d,%d,%d,%d,%d,%d,%d,%d,%d,%d)",((int)reg_type),((int)var_size), ((int)reg_num), ((int)deref_value ? 1 : 0), ((int)offset), ((int)resource), ((int)isa_memory_region), ((int)piece_offset), ((int)piece_size), ((int)const_add));
 
   /* print information to screen for debugging */
   /*printf("reg type:%d var size:%d, reg num:%d\nderef val:%d, offset:%d, resource:%d\nisa mem region:%d, piece offset:%d, piece size:%d, const add:%d\n", reg_type,((int)var_size), ((int)reg_num), ((int)deref_value ? 1 : 0), ((int)offset), ((int)resource), ((int)isa_memory_region), ((int)piece_offset), ((int)piece_size), ((int)const_add));*/
@@ -395,22 +815,348 @@ struct value* hsail_print_var_info_with_location(HwDbgInfo_variable dbgVar, size
 
   /* Call the evaluator */
   retVal = evaluate_expression (expr);
+  gs_print_used_inferior_call = true;
 
   return retVal;
 }
 
 
+/* The fields of the structure printed for "print hsail:var @scope reduce", in their order */
+typedef enum
+{
+  HSAIL_GATHER_FIELD_LANES,
+  HSAIL_GATHER_FIELD_MIN,
+  HSAIL_GATHER_FIELD_MAX,
+  HSAIL_GATHER_FIELD_SUM,
+  HSAIL_GATHER_FIELD_UNIQUE,
+  HSAIL_GATHER_FIELD_MIN_WORK_GROUP,
+  HSAIL_GATHER_FIELD_MIN_WORK_ITEM,
+  HSAIL_GATHER_FIELD_MAX_WORK_GROUP,
+  HSAIL_GATHER_FIELD_MAX_WORK_ITEM,
+  HSAIL_GATHER_FIELD_BUCKET_WIDTH,
+  HSAIL_GATHER_FIELD_HISTOGRAM
+} HsailGatherField;
+
+/* Get how the agent compares and adds up the values of a variable,
+ * false if the variable is not a scalar the agent can gather */
+static bool hsail_print_gather_encoding(HwDbgInfo_encoding encoding, size_t var_size, HsailGatherEncoding* gather_encoding)
+{
+  gdb_assert(NULL != gather_encoding);
+
+  if (1 != var_size && 2 != var_size && 4 != var_size && 8 != var_size)
+  {
+    return false;
+  }
+
+  switch (encoding)
+  {
+    case HWDBGINFO_VENC_FLOAT:
+      *gather_encoding = HSAIL_GATHER_ENCODING_FLOAT;
+      return (4 == var_size || 8 == var_size);
+
+    case HWDBGINFO_VENC_INTEGER:
+    case HWDBGINFO_VENC_CHARACTER:
+      *gather_encoding = HSAIL_GATHER_ENCODING_SIGNED;
+      return true;
+
+    case HWDBGINFO_VENC_UINTEGER:
+    case HWDBGINFO_VENC_UCHARACTER:
+    case HWDBGINFO_VENC_BOOLEAN:
+    case HWDBGINFO_VENC_POINTER:
+      *gather_encoding = HSAIL_GATHER_ENCODING_UNSIGNED;
+      return true;
+
+    case HWDBGINFO_VENC_NONE:
+    default:
+      return false;
+  }
+}
+
+/* The type of the gathered values of a variable, var_size bytes long */
+static struct type* hsail_print_gather_element_type(HwDbgInfo_encoding encoding, size_t var_size)
+{
+  const struct builtin_type* builtin = builtin_type (target_gdbarch ());
+  struct type* signed_types[] = {builtin->builtin_int8, builtin->builtin_int16, builtin->builtin_int32, builtin->builtin_int64};
+  struct type* unsigned_types[] = {builtin->builtin_uint8, builtin->builtin_uint16, builtin->builtin_uint32, builtin->builtin_uint64};
+  int size_index = (1 == var_size) ? 0 : (2 == var_size) ? 1 : (4 == var_size) ? 2 : 3;
+
+  switch (encoding)
+  {
+    case HWDBGINFO_VENC_FLOAT:
+      return (4 == var_size) ? builtin->builtin_float : builtin->builtin_double;
+
+    case HWDBGINFO_VENC_CHARACTER:
+      return (1 == var_size) ? builtin->builtin_char : signed_types[size_index];
+
+    case HWDBGINFO_VENC_UCHARACTER:
+      return (1 == var_size) ? builtin->builtin_unsigned_char : unsigned_types[size_index];
+
+    case HWDBGINFO_VENC_BOOLEAN:
+      return (TYPE_LENGTH (builtin->builtin_bool) == var_size) ? builtin->builtin_bool : unsigned_types[size_index];
+
+    case HWDBGINFO_VENC_POINTER:
+      return (TYPE_LENGTH (builtin->builtin_data_ptr) == var_size) ? builtin->builtin_data_ptr : unsigned_types[size_index];
+
+    case HWDBGINFO_VENC_INTEGER:
+      return signed_types[size_index];
+
+    case HWDBGINFO_VENC_UINTEGER:
+    default:
+      return unsigned_types[size_index];
+  }
+}
+
+/* The structure printed for the reductions of a variable, one for each encoding.
+ * The min, max and sum have the type the agent computed them with */
+static struct type* hsail_print_gather_reduction_type(HsailGatherEncoding gather_encoding)
+{
+  static struct gdbarch* types_gdbarch = NULL;
+  static struct type* reduction_types[HSAIL_GATHER_ENCODING_FLOAT + 1];
+  struct gdbarch* gdbarch = target_gdbarch ();
+  const struct builtin_type* builtin = builtin_type (gdbarch);
+  struct type* value_type = NULL;
+  struct type* id_type = NULL;
+  struct type* reduction_type = NULL;
+
+  gdb_assert(gather_encoding >= 0 && gather_encoding <= HSAIL_GATHER_ENCODING_FLOAT);
+
+  /* The types belong to the architecture */
+  if (types_gdbarch != gdbarch)
+  {
+    memset(reduction_types, 0, sizeof(reduction_types));
+    types_gdbarch = gdbarch;
+  }
+
+  if (NULL != reduction_types[gather_encoding])
+  {
+    return reduction_types[gather_encoding];
+  }
+
+  value_type = (HSAIL_GATHER_ENCODING_FLOAT == gather_encoding) ? builtin->builtin_double :
+               (HSAIL_GATHER_ENCODING_SIGNED == gather_encoding) ? builtin->builtin_int64 : builtin->builtin_uint64;
+  id_type = lookup_array_range_type (builtin->builtin_uint32, 0, 2);
+
+  reduction_type = arch_composite_type (gdbarch, "hsail_gather_reduction", TYPE_CODE_STRUCT);
+  append_composite_type_field (reduction_type, "lanes", builtin->builtin_uint64);
+  append_composite_type_field (reduction_type, "min", value_type);
+  append_composite_type_field (reduction_type, "max", value_type);
+  append_composite_type_field (reduction_type, "sum", value_type);
+  append_composite_type_field (reduction_type, "unique", builtin->builtin_uint64);
+  append_composite_type_field (reduction_type, "min_work_group", id_type);
+  append_composite_type_field (reduction_type, "min_work_item", id_type);
+  append_composite_type_field (reduction_type, "max_work_group", id_type);
+  append_composite_type_field (reduction_type, "max_work_item", id_type);
+  append_composite_type_field (reduction_type, "bucket_width",
+                               (HSAIL_GATHER_ENCODING_FLOAT == gather_encoding) ? builtin->builtin_double : builtin->builtin_uint64);
+  append_composite_type_field (reduction_type, "histogram",
+                               lookup_array_range_type (builtin->builtin_uint64, 0, HSAIL_GATHER_HISTOGRAM_BUCKETS - 1));
+
+  reduction_types[gather_encoding] = reduction_type;
+
+  return reduction_type;
+}
+
+static void hsail_print_gather_store_field(struct value* val, HsailGatherField field, const void* data, size_t size)
+{
+  struct type* type = value_type (val);
+
+  gdb_assert(TYPE_LENGTH (TYPE_FIELD_TYPE (type, field)) == size);
+  memcpy(value_contents_raw (val) + TYPE_FIELD_BITPOS (type, field) / 8, data, size);
+}
+
+/* Store the work-group and work-item of a lane in the reductions */
+static void hsail_print_gather_store_lane(struct value* val, HsailGatherField work_group_field, uint32_t wave_index, uint32_t lane)
+{
+  HsailWaveDim3 work_group_id = {0, 0, 0};
+  HsailWaveDim3 work_item_id = {0, 0, 0};
+
+  if ((int)wave_index < hsail_wave_index_num_waves() && lane < HSAIL_WAVE_LANES)
+  {
+    hsail_utils_copy_wavedim3(&work_group_id, hsail_wave_index_workgroup_id(wave_index));
+    hsail_wave_index_workitem_id(wave_index, lane, &work_item_id);
+  }
+
+  hsail_print_gather_store_field(val, work_group_field, &work_group_id, sizeof(HsailWaveDim3));
+  hsail_print_gather_store_field(val, work_group_field + 1, &work_item_id, sizeof(HsailWaveDim3));
+}
+
+/* Release a variable found by hsail_print_find_variable */
+static void hsail_print_release_variable_cleanup(void* pData)
+{
+  HwDbgInfo_variable dbgVar = pData;
+
+  hwdbginfo_release_variables(hsail_init_hwdbginfo(NULL), &dbgVar, 1);
+}
+
+/* Gather a variable from every active work-item of a scope in one request to the agent.
+ *
+ * The request is written to the variable gather buffer and announced with a single
+ * HSAIL_COMMAND_GATHER_VARIABLE packet, the GatherVarValues inferior call lets the agent's
+ * debug thread service it. The agent returns either the value of each work-item, printed as
+ * an array in the order of the waves in the wave buffer and of the lanes in each wave, or the
+ * min, max, sum, unique count and histogram of the values, printed as a structure.
+ * */
+static struct value* hsail_print_var_gather(const char* print_name, uint64_t addr, HsailGatherScope scope, HsailGatherMode mode)
+{
+  HwDbgInfo_err dbgErr = HWDBGINFO_E_SUCCESS;
+  HwDbgInfo_variable dbgVar = NULL;
+  HwDbgInfo_encoding encoding = HWDBGINFO_VENC_NONE;
+  HsailGatherEncoding gather_encoding = HSAIL_GATHER_ENCODING_UNSIGNED;
+  HsailVariableGatherHeader* header = NULL;
+  HsailWaveDim3 focus_work_group = {0, 0, 0};
+  HsailWaveDim3 focus_work_item = {0, 0, 0};
+  void* gather_buffer = NULL;
+  size_t var_size = 0;
+  bool is_constant = false;
+  bool is_output = false;
+  int wave_index = -1;
+  struct value* retVal = NULL;
+  struct cleanup* old_chain = NULL;
+
+  struct expression* expr = NULL;
+  const size_t max_buffer_size = hsail_get_variable_gather_buffer_shmem_max_size();
+
+  gdb_assert(NULL != print_name);
+
+  dbgVar = hsail_print_find_variable(print_name, addr, &dbgErr);
+  if (dbgErr != HWDBGINFO_E_SUCCESS)
+  {
+    gLastPrintError = HSAIL_PRINT_VAR_NOT_FOUND;
+    return NULL;
+  }
+
+  /* The variable is released on every exit, including an error in the inferior call */
+  old_chain = make_cleanup(hsail_print_release_variable_cleanup, dbgVar);
+
+  dbgErr = hwdbginfo_variable_data(dbgVar, 0, NULL, NULL, 0, NULL, NULL, &var_size, &encoding, &is_constant, &is_output);
+
+  /* temporary work around due to bug in dwarf missing data*/
+  if (0 == var_size)
+  {
+    var_size = 8;
+  }
+
+  if (dbgErr != HWDBGINFO_E_SUCCESS || is_constant || !hsail_print_gather_encoding(encoding, var_size, &gather_encoding))
+  {
+    gLastPrintError = HSAIL_PRINT_GATHER_NOT_SCALAR;
+    do_cleanups(old_chain);
+    return NULL;
+  }
+
+  /* The wave and the work-group are the ones of the focus work-item */
+  if (!hsail_cmd_get_focus(&focus_work_group, &focus_work_item) ||
+      !hsail_wave_index_find_workitem(&focus_work_group, &focus_work_item, &wave_index, NULL))
+  {
+    gLastPrintError = HSAIL_PRINT_NO_WAVES;
+    do_cleanups(old_chain);
+    return NULL;
+  }
+
+  gather_buffer = hsail_tdep_map_variable_gather_buffer();
+  if (NULL == gather_buffer)
+  {
+    gLastPrintError = HSAIL_PRINT_GATHER_NOT_AVAILABLE;
+    do_cleanups(old_chain);
+    return NULL;
+  }
+
+  header = (HsailVariableGatherHeader*)gather_buffer;
+  memset(header, 0, sizeof(HsailVariableGatherHeader));
+
+  if (!hsail_print_fill_var_location(dbgVar, var_size, &header->m_location))
+  {
+    hsail_tdep_unmap_variable_gather_buffer(gather_buffer);
+    gLastPrintError = HSAIL_PRINT_GATHER_FAILED;
+    do_cleanups(old_chain);
+    return NULL;
+  }
+
+  header->m_version = HSAIL_VARIABLE_GATHER_VERSION;
+  header->m_scope = scope;
+  header->m_mode = mode;
+  header->m_encoding = gather_encoding;
+  header->m_waveIndex = (uint32_t)wave_index;
+  hsail_utils_copy_wavedim3(&header->m_workGroupId, &focus_work_group);
+  header->m_valueAreaOffset = sizeof(HsailVariableGatherHeader);
+  header->m_valueAreaSize = max_buffer_size - header->m_valueAreaOffset;
+  header->m_status = HSAIL_AGENT_STATUS_FAILURE;
+
+  /* Send the request and let the agent service it */
+  hsail_enqueue_gather_variable_packet();
+
+  expr = parse_expression ("GatherVarValues()");
+  evaluate_expression (expr);
+  xfree (expr);
+
+  if (HSAIL_AGENT_STATUS_SUCCESS != header->m_status || 0 == header->m_numLanes)
+  {
+    hsail_tdep_unmap_variable_gather_buffer(gather_buffer);
+    gLastPrintError = HSAIL_PRINT_GATHER_FAILED;
+    do_cleanups(old_chain);
+    return NULL;
+  }
+
+  if (HSAIL_GATHER_MODE_PACKED == mode)
+  {
+    struct type* element_type = hsail_print_gather_element_type(encoding, var_size);
+    ULONGEST num_values = header->m_numValuesWritten;
+
+    gdb_assert(TYPE_LENGTH (element_type) == var_size);
+
+    if (num_values > header->m_valueAreaSize / var_size)
+    {
+      num_values = header->m_valueAreaSize / var_size;
+    }
+
+    if (num_values < header->m_numLanes)
+    {
+      printf_filtered (_("Only the first %s of %s work-items fit in the gather buffer\n"),
+                       pulongest (num_values), pulongest (header->m_numLanes));
+    }
+
+    if (0 == num_values)
+    {
+      hsail_tdep_unmap_variable_gather_buffer(gather_buffer);
+      gLastPrintError = HSAIL_PRINT_GATHER_FAILED;
+      do_cleanups(old_chain);
+      return NULL;
+    }
+
+    retVal = allocate_value (lookup_array_range_type (element_type, 0, num_values - 1));
+    memcpy(value_contents_raw (retVal), (gdb_byte*)gather_buffer + header->m_valueAreaOffset, num_values * var_size);
+  }
+  else
+  {
+    retVal = allocate_value (hsail_print_gather_reduction_type(gather_encoding));
+    hsail_print_gather_store_field(retVal, HSAIL_GATHER_FIELD_LANES, &header->m_numLanes, sizeof(uint64_t));
+    hsail_print_gather_store_field(retVal, HSAIL_GATHER_FIELD_MIN, &header->m_min, sizeof(uint64_t));
+    hsail_print_gather_store_field(retVal, HSAIL_GATHER_FIELD_MAX, &header->m_max, sizeof(uint64_t));
+    hsail_print_gather_store_field(retVal, HSAIL_GATHER_FIELD_SUM, &header->m_sum, sizeof(uint64_t));
+    hsail_print_gather_store_field(retVal, HSAIL_GATHER_FIELD_UNIQUE, &header->m_numUnique, sizeof(uint64_t));
+    hsail_print_gather_store_lane(retVal, HSAIL_GATHER_FIELD_MIN_WORK_GROUP, header->m_minWaveIndex, header->m_minLane);
+    hsail_print_gather_store_lane(retVal, HSAIL_GATHER_FIELD_MAX_WORK_GROUP, header->m_maxWaveIndex, header->m_maxLane);
+    hsail_print_gather_store_field(retVal, HSAIL_GATHER_FIELD_BUCKET_WIDTH, &header->m_bucketWidth, sizeof(uint64_t));
+    hsail_print_gather_store_field(retVal, HSAIL_GATHER_FIELD_HISTOGRAM, header->m_histogram, sizeof(header->m_histogram));
+  }
+
+  hsail_tdep_unmap_variable_gather_buffer(gather_buffer);
+
+  do_cleanups(old_chain);
+  return retVal;
+}
+
 void hsail_print_all_vars_with_addr(uint64_t addr)
 {
   HwDbgInfo_err dbgErr = 0;
   HwDbgInfo_debug dbgInfo = hsail_init_hwdbginfo(NULL);
   /* HwDbgInfo_variable dbgVar = hwdbginfo_variable(dbgInfo, addr, true, var_name, &dbgErr); */
-  HwDbgInfo_variable* vars = NULL;
+  HwDbgInfo_result vars_result = NULL;
+  const HwDbgInfo_variable* vars = NULL;
   size_t var_count = 0;
   int nVar = 0;
-  char* var_name = NULL;
+  const char* var_name = NULL;
   size_t var_name_len = 0;
-  char* type_name = NULL;
+  const char* type_name = NULL;
   size_t type_name_len = 0;
   size_t var_size = 0;
   bool is_constant = false;
@@ -427,14 +1173,17 @@ void hsail_print_all_vars_with_addr(uint64_t addr)
     return ;
   }
 
-  dbgErr = hwdbginfo_frame_variables(dbgInfo, addr, -1, false, 0, vars, &var_count);
+  /* The variables stay in the query result until it is released */
+  vars_result = hwdbginfo_query_frame_variables(dbgInfo, addr, -1, false, &dbgErr);
 
   if (dbgErr != HWDBGINFO_E_SUCCESS)
   {
-    printf("dbgErr in getting the num vars%d\n" , dbgErr);
+    printf("dbgErr in getting the vars%d\n" , dbgErr);
     return ;
   }
 
+  vars = hwdbginfo_result_variables(vars_result, &var_count);
+
   printf ("Number of vars: %zu\n", var_count);
   gdb_assert(0 != var_count);
 
@@ -444,6 +1193,7 @@ void hsail_print_all_vars_with_addr(uint64_t addr)
   if (dbgErr != HWDBGINFO_E_SUCCESS)
   {
     printf("dbgErr in getting code location %d\n" , dbgErr);
+    hwdbginfo_release_result(&vars_result);
     return ;
   }
 
@@ -451,23 +1201,7 @@ void hsail_print_all_vars_with_addr(uint64_t addr)
   if (dbgErr != HWDBGINFO_E_SUCCESS)
   {
     printf("dbgErr in getting location data %d\n" , dbgErr);
-    return ;
-  }
-
-  vars = (HwDbgInfo_variable*)malloc(sizeof(HwDbgInfo_variable)*var_count);
-  if (NULL == vars)
-  {
-    printf("failed to allocate vars\n");
-    return ;
-  }
-
-  memset(vars, 0, sizeof(HwDbgInfo_variable)*var_count);
-
-  dbgErr = hwdbginfo_frame_variables(dbgInfo, addr, -1, false, var_count, vars, NULL);
-  if (dbgErr != HWDBGINFO_E_SUCCESS)
-  {
-    printf("dbgErr in getting the vars data%d\n" , dbgErr);
-    free_current_contents(&vars);
+    hwdbginfo_release_result(&vars_result);
     return ;
   }
 
@@ -482,30 +1216,17 @@ void hsail_print_all_vars_with_addr(uint64_t addr)
     is_constant = false;
     is_output = false;
 
-    dbgErr = hwdbginfo_variable_data(vars[nVar], 0, var_name, &var_name_len, 0, type_name, &type_name_len, &var_size, &encoding, &is_constant, &is_output);
-    if (dbgErr != HWDBGINFO_E_SUCCESS)
+    /* The names are read in place, they belong to the variable */
+    dbgErr = hwdbginfo_variable_names(vars[nVar], &var_name, &var_name_len, &type_name, &type_name_len);
+    if (dbgErr == HWDBGINFO_E_SUCCESS)
     {
-      printf("dbgErr in getting var info %d %d\n", nVar, dbgErr);
-      free_current_contents(&vars);
-      return ;
+      dbgErr = hwdbginfo_variable_data(vars[nVar], 0, NULL, NULL, 0, NULL, NULL, &var_size, &encoding, &is_constant, &is_output);
     }
 
-    var_name = (char*)malloc(var_name_len+1);
-    type_name = (char*)malloc(type_name_len+1);
-
-    gdb_assert(NULL != var_name);
-    gdb_assert(NULL != type_name);
-
-    memset(var_name, 0, var_name_len+1);
-    memset(type_name, 0, type_name_len+1);
-
-    dbgErr = hwdbginfo_variable_data(vars[nVar], var_name_len, var_name, NULL, type_name_len, type_name, NULL, &var_size, &encoding, &is_constant, &is_output);
     if (dbgErr != HWDBGINFO_E_SUCCESS)
     {
       printf("dbgErr in getting var data %d %d\n", nVar, dbgErr);
-      free_current_contents(&vars);
-      free_current_contents(&var_name);
-      free_current_contents(&type_name);
+      hwdbginfo_release_result(&vars_result);
       return ;
     }
     /* temporary work around due to bug in dwarf missing data*/
@@ -513,13 +1234,9 @@ void hsail_print_all_vars_with_addr(uint64_t addr)
     {
       var_size = 8;
     }
-
-    free_current_contents(&var_name);
-    free_current_contents(&type_name);
   }
 
-  free_current_contents(&vars);
-  /*  HwDbgInfo_err hwdbginfo_variable_data(HwDbgInfo_variable var, size_t name_buf_len, char* var_name, size_t* var_name_len, size_t type_name_buf_len, char* type_name, size_t* type_name_len, size_t* var_size, bool* is_constant, bool* is_output); */
+  hwdbginfo_release_result(&vars_result);
   hwdbginfo_release_code_locations(&loc, 1);
 }
 
@@ -531,71 +1248,13 @@ void hsail_print_wave_info (struct ui_out* uiout, int from_tty)
   printf_filtered("Number of Active Waves: %d\n",num_waves);
 }
 
-/* build a vector of work groups, this is used when printing the work-groups, but also when printing a specific work group so it will related to the same
-   position since in the wave buffer two elements can have the same work group so a vector is created where each work group appears only once and the
-   index refer to the work group and from this vector the work group info can be retrieved */
-static HsailWaveDim3* gs_workgroup_vector = NULL;
-static int gs_num_workgroups_in_vector = 0;
-
-static void hsail_build_workgroups_vector(void)
-{
-  int nWave = 0;
-  int checked_group = 0;
-  bool workgroup_found = false;
-  int num_waves = hsail_tdep_get_active_wave_count();
-  HsailAgentWaveInfo* wave_info_buffer = (HsailAgentWaveInfo*)hsail_tdep_map_wave_buffer();
-
-  gdb_assert(NULL != wave_info_buffer);
-
-  /* allocated memory for a buffer to hold the work group we already found. worst case is every wave belongs to a different group */
-  free_current_contents(&gs_workgroup_vector);
-  gs_workgroup_vector= (HsailWaveDim3*)malloc(sizeof(HsailWaveDim3)*num_waves);
-  gdb_assert(NULL != gs_workgroup_vector);
-
-  gs_num_workgroups_in_vector = 0;
-
-  for (nWave = 0 ; nWave < num_waves ; nWave++)
-  {
-    workgroup_found = false;
-    /* check if the work group was not already found */
-    for (checked_group = 0 ; checked_group < gs_num_workgroups_in_vector ; checked_group++)
-    {
-      if (gs_workgroup_vector[checked_group].x == wave_info_buffer[nWave].workGroupId.x &&
-          gs_workgroup_vector[checked_group].y == wave_info_buffer[nWave].workGroupId.y &&
-          gs_workgroup_vector[checked_group].z == wave_info_buffer[nWave].workGroupId.z)
-          {
-            workgroup_found = true;
-            break;
-          }
-    }
-
-    /* if new group in the wave add it */
-    if (!workgroup_found)
-    {
-      gs_workgroup_vector[gs_num_workgroups_in_vector].x = wave_info_buffer[nWave].workGroupId.x;
-      gs_workgroup_vector[gs_num_workgroups_in_vector].y = wave_info_buffer[nWave].workGroupId.y;
-      gs_workgroup_vector[gs_num_workgroups_in_vector].z = wave_info_buffer[nWave].workGroupId.z;
-      gs_num_workgroups_in_vector++;
-    }
-  }
-
-  /* release the wave buffer */
-  hsail_tdep_unmap_wave_buffer((void*)wave_info_buffer);
-}
-
 void hsail_print_workgroups_info (HsailWaveDim3 active_work_group, struct ui_out* uiout, int from_tty)
 {
   int nWorkgroup = 0;
-  /* get the waves info */
-
-  int num_waves = hsail_tdep_get_active_wave_count();
-  int flattened_id = 0;
-  int workgroupsizex = 0;
-  int workgroupsizey = 0;
+  /* get the work-groups from the wave index */
+  int num_workgroups = hsail_wave_index_num_workgroups();
   struct hsail_dispatch* active_dispatch = hsail_kernel_active_dispatch();
 
-  HsailAgentWaveInfo* wave_info_buffer = (HsailAgentWaveInfo*)hsail_tdep_map_wave_buffer();
-
   char index_buffer[10] = "";
   char wg_id_buffer[30] = "";
   char flat_id_buffer[10] = "";
@@ -605,81 +1264,78 @@ void hsail_print_workgroups_info (HsailWaveDim3 active_work_group, struct ui_out
   gdb_assert(NULL != uiout);
   gdb_assert(NULL != active_dispatch);
 
-  if (0 == num_waves || NULL == wave_info_buffer)
+  if (0 == num_workgroups)
   {
     hsail_print_no_wave_msg(uiout, "work-groups");
     return;
   }
 
-  /* build the vector list */
-  hsail_build_workgroups_vector();
-
   /* print header */
   ui_out_text(uiout,"Active Work-groups Information\n");
   printf_filtered("%5s%15s%27s\n","Index","Work-group ID","Flattened Work-group ID");
 
-  /* calculate work group size */
-  if (NULL != active_dispatch)
+  for (nWorkgroup = 0 ; nWorkgroup < num_workgroups ; nWorkgroup++)
   {
-    workgroupsizex = (active_dispatch->work_items.x == 0 ? 1 : active_dispatch->work_items.x) / (active_dispatch->work_groups_size.x == 0 ? 1 : active_dispatch->work_groups_size.x);
-    workgroupsizey = (active_dispatch->work_items.y == 0 ? 1 : active_dispatch->work_items.y) / (active_dispatch->work_groups_size.y == 0 ? 1 : active_dispatch->work_groups_size.y);
-  }
+    const struct hsail_wave_index_workgroup* wg = hsail_wave_index_get_workgroup(nWorkgroup);
 
-  for (nWorkgroup = 0 ; nWorkgroup < gs_num_workgroups_in_vector ; nWorkgroup++)
-  {
-    found_workgroup = false;
-    /* based on the equation in HSA programmer Ref page 22 sec 2.2.2 */
-    if (NULL != active_dispatch)
-    {
-      flattened_id = gs_workgroup_vector[nWorkgroup].x +
-                     gs_workgroup_vector[nWorkgroup].y * workgroupsizex +
-                     gs_workgroup_vector[nWorkgroup].z * workgroupsizex * workgroupsizey;
-    }
-
-    if (gs_workgroup_vector[nWorkgroup].x == active_work_group.x &&
-        gs_workgroup_vector[nWorkgroup].y == active_work_group.y &&
-        gs_workgroup_vector[nWorkgroup].z == active_work_group.z)
-        {
-          found_workgroup = true;
-        }
+    found_workgroup = hsail_utils_compare_wavedim3(&wg->work_group_id, &active_work_group);
 
     sprintf(index_buffer,"%s%d", found_workgroup ? "*" : "", nWorkgroup);
-    sprintf(wg_id_buffer,"%d,%d,%d",gs_workgroup_vector[nWorkgroup].x,
-                                    gs_workgroup_vector[nWorkgroup].y,
-                                    gs_workgroup_vector[nWorkgroup].z);
-    sprintf(flat_id_buffer,"%d",flattened_id);
+    sprintf(wg_id_buffer,"%d,%d,%d",wg->work_group_id.x,
+                                    wg->work_group_id.y,
+                                    wg->work_group_id.z);
+    sprintf(flat_id_buffer,"%d",wg->flattened_id);
 
     printf_filtered("%5s%15s%27s\n", index_buffer, wg_id_buffer, flat_id_buffer);
   }
+}
 
-  /* release the vector data */
-  free_current_contents(&gs_workgroup_vector);
-  gs_num_workgroups_in_vector = 0;
+/* Print the source line of a wave's pc to source_line_buffer */
+static void hsail_print_source_line_of_pc(HwDbgInfo_debug dbgInfo, HsailProgramCounter pc, char* source_line_buffer)
+{
+  HwDbgInfo_err dbgErr = 0;
+  HwDbgInfo_addr addr = 0;
+  HwDbgInfo_code_location loc = NULL;
+  HwDbgInfo_linenum line_num = 0;
+  size_t file_name_len = 0;
 
-  /* release the wave buffer */
-  hsail_tdep_unmap_wave_buffer((void*)wave_info_buffer);
+  dbgErr = hwdbginfo_nearest_mapped_addr(dbgInfo, pc,  &addr);
+  if (dbgErr == HWDBGINFO_E_SUCCESS)
+  {
+    dbgErr = hwdbginfo_addr_to_line(dbgInfo, addr, &loc);
+  }
+
+  if (dbgErr == HWDBGINFO_E_SUCCESS)
+  {
+    dbgErr = hwdbginfo_code_location_details(loc, &line_num, 0, NULL, &file_name_len);
+  }
+
+  if (dbgErr == HWDBGINFO_E_SUCCESS)
+  {
+    sprintf(source_line_buffer,"temp_source@line %d",((int)line_num));
+  }
+  else
+  {
+    sprintf(source_line_buffer,"dbginfo error");
+  }
 
+  /* release loc */
+  hwdbginfo_release_code_locations(&loc, 1);
 }
 
-static void hsail_print_wave_data(HwDbgInfo_debug dbgInfo, HsailAgentWaveInfo* wave_info_buffer, int wave_index, int index_to_show, HsailWaveDim3 work_item, bool use_work_item, bool mark_active_item)
+static void hsail_print_wave_data(HwDbgInfo_debug dbgInfo, int wave_index, int index_to_show, HsailWaveDim3 work_item, bool use_work_item, bool mark_active_item)
 {
-  /* vars used to pass through the exec mask */
-  int nExec = 0;
-  bool firstExec = true;
+  /* the active lanes, filtered by the work item if one is used */
+  uint64_t lane_mask = 0;
   int last_bit_num = 0;
   int first_bit_num = 0;
-  /* current_bit_mask used with the exec mask */
-  uint64_t current_bit_mask = 1;
+  /* the work-item IDs are only decoded for the first and last lanes shown */
+  HsailWaveDim3 first_id;
+  HsailWaveDim3 last_id;
+  HsailWaveDim3 absolute_id;
   struct hsail_dispatch* active_dispatch = hsail_kernel_active_dispatch();
-  bool found_work_item = false;
-
-  /* get the source line information */
-  HwDbgInfo_err dbgErr = 0;
-  HwDbgInfo_addr addr = NULL;
-  HwDbgInfo_code_location loc = NULL;
-  HwDbgInfo_linenum line_num = 0;
-  char* file_name = NULL;
-  size_t file_name_len = 0;
+  const HsailWaveDim3* work_group_id = hsail_wave_index_workgroup_id(wave_index);
+  HsailProgramCounter pc = hsail_wave_index_pc(wave_index);
 
   char index_buffer[10] = "";
   char wave_addr_buffer[30] = "";
@@ -692,45 +1348,39 @@ static void hsail_print_wave_data(HwDbgInfo_debug dbgInfo, HsailAgentWaveInfo* w
   char source_line_buffer[256] = "";
   char pc_buffer[30] = "";
 
-  gdb_assert(NULL != wave_info_buffer);
+  /* use the work item if it is the filter work item or not using filter at all */
+  lane_mask = hsail_wave_index_exec_mask(wave_index);
+  if (use_work_item)
+  {
+    lane_mask &= hsail_wave_index_match_workitem(wave_index, &work_item);
+  }
 
-  /* print the index and the wave front id */
+  first_bit_num = hsail_lanes_first(lane_mask);
+  last_bit_num = hsail_lanes_last(lane_mask);
 
-  for (nExec = 0 ; nExec < 64 ; nExec++)
+  if (!use_work_item || 0 != lane_mask)
   {
-    if (wave_info_buffer[wave_index].execMask & current_bit_mask)
+    /* an empty exec mask shows lane 0 */
+    if (0 > first_bit_num)
     {
-      /* use the work item if it is the filter work item or not using filter at all */
-      if (!use_work_item || (work_item.x == wave_info_buffer[wave_index].workItemId[nExec].x &&
-                             work_item.y == wave_info_buffer[wave_index].workItemId[nExec].y &&
-                             work_item.z == wave_info_buffer[wave_index].workItemId[nExec].z))
-      {
-        last_bit_num = nExec;
-        if (firstExec)
-        {
-          firstExec = false;
-          first_bit_num = nExec;
-          found_work_item = true;
-        }
-      }
+      first_bit_num = 0;
+      last_bit_num = 0;
     }
-    /* move the current_bit_mask to the next bit so the next exec mask bit will be checked */
-    current_bit_mask = current_bit_mask<<1;
-  }
 
-  if (!use_work_item || found_work_item)
-  {
+    hsail_wave_index_workitem_id(wave_index, first_bit_num, &first_id);
+    hsail_wave_index_workitem_id(wave_index, last_bit_num, &last_id);
+
     sprintf(index_buffer,"%s%d",mark_active_item ? "*": "", index_to_show);
-    sprintf(wave_addr_buffer,"0x%x",wave_info_buffer[wave_index].waveAddress);
+    sprintf(wave_addr_buffer,"0x%x",hsail_wave_index_wave_address(wave_index));
 
-    sprintf(wi_id1_buffer,"%2d,%2d,%2d",wave_info_buffer[wave_index].workItemId[first_bit_num].x,
-                                        wave_info_buffer[wave_index].workItemId[first_bit_num].y,
-                                        wave_info_buffer[wave_index].workItemId[first_bit_num].z );
+    sprintf(wi_id1_buffer,"%2d,%2d,%2d",first_id.x,
+                                        first_id.y,
+                                        first_id.z );
     if (!use_work_item)
     {
-      sprintf(wi_id2_buffer," - %2d,%2d,%2d",wave_info_buffer[wave_index].workItemId[last_bit_num].x,
-                                             wave_info_buffer[wave_index].workItemId[last_bit_num].y,
-                                             wave_info_buffer[wave_index].workItemId[last_bit_num].z );
+      sprintf(wi_id2_buffer," - %2d,%2d,%2d",last_id.x,
+                                             last_id.y,
+                                             last_id.z );
     }
     else
     {
@@ -741,19 +1391,20 @@ static void hsail_print_wave_data(HwDbgInfo_debug dbgInfo, HsailAgentWaveInfo* w
     /* print absolute work-item id */
     if (NULL != active_dispatch)
     {
-      uint32_t baseX = wave_info_buffer[wave_index].workGroupId.x * active_dispatch->work_groups_size.x;
-      uint32_t baseY = wave_info_buffer[wave_index].workGroupId.y * active_dispatch->work_groups_size.y;
-      uint32_t baseZ = wave_info_buffer[wave_index].workGroupId.z * active_dispatch->work_groups_size.z;
+      hsail_lanes_absolute_workitem(&first_id, work_group_id,
+                                    &active_dispatch->work_groups_size, &absolute_id);
       sprintf(abs_wi_id1_buffer,"%2d,%2d,%2d",
-                      baseX + wave_info_buffer[wave_index].workItemId[first_bit_num].x,
-                      baseY + wave_info_buffer[wave_index].workItemId[first_bit_num].y,
-                      baseZ + wave_info_buffer[wave_index].workItemId[first_bit_num].z);
+                      absolute_id.x,
+                      absolute_id.y,
+                      absolute_id.z);
       if (!use_work_item)
       {
+        hsail_lanes_absolute_workitem(&last_id, work_group_id,
+                                      &active_dispatch->work_groups_size, &absolute_id);
         sprintf(abs_wi_id2_buffer," - %2d,%2d,%2d",
-                      baseX + wave_info_buffer[wave_index].workItemId[last_bit_num].x,
-                      baseY + wave_info_buffer[wave_index].workItemId[last_bit_num].y,
-                      baseZ + wave_info_buffer[wave_index].workItemId[last_bit_num].z);
+                      absolute_id.x,
+                      absolute_id.y,
+                      absolute_id.z);
       }
       else
       {
@@ -766,159 +1417,133 @@ static void hsail_print_wave_data(HwDbgInfo_debug dbgInfo, HsailAgentWaveInfo* w
       sprintf(abs_wi_id_buffer,"%s","");
     }
     /* print the source line and pc */
-    dbgErr = hwdbginfo_nearest_mapped_addr(dbgInfo, wave_info_buffer[wave_index].pc,  &addr);
-    if (dbgErr == HWDBGINFO_E_SUCCESS)
-    {
-      dbgErr = hwdbginfo_addr_to_line(dbgInfo, addr, &loc);
-    }
-
-    if (dbgErr == HWDBGINFO_E_SUCCESS)
-    {
-      dbgErr = hwdbginfo_code_location_details(loc, &line_num, 0, file_name, &file_name_len);
-    }
-
-    if (dbgErr == HWDBGINFO_E_SUCCESS)
-    {
-      sprintf(source_line_buffer,"temp_source@line %d",((int)line_num));
-    }
-    else
-    {
-      sprintf(source_line_buffer,"dbginfo error");
-    }
+    hsail_print_source_line_of_pc(dbgInfo, pc, source_line_buffer);
 
-    sprintf(pc_buffer,"0x%x",((int)wave_info_buffer[wave_index].pc));
+    sprintf(pc_buffer,"0x%x",((int)pc));
 
     printf_filtered("%5s%15s%27s%27s%12s%23s\n", index_buffer, wave_addr_buffer, wi_id_buffer, abs_wi_id_buffer, pc_buffer, source_line_buffer);
-
-    /* release loc */
-    hwdbginfo_release_code_locations(&loc, 1);
   }
 }
 
-void hsail_print_specific_workgroup_by_id_info (int index, struct ui_out* uiout, int from_tty)
+/* Print one line per wave, or only for the waves that moved since the previous stop.
+ * The moved waves come from the wave index, so listing them does not look at the other waves */
+void hsail_print_waves_info (bool moved_only, struct ui_out* uiout, int from_tty)
 {
-  /* vars used to loop through the waves and count the groups */
-  int nWorkgroup = 0;
+  int num_waves = hsail_wave_index_num_waves();
+  int num_moved_waves = 0;
+  const int* moved_waves = NULL;
+  int num_shown = 0;
   int nWave = 0;
-  int count_index = 0;
-  HsailWaveDim3 dummy_work_item = {-1, -1, -1};
-  bool workgroup_found = false;
-  /* get the waves info */
-  int num_waves = hsail_tdep_get_active_wave_count();
-  HsailAgentWaveInfo* wave_info_buffer = (HsailAgentWaveInfo*)hsail_tdep_map_wave_buffer();
-
-  /* get the source line information */
   HwDbgInfo_debug dbgInfo = NULL;
 
-  /* active dispatch to calculate the flattened id */
-  struct hsail_dispatch* active_dispatch = hsail_kernel_active_dispatch();
-  int workgroupnumX = 0;
-  int workgroupnumY = 0;
-  int flattened_id = 0;
+  char index_buffer[10] = "";
+  char wave_addr_buffer[30] = "";
+  char wg_id_buffer[30] = "";
+  char pc_buffer[30] = "";
+  char source_line_buffer[256] = "";
 
   gdb_assert(NULL != uiout);
 
-  /* calculate work group size */
-  if (NULL != active_dispatch)
+  if (0 == num_waves)
   {
-    workgroupnumX = (active_dispatch->work_items.x == 0 ? 1 : active_dispatch->work_items.x) / (active_dispatch->work_groups_size.x == 0 ? 1 : active_dispatch->work_groups_size.x);
-    workgroupnumY = (active_dispatch->work_items.y == 0 ? 1 : active_dispatch->work_items.y) / (active_dispatch->work_groups_size.y == 0 ? 1 : active_dispatch->work_groups_size.y);
+    hsail_print_no_wave_msg(uiout, "waves");
+    return;
   }
 
-  if (NULL == wave_info_buffer || num_waves == 0)
+  moved_waves = hsail_wave_index_moved_waves(&num_moved_waves);
+  dbgInfo = hsail_init_hwdbginfo(NULL);
+
+  if (0 != hsail_wave_index_sequence())
   {
-    hsail_print_no_wave_msg(uiout, "work-group <id>");
-    return ;
+    printf_filtered("Wave snapshot %llu: %d of %d waves moved since the previous stop\n",
+                    (unsigned long long)hsail_wave_index_sequence(), num_moved_waves, num_waves);
+  }
+  else
+  {
+    printf_filtered("%d waves, the agent does not report which waves moved\n", num_waves);
   }
 
-  dbgInfo = hsail_init_hwdbginfo(NULL);
-
-  /* create the work-group vector and verify the index is valid */
-  hsail_build_workgroups_vector();
+  printf_filtered("%7s%15s%15s%12s%7s%23s\n","Index","Wavefront ID","Work-group ID","PC","Moved","Source line");
 
-  /* pass through all the work-groups in the vector and look for the flattened id */
-  for (nWorkgroup = 0 ; nWorkgroup < gs_num_workgroups_in_vector ; nWorkgroup++)
+  num_shown = moved_only ? num_moved_waves : num_waves;
+  for (nWave = 0; nWave < num_shown; nWave++)
   {
+    int wave_index = moved_only ? moved_waves[nWave] : nWave;
+    const HsailWaveDim3* work_group_id = hsail_wave_index_workgroup_id(wave_index);
+    HsailProgramCounter pc = hsail_wave_index_pc(wave_index);
+
+    sprintf(index_buffer,"%d",wave_index);
+    sprintf(wave_addr_buffer,"0x%x",hsail_wave_index_wave_address(wave_index));
+    sprintf(wg_id_buffer,"%d,%d,%d",work_group_id->x, work_group_id->y, work_group_id->z);
+    sprintf(pc_buffer,"0x%x",((int)pc));
+    hsail_print_source_line_of_pc(dbgInfo, pc, source_line_buffer);
+
+    printf_filtered("%7s%15s%15s%12s%7s%23s\n", index_buffer, wave_addr_buffer, wg_id_buffer, pc_buffer,
+                    hsail_wave_index_wave_moved(wave_index) ? "*" : "", source_line_buffer);
+  }
+}
 
-    if (NULL != active_dispatch)
-    {
-      flattened_id = gs_workgroup_vector[nWorkgroup].x +
-                     gs_workgroup_vector[nWorkgroup].y * workgroupnumX +
-                     gs_workgroup_vector[nWorkgroup].z * workgroupnumX * workgroupnumY;
-    }
+void hsail_print_specific_workgroup_by_id_info (int index, struct ui_out* uiout, int from_tty)
+{
+  int nWave = 0;
+  HsailWaveDim3 dummy_work_item = {-1, -1, -1};
+  const struct hsail_wave_index_workgroup* wg = NULL;
 
-    if (flattened_id == index)
-    {
-      /* print the header */
-      printf_filtered("Information for Work-group %d\n",index);
-      printf_filtered("%5s%15s%27s%27s%12s%23s\n","Index","Wavefront ID","Work-item ID","Absolute Work-item ID","PC","Source line");
+  /* get the source line information */
+  HwDbgInfo_debug dbgInfo = NULL;
 
-      /* pass through all the waves and check if their information match the work group of the index needed */
-      for (nWave = 0 ; nWave < num_waves ; nWave++)
-      {
-          if (gs_workgroup_vector[nWorkgroup].x == wave_info_buffer[nWave].workGroupId.x &&
-              gs_workgroup_vector[nWorkgroup].y == wave_info_buffer[nWave].workGroupId.y &&
-              gs_workgroup_vector[nWorkgroup].z == wave_info_buffer[nWave].workGroupId.z)
-          {
-            hsail_print_wave_data(dbgInfo, wave_info_buffer, nWave, count_index, dummy_work_item, false, false);
-            count_index++;
-          }
-      }
-      workgroup_found = true;
-    }
+  gdb_assert(NULL != uiout);
+
+  if (0 == hsail_wave_index_num_waves())
+  {
+    hsail_print_no_wave_msg(uiout, "work-group <id>");
+    return ;
   }
 
-  if (!workgroup_found)
+  wg = hsail_wave_index_find_workgroup_by_flattened_id(index);
+  if (NULL == wg)
   {
     ui_out_text(uiout,"Provided work-group ID not found.\n");
+    return ;
   }
 
-  /* release the vector data */
-  free_current_contents(&gs_workgroup_vector);
-  gs_num_workgroups_in_vector = 0;
+  dbgInfo = hsail_init_hwdbginfo(NULL);
+
+  /* print the header */
+  printf_filtered("Information for Work-group %d\n",index);
+  printf_filtered("%5s%15s%27s%27s%12s%23s\n","Index","Wavefront ID","Work-item ID","Absolute Work-item ID","PC","Source line");
 
-  /* release the wave buffer */
-  hsail_tdep_unmap_wave_buffer((void*)wave_info_buffer);
+  /* print all the waves of the work-group */
+  for (nWave = 0 ; nWave < wg->num_waves ; nWave++)
+  {
+    hsail_print_wave_data(dbgInfo, wg->waves[nWave], nWave, dummy_work_item, false, false);
+  }
 }
 
 void hsail_print_specific_workgroup_info (unsigned int* workgroupid, struct ui_out* uiout, int from_tty)
 {
   /* convert the work_group_id to flattened_id */
-  /* active dispatch to calculate the flattened_id */
-  struct hsail_dispatch* active_dispatch = hsail_kernel_active_dispatch();
-  int workgroupnumX = 0;
-  int workgroupnumY = 0;
-  int flattened_id = 0;
+  HsailWaveDim3 work_group_id;
 
   gdb_assert(NULL != workgroupid);
   gdb_assert(NULL != uiout);
 
-  if (NULL != active_dispatch)
-  {
-    /* calculate number of work group in X and Y dimensions */
-    workgroupnumX = (active_dispatch->work_items.x == 0 ? 1 : active_dispatch->work_items.x) / (active_dispatch->work_groups_size.x == 0 ? 1 : active_dispatch->work_groups_size.x);
-    workgroupnumY = (active_dispatch->work_items.y == 0 ? 1 : active_dispatch->work_items.y) / (active_dispatch->work_groups_size.y == 0 ? 1 : active_dispatch->work_groups_size.y);
+  work_group_id.x = workgroupid[0];
+  work_group_id.y = workgroupid[1];
+  work_group_id.z = workgroupid[2];
 
-    flattened_id = workgroupid[0] +
-                   workgroupid[1] * workgroupnumX +
-                   workgroupid[2] * workgroupnumX * workgroupnumY;
-  }
-
-  hsail_print_specific_workgroup_by_id_info(flattened_id, uiout, from_tty);
+  hsail_print_specific_workgroup_by_id_info(hsail_wave_index_flattened_workgroup_id(&work_group_id), uiout, from_tty);
 }
 
 void hsail_print_workitem_info (HsailWaveDim3 active_work_group, HsailWaveDim3 active_work_item, bool mark_active_item, struct ui_out* uiout, int from_tty)
 {
-  int nWave = 0;
-  /* get the waves info */
-  HsailAgentWaveInfo* wave_info_buffer = (HsailAgentWaveInfo*)hsail_tdep_map_wave_buffer();
+  int wave_index = 0;
 
   /* get the source line information */
-  int num_waves = hsail_tdep_get_active_wave_count();
   HwDbgInfo_debug dbgInfo = NULL;
 
   gdb_assert(NULL != uiout);
-  if (NULL == wave_info_buffer || num_waves == 0)
+  if (0 == hsail_wave_index_num_waves())
   {
     hsail_print_no_wave_msg(uiout, "work-item");
     return ;
@@ -928,16 +1553,9 @@ void hsail_print_workitem_info (HsailWaveDim3 active_work_group, HsailWaveDim3 a
 
   printf_filtered("Information for Work-item\n");
   printf_filtered("%5s%15s%27s%27s%12s%23s\n","Index","Wavefront ID","Work-item ID","Absolute Work-item ID","PC","Source line");
-  for (nWave = 0 ; nWave < num_waves ; nWave++)
+
+  if (hsail_wave_index_find_workitem(&active_work_group, &active_work_item, &wave_index, NULL))
   {
-      if (active_work_group.x == wave_info_buffer[nWave].workGroupId.x &&
-          active_work_group.y == wave_info_buffer[nWave].workGroupId.y &&
-          active_work_group.z == wave_info_buffer[nWave].workGroupId.z)
-      {
-        hsail_print_wave_data(dbgInfo, wave_info_buffer, nWave, 0, active_work_item, true, mark_active_item);
-      }
+    hsail_print_wave_data(dbgInfo, wave_index, 0, active_work_item, true, mark_active_item);
   }
-
-  /* release the wave buffer */
-  hsail_tdep_unmap_wave_buffer((void*)wave_info_buffer);
 }
@@ -34,12 +34,18 @@
 #include <stdbool.h>
 #include "CommunicationControl.h"
 
+/* Include HwDbgFacilities C interface*/
+#include "FacilitiesInterface.h"
+
 typedef enum
 {
   HSAIL_PRINT_SUCCESS = 0,
   HSAIL_PRINT_WRONG_FORMAT,           /* print command is not in the print hsail:arg format */
   HSAIL_PRINT_VAR_NOT_FOUND,          /* var requested not found */
   HSAIL_PRINT_NO_WAVES,               /* no waves were found probably breakpoint at start of kernel */
+  HSAIL_PRINT_GATHER_NOT_SCALAR,      /* only scalar variables can be gathered from many work-items */
+  HSAIL_PRINT_GATHER_NOT_AVAILABLE,   /* the agent cannot gather variables from many work-items */
+  HSAIL_PRINT_GATHER_FAILED,          /* the agent could not read the variable from the work-items */
   HSAIL_PRINT_UNKNOWN                 /* An unknown error code */
 } HsailPrintStatus;
 
@@ -49,10 +55,18 @@ struct value* hsail_print_expression(const char *exp, char* printFormat, size_t*
 
 HsailPrintStatus hsail_print_get_last_error(void);
 
+/* Fill a shared location structure from the debug information of a variable */
+bool hsail_print_fill_var_location(HwDbgInfo_variable dbgVar, size_t var_size, HsailVariableLocation* location);
+
 void hsail_print_cleanup(void* pData);
 
+/* Print the members read with the last printed variable, after the variable itself */
+void hsail_print_members(void);
+
 void hsail_print_wave_info (struct ui_out *uiout, int from_tty);
 
+void hsail_print_waves_info (bool moved_only, struct ui_out *uiout, int from_tty);
+
 void hsail_print_workgroups_info (HsailWaveDim3 active_work_group, struct ui_out *uiout, int from_tty);
 
 void hsail_print_specific_workgroup_by_id_info (int index, struct ui_out *uiout, int from_tty);
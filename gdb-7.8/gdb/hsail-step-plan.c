@@ -0,0 +1,438 @@
+/*
+   HSAIL per code object step plan
+
+   Copyright (c) 2015 ADVANCED MICRO DEVICES, INC.  All rights reserved.
+   This file includes code originally published under
+
+   Copyright (C) 1986-2014 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+/* GDB headers */
+#include "defs.h"
+#include "gdb_assert.h"
+#include "hashtab.h"
+
+#include "hsail-infcmd.h"
+#include "hsail-step-plan.h"
+
+/* The breakpoints of a step from a PC */
+struct hsail_step_plan_targets
+{
+  uint64_t pc;
+  int step_type;
+
+  HsailMomentaryBP* bps;
+  size_t num_bps;
+};
+
+/* The debug info object the plan was built for */
+static HwDbgInfo_debug gs_plan_dbg = NULL;
+
+/* The line entries of the code object sorted by PC */
+static HsailMomentaryBP* gs_line_entries = NULL;
+static size_t gs_num_line_entries = 0;
+static bool gs_line_entries_built = false;
+
+/* The mapped addresses of the code object sorted by PC, the line entries are built from them */
+static HwDbgInfo_addr* gs_mapped_addrs = NULL;
+static size_t gs_num_mapped_addrs = 0;
+
+/* The inlined call stack depth of each mapped address, built on the first step-in */
+static int* gs_mapped_depths = NULL;
+
+/* The breakpoints of each step, by PC and step type */
+static htab_t gs_targets_htab = NULL;
+
+static hashval_t hsail_step_plan_targets_hash(const void* p)
+{
+  const struct hsail_step_plan_targets* targets = p;
+  hashval_t hash = (hashval_t)(targets->pc ^ (targets->pc >> 32));
+  return hash * 4 + (hashval_t)targets->step_type;
+}
+
+static int hsail_step_plan_targets_eq(const void* p1, const void* p2)
+{
+  const struct hsail_step_plan_targets* targets1 = p1;
+  const struct hsail_step_plan_targets* targets2 = p2;
+  return targets1->pc == targets2->pc && targets1->step_type == targets2->step_type;
+}
+
+static void hsail_step_plan_targets_free(void* p)
+{
+  struct hsail_step_plan_targets* targets = p;
+  xfree(targets->bps);
+  xfree(targets);
+}
+
+static int hsail_step_plan_compare_addr(const void* p1, const void* p2)
+{
+  const HwDbgInfo_addr addr1 = *(const HwDbgInfo_addr*)p1;
+  const HwDbgInfo_addr addr2 = *(const HwDbgInfo_addr*)p2;
+  return (addr1 > addr2) - (addr1 < addr2);
+}
+
+static int hsail_step_plan_addr_to_line(HwDbgInfo_debug dbg, HwDbgInfo_addr addr)
+{
+  HwDbgInfo_code_location loc = NULL;
+  HwDbgInfo_linenum line_num = 0;
+
+  if (hwdbginfo_addr_to_line(dbg, addr, &loc) == HWDBGINFO_E_SUCCESS)
+    {
+      hwdbginfo_code_location_details(loc, &line_num, 0, NULL, NULL);
+    }
+
+  hwdbginfo_release_code_locations(&loc, 1);
+
+  return (int)line_num;
+}
+
+/* The number of frames in the inlined call stack of addr, 0 if it has none */
+static int hsail_step_plan_addr_depth(HwDbgInfo_debug dbg, HwDbgInfo_addr addr)
+{
+  size_t frame_count = 0;
+
+  if (hwdbginfo_addr_call_stack(dbg, addr, 0, NULL, &frame_count) != HWDBGINFO_E_SUCCESS)
+    {
+      return 0;
+    }
+
+  return (int)frame_count;
+}
+
+/* Query the addresses of a step from the debug facilities, sorted and without
+ * duplicates. The caller frees the addresses */
+static HwDbgInfo_addr* hsail_step_plan_query_addrs(HwDbgInfo_debug dbg,
+                                                   int step_type,
+                                                   uint64_t pc,
+                                                   size_t* num_addrs)
+{
+  HwDbgInfo_err err = HWDBGINFO_E_SUCCESS;
+  HwDbgInfo_result result = NULL;
+  const HwDbgInfo_addr* result_addrs = NULL;
+  HwDbgInfo_addr* addrs = NULL;
+  bool step_out = (HSAIL_STEP_OUT == step_type);
+  size_t addr_count = 0;
+  size_t i = 0;
+  size_t j = 0;
+
+  *num_addrs = 0;
+
+  /* The query runs once, the addresses are copied out of its result to be
+   * sorted. All the mapped addresses are queried to build the line entries */
+  if (HSAIL_STEP_IN == step_type)
+    {
+      result = hwdbginfo_query_all_mapped_addrs(dbg, &err);
+    }
+  else
+    {
+      result = hwdbginfo_query_step_addresses(dbg, pc, step_out, &err);
+    }
+
+  result_addrs = hwdbginfo_result_addrs(result, &addr_count);
+
+  if ((HWDBGINFO_E_SUCCESS != err) || (0 == addr_count))
+    {
+      hwdbginfo_release_result(&result);
+      return NULL;
+    }
+
+  addrs = XNEWVEC(HwDbgInfo_addr, addr_count);
+  memcpy(addrs, result_addrs, addr_count * sizeof(HwDbgInfo_addr));
+  hwdbginfo_release_result(&result);
+
+  qsort(addrs, addr_count, sizeof(HwDbgInfo_addr), hsail_step_plan_compare_addr);
+
+  for (i = 0; i < addr_count; i++)
+    {
+      if ((0 == j) || (addrs[j - 1] != addrs[i]))
+        {
+          addrs[j++] = addrs[i];
+        }
+    }
+
+  *num_addrs = j;
+  return addrs;
+}
+
+static void hsail_step_plan_build_line_entries(HwDbgInfo_debug dbg)
+{
+  HwDbgInfo_addr* addrs = NULL;
+  size_t num_addrs = 0;
+  size_t i = 0;
+  int prev_line_num = 0;
+
+  addrs = hsail_step_plan_query_addrs(dbg, HSAIL_STEP_IN, 0, &num_addrs);
+  gs_mapped_addrs = addrs;
+  gs_num_mapped_addrs = num_addrs;
+
+  if (num_addrs > 0)
+    {
+      gs_line_entries = XNEWVEC(HsailMomentaryBP, num_addrs);
+    }
+
+  for (i = 0; i < num_addrs; i++)
+    {
+      int line_num = hsail_step_plan_addr_to_line(dbg, addrs[i]);
+
+      if ((0 == i) || (line_num != prev_line_num))
+        {
+          gs_line_entries[gs_num_line_entries].m_pc = addrs[i];
+          gs_line_entries[gs_num_line_entries].m_lineNum = line_num;
+          gs_num_line_entries++;
+        }
+
+      prev_line_num = line_num;
+    }
+
+  gs_line_entries_built = true;
+}
+
+/* The line of a mapped address, from the line entry it follows */
+static int hsail_step_plan_entry_line(HwDbgInfo_addr addr)
+{
+  size_t first = 0;
+  size_t last = gs_num_line_entries;
+
+  while (first < last)
+    {
+      size_t middle = first + (last - first) / 2;
+
+      if (gs_line_entries[middle].m_pc <= addr)
+        {
+          first = middle + 1;
+        }
+      else
+        {
+          last = middle;
+        }
+    }
+
+  return (0 == first) ? 0 : gs_line_entries[first - 1].m_lineNum;
+}
+
+/* Whether addr is the mapped address right after prev_addr */
+static bool hsail_step_plan_is_next_mapped_addr(HwDbgInfo_addr prev_addr, HwDbgInfo_addr addr)
+{
+  const HwDbgInfo_addr* mapped = bsearch(&addr, gs_mapped_addrs, gs_num_mapped_addrs,
+                                         sizeof(HwDbgInfo_addr), hsail_step_plan_compare_addr);
+
+  return (mapped != NULL) && (mapped != gs_mapped_addrs) && (mapped[-1] == prev_addr);
+}
+
+/* Step-in also stops in the functions inlined into the current one: add the
+ * mapped addresses whose inlined call stack is deeper than the one of pc to the
+ * step-over addresses. The facilities expose no control flow, so the inlined
+ * functions of other frames at the same depth are included too.
+ * Returns the merged addresses, sorted and without duplicates, and frees addrs */
+static HwDbgInfo_addr* hsail_step_plan_add_deeper_addrs(HwDbgInfo_debug dbg,
+                                                        uint64_t pc,
+                                                        HwDbgInfo_addr* addrs,
+                                                        size_t* num_addrs)
+{
+  HwDbgInfo_addr* merged = NULL;
+  int pc_depth = hsail_step_plan_addr_depth(dbg, pc);
+  size_t num_merged = 0;
+  size_t i = 0;
+  size_t j = 0;
+
+  if ((NULL == gs_mapped_depths) && (0 < gs_num_mapped_addrs))
+    {
+      gs_mapped_depths = XNEWVEC(int, gs_num_mapped_addrs);
+
+      for (i = 0; i < gs_num_mapped_addrs; i++)
+        {
+          gs_mapped_depths[i] = hsail_step_plan_addr_depth(dbg, gs_mapped_addrs[i]);
+        }
+    }
+
+  merged = XNEWVEC(HwDbgInfo_addr, *num_addrs + gs_num_mapped_addrs);
+
+  for (i = 0, j = 0; (i < *num_addrs) || (j < gs_num_mapped_addrs);)
+    {
+      if ((j < gs_num_mapped_addrs) && (gs_mapped_depths[j] <= pc_depth))
+        {
+          j++;
+        }
+      else if ((j == gs_num_mapped_addrs) || ((i < *num_addrs) && (addrs[i] < gs_mapped_addrs[j])))
+        {
+          merged[num_merged++] = addrs[i++];
+        }
+      else
+        {
+          if ((i < *num_addrs) && (addrs[i] == gs_mapped_addrs[j]))
+            {
+              i++;
+            }
+          merged[num_merged++] = gs_mapped_addrs[j++];
+        }
+    }
+
+  xfree(addrs);
+  *num_addrs = num_merged;
+  return merged;
+}
+
+static struct hsail_step_plan_targets* hsail_step_plan_build_targets(HwDbgInfo_debug dbg,
+                                                                     int step_type,
+                                                                     uint64_t pc)
+{
+  struct hsail_step_plan_targets* targets = XCNEW(struct hsail_step_plan_targets);
+  HwDbgInfo_addr* addrs = NULL;
+  size_t num_addrs = 0;
+  size_t i = 0;
+  int current_line_num = 0;
+  int line_num = 0;
+  int prev_line_num = 0;
+
+  targets->pc = pc;
+  targets->step_type = step_type;
+
+  if (HSAIL_STEP_IN == step_type)
+    {
+      addrs = hsail_step_plan_query_addrs(dbg, HSAIL_STEP_OVER, pc, &num_addrs);
+      addrs = hsail_step_plan_add_deeper_addrs(dbg, pc, addrs, &num_addrs);
+    }
+  else
+    {
+      addrs = hsail_step_plan_query_addrs(dbg, step_type, pc, &num_addrs);
+    }
+
+  if (num_addrs > 0)
+    {
+      targets->bps = XNEWVEC(HsailMomentaryBP, num_addrs);
+    }
+
+  current_line_num = hsail_step_plan_addr_to_line(dbg, pc);
+
+  /* Every address of another line is a target: a branch can land in the middle of
+   * a line. Only the addresses that follow a target of the same line are dropped,
+   * the wave reaches them through that target */
+  for (i = 0; i < num_addrs; i++)
+    {
+      line_num = hsail_step_plan_entry_line(addrs[i]);
+
+      if ((line_num != current_line_num)
+          && !((0 < i) && (line_num == prev_line_num)
+               && hsail_step_plan_is_next_mapped_addr(addrs[i - 1], addrs[i])))
+        {
+          targets->bps[targets->num_bps].m_pc = addrs[i];
+          targets->bps[targets->num_bps].m_lineNum = line_num;
+          targets->num_bps++;
+        }
+
+      prev_line_num = line_num;
+    }
+
+  /* All the addresses are on the current line, keep all of them rather than not stopping */
+  if ((0 == targets->num_bps) && (num_addrs > 0))
+    {
+      for (i = 0; i < num_addrs; i++)
+        {
+          targets->bps[i].m_pc = addrs[i];
+          targets->bps[i].m_lineNum = hsail_step_plan_addr_to_line(dbg, addrs[i]);
+        }
+
+      targets->num_bps = num_addrs;
+    }
+
+  xfree(addrs);
+  return targets;
+}
+
+const HsailMomentaryBP* hsail_step_plan_get(HwDbgInfo_debug dbg,
+                                            int step_type,
+                                            uint64_t pc,
+                                            size_t* num_bps)
+{
+  struct hsail_step_plan_targets key;
+  struct hsail_step_plan_targets* targets = NULL;
+  void** slot = NULL;
+
+  gdb_assert(dbg != NULL);
+  gdb_assert(num_bps != NULL);
+
+  if (dbg != gs_plan_dbg)
+    {
+      hsail_step_plan_release(NULL);
+      gs_plan_dbg = dbg;
+    }
+
+  if (!gs_line_entries_built)
+    {
+      hsail_step_plan_build_line_entries(dbg);
+    }
+
+  /* Without a PC (before the dispatch starts) step-in stops at the first line reached */
+  if ((HSAIL_STEP_IN == step_type) && (0 == pc))
+    {
+      *num_bps = gs_num_line_entries;
+      return (gs_num_line_entries > 0) ? gs_line_entries : NULL;
+    }
+
+  if (gs_targets_htab == NULL)
+    {
+      gs_targets_htab = htab_create_alloc(16, hsail_step_plan_targets_hash,
+                                          hsail_step_plan_targets_eq,
+                                          hsail_step_plan_targets_free, xcalloc, xfree);
+    }
+
+  memset(&key, 0, sizeof(key));
+  key.pc = pc;
+  key.step_type = step_type;
+
+  slot = htab_find_slot(gs_targets_htab, &key, INSERT);
+  if (*slot == NULL)
+    {
+      *slot = hsail_step_plan_build_targets(dbg, step_type, pc);
+    }
+
+  targets = *slot;
+  *num_bps = targets->num_bps;
+  return (targets->num_bps > 0) ? targets->bps : NULL;
+}
+
+void hsail_step_plan_release(HwDbgInfo_debug dbg)
+{
+  if ((dbg != NULL) && (dbg != gs_plan_dbg))
+    {
+      return;
+    }
+
+  if (gs_targets_htab != NULL)
+    {
+      htab_delete(gs_targets_htab);
+      gs_targets_htab = NULL;
+    }
+
+  xfree(gs_line_entries);
+  gs_line_entries = NULL;
+  gs_num_line_entries = 0;
+  gs_line_entries_built = false;
+
+  xfree(gs_mapped_addrs);
+  gs_mapped_addrs = NULL;
+  gs_num_mapped_addrs = 0;
+
+  xfree(gs_mapped_depths);
+  gs_mapped_depths = NULL;
+
+  gs_plan_dbg = NULL;
+}
@@ -0,0 +1,62 @@
+/*
+   HSAIL per code object step plan
+
+   Copyright (c) 2015 ADVANCED MICRO DEVICES, INC.  All rights reserved.
+   This file includes code originally published under
+
+   Copyright (C) 1986-2014 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#if !defined (HSAIL_STEP_PLAN_H)
+#define HSAIL_STEP_PLAN_H 1
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Include HwDbgFacilities C interface*/
+#include "FacilitiesInterface.h"
+
+#include "CommunicationControl.h"
+
+/*
+ * The step plan holds the momentary breakpoints of each step for one debug
+ * info object, so repeated steps do not query the debug facilities again.
+ *
+ * The breakpoints of each step are built on the first step from each PC.
+ * Step-over and step-out use the step addresses of the debug facilities.
+ * Step-in uses the step-over addresses and the mapped addresses whose
+ * inlined call stack is deeper than the one of the PC. Before the dispatch
+ * has a PC, step-in stops at the line entries of the whole code object: a
+ * mapped address whose line differs from the one of the address before it.
+ *
+ * Every one of these addresses of another line gets a breakpoint, since
+ * a branch can land in the middle of a line, except the addresses that
+ * directly follow a breakpoint of the same line.
+ */
+
+/* Get the momentary breakpoints of a step of type step_type (HSAIL_STEP_*)
+ * from pc. The breakpoints stay valid until the plan is released.
+ * Returns NULL if the debug info has no step addresses */
+const HsailMomentaryBP* hsail_step_plan_get(HwDbgInfo_debug dbg,
+                                            int step_type,
+                                            uint64_t pc,
+                                            size_t* num_bps);
+
+/* Release the plan built for dbg, NULL releases any plan */
+void hsail_step_plan_release(HwDbgInfo_debug dbg);
+
+#endif // HSAIL_STEP_PLAN_H
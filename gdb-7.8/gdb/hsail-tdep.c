@@ -58,11 +58,13 @@
 /* HSAIL headers */
 #include "hsail-breakpoint.h"
 #include "hsail-cmd.h"
+#include "hsail-dbginfo-cache.h"
 #include "hsail-fifo-control.h"
 #include "hsail-infcmd.h"
 #include "hsail-kernel.h"
 #include "hsail-print.h"
 #include "hsail-tdep.h"
+#include "hsail-wave-index.h"
 
 /* Include HwDbgFacilities C interface*/
 #include "FacilitiesInterface.h"
@@ -88,6 +90,26 @@ int g_hsail_fifo_read_descriptor = 0;
 
 static int gs_num_handle_event_function_calls = 0;
 
+/* How many notifications the reader buffers, a burst larger than this
+ * is handled in several passes of the same event */
+#define HSAIL_NOTIFICATION_BUFFER_LEN 32
+
+/* The bytes read from the agent's fifo and not handled yet.
+ * Only the last notification may be incomplete, it is completed by the next read
+ * */
+static HsailNotificationPayload gs_hsail_notification_buffer[HSAIL_NOTIFICATION_BUFFER_LEN];
+static size_t gs_hsail_notification_buffer_len = 0;
+
+/* Set while the notifications are handled, see handle_hsail_event.
+ * An int so that a cleanup can restore it when a handler throws */
+static int gs_is_handling_notifications = 0;
+
+/* Drop the buffered notifications, the fifo they came from is closed */
+static void hsail_tdep_clear_notification_buffer(void)
+{
+  gs_hsail_notification_buffer_len = 0;
+}
+
 static int gs_num_active_waves=-1;
 
 static bool gs_stage2_has_run = false;
@@ -121,6 +143,9 @@ void hsail_linux_initialize_stg2(void)
       else
         {
           g_hsail_fifo_descriptor = fd;
+
+          /* Negotiate the command protocol with the agent */
+          hsail_fifo_begin_debugging();
         }
 
       /*
@@ -299,13 +324,173 @@ bool hsail_tdep_kill_all_waves(bool is_quit_command)
   return is_kill_delay_needed;
 }
 
-void* hsail_tdep_map_momentary_bp_buffer(void)
+/* The shared memory segments are attached the first time they are needed and
+ * stay attached until the end of the debugging session, see hsail_tdep_detach_all_shmem.
+ * The generation of a segment is incremented every time the agent rewrites it,
+ * so that readers caching data decoded from a segment know when to refresh it.
+ *
+ * A max_size of 0 is used for the segments the agent replaces with larger ones,
+ * such a segment is attached again when its key refers to another segment.
+ * */
+typedef struct _HsailShmemMapping
+{
+  key_t key;
+  size_t max_size;
+  void* pShm;
+  int shmid;
+  size_t size;
+  unsigned int generation;
+  const char* name;
+} HsailShmemMapping;
+
+static HsailShmemMapping gs_hsail_shmem_mappings[HSAIL_SHMEM_COUNT] =
+{
+  {g_DBEBINARY_SHMKEY, g_BINARY_BUFFER_MAXSIZE, NULL, -1, 0, 0, "binary buffer"},
+  {g_WAVE_BUFFER_SHMKEY, 0, NULL, -1, 0, 0, "wave info buffer"},
+  {g_MOMENTARY_BP_BUFFER_SHMKEY, g_MOMENTARY_BP_BUFFER_MAXSIZE, NULL, -1, 0, 0, "momentary bp buffer"},
+  {g_VARIABLE_READ_BUFFER_SHMKEY, g_VARIABLE_READ_BUFFER_MAXSIZE, NULL, -1, 0, 0, "variable read buffer"},
+  {g_BREAKPOINT_STATISTICS_SHMKEY, g_BREAKPOINT_STATISTICS_MAXSIZE, NULL, -1, 0, 0, "breakpoint statistics buffer"},
+  {g_VARIABLE_GATHER_BUFFER_SHMKEY, g_VARIABLE_GATHER_BUFFER_MAXSIZE, NULL, -1, 0, 0, "variable gather buffer"},
+};
+
+/* Return the attached segment, attaching it if this is the first use in the session.
+ * Returns NULL if the segment does not exist */
+static void* hsail_tdep_attach_shmem(const HsailShmemBuffer buffer)
+{
+  HsailShmemMapping* mapping = NULL;
+  struct shmid_ds shm_info;
+  void* pShm = NULL;
+  int shmid = -1;
+
+  gdb_assert(buffer >= 0 && buffer < HSAIL_SHMEM_COUNT);
+  mapping = &gs_hsail_shmem_mappings[buffer];
+
+  if (mapping->pShm != NULL)
+    {
+      return mapping->pShm;
+    }
+
+  shmid = shmget(mapping->key, mapping->max_size, 0666);
+
+  if (shmid <= 0)
+    {
+      return NULL;
+    }
+
+  /* Get shm pointer */
+  pShm = (void*)shmat(shmid, NULL, 0);
+
+  if (pShm == (void*)-1)
+    {
+      return NULL;
+    }
+
+  /* The fixed size segments are at least max_size bytes */
+  mapping->size = mapping->max_size;
+  if (shmctl(shmid, IPC_STAT, &shm_info) == 0)
+    {
+      mapping->size = shm_info.shm_segsz;
+    }
+
+  mapping->pShm = pShm;
+  mapping->shmid = shmid;
+
+  return mapping->pShm;
+}
+
+/* Detach all the segments, called when the debugging session ends since the agent
+ * may then free the segments and allocate new ones for the next session */
+void hsail_tdep_detach_all_shmem(void)
 {
   struct ui_out* uiout = current_uiout;
+  int i = 0;
+
+  gdb_assert(NULL != uiout);
+
+  /* The wave index points into the wave buffer */
+  hsail_wave_index_invalidate();
+
+  for (i = 0; i < HSAIL_SHMEM_COUNT; i++)
+    {
+      HsailShmemMapping* mapping = &gs_hsail_shmem_mappings[i];
 
+      if (mapping->pShm == NULL)
+        {
+          continue;
+        }
+
+      /* Detach shared memory */
+      if (shmdt(mapping->pShm) == -1)
+        {
+          ui_out_text(uiout, "GDB: Error detaching ");
+          ui_out_text(uiout, mapping->name);
+          ui_out_text(uiout, "\n");
+        }
+
+      mapping->pShm = NULL;
+      mapping->shmid = -1;
+      mapping->size = 0;
+      mapping->generation++;
+    }
+}
+
+/* Let the readers of a segment know that the agent has rewritten it.
+ * If the agent has replaced a growable segment, the old one is detached
+ * so that the next map attaches the new one */
+static void hsail_tdep_shmem_updated(const HsailShmemBuffer buffer)
+{
+  HsailShmemMapping* mapping = NULL;
+
+  gdb_assert(buffer >= 0 && buffer < HSAIL_SHMEM_COUNT);
+  mapping = &gs_hsail_shmem_mappings[buffer];
+
+  if (mapping->max_size == 0 && mapping->pShm != NULL &&
+      shmget(mapping->key, 0, 0666) != mapping->shmid)
+    {
+      shmdt(mapping->pShm);
+      mapping->pShm = NULL;
+      mapping->shmid = -1;
+      mapping->size = 0;
+    }
+
+  mapping->generation++;
+}
+
+size_t hsail_tdep_get_shmem_size(const HsailShmemBuffer buffer)
+{
+  gdb_assert(buffer >= 0 && buffer < HSAIL_SHMEM_COUNT);
+  return gs_hsail_shmem_mappings[buffer].size;
+}
+
+unsigned int hsail_tdep_get_shmem_generation(const HsailShmemBuffer buffer)
+{
+  gdb_assert(buffer >= 0 && buffer < HSAIL_SHMEM_COUNT);
+  return gs_hsail_shmem_mappings[buffer].generation;
+}
+
+void* hsail_tdep_map_binary_buffer(void)
+{
+  struct ui_out* uiout = current_uiout;
+  void* pShm = NULL;
+
+  gdb_assert(NULL != uiout);
+
+  pShm = hsail_tdep_attach_shmem(HSAIL_SHMEM_BINARY);
+
+  if (pShm == NULL)
+    {
+      ui_out_text(uiout, "GDB: HwDbgFacilities init: shmid is invalid\n");
+    }
+
+  gdb_assert(pShm != NULL);
+
+  return pShm;
+}
+
+void* hsail_tdep_map_momentary_bp_buffer(void)
+{
+  struct ui_out* uiout = current_uiout;
   void* pShm = NULL;
-  int shmid = -1;
-  int max_shared_mem_size = hsail_get_momentary_bp_buffer_shmem_max_size();
 
   gdb_assert(NULL != uiout);
 
@@ -314,19 +499,13 @@ void* hsail_tdep_map_momentary_bp_buffer(void)
       return NULL;
     }
 
-  shmid = shmget(hsail_get_momentary_bp_buffer_shmem_key(),
-                 max_shared_mem_size, 0666);
+  pShm = hsail_tdep_attach_shmem(HSAIL_SHMEM_MOMENTARY_BP);
 
-  if (shmid <= 0)
+  if (pShm == NULL)
     {
       ui_out_text(uiout, "momentary_bp_buffer mapping: shmid is invalid\n");
     }
 
-  gdb_assert(shmid > 0);
-
-  /* Get shm pointer */
-  pShm = (void*)shmat(shmid, NULL, 0);
-
   gdb_assert(pShm != NULL);
 
   return pShm;
@@ -336,60 +515,104 @@ void* hsail_tdep_map_momentary_bp_buffer(void)
 void* hsail_tdep_map_wave_buffer(void)
 {
   struct ui_out* uiout = current_uiout;
-
   void* pShm = NULL;
-  int shmid = -1;
-  const int max_shared_mem_size = hsail_get_wave_buffer_shmem_max_size();
 
   gdb_assert(NULL != uiout);
-  /*1M used is hard wired for now*/
 
   if (hsail_is_focus_device() == false || is_hsail_linux_initialized() == false)
     {
       return NULL;
     }
 
-  shmid = shmget(hsail_get_wave_buffer_shmem_key(), max_shared_mem_size, 0666);
+  pShm = hsail_tdep_attach_shmem(HSAIL_SHMEM_WAVE);
 
-  if (shmid <= 0)
+  if (pShm == NULL)
     {
       ui_out_text(uiout, "wave info buffer mapping: shmid is invalid\n");
     }
 
-  gdb_assert(shmid > 0);
-
-  /* Get shm pointer */
-  pShm = (void*)shmat(shmid, NULL, 0);
-
   gdb_assert(pShm != NULL);
 
   return pShm;
 }
 
-void hsail_tdep_unmap_wave_buffer(void* pShm)
+/* Map and unmap the variable read buffer from the shared memory.
+ * Unlike the other buffers, a missing segment is not an error since older agents
+ * do not create it, so NULL is returned and the caller falls back to GetVarValue
+ * */
+void* hsail_tdep_map_variable_read_buffer(void)
 {
-  struct ui_out* uiout = current_uiout;
-  gdb_assert(NULL != uiout);
-  gdb_assert(NULL != pShm);
-
-  /* Detach shared memory */
-  if (shmdt(pShm) == -1)
+  if (hsail_is_focus_device() == false || is_hsail_linux_initialized() == false)
     {
-      ui_out_text(uiout, "GDB: Error detaching wave info buffer\n");
+      return NULL;
     }
+
+  return hsail_tdep_attach_shmem(HSAIL_SHMEM_VARIABLE_READ);
 }
 
-void hsail_tdep_unmap_momentary_bp_buffer(void* pShm)
+/* Map the breakpoint statistics buffer from the shared memory.
+ * The counters are kept for all the devices, so unlike the other buffers this one
+ * does not need the focus device. NULL is returned if the agent does not keep statistics
+ * */
+void* hsail_tdep_map_breakpoint_statistics_buffer(void)
 {
-  struct ui_out* uiout = current_uiout;
-  gdb_assert(NULL != uiout);
-  gdb_assert(NULL != pShm);
+  if (is_hsail_linux_initialized() == false)
+    {
+      return NULL;
+    }
 
-  /* Detach shared memory */
-  if (shmdt(pShm) == -1)
+  return hsail_tdep_attach_shmem(HSAIL_SHMEM_BREAKPOINT_STATISTICS);
+}
+
+/* Map the variable gather buffer from the shared memory.
+ * NULL is returned if the agent cannot gather variables from many work-items
+ * */
+void* hsail_tdep_map_variable_gather_buffer(void)
+{
+  if (hsail_is_focus_device() == false || is_hsail_linux_initialized() == false)
     {
-      ui_out_text(uiout, "GDB: Error detaching momentary bp buffer\n");
+      return NULL;
     }
+
+  return hsail_tdep_attach_shmem(HSAIL_SHMEM_VARIABLE_GATHER);
+}
+
+/* The unmap functions only check that the buffer is the attached one,
+ * the segments stay attached until hsail_tdep_detach_all_shmem is called */
+static void hsail_tdep_unmap_shmem(const HsailShmemBuffer buffer, void* pShm)
+{
+  gdb_assert(NULL != pShm);
+  gdb_assert(pShm == gs_hsail_shmem_mappings[buffer].pShm);
+}
+
+void hsail_tdep_unmap_binary_buffer(void* pShm)
+{
+  hsail_tdep_unmap_shmem(HSAIL_SHMEM_BINARY, pShm);
+}
+
+void hsail_tdep_unmap_variable_read_buffer(void* pShm)
+{
+  hsail_tdep_unmap_shmem(HSAIL_SHMEM_VARIABLE_READ, pShm);
+}
+
+void hsail_tdep_unmap_wave_buffer(void* pShm)
+{
+  hsail_tdep_unmap_shmem(HSAIL_SHMEM_WAVE, pShm);
+}
+
+void hsail_tdep_unmap_momentary_bp_buffer(void* pShm)
+{
+  hsail_tdep_unmap_shmem(HSAIL_SHMEM_MOMENTARY_BP, pShm);
+}
+
+void hsail_tdep_unmap_breakpoint_statistics_buffer(void* pShm)
+{
+  hsail_tdep_unmap_shmem(HSAIL_SHMEM_BREAKPOINT_STATISTICS, pShm);
+}
+
+void hsail_tdep_unmap_variable_gather_buffer(void* pShm)
+{
+  hsail_tdep_unmap_shmem(HSAIL_SHMEM_VARIABLE_GATHER, pShm);
 }
 /*
  * This function should be called only once, for each run of the inferior
@@ -436,6 +659,16 @@ void hsail_linux_close(void)
         }
 
 
+      /* Keep the final hit counts, the statistics buffer is deleted below */
+      hsail_breakpoint_refresh_all_statistics();
+
+      /* The cached debug info is only valid for this inferior */
+      hsail_free_hwdbginfo();
+      hsail_dbginfo_cache_clear();
+
+      /* Detach our own mappings before deleting the segments */
+      hsail_tdep_detach_all_shmem();
+
       /* We can assert on is_shm_closed() since if the shared memory ID cannot be found,
        * we just dont do the deletion. The assertion catches what happened during the
        * actual deletion
@@ -447,7 +680,8 @@ void hsail_linux_close(void)
         }
       gdb_assert(is_shm_closed == true);
 
-      is_shm_closed = hsail_linux_delete_shmem(g_WAVE_BUFFER_SHMKEY, g_WAVE_BUFFER_MAXSIZE);
+      /* The wave buffer has no fixed size, 0 finds it whatever its size */
+      is_shm_closed = hsail_linux_delete_shmem(g_WAVE_BUFFER_SHMKEY, 0);
       if (!is_shm_closed)
         {
           ui_out_text(uiout, "GDB: Wave buffer could not be detached\n");
@@ -461,6 +695,27 @@ void hsail_linux_close(void)
         }
       gdb_assert(is_shm_closed == true);
 
+      is_shm_closed = hsail_linux_delete_shmem(g_VARIABLE_READ_BUFFER_SHMKEY, g_VARIABLE_READ_BUFFER_MAXSIZE);
+      if (!is_shm_closed)
+        {
+          ui_out_text(uiout, "GDB: Variable read buffer could not be detached\n");
+        }
+      gdb_assert(is_shm_closed == true);
+
+      is_shm_closed = hsail_linux_delete_shmem(g_BREAKPOINT_STATISTICS_SHMKEY, g_BREAKPOINT_STATISTICS_MAXSIZE);
+      if (!is_shm_closed)
+        {
+          ui_out_text(uiout, "GDB: Breakpoint statistics buffer could not be detached\n");
+        }
+      gdb_assert(is_shm_closed == true);
+
+      is_shm_closed = hsail_linux_delete_shmem(g_VARIABLE_GATHER_BUFFER_SHMKEY, g_VARIABLE_GATHER_BUFFER_MAXSIZE);
+      if (!is_shm_closed)
+        {
+          ui_out_text(uiout, "GDB: Variable gather buffer could not be detached\n");
+        }
+      gdb_assert(is_shm_closed == true);
+
       /* Explicitly set state that denotes that the hsail agent is no longer there
        * by setting the  global state for closed
        *
@@ -476,6 +731,8 @@ void hsail_linux_close(void)
       gs_stage1_has_run = false;
       gs_stage2_has_run = false;
 
+      hsail_tdep_clear_notification_buffer();
+
     }
 
   gdb_assert(is_hsail_linux_initialized() == 0);
@@ -505,29 +762,20 @@ bool hsail_is_focus_device(void)
 
 uint64_t hsail_get_current_pc(void)
 {
-  uint64_t ret = 0;
-  int num_waves = hsail_tdep_get_active_wave_count();
-  HsailAgentWaveInfo* wave_info_buffer = (HsailAgentWaveInfo*)hsail_tdep_map_wave_buffer();
-
-  /* The wave address can be NULL if the user enters print hsail:foo
+  /* There are no waves if the user enters print hsail:foo
    * when we are not in kernel debugging
    * */
 
   /* assuming the for this version the addr is taken from wave[0] addr
    * In future we need to get from the user which wave he wants the addr to be taken from (maybe print hsail:var:wave)
    */
-  if (NULL == wave_info_buffer || 0 >= num_waves)
+  if (0 >= hsail_wave_index_num_waves())
   {
     /* At this point we should have at least one wave */
     return 0;
   }
 
-  ret = wave_info_buffer[0].pc;
-
-  /* release the wave buffer */
-  hsail_tdep_unmap_wave_buffer((void*)wave_info_buffer);
-
-  return ret;
+  return hsail_wave_index_pc(0);
 }
 
 bool hsail_is_signal_from_agent(const char* signal_name)
@@ -585,12 +833,6 @@ int hsail_get_wave_buffer_shmem_key(void)
   return g_WAVE_BUFFER_SHMKEY;
 }
 
-/* Return the max size for the shared mem location that has the wave info*/
-const int hsail_get_wave_buffer_shmem_max_size(void)
-{
-  return g_WAVE_BUFFER_MAXSIZE;
-}
-
 /* Return the key for the shared mem location that has the momentary bp list*/
 int hsail_get_momentary_bp_buffer_shmem_key(void)
 {
@@ -603,6 +845,30 @@ const int hsail_get_momentary_bp_buffer_shmem_max_size(void)
   return g_MOMENTARY_BP_BUFFER_MAXSIZE;
 }
 
+/* Return the key for the shared mem location used for batched variable reads*/
+int hsail_get_variable_read_buffer_shmem_key(void)
+{
+  return g_VARIABLE_READ_BUFFER_SHMKEY;
+}
+
+/* Return the max size for the shared mem location used for batched variable reads*/
+const int hsail_get_variable_read_buffer_shmem_max_size(void)
+{
+  return g_VARIABLE_READ_BUFFER_MAXSIZE;
+}
+
+/* Return the max size for the shared mem location that has the breakpoint statistics*/
+const int hsail_get_breakpoint_statistics_shmem_max_size(void)
+{
+  return g_BREAKPOINT_STATISTICS_MAXSIZE;
+}
+
+/* Return the max size for the shared mem location used to gather variables from many work-items*/
+const int hsail_get_variable_gather_buffer_shmem_max_size(void)
+{
+  return g_VARIABLE_GATHER_BUFFER_MAXSIZE;
+}
+
 /* Just a debugging helper function */
 void hsail_tdep_print_notification_type(const HsailNotification notification)
 {
@@ -653,198 +919,304 @@ void hsail_tdep_print_notification_type(const HsailNotification notification)
         printf("Notification Type: HSAIL_NOTIFY_KILL_COMPLETE \n");
         break;
       }
+    case HSAIL_NOTIFY_PROTOCOL_VERSION:
+      {
+        printf("Notification Type: HSAIL_NOTIFY_PROTOCOL_VERSION \n");
+        break;
+      }
+    case HSAIL_NOTIFY_COMMAND_BATCH_COMPLETE:
+      {
+        printf("Notification Type: HSAIL_NOTIFY_COMMAND_BATCH_COMPLETE \n");
+        break;
+      }
     default:
       printf_filtered("Unsupported notification type");
   }
 }
-/*
- * This function is called from "handle_file_event (event_data data)"
- * in eventloop.c
- */
-void handle_hsail_event(int err, gdb_client_data client_data)
+/* Act on one notification from the agent */
+static void hsail_tdep_handle_notification(HsailNotificationPayload* fifo_data)
 {
-
-  struct ui_out* uiout = current_uiout;
-  int read_status = 0;
-  int bytes_read = 0;
   bool ret_code = false;
-  HsailNotificationPayload fifo_data;
   HwDbgInfo_debug dbg = NULL;
 
-  gdb_assert(NULL != uiout);
-
-  /* Just a debug counter to track how many times the
-   * handle_hsail_event function is called, result printed in linux_nat_close()
-   * */
-  gs_num_handle_event_function_calls = gs_num_handle_event_function_calls + 1;
+  /* Logging function to view notifications */
+  /* hsail_tdep_print_notification_type(fifo_data->m_Notification);*/
 
-  memset(&fifo_data,0,sizeof(HsailNotificationPayload));
-  bytes_read  = read(hsail_get_read_fifo_handler(),
-          &fifo_data,
-          sizeof(HsailNotificationPayload));
-
-  /* save errno to a local variable*/
-  read_status = errno;
+  switch (fifo_data->m_Notification)
+  {
+    case HSAIL_NOTIFY_NEW_BINARY:
+      {
+        /* On this event,
+         * 1) Drop the existing debug facilities object. We can do this since we know that
+         * only one binary is active at any point in time, so the new binary notification
+         * should come after the previous kernel has ended debugging.
+         * The debug info cache keeps the object in case the code object is dispatched again
+         *
+         * 2) initialize debug facilities with the new binary, or get it from the cache
+         * 3) flush the command buffer if there is anything left
+         * 4) Add the dispatch to the list of kernels, and if a new kernel save to a file
+         * */
+        hsail_free_hwdbginfo();
+        hsail_tdep_shmem_updated(HSAIL_SHMEM_BINARY);
+
+        /* We set to HSAIL_AGENT_BINARY_AVAILABLE just to let hsail_init_hwdbginfo
+         * know about the new binary
+         * */
+        hsail_dbginfo_set_facilities_status(HSAIL_AGENT_BINARY_AVAILABLE);
+
+        /* We set to HSAIL_AGENT_BINARY_AVAILABLE if hsail_init_hwdbginfo
+         * can initialize debug facilities with the new binary available.
+         *
+         * If the initialization fails, we restore the status to HSAIL_AGENT_BINARY_UNKNOWN
+         * */
+
+        dbg = NULL;
+        dbg = hsail_init_hwdbginfo(fifo_data);
+        if (dbg != NULL)
+          {
+            hsail_dbginfo_set_facilities_status(HSAIL_AGENT_BINARY_AVAILABLE);
+            ret_code = hsail_kernel_add_dispatch(fifo_data);
+            gdb_assert(ret_code == true);
 
-  /* We need to figure out why the event-loop implementation is called multiple times
-   * when the FIFO is not ready with new data
-   * This is not treated as a error for now
-   * */
-  if (bytes_read == -1 && read_status == EAGAIN)
-    {
-      return;
-    }
+          }
+        else
+          {
+            printf_filtered("HSAIL kernel source debugging will not occur\n");
+            hsail_dbginfo_set_facilities_status(HSAIL_AGENT_BINARY_UNKNOWN);
+          }
+        hsail_flush_breakpoint_command_buffer();
 
-  /*
-   * Since the read fifo is created in a nonblocking manner.
-   * The read returns instantly if there is no data on the fifo
-   * with bytesRead = 0
-   * */
-  if (bytes_read != sizeof(HsailNotificationPayload))
-    {
-      /* We have some unusual error code.
-       * We should atleast print it for now
-       * This commonly happens if the shared header used between GDB and the agent are not in sync
-       * */
-      if(bytes_read != 0)
+        break;
+      }
+    case HSAIL_NOTIFY_PREDISPATCH_STATE:
       {
-          printf_filtered("Handle_hsail_event error %d\t Bytes read %d\t ",err, bytes_read);
-          printf_filtered("Read fifo errno:  %d \n", read_status);
+        gdb_assert(fifo_data->payload.PredispatchNotification.m_predispatchState
+                   != HSAIL_PREDISPATCH_STATE_UNKNOWN);
+        gs_hsail_predispatch_state = fifo_data->payload.PredispatchNotification.m_predispatchState;
+        break;
       }
-    }
-  else
-    {
-      /* Based on the data the agent sent us, call the right function in hsail-* files */
+    case HSAIL_NOTIFY_START_DEBUG_THREAD:
+      {
+        hsail_infcmd_set_dispatch_thread_pid(fifo_data->payload.StartDebugThreadNotification.m_tid);
+        break;
+      }
+    case HSAIL_NOTIFY_BREAKPOINT_HIT:
+      {
+        hsail_breakpoint_update_statistics(fifo_data->payload.BreakpointHit.m_breakpointId,
+                                           fifo_data->payload.BreakpointHit.m_hitCount,
+                                           HSAIL_MAX_REPORTABLE_BREAKPOINTS);
 
-      /* Logging function to view notifications */
-      /* hsail_tdep_print_notification_type(fifo_data.m_Notification);*/
+        hsail_tdep_set_active_wave_count(fifo_data->payload.BreakpointHit.m_numActiveWaves);
+        /* The waves have moved, the index is updated or rebuilt on the next query */
+        hsail_tdep_shmem_updated(HSAIL_SHMEM_WAVE);
 
-      switch (fifo_data.m_Notification)
+        break;
+      }
+    case HSAIL_NOTIFY_BEGIN_DEBUGGING:
       {
-        case HSAIL_NOTIFY_NEW_BINARY:
+        gs_is_hsail_focus_device = true;
+        hsail_tdep_set_active_wave_count(0);
+        break;
+      }
+    case HSAIL_NOTIFY_END_DEBUGGING:
+      {
+        /*We now focus on the host*/
+        gs_is_hsail_focus_device = false;
+
+        /* The binary we have now is invalid if and only if the dispatch has completed.
+         *
+         * This check handles cases where we end debugging with the DISABLE_DISPATCH
+         * behavior flag and then restart debugging within the callback.
+         */
+        if (fifo_data->payload.EndDebugNotification.hasDispatchCompleted)
           {
-            /* On this event,
-             * 1) Free any existing debug facilities objects. We can do this since we know that
-             * only one binary is active at any point in time, so the new binary notification
-             * should come after the previous kernel has ended debugging
-             *
-             * 2) initialize debug facilities with the new binary
-             * 3) flush the command buffer if there is anything left
-             * 4) Add the dispatch to the list of kernels, and if a new kernel save to a file
-             * */
-            hsail_free_hwdbginfo();
-
-            /* We set to HSAIL_AGENT_BINARY_AVAILABLE just to let hsail_init_hwdbginfo
-             * know about the new binary
-             * */
-            hsail_dbginfo_set_facilities_status(HSAIL_AGENT_BINARY_AVAILABLE);
+            hsail_dbginfo_set_facilities_status(HSAIL_AGENT_BINARY_UNKNOWN);
+          }
 
-            /* We set to HSAIL_AGENT_BINARY_AVAILABLE if hsail_init_hwdbginfo
-             * can initialize debug facilities with the new binary available.
-             *
-             * If the initialization fails, we restore the status to HSAIL_AGENT_BINARY_UNKNOWN
-             * */
+        hsail_tdep_set_active_wave_count(0);
+        hsail_cmd_clear_focus();
 
-            dbg = NULL;
-            dbg = hsail_init_hwdbginfo(&fifo_data);
-            if (dbg != NULL)
+        /* The agent may free the buffers once the session is over */
+        hsail_tdep_detach_all_shmem();
+        break;
+      }
+    case HSAIL_NOTIFY_FOCUS_CHANGE:
+      {
+        hsail_cmd_set_focus(fifo_data->payload.FocusChange.m_focusWorkGroup,
+                            fifo_data->payload.FocusChange.m_focusWorkItem);
+        break;
+      }
+    case HSAIL_NOTIFY_AGENT_ERROR:
+      {
+        printf_filtered("Agent Error: %d \n", fifo_data->payload.AgentErrorNotification.m_errorCode);
+        break;
+      }
+    case HSAIL_NOTIFY_KILL_COMPLETE:
+      {
+        if (fifo_data->payload.KillCompleteNotification.killSuccessful)
+          {
+            if (fifo_data->payload.KillCompleteNotification.isQuitCommandIssued)
               {
-                hsail_dbginfo_set_facilities_status(HSAIL_AGENT_BINARY_AVAILABLE);
-                ret_code = hsail_kernel_add_dispatch(&fifo_data);
-                gdb_assert(ret_code == true);
-
+                quit_command_complete();
               }
             else
               {
-                printf_filtered("HSAIL kernel source debugging will not occur\n");
-                hsail_dbginfo_set_facilities_status(HSAIL_AGENT_BINARY_UNKNOWN);
+                kill_command_complete();
               }
-            hsail_flush_breakpoint_command_buffer();
-
-            break;
           }
-        case HSAIL_NOTIFY_PREDISPATCH_STATE:
+        else
           {
-            gdb_assert(fifo_data.payload.PredispatchNotification.m_predispatchState
-                       != HSAIL_PREDISPATCH_STATE_UNKNOWN);
-            gs_hsail_predispatch_state = fifo_data.payload.PredispatchNotification.m_predispatchState;
-            break;
+            printf_filtered("Could not kill waves safely");
           }
-        case HSAIL_NOTIFY_START_DEBUG_THREAD:
-          {
-            hsail_infcmd_set_dispatch_thread_pid(fifo_data.payload.StartDebugThreadNotification.m_tid);
-            break;
-          }
-        case HSAIL_NOTIFY_BREAKPOINT_HIT:
-          {
-            hsail_breakpoint_update_statistics(fifo_data.payload.BreakpointHit.m_breakpointId,
-                                               fifo_data.payload.BreakpointHit.m_hitCount,
-                                               HSAIL_MAX_REPORTABLE_BREAKPOINTS);
-
-            hsail_tdep_set_active_wave_count(fifo_data.payload.BreakpointHit.m_numActiveWaves);
+        break;
+      }
+    case HSAIL_NOTIFY_PROTOCOL_VERSION:
+      {
+        hsail_fifo_set_protocol_version(fifo_data->payload.ProtocolVersionNotification.m_protocolVersion);
+        break;
+      }
+    case HSAIL_NOTIFY_COMMAND_BATCH_COMPLETE:
+      {
+        hsail_fifo_command_batch_complete(fifo_data->payload.CommandBatchCompleteNotification.m_batchId,
+                                          fifo_data->payload.CommandBatchCompleteNotification.m_numCommandsApplied,
+                                          fifo_data->payload.CommandBatchCompleteNotification.m_status);
+        break;
+      }
+    default:
+      printf_filtered("Unsupported notification type");
+  }
+}
 
-            break;
-          }
-        case HSAIL_NOTIFY_BEGIN_DEBUGGING:
-          {
-            gs_is_hsail_focus_device = true;
-            hsail_tdep_set_active_wave_count(0);
-            break;
-          }
-        case HSAIL_NOTIFY_END_DEBUGGING:
-          {
-            /*We now focus on the host*/
-            gs_is_hsail_focus_device = false;
-
-            /* The binary we have now is invalid if and only if the dispatch has completed.
-             *
-             * This check handles cases where we end debugging with the DISABLE_DISPATCH
-             * behavior flag and then restart debugging within the callback.
-             */
-            if (fifo_data.payload.EndDebugNotification.hasDispatchCompleted)
-              {
-                hsail_dbginfo_set_facilities_status(HSAIL_AGENT_BINARY_UNKNOWN);
-              }
+/* Can the notification be dropped because the next one supersedes it */
+static bool hsail_tdep_is_notification_superseded(const HsailNotificationPayload* notification,
+                                                  const HsailNotificationPayload* next_notification)
+{
+  bool retVal = false;
 
-            hsail_tdep_set_active_wave_count(0);
-            hsail_cmd_clear_focus();
-            break;
-          }
+  if (notification->m_Notification == next_notification->m_Notification)
+    {
+      switch (notification->m_Notification)
+      {
+        /* These only set a state, the last one wins */
         case HSAIL_NOTIFY_FOCUS_CHANGE:
-          {
-            hsail_cmd_set_focus(fifo_data.payload.FocusChange.m_focusWorkGroup,
-                                fifo_data.payload.FocusChange.m_focusWorkItem);
-            break;
-          }
-        case HSAIL_NOTIFY_AGENT_ERROR:
-          {
-            printf_filtered("Agent Error: %d \n", fifo_data.payload.AgentErrorNotification.m_errorCode);
-            break;
-          }
-        case HSAIL_NOTIFY_KILL_COMPLETE:
-          {
-            if (fifo_data.payload.KillCompleteNotification.killSuccessful)
-              {
-                if (fifo_data.payload.KillCompleteNotification.isQuitCommandIssued)
-                  {
-                    quit_command_complete();
-                  }
-                else
-                  {
-                    kill_command_complete();
-                  }
-              }
-            else
-              {
-                printf_filtered("Could not kill waves safely");
-              }
-            break;
-          }
+        case HSAIL_NOTIFY_PREDISPATCH_STATE:
+          retVal = true;
+          break;
         default:
-          printf_filtered("Unsupported notification type");
+          break;
       }
     }
 
+  return retVal;
+}
+
+/* Handle all the complete notifications in the buffer, in order,
+ * and keep the incomplete one, if any, for the next read.
+ * Each notification leaves the buffer before it is handled, so that
+ * a handler that throws does not get it again on the next event
+ * */
+static void hsail_tdep_handle_buffered_notifications(void)
+{
+  HsailNotificationPayload fifo_data;
+  bool is_superseded = false;
+
+  while (sizeof(HsailNotificationPayload) <= gs_hsail_notification_buffer_len)
+    {
+      is_superseded = (2 * sizeof(HsailNotificationPayload) <= gs_hsail_notification_buffer_len)
+                      && hsail_tdep_is_notification_superseded(&gs_hsail_notification_buffer[0],
+                                                               &gs_hsail_notification_buffer[1]);
+
+      /* The handlers get a copy, since they may reset the buffer (e.g. if the inferior is killed) */
+      memcpy(&fifo_data, &gs_hsail_notification_buffer[0], sizeof(HsailNotificationPayload));
+
+      /* Take the notification out of the buffer, this also moves the incomplete one to the front */
+      gs_hsail_notification_buffer_len -= sizeof(HsailNotificationPayload);
+      memmove(gs_hsail_notification_buffer,
+              &gs_hsail_notification_buffer[1],
+              gs_hsail_notification_buffer_len);
+
+      if (!is_superseded)
+        {
+          hsail_tdep_handle_notification(&fifo_data);
+        }
+    }
+}
+
+/*
+ * This function is called from "handle_file_event (event_data data)"
+ * in eventloop.c
+ *
+ * The fifo is drained on each call, so that a burst of notifications
+ * is handled in one pass of the event loop.
+ */
+void handle_hsail_event(int err, gdb_client_data client_data)
+{
+  struct ui_out* uiout = current_uiout;
+  struct cleanup* old_chain = NULL;
+  const size_t buffer_size = sizeof(gs_hsail_notification_buffer);
+  bool is_fifo_drained = false;
+  int read_status = 0;
+  ssize_t bytes_read = 0;
+
+  gdb_assert(NULL != uiout);
+
+  /* Just a debug counter to track how many times the
+   * handle_hsail_event function is called, result printed in linux_nat_close()
+   * */
+  gs_num_handle_event_function_calls = gs_num_handle_event_function_calls + 1;
+
+  /* A handler may end up back in the event loop, the nested call leaves the data
+   * in the fifo, the event fires again once we are done
+   * */
+  if (gs_is_handling_notifications)
+    {
+      return;
+    }
+
+  /* The flag is cleared even if a handler throws, otherwise the fifo is never read again */
+  old_chain = make_cleanup_restore_integer(&gs_is_handling_notifications);
+  gs_is_handling_notifications = 1;
+
+  while (!is_fifo_drained && 0 < g_hsail_fifo_read_descriptor)
+    {
+      bytes_read = read(g_hsail_fifo_read_descriptor,
+                        (gdb_byte*)gs_hsail_notification_buffer + gs_hsail_notification_buffer_len,
+                        buffer_size - gs_hsail_notification_buffer_len);
+
+      /* save errno to a local variable*/
+      read_status = errno;
+
+      if (0 < bytes_read)
+        {
+          gs_hsail_notification_buffer_len += bytes_read;
+        }
+      else if (-1 == bytes_read && EINTR == read_status)
+        {
+          continue;
+        }
+      else
+        {
+          /*
+           * Since the read fifo is created in a nonblocking manner,
+           * the read returns EAGAIN once the fifo is empty, and 0 if the agent closed it.
+           * Anything else is unusual, we should atleast print it for now
+           * */
+          if (-1 == bytes_read && EAGAIN != read_status)
+            {
+              printf_filtered("Handle_hsail_event error %d\t Bytes read %d\t ", err, (int)bytes_read);
+              printf_filtered("Read fifo errno:  %d \n", read_status);
+            }
+          is_fifo_drained = true;
+        }
+
+      /* Based on the data the agent sent us, call the right function in hsail-* files */
+      if (is_fifo_drained || buffer_size == gs_hsail_notification_buffer_len)
+        {
+          hsail_tdep_handle_buffered_notifications();
+        }
+    }
+
+  do_cleanups(old_chain);
 }
 
 
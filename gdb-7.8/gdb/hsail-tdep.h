@@ -71,6 +71,31 @@ int hsail_get_read_fifo_handler(void);
 
 int hsail_tdep_get_active_wave_count(void);
 
+/* The shared memory segments used to communicate with the agent */
+typedef enum
+{
+  HSAIL_SHMEM_BINARY,
+  HSAIL_SHMEM_WAVE,
+  HSAIL_SHMEM_MOMENTARY_BP,
+  HSAIL_SHMEM_VARIABLE_READ,
+  HSAIL_SHMEM_BREAKPOINT_STATISTICS,
+  HSAIL_SHMEM_VARIABLE_GATHER,
+  HSAIL_SHMEM_COUNT
+} HsailShmemBuffer;
+
+/* Incremented every time the agent rewrites the segment or the segment is detached */
+unsigned int hsail_tdep_get_shmem_generation(const HsailShmemBuffer buffer);
+
+/* The size of the attached segment, 0 if it is not attached */
+size_t hsail_tdep_get_shmem_size(const HsailShmemBuffer buffer);
+
+/* Detach all the segments attached in this debugging session */
+void hsail_tdep_detach_all_shmem(void);
+
+void* hsail_tdep_map_binary_buffer(void);
+
+void hsail_tdep_unmap_binary_buffer(void* pShm);
+
 void* hsail_tdep_map_momentary_bp_buffer(void);
 
 void* hsail_tdep_map_wave_buffer(void);
@@ -79,6 +104,18 @@ void hsail_tdep_unmap_wave_buffer(void* pShm);
 
 void hsail_tdep_unmap_momentary_bp_buffer(void* pShm);
 
+void* hsail_tdep_map_variable_read_buffer(void);
+
+void hsail_tdep_unmap_variable_read_buffer(void* pShm);
+
+void* hsail_tdep_map_breakpoint_statistics_buffer(void);
+
+void hsail_tdep_unmap_breakpoint_statistics_buffer(void* pShm);
+
+void* hsail_tdep_map_variable_gather_buffer(void);
+
+void hsail_tdep_unmap_variable_gather_buffer(void* pShm);
+
 /*
  * Get the keys and max sizes for all shared memory segments.
  *
@@ -93,12 +130,18 @@ const int hsail_get_agent_binary_shmem_max_size(void);
 
 int hsail_get_wave_buffer_shmem_key(void);
 
-const int hsail_get_wave_buffer_shmem_max_size(void);
-
 int hsail_get_momentary_bp_buffer_shmem_key(void);
 
 const int hsail_get_momentary_bp_buffer_shmem_max_size(void);
 
+int hsail_get_variable_read_buffer_shmem_key(void);
+
+const int hsail_get_variable_read_buffer_shmem_max_size(void);
+
+const int hsail_get_breakpoint_statistics_shmem_max_size(void);
+
+const int hsail_get_variable_gather_buffer_shmem_max_size(void);
+
 /* Function to handle each hsail event */
 void handle_hsail_event(int err, gdb_client_data client_data);
 
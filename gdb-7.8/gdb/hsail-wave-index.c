@@ -0,0 +1,869 @@
+/*
+   HSAIL index of the active waves by work-group and work-item
+
+   Copyright (c) 2015 ADVANCED MICRO DEVICES, INC.  All rights reserved.
+   This file includes code originally published under
+
+   Copyright (C) 1986-2014 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <string.h>
+#include <stdbool.h>
+
+/* GDB headers */
+#include "defs.h"
+#include "gdb_assert.h"
+#include "hashtab.h"
+
+#include "hsail-kernel.h"
+#include "hsail-lanes.h"
+#include "hsail-tdep.h"
+#include "hsail-utils.h"
+#include "hsail-wave-index.h"
+
+#include "CommunicationControl.h"
+
+/* The index is valid while gs_index_generation matches the wave buffer generation */
+static bool gs_index_valid = false;
+static unsigned int gs_index_generation = 0;
+
+/* The arrays of the wave buffer snapshot, see HsailWaveSnapshotHeader */
+static const HsailWaveSnapshotHeader* gs_snapshot = NULL;
+static const HsailWaveDim3* gs_workgroup_ids = NULL;
+static const HsailWaveDim3* gs_base_workitem_ids = NULL;
+static const uint64_t* gs_exec_masks = NULL;
+static const HsailWaveAddress* gs_wave_addresses = NULL;
+static const HsailProgramCounter* gs_pcs = NULL;
+static const HsailWaveLaneOverride* gs_lane_overrides = NULL;
+static int gs_num_waves = 0;
+
+/* The sequence of the snapshot the index matches, 0 for a version 1 snapshot */
+static uint64_t gs_sequence = 0;
+
+/* The changed-waves bitmap and delta records, NULL for a version 1 snapshot */
+static const unsigned char* gs_changed_wave_bitmap = NULL;
+static const HsailWaveDeltaRecord* gs_delta_records = NULL;
+
+/* The changed waves, only listed when they are asked for */
+static int* gs_moved_waves = NULL;
+static int gs_num_moved_waves = -1;
+
+/* The work-groups in the order their first wave appears in the wave buffer */
+static struct hsail_wave_index_workgroup* gs_workgroups = NULL;
+static int gs_num_workgroups = 0;
+
+/* The wave indexes grouped by work-group, each work-group points to its slice */
+static int* gs_wave_order = NULL;
+
+static htab_t gs_workgroup_htab = NULL;
+static htab_t gs_flattened_id_htab = NULL;
+
+/* The snapshot built from the wave buffer of an agent that predates the snapshot */
+static HsailWaveSnapshotHeader* gs_legacy_snapshot = NULL;
+
+/* A wave buffer that could not be read is only reported once */
+static bool gs_is_buffer_rejected = false;
+static unsigned int gs_rejected_generation = 0;
+
+static hashval_t hsail_wave_index_hash_dim3(const HsailWaveDim3* dim)
+{
+  hashval_t hash = dim->x;
+  hash = hash * 31 + dim->y;
+  hash = hash * 31 + dim->z;
+  return hash;
+}
+
+static hashval_t hsail_wave_index_workgroup_hash(const void* p)
+{
+  const struct hsail_wave_index_workgroup* wg = p;
+  return hsail_wave_index_hash_dim3(&wg->work_group_id);
+}
+
+static int hsail_wave_index_workgroup_eq(const void* p1, const void* p2)
+{
+  const struct hsail_wave_index_workgroup* wg1 = p1;
+  const struct hsail_wave_index_workgroup* wg2 = p2;
+  return hsail_utils_compare_wavedim3(&wg1->work_group_id, &wg2->work_group_id);
+}
+
+static hashval_t hsail_wave_index_flattened_id_hash(const void* p)
+{
+  const struct hsail_wave_index_workgroup* wg = p;
+  return (hashval_t)wg->flattened_id;
+}
+
+static int hsail_wave_index_flattened_id_eq(const void* p1, const void* p2)
+{
+  const struct hsail_wave_index_workgroup* wg1 = p1;
+  const struct hsail_wave_index_workgroup* wg2 = p2;
+  return wg1->flattened_id == wg2->flattened_id;
+}
+
+int hsail_wave_index_flattened_workgroup_id(const HsailWaveDim3* work_group_id)
+{
+  /* based on the equation in HSA programmer Ref page 22 sec 2.2.2 */
+  struct hsail_dispatch* active_dispatch = hsail_kernel_active_dispatch();
+  int workgroupnumX = 0;
+  int workgroupnumY = 0;
+
+  gdb_assert(NULL != work_group_id);
+
+  if (NULL == active_dispatch)
+    {
+      return 0;
+    }
+
+  workgroupnumX = (active_dispatch->work_items.x == 0 ? 1 : active_dispatch->work_items.x) / (active_dispatch->work_groups_size.x == 0 ? 1 : active_dispatch->work_groups_size.x);
+  workgroupnumY = (active_dispatch->work_items.y == 0 ? 1 : active_dispatch->work_items.y) / (active_dispatch->work_groups_size.y == 0 ? 1 : active_dispatch->work_groups_size.y);
+
+  return work_group_id->x +
+         work_group_id->y * workgroupnumX +
+         work_group_id->z * workgroupnumX * workgroupnumY;
+}
+
+void hsail_wave_index_invalidate(void)
+{
+  if (gs_workgroup_htab != NULL)
+    {
+      htab_delete(gs_workgroup_htab);
+      gs_workgroup_htab = NULL;
+    }
+  if (gs_flattened_id_htab != NULL)
+    {
+      htab_delete(gs_flattened_id_htab);
+      gs_flattened_id_htab = NULL;
+    }
+
+  free_current_contents(&gs_workgroups);
+  free_current_contents(&gs_wave_order);
+  free_current_contents(&gs_moved_waves);
+  free_current_contents(&gs_legacy_snapshot);
+
+  gs_num_workgroups = 0;
+  gs_num_moved_waves = -1;
+  gs_num_waves = 0;
+  gs_snapshot = NULL;
+  gs_workgroup_ids = NULL;
+  gs_base_workitem_ids = NULL;
+  gs_exec_masks = NULL;
+  gs_wave_addresses = NULL;
+  gs_pcs = NULL;
+  gs_lane_overrides = NULL;
+  gs_sequence = 0;
+  gs_changed_wave_bitmap = NULL;
+  gs_delta_records = NULL;
+  gs_index_valid = false;
+}
+
+/* Check that an array of the snapshot lies within the snapshot */
+static bool hsail_wave_index_check_array(const HsailWaveSnapshotHeader* snapshot,
+                                         uint64_t offset, uint64_t count, size_t element_size)
+{
+  return offset >= snapshot->m_headerSize &&
+         offset <= snapshot->m_snapshotSize &&
+         count <= (snapshot->m_snapshotSize - offset) / element_size;
+}
+
+/* Point the arrays at the snapshot, returns false if the agent wrote
+ * another format or the snapshot does not fit in the attached segment */
+static bool hsail_wave_index_map_snapshot(const void* wave_buffer, size_t wave_buffer_size)
+{
+  const HsailWaveSnapshotHeader* snapshot = wave_buffer;
+  const char* base = wave_buffer;
+
+  bool is_delta_version = false;
+
+  /* A version 1 header ends before the delta fields */
+  if (wave_buffer_size < HSAIL_WAVE_SNAPSHOT_HEADER_SIZE_FULL ||
+      snapshot->m_magic != HSAIL_WAVE_SNAPSHOT_MAGIC ||
+      snapshot->m_version < HSAIL_WAVE_SNAPSHOT_VERSION_FULL ||
+      snapshot->m_version > HSAIL_WAVE_SNAPSHOT_VERSION ||
+      snapshot->m_headerSize < HSAIL_WAVE_SNAPSHOT_HEADER_SIZE_FULL ||
+      snapshot->m_snapshotSize > wave_buffer_size)
+    {
+      return false;
+    }
+
+  is_delta_version = (snapshot->m_version >= HSAIL_WAVE_SNAPSHOT_VERSION_DELTA);
+
+  if (is_delta_version &&
+      (snapshot->m_headerSize < sizeof(HsailWaveSnapshotHeader) ||
+       !hsail_wave_index_check_array(snapshot, snapshot->m_changedWaveBitmapOffset, (snapshot->m_numWaves + 7) / 8, 1) ||
+       !hsail_wave_index_check_array(snapshot, snapshot->m_deltaRecordOffset, snapshot->m_numDeltaRecords, sizeof(HsailWaveDeltaRecord))))
+    {
+      return false;
+    }
+
+  if (!hsail_wave_index_check_array(snapshot, snapshot->m_workGroupIdOffset, snapshot->m_numWaves, sizeof(HsailWaveDim3)) ||
+      !hsail_wave_index_check_array(snapshot, snapshot->m_baseWorkItemIdOffset, snapshot->m_numWaves, sizeof(HsailWaveDim3)) ||
+      !hsail_wave_index_check_array(snapshot, snapshot->m_execMaskOffset, snapshot->m_numWaves, sizeof(uint64_t)) ||
+      !hsail_wave_index_check_array(snapshot, snapshot->m_waveAddressOffset, snapshot->m_numWaves, sizeof(HsailWaveAddress)) ||
+      !hsail_wave_index_check_array(snapshot, snapshot->m_pcOffset, snapshot->m_numWaves, sizeof(HsailProgramCounter)) ||
+      !hsail_wave_index_check_array(snapshot, snapshot->m_laneOverrideOffset, snapshot->m_numLaneOverrides, sizeof(HsailWaveLaneOverride)))
+    {
+      return false;
+    }
+
+  gs_snapshot = snapshot;
+  gs_workgroup_ids = (const HsailWaveDim3*)(base + snapshot->m_workGroupIdOffset);
+  gs_base_workitem_ids = (const HsailWaveDim3*)(base + snapshot->m_baseWorkItemIdOffset);
+  gs_exec_masks = (const uint64_t*)(base + snapshot->m_execMaskOffset);
+  gs_wave_addresses = (const HsailWaveAddress*)(base + snapshot->m_waveAddressOffset);
+  gs_pcs = (const HsailProgramCounter*)(base + snapshot->m_pcOffset);
+  gs_lane_overrides = (const HsailWaveLaneOverride*)(base + snapshot->m_laneOverrideOffset);
+
+  if (is_delta_version)
+    {
+      gs_sequence = snapshot->m_sequence;
+      gs_changed_wave_bitmap = (const unsigned char*)(base + snapshot->m_changedWaveBitmapOffset);
+      gs_delta_records = (const HsailWaveDeltaRecord*)(base + snapshot->m_deltaRecordOffset);
+    }
+
+  return true;
+}
+
+static uint64_t hsail_wave_index_align(uint64_t offset)
+{
+  return (offset + 7) & ~(uint64_t)7;
+}
+
+/* Build a version 1 snapshot from the HsailAgentWaveInfo array of an agent that
+ * predates the snapshot. The ID of lane 0 is the base work-item ID of a wave, the
+ * active lanes whose ID does not follow from it become lane overrides.
+ * Returns NULL if the array does not fit in the attached segment */
+static HsailWaveSnapshotHeader* hsail_wave_index_convert_legacy(const void* wave_buffer, size_t wave_buffer_size, int num_waves)
+{
+  const HsailAgentWaveInfo* waves = wave_buffer;
+  struct hsail_dispatch* active_dispatch = hsail_kernel_active_dispatch();
+  HsailWaveSnapshotHeader header;
+  HsailWaveSnapshotHeader* snapshot = NULL;
+  HsailWaveLaneOverride* overrides = NULL;
+  char* base = NULL;
+  uint32_t num_overrides = 0;
+  int nWave = 0;
+  int lane = 0;
+
+  if (0 >= num_waves || (size_t)num_waves > wave_buffer_size / sizeof(HsailAgentWaveInfo))
+    {
+      return NULL;
+    }
+
+  memset(&header, 0, sizeof(header));
+  header.m_magic = HSAIL_WAVE_SNAPSHOT_MAGIC;
+  header.m_version = HSAIL_WAVE_SNAPSHOT_VERSION_FULL;
+  header.m_headerSize = sizeof(header);
+  header.m_numWaves = (uint32_t)num_waves;
+
+  /* The old buffer does not have the work-group size, the dispatch does */
+  if (NULL != active_dispatch)
+    {
+      header.m_workGroupSize = active_dispatch->work_groups_size;
+    }
+
+  for (nWave = 0; nWave < num_waves; nWave++)
+    {
+      for (lane = 0; lane < HSAIL_WAVE_LANES; lane++)
+        {
+          HsailWaveDim3 work_item_id;
+
+          if (0 == (waves[nWave].execMask & ((uint64_t)1 << lane)))
+            {
+              continue;
+            }
+
+          hsail_lanes_workitem_id(&waves[nWave].workItemId[0], lane, &header.m_workGroupSize, &work_item_id);
+          if (!hsail_utils_compare_wavedim3(&work_item_id, &waves[nWave].workItemId[lane]))
+            {
+              num_overrides++;
+            }
+        }
+    }
+
+  header.m_numLaneOverrides = num_overrides;
+  header.m_execMaskOffset = hsail_wave_index_align(sizeof(header));
+  header.m_pcOffset = header.m_execMaskOffset + num_waves * sizeof(uint64_t);
+  header.m_workGroupIdOffset = header.m_pcOffset + num_waves * sizeof(HsailProgramCounter);
+  header.m_baseWorkItemIdOffset = hsail_wave_index_align(header.m_workGroupIdOffset + num_waves * sizeof(HsailWaveDim3));
+  header.m_waveAddressOffset = hsail_wave_index_align(header.m_baseWorkItemIdOffset + num_waves * sizeof(HsailWaveDim3));
+  header.m_laneOverrideOffset = hsail_wave_index_align(header.m_waveAddressOffset + num_waves * sizeof(HsailWaveAddress));
+  header.m_snapshotSize = header.m_laneOverrideOffset + num_overrides * sizeof(HsailWaveLaneOverride);
+
+  base = XCNEWVEC(char, header.m_snapshotSize);
+  snapshot = (HsailWaveSnapshotHeader*)base;
+  *snapshot = header;
+  overrides = (HsailWaveLaneOverride*)(base + header.m_laneOverrideOffset);
+  num_overrides = 0;
+
+  for (nWave = 0; nWave < num_waves; nWave++)
+    {
+      ((uint64_t*)(base + header.m_execMaskOffset))[nWave] = waves[nWave].execMask;
+      ((HsailProgramCounter*)(base + header.m_pcOffset))[nWave] = waves[nWave].pc;
+      ((HsailWaveDim3*)(base + header.m_workGroupIdOffset))[nWave] = waves[nWave].workGroupId;
+      ((HsailWaveDim3*)(base + header.m_baseWorkItemIdOffset))[nWave] = waves[nWave].workItemId[0];
+      ((HsailWaveAddress*)(base + header.m_waveAddressOffset))[nWave] = waves[nWave].waveAddress;
+
+      for (lane = 0; lane < HSAIL_WAVE_LANES; lane++)
+        {
+          HsailWaveDim3 work_item_id;
+
+          if (0 == (waves[nWave].execMask & ((uint64_t)1 << lane)))
+            {
+              continue;
+            }
+
+          hsail_lanes_workitem_id(&waves[nWave].workItemId[0], lane, &header.m_workGroupSize, &work_item_id);
+          if (!hsail_utils_compare_wavedim3(&work_item_id, &waves[nWave].workItemId[lane]))
+            {
+              overrides[num_overrides].m_waveIndex = (uint32_t)nWave;
+              overrides[num_overrides].m_lane = (uint32_t)lane;
+              overrides[num_overrides].m_workItemId = waves[nWave].workItemId[lane];
+              num_overrides++;
+            }
+        }
+    }
+
+  return snapshot;
+}
+
+/* Update the index in place from a delta of the snapshot it was built from.
+ * The index only depends on the work-group of each wave, the other fields are
+ * read from the wave buffer when they are asked for, so only the delta records
+ * are looked at. Returns false if the index has to be rebuilt */
+static bool hsail_wave_index_update(const void* wave_buffer, size_t wave_buffer_size)
+{
+  const HsailWaveSnapshotHeader* old_snapshot = gs_snapshot;
+  const HsailWaveDim3* old_workgroup_ids = gs_workgroup_ids;
+  const HsailWaveDim3* old_base_workitem_ids = gs_base_workitem_ids;
+  const uint64_t* old_exec_masks = gs_exec_masks;
+  const HsailWaveAddress* old_wave_addresses = gs_wave_addresses;
+  const HsailProgramCounter* old_pcs = gs_pcs;
+  const HsailWaveLaneOverride* old_lane_overrides = gs_lane_overrides;
+  uint64_t old_sequence = gs_sequence;
+  uint32_t nRecord = 0;
+
+  if (wave_buffer != old_snapshot || 0 == old_sequence ||
+      !hsail_wave_index_map_snapshot(wave_buffer, wave_buffer_size))
+    {
+      return false;
+    }
+
+  /* The arrays must not have moved */
+  if (gs_snapshot->m_baseSequence != old_sequence ||
+      gs_snapshot->m_numWaves != (uint32_t)gs_num_waves ||
+      gs_workgroup_ids != old_workgroup_ids ||
+      gs_base_workitem_ids != old_base_workitem_ids ||
+      gs_exec_masks != old_exec_masks ||
+      gs_wave_addresses != old_wave_addresses ||
+      gs_pcs != old_pcs ||
+      gs_lane_overrides != old_lane_overrides)
+    {
+      return false;
+    }
+
+  for (nRecord = 0; nRecord < gs_snapshot->m_numDeltaRecords; nRecord++)
+    {
+      const HsailWaveDeltaRecord* record = &gs_delta_records[nRecord];
+
+      if (record->m_waveIndex >= (uint32_t)gs_num_waves ||
+          0 != (record->m_changedFields & HSAIL_WAVE_FIELD_WORK_GROUP_ID))
+        {
+          return false;
+        }
+    }
+
+  free_current_contents(&gs_moved_waves);
+  gs_num_moved_waves = -1;
+
+  return true;
+}
+
+/* Build the work-group tables in two passes over the waves:
+ * the first pass finds the work-groups and counts their waves,
+ * the second pass places each wave in its work-group's slice of gs_wave_order */
+static void hsail_wave_index_build(int num_waves)
+{
+  int* next_slot = NULL;
+  int nWave = 0;
+  int nWorkgroup = 0;
+  int offset = 0;
+
+  gs_num_waves = num_waves;
+
+  gs_workgroups = XCNEWVEC(struct hsail_wave_index_workgroup, num_waves);
+  gs_wave_order = XNEWVEC(int, num_waves);
+  gs_workgroup_htab = htab_create_alloc(num_waves, hsail_wave_index_workgroup_hash,
+                                        hsail_wave_index_workgroup_eq, NULL, xcalloc, xfree);
+  gs_flattened_id_htab = htab_create_alloc(num_waves, hsail_wave_index_flattened_id_hash,
+                                           hsail_wave_index_flattened_id_eq, NULL, xcalloc, xfree);
+
+  for (nWave = 0; nWave < num_waves; nWave++)
+    {
+      struct hsail_wave_index_workgroup key;
+      struct hsail_wave_index_workgroup* wg = NULL;
+      void** slot = NULL;
+
+      key.work_group_id = gs_workgroup_ids[nWave];
+      slot = htab_find_slot(gs_workgroup_htab, &key, INSERT);
+
+      if (*slot == NULL)
+        {
+          wg = &gs_workgroups[gs_num_workgroups];
+          wg->work_group_id = key.work_group_id;
+          wg->flattened_id = hsail_wave_index_flattened_workgroup_id(&key.work_group_id);
+          wg->index = gs_num_workgroups;
+          wg->num_waves = 0;
+          *slot = wg;
+          gs_num_workgroups++;
+
+          /* Keep the first work-group if two of them flatten to the same ID */
+          slot = htab_find_slot(gs_flattened_id_htab, wg, INSERT);
+          if (*slot == NULL)
+            {
+              *slot = wg;
+            }
+        }
+      else
+        {
+          wg = *slot;
+        }
+
+      wg->num_waves++;
+    }
+
+  next_slot = XNEWVEC(int, gs_num_workgroups);
+  for (nWorkgroup = 0; nWorkgroup < gs_num_workgroups; nWorkgroup++)
+    {
+      gs_workgroups[nWorkgroup].waves = gs_wave_order + offset;
+      next_slot[nWorkgroup] = offset;
+      offset += gs_workgroups[nWorkgroup].num_waves;
+    }
+
+  for (nWave = 0; nWave < num_waves; nWave++)
+    {
+      struct hsail_wave_index_workgroup key;
+      const struct hsail_wave_index_workgroup* wg = NULL;
+
+      key.work_group_id = gs_workgroup_ids[nWave];
+      wg = htab_find(gs_workgroup_htab, &key);
+      gdb_assert(NULL != wg);
+
+      gs_wave_order[next_slot[wg->index]++] = nWave;
+    }
+
+  xfree(next_slot);
+}
+
+/* Make sure the index matches the wave buffer, returns false if there are no waves */
+static bool hsail_wave_index_refresh(void)
+{
+  const void* wave_buffer = NULL;
+  size_t wave_buffer_size = 0;
+  int num_active_waves = hsail_tdep_get_active_wave_count();
+  unsigned int generation = hsail_tdep_get_shmem_generation(HSAIL_SHMEM_WAVE);
+  bool is_mapped = false;
+
+  /* The waves are gone once the agent reports the dispatch stopped running */
+  if (0 >= num_active_waves)
+    {
+      hsail_wave_index_invalidate();
+      return false;
+    }
+
+  if (gs_index_valid && generation == gs_index_generation)
+    {
+      return 0 < gs_num_waves;
+    }
+
+  if (gs_is_buffer_rejected && generation == gs_rejected_generation)
+    {
+      return false;
+    }
+
+  wave_buffer = hsail_tdep_map_wave_buffer();
+  if (NULL == wave_buffer)
+    {
+      hsail_wave_index_invalidate();
+      return false;
+    }
+
+  /* Stepping usually moves a few waves, which a delta snapshot lists */
+  if (gs_index_valid &&
+      hsail_wave_index_update(wave_buffer, hsail_tdep_get_shmem_size(HSAIL_SHMEM_WAVE)))
+    {
+      hsail_tdep_unmap_wave_buffer((void*)wave_buffer);
+      gs_index_generation = generation;
+      return true;
+    }
+
+  hsail_wave_index_invalidate();
+
+  wave_buffer_size = hsail_tdep_get_shmem_size(HSAIL_SHMEM_WAVE);
+
+  /* Agents that predate the snapshot write an array of HsailAgentWaveInfo */
+  if (wave_buffer_size >= sizeof(uint32_t) &&
+      HSAIL_WAVE_SNAPSHOT_MAGIC != *(const uint32_t*)wave_buffer)
+    {
+      gs_legacy_snapshot = hsail_wave_index_convert_legacy(wave_buffer, wave_buffer_size, num_active_waves);
+      is_mapped = (NULL != gs_legacy_snapshot &&
+                   hsail_wave_index_map_snapshot(gs_legacy_snapshot, gs_legacy_snapshot->m_snapshotSize));
+    }
+  else
+    {
+      is_mapped = hsail_wave_index_map_snapshot(wave_buffer, wave_buffer_size);
+    }
+
+  /* the buffer stays attached until the end of the debugging session */
+  hsail_tdep_unmap_wave_buffer((void*)wave_buffer);
+
+  if (!is_mapped)
+    {
+      hsail_wave_index_invalidate();
+      gs_is_buffer_rejected = true;
+      gs_rejected_generation = generation;
+      warning(_("The HSAIL agent reported %d active waves, but GDB cannot read its wave buffer.\n"
+                "The waves are not shown at this stop."),
+              num_active_waves);
+      return false;
+    }
+
+  gs_is_buffer_rejected = false;
+
+  if (0 == gs_snapshot->m_numWaves)
+    {
+      hsail_wave_index_invalidate();
+      return false;
+    }
+
+  hsail_wave_index_build((int)gs_snapshot->m_numWaves);
+
+  gs_index_generation = generation;
+  gs_index_valid = true;
+
+  return true;
+}
+
+/* The overrides of a wave, the overrides are sorted by wave and lane */
+static const HsailWaveLaneOverride* hsail_wave_index_lane_overrides(int wave_index, int* num_overrides)
+{
+  uint32_t first = 0;
+  uint32_t last = gs_snapshot->m_numLaneOverrides;
+  uint32_t end = 0;
+
+  while (first < last)
+    {
+      uint32_t middle = first + (last - first) / 2;
+
+      if (gs_lane_overrides[middle].m_waveIndex < (uint32_t)wave_index)
+        {
+          first = middle + 1;
+        }
+      else
+        {
+          last = middle;
+        }
+    }
+
+  for (end = first; end < gs_snapshot->m_numLaneOverrides &&
+                    gs_lane_overrides[end].m_waveIndex == (uint32_t)wave_index; end++)
+    {
+    }
+
+  *num_overrides = (int)(end - first);
+
+  return &gs_lane_overrides[first];
+}
+
+static void hsail_wave_index_check_wave(int wave_index)
+{
+  gdb_assert(gs_index_valid);
+  gdb_assert(wave_index >= 0 && wave_index < gs_num_waves);
+}
+
+const HsailWaveDim3* hsail_wave_index_workgroup_id(int wave_index)
+{
+  hsail_wave_index_check_wave(wave_index);
+  return &gs_workgroup_ids[wave_index];
+}
+
+uint64_t hsail_wave_index_exec_mask(int wave_index)
+{
+  hsail_wave_index_check_wave(wave_index);
+  return gs_exec_masks[wave_index];
+}
+
+HsailWaveAddress hsail_wave_index_wave_address(int wave_index)
+{
+  hsail_wave_index_check_wave(wave_index);
+  return gs_wave_addresses[wave_index];
+}
+
+HsailProgramCounter hsail_wave_index_pc(int wave_index)
+{
+  hsail_wave_index_check_wave(wave_index);
+  return gs_pcs[wave_index];
+}
+
+const HsailWaveDim3* hsail_wave_index_workgroup_size(void)
+{
+  gdb_assert(gs_index_valid);
+  return &gs_snapshot->m_workGroupSize;
+}
+
+void hsail_wave_index_workitem_id(int wave_index, int lane, HsailWaveDim3* work_item_id)
+{
+  const HsailWaveLaneOverride* overrides = NULL;
+  int num_overrides = 0;
+  int i = 0;
+
+  hsail_wave_index_check_wave(wave_index);
+  gdb_assert(NULL != work_item_id);
+
+  overrides = hsail_wave_index_lane_overrides(wave_index, &num_overrides);
+  for (i = 0; i < num_overrides; i++)
+    {
+      if (overrides[i].m_lane == (uint32_t)lane)
+        {
+          *work_item_id = overrides[i].m_workItemId;
+          return;
+        }
+    }
+
+  hsail_lanes_workitem_id(&gs_base_workitem_ids[wave_index], lane,
+                          &gs_snapshot->m_workGroupSize, work_item_id);
+}
+
+uint64_t hsail_wave_index_match_workitem(int wave_index, const HsailWaveDim3* work_item)
+{
+  const HsailWaveLaneOverride* overrides = NULL;
+  uint64_t match_mask = 0;
+  int num_overrides = 0;
+  int lane = 0;
+  int i = 0;
+
+  hsail_wave_index_check_wave(wave_index);
+  gdb_assert(NULL != work_item);
+
+  lane = hsail_lanes_workitem_lane(&gs_base_workitem_ids[wave_index], work_item,
+                                   &gs_snapshot->m_workGroupSize);
+  if (lane >= 0)
+    {
+      match_mask = (uint64_t)1 << lane;
+    }
+
+  /* An overridden lane matches by its override only */
+  overrides = hsail_wave_index_lane_overrides(wave_index, &num_overrides);
+  for (i = 0; i < num_overrides; i++)
+    {
+      if (overrides[i].m_lane >= HSAIL_WAVE_LANES)
+        {
+          continue;
+        }
+
+      match_mask &= ~((uint64_t)1 << overrides[i].m_lane);
+
+      if (hsail_utils_compare_wavedim3(&overrides[i].m_workItemId, work_item))
+        {
+          match_mask |= (uint64_t)1 << overrides[i].m_lane;
+        }
+    }
+
+  return match_mask;
+}
+
+uint64_t hsail_wave_index_sequence(void)
+{
+  if (!hsail_wave_index_refresh())
+    {
+      return 0;
+    }
+
+  return gs_sequence;
+}
+
+bool hsail_wave_index_wave_moved(int wave_index)
+{
+  hsail_wave_index_check_wave(wave_index);
+
+  if (NULL == gs_changed_wave_bitmap)
+    {
+      return true;
+    }
+
+  return 0 != (gs_changed_wave_bitmap[wave_index / 8] & (1 << (wave_index % 8)));
+}
+
+const int* hsail_wave_index_moved_waves(int* num_moved_waves)
+{
+  int nWave = 0;
+
+  gdb_assert(NULL != num_moved_waves);
+  *num_moved_waves = 0;
+
+  if (!hsail_wave_index_refresh())
+    {
+      return NULL;
+    }
+
+  if (gs_num_moved_waves < 0)
+    {
+      gs_num_moved_waves = 0;
+
+      if (NULL != gs_changed_wave_bitmap && 0 != gs_snapshot->m_baseSequence)
+        {
+          /* The delta records list the same waves as the bitmap */
+          uint32_t nRecord = 0;
+
+          gs_moved_waves = XNEWVEC(int, gs_snapshot->m_numDeltaRecords + 1);
+          for (nRecord = 0; nRecord < gs_snapshot->m_numDeltaRecords; nRecord++)
+            {
+              gs_moved_waves[gs_num_moved_waves++] = gs_delta_records[nRecord].m_waveIndex;
+            }
+        }
+      else
+        {
+          gs_moved_waves = XNEWVEC(int, gs_num_waves);
+          for (nWave = 0; nWave < gs_num_waves; nWave++)
+            {
+              /* skip the bytes of unchanged waves */
+              if (NULL != gs_changed_wave_bitmap && 0 == (nWave % 8) &&
+                  0 == gs_changed_wave_bitmap[nWave / 8])
+                {
+                  nWave += 7;
+                  continue;
+                }
+
+              if (hsail_wave_index_wave_moved(nWave))
+                {
+                  gs_moved_waves[gs_num_moved_waves++] = nWave;
+                }
+            }
+        }
+    }
+
+  *num_moved_waves = gs_num_moved_waves;
+
+  return gs_moved_waves;
+}
+
+int hsail_wave_index_num_waves(void)
+{
+  if (!hsail_wave_index_refresh())
+    {
+      return 0;
+    }
+
+  return gs_num_waves;
+}
+
+int hsail_wave_index_num_workgroups(void)
+{
+  if (!hsail_wave_index_refresh())
+    {
+      return 0;
+    }
+
+  return gs_num_workgroups;
+}
+
+const struct hsail_wave_index_workgroup* hsail_wave_index_get_workgroup(int index)
+{
+  if (!hsail_wave_index_refresh())
+    {
+      return NULL;
+    }
+
+  gdb_assert(index >= 0 && index < gs_num_workgroups);
+
+  return &gs_workgroups[index];
+}
+
+const struct hsail_wave_index_workgroup* hsail_wave_index_find_workgroup(const HsailWaveDim3* work_group_id)
+{
+  struct hsail_wave_index_workgroup key;
+
+  gdb_assert(NULL != work_group_id);
+
+  if (!hsail_wave_index_refresh())
+    {
+      return NULL;
+    }
+
+  key.work_group_id = *work_group_id;
+
+  return htab_find(gs_workgroup_htab, &key);
+}
+
+const struct hsail_wave_index_workgroup* hsail_wave_index_find_workgroup_by_flattened_id(int flattened_id)
+{
+  struct hsail_wave_index_workgroup key;
+
+  if (!hsail_wave_index_refresh())
+    {
+      return NULL;
+    }
+
+  key.flattened_id = flattened_id;
+
+  return htab_find(gs_flattened_id_htab, &key);
+}
+
+bool hsail_wave_index_find_workitem(const HsailWaveDim3* work_group_id,
+                                    const HsailWaveDim3* work_item_id,
+                                    int* wave_index,
+                                    int* lane)
+{
+  struct hsail_wave_index_workgroup key;
+  const struct hsail_wave_index_workgroup* wg = NULL;
+  int nWave = 0;
+
+  gdb_assert(NULL != work_group_id);
+  gdb_assert(NULL != work_item_id);
+
+  if (!hsail_wave_index_refresh())
+    {
+      return false;
+    }
+
+  key.work_group_id = *work_group_id;
+  wg = htab_find(gs_workgroup_htab, &key);
+  if (NULL == wg)
+    {
+      return false;
+    }
+
+  for (nWave = 0; nWave < wg->num_waves; nWave++)
+    {
+      int wave = wg->waves[nWave];
+      uint64_t lane_mask = gs_exec_masks[wave] & hsail_wave_index_match_workitem(wave, work_item_id);
+
+      if (0 != lane_mask)
+        {
+          if (NULL != wave_index)
+            {
+              *wave_index = wave;
+            }
+          if (NULL != lane)
+            {
+              *lane = hsail_lanes_first(lane_mask);
+            }
+
+          return true;
+        }
+    }
+
+  return false;
+}
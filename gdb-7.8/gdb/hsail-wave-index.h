@@ -0,0 +1,109 @@
+/*
+   HSAIL index of the active waves by work-group and work-item
+
+   Copyright (c) 2015 ADVANCED MICRO DEVICES, INC.  All rights reserved.
+   This file includes code originally published under
+
+   Copyright (C) 1986-2014 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#if !defined (HSAIL_WAVE_INDEX_H)
+#define HSAIL_WAVE_INDEX_H 1
+
+#include <stdbool.h>
+
+#include "CommunicationControl.h"
+
+/* A work-group with at least one active wave */
+struct hsail_wave_index_workgroup
+{
+  /* The work-group ID reported by the agent */
+  HsailWaveDim3 work_group_id;
+
+  /* The flattened work-group ID in the active dispatch */
+  int flattened_id;
+
+  /* The position of the work-group in the order the waves report it */
+  int index;
+
+  /* The indexes of this work-group's waves in the wave buffer snapshot */
+  const int* waves;
+  int num_waves;
+};
+
+/*
+ * The index is built from the wave buffer snapshot the first time it is queried
+ * after a stop and is reused until the agent rewrites the wave buffer.
+ * When the agent only sends the waves that changed since the snapshot the index
+ * was built from, the index is updated in place.
+ *
+ * All the functions return NULL / 0 / false if no dispatch is active
+ */
+
+/* Drop the index, the next query rebuilds it */
+void hsail_wave_index_invalidate(void);
+
+int hsail_wave_index_num_waves(void);
+
+/* The fields of a wave, 0 <= wave_index < hsail_wave_index_num_waves().
+ * The wave indexes returned by the other functions stay valid until the next stop */
+const HsailWaveDim3* hsail_wave_index_workgroup_id(int wave_index);
+
+uint64_t hsail_wave_index_exec_mask(int wave_index);
+
+HsailWaveAddress hsail_wave_index_wave_address(int wave_index);
+
+HsailProgramCounter hsail_wave_index_pc(int wave_index);
+
+/* The work-group size reported with the waves */
+const HsailWaveDim3* hsail_wave_index_workgroup_size(void);
+
+/* The local work-item ID of a lane, decoded from the wave buffer when it is asked for */
+void hsail_wave_index_workitem_id(int wave_index, int lane, HsailWaveDim3* work_item_id);
+
+/* The mask of the lanes of a wave whose local work-item ID is work_item */
+uint64_t hsail_wave_index_match_workitem(int wave_index, const HsailWaveDim3* work_item);
+
+/* The sequence number of the wave buffer snapshot, 0 if the agent does not number them */
+uint64_t hsail_wave_index_sequence(void);
+
+/* True if the wave changed since the previous stop.
+ * Every wave has changed if the agent does not say which ones did */
+bool hsail_wave_index_wave_moved(int wave_index);
+
+/* The indexes of the waves that changed since the previous stop, in increasing order */
+const int* hsail_wave_index_moved_waves(int* num_moved_waves);
+
+int hsail_wave_index_num_workgroups(void);
+
+/* Get a work-group by its position, 0 <= index < hsail_wave_index_num_workgroups() */
+const struct hsail_wave_index_workgroup* hsail_wave_index_get_workgroup(int index);
+
+const struct hsail_wave_index_workgroup* hsail_wave_index_find_workgroup(const HsailWaveDim3* work_group_id);
+
+const struct hsail_wave_index_workgroup* hsail_wave_index_find_workgroup_by_flattened_id(int flattened_id);
+
+/* Find the wave and the lane running an active work-item */
+bool hsail_wave_index_find_workitem(const HsailWaveDim3* work_group_id,
+                                    const HsailWaveDim3* work_item_id,
+                                    int* wave_index,
+                                    int* lane);
+
+/* The flattened work-group ID of a work-group in the active dispatch */
+int hsail_wave_index_flattened_workgroup_id(const HsailWaveDim3* work_group_id);
+
+#endif // HSAIL_WAVE_INDEX_H
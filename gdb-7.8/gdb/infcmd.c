@@ -949,12 +949,23 @@ step_1 (int skip_subroutines, int single_inst, char *count_string)
        * each time and we also cannot step over HSAIL functions. Once this is fixed,
        * use the below function call to set step breakpoints.
        *
-       * hsail_set_step_breakpoints(skip_subroutines ? HSAIL_STEP_OVER : HSAIL_STEP_IN, count);
+       * hsail_set_step_breakpoints(skip_subroutines ? HSAIL_STEP_OVER : HSAIL_STEP_IN);
+       *
+       * "step N" repeats single steps while the focus stays on the HSAIL
+       * dispatch, each one armed from the cached step plan. An asynchronous
+       * target returns as soon as the first step is resumed, so it only
+       * takes one.
        */
-       hsail_set_step_breakpoints(HSAIL_STEP_IN, count);
+      for (; count > 0 && target_has_execution && is_hsail_step(); count--)
+        {
+          hsail_set_step_breakpoints(HSAIL_STEP_IN);
 
-      clear_proceed_status();
-      proceed ((CORE_ADDR) -1, 0, 0);
+          clear_proceed_status();
+          proceed ((CORE_ADDR) -1, 0, 0);
+
+          if (target_can_async_p ())
+            break;
+        }
       return;
     }
 
@@ -1746,7 +1757,7 @@ finish_command (char *arg, int from_tty)
 
   if (is_hsail_step())
     {
-      hsail_set_step_breakpoints(HSAIL_STEP_OUT, 1);
+      hsail_set_step_breakpoints(HSAIL_STEP_OUT);
       clear_proceed_status();
       proceed ((CORE_ADDR) -1, 0, 0);
       return;
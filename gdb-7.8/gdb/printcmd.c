@@ -1015,6 +1015,9 @@ print_command_1 (const char *exp, int voidprint)
           case HSAIL_PRINT_WRONG_FORMAT:  error(_("Wrong hsail print format")); break;
           case HSAIL_PRINT_VAR_NOT_FOUND: error(_("Variable not found in current context")); break;
           case HSAIL_PRINT_NO_WAVES:      error(_("No hsail variables information available at start of kernel")); break;
+          case HSAIL_PRINT_GATHER_NOT_SCALAR:    error(_("Only scalar variables can be printed for many work-items")); break;
+          case HSAIL_PRINT_GATHER_NOT_AVAILABLE: error(_("The agent cannot read variables from many work-items")); break;
+          case HSAIL_PRINT_GATHER_FAILED:        error(_("The variable could not be read from the work-items")); break;
         }
       }
       hsail_chain = make_cleanup (hsail_print_cleanup, val);
@@ -1081,6 +1084,9 @@ print_command_1 (const char *exp, int voidprint)
       }
   
       annotate_value_history_end ();
+
+      if (NULL != hsail_chain)
+        hsail_print_members ();
     }
 
   if (NULL != hsail_chain)